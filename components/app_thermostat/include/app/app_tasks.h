@@ -0,0 +1,86 @@
+#ifndef APP_TASKS_H
+#define APP_TASKS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "core/boot.h"
+#include "core/error.h"
+#include "core/rtos_alloc.h"
+#include "core/watchdog.h"
+
+/**
+ * @file app_tasks.h
+ * @brief The application's task plan, as one table.
+ *
+ * Every application task is one row of s_tasks[] in app_tasks.c: entry
+ * point, name, stack, priority, core, watchdog period / deadline and
+ * hooks, and the boot stages it needs. app_tasks_start() runs every
+ * row's init() first, then creates every row back to back, without
+ * yielding to the new tasks, so no task's own start-up (Wi-Fi, LCD, I2C)
+ * delays the creation of another. Each task then runs:
+ *
+ *   boot_wait(row.needs)           declared dependencies (BOOT_BIT()s)
+ *   watchdog_register_current()    rows with wdt.deadline_ms > 0
+ *   row.entry()
+ *
+ * so independent drivers initialise concurrently and ordering lives in
+ * .needs, not in row order. Nothing on the control path (SENSORS,
+ * CONTROL) needs the network: the first relay decision follows the first
+ * sample, not Wi-Fi association (see core/boot.h for the timings).
+ *
+ * Default placement (dual-core ESP32): core 0 (CORE_NET), which also runs
+ * the Wi-Fi driver, lwIP and esp_timer tasks, takes NET, LOGGER,
+ * TELEMETRY, MQTT, HTTPD and HEARTBEAT; core 1 (CORE_CONTROL) takes
+ * SENSORS, CONTROL, BUTTONS and DISPLAY, so radio bursts and TLS do not
+ * delay sampling, the control decision or the LCD bus. Priorities then
+ * only order tasks sharing a core. APP_TASK_PINNING=0 (or a single-core
+ * target) leaves every task unpinned, for comparing control-loop jitter
+ * (watchdog work_max_us / feed_interval_max_us, /metrics) with and
+ * without the plan.
+ */
+
+typedef struct {
+    TaskFunction_t   entry;
+    const char      *name;          // FreeRTOS task name
+    rtos_task_mem_t *mem;           // stack size (+ storage in static builds)
+    UBaseType_t      prio;
+    BaseType_t       core;          // CORE_NET, CORE_CONTROL or tskNO_AFFINITY
+    app_error_t    (*init)(void);   // optional, runs before any task is created
+    uint32_t         needs;         // BOOT_BIT()s reached before entry runs
+    bool             critical;      // creation failure is fatal
+    watchdog_cfg_t   wdt;           // deadline_ms == 0: not supervised
+} app_task_t;
+
+/**
+ * @brief Run every row's init(), then create every task.
+ *
+ * A critical row that fails ends in error_fatal(); other failures are
+ * reported and the remaining rows still start.
+ *
+ * @return ERR_OK if every task started, ERR_TASK_CREATE_FAILED otherwise.
+ */
+app_error_t app_tasks_start(void);
+
+/**
+ * @brief Watchdog restart hook: recreate the task whose row holds @p cfg
+ *        (no init); it registers again once running.
+ */
+void app_tasks_restart(const watchdog_cfg_t *cfg);
+
+/**
+ * @brief The core a row's @p core maps to in this build
+ *        (tskNO_AFFINITY without pinning).
+ */
+BaseType_t app_tasks_core(BaseType_t core);
+
+/**
+ * @brief The task table (for diagnostics).
+ */
+const app_task_t *app_tasks_table(size_t *count);
+
+#endif  // APP_TASKS_H
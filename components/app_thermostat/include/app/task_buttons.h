@@ -1,7 +1,7 @@
 #ifndef TASK_BUTTONS_H
 #define TASK_BUTTONS_H
 
-// Create and start the UI button task.
-void task_buttons_start(void);
+// UI button task (created from the task table, app_tasks.c).
+void task_buttons(void *arg);
 
 #endif  // TASK_BUTTONS_H
@@ -1,20 +1,23 @@
 #ifndef TASK_COMMON_H
 #define TASK_COMMON_H
 
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
-
+#include "core/mailbox.h"
+#include "core/msgbus.h"
+#include "core/history.h"
 #include "core/app_types.h"     // sensor_sample_t
 #include "core/thermostat.h"    // thermostat_state_t
 #include "core/error.h"
 
-// Queue of latest sensor samples (producer: SENSORS, consumer: CONTROL)
-extern QueueHandle_t g_q_sensor_samples;
+// Latest sensor sample (producer: SENSORS, consumer: CONTROL)
+extern mailbox_t g_mb_sensor_samples;
+
+// Down-sampled state history (writer: CONTROL, readers: HTTP API)
+extern history_t g_history;
 
-// Queue of latest thermostat state (producer: CONTROL, consumers: DISPLAY, maybe TELEMETRY)
-extern QueueHandle_t g_q_thermostat_state;
+// Everything else (state, config changes, button events, sample history)
+// is published on the message bus; see core/msgbus.h for the topics.
 
-// Initialize all shared queues used by tasks
+// Initialize all shared mailboxes and bus topics used by tasks
 void tasks_common_init_queues(void);
 
 #endif  // TASK_COMMON_H
@@ -1,15 +1,51 @@
 #ifndef TASK_CONTROL_H
 #define TASK_CONTROL_H
 
+#include <stdbool.h>
+
+#include "core/error.h"
+#include "core/watchdog.h"
+
 /**
- * @brief Start the thermostat control task.
+ * @brief Thermostat control task.
  *
  * This task:
- *   - waits on g_q_sensor_samples for new sensor_sample_t frames
+ *   - waits on g_mb_sensor_samples for new sensor_sample_t frames
  *   - applies hysteresis control around THERMOSTAT_SETPOINT_C
  *   - drives GPIO_HEAT_OUTPUT accordingly
  *   - logs decisions via JSON logger
  */
-void task_control_start(void);
+void task_control(void *arg);
+
+/**
+ * @brief Configure the relay GPIOs (all off). Runs before the task is
+ *        created, so the safe-state hook works from the first moment.
+ */
+app_error_t task_control_init(void);
+
+/**
+ * @brief Watchdog on_miss hook: drop every relay. Called from the
+ *        supervisor while CONTROL is stuck; a single port write.
+ *        CONTROL re-applies its output on its next cycle.
+ */
+void task_control_safe_state(void);
+
+/**
+ * @brief Watchdog detach hook: detach CONTROL from the sample mailbox
+ *        (the only handle to it other tasks use) before it is deleted.
+ *
+ * @return false if CONTROL holds the config mutex; the supervisor then
+ *         resets instead of restarting.
+ */
+bool task_control_detach(void *task);
+
+/**
+ * @brief Re-run the control decision on the latest sample right away.
+ *
+ * Call after changing the mode or the config so the relays follow
+ * within one scheduling round instead of at the next sensor sample.
+ * Safe from any task.
+ */
+void task_control_kick(void);
 
 #endif
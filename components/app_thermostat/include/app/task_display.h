@@ -1,7 +1,7 @@
 #ifndef TASK_DISPLAY_H
 #define TASK_DISPLAY_H
 
-// Create and start the UI / display task
-void task_display_start(void);
+// UI / display task (created from the task table, app_tasks.c)
+void task_display(void *arg);
 
 #endif // TASK_DISPLAY_H
@@ -1,6 +1,7 @@
 #ifndef TASK_HEARTBEAT_H
 #define TASK_HEARTBEAT_H
 
-void task_heartbeat_start(void);
+// LED blink + alive message (created from the task table, app_tasks.c).
+void task_heartbeat(void *arg);
 
 #endif
@@ -0,0 +1,23 @@
+#ifndef TASK_HTTPD_H
+#define TASK_HTTPD_H
+
+/**
+ * @brief One-shot task: start the local HTTP API once the network is up.
+ *
+ * Read-only JSON endpoints, served by the esp_http_server task at
+ * TASK_PRIO_HTTPD:
+ *   GET /state            latest thermostat state
+ *   GET /config           setpoint / hysteresis and their limits
+ *   GET /history[?limit=N] down-sampled state history, oldest first
+ *   GET /metrics          counters of the other subsystems
+ *   GET /metrics/prom     metrics registry, Prometheus text format
+ *   GET /metrics/bin      metrics registry, compact binary (metrics.h)
+ *
+ * Handlers only read lock-free snapshots (message bus, history ring,
+ * stats copies) and stream the body in HTTPD_CHUNK_LEN chunks, so
+ * request load never holds a lock the control path needs and no response
+ * is ever buffered whole.
+ */
+void task_httpd(void *arg);
+
+#endif  // TASK_HTTPD_H
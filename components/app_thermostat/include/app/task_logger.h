@@ -1,6 +1,7 @@
 #ifndef TASK_LOGGER_H
 #define TASK_LOGGER_H
 
-void task_logger_start(void);
+// Drains the log queue (created from the task table, app_tasks.c).
+void task_logger(void *arg);
 
 #endif
\ No newline at end of file
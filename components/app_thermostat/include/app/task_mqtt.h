@@ -0,0 +1,38 @@
+#ifndef TASK_MQTT_H
+#define TASK_MQTT_H
+
+#include <stdint.h>
+
+/**
+ * @brief MQTT counters (for diagnostics).
+ */
+typedef struct {
+    uint32_t connects;           // sessions established
+    uint32_t commands;           // commands applied
+    uint32_t commands_rejected;  // unknown command or bad value
+    uint32_t states_published;   // retained state messages
+    uint32_t batches_published;  // sample batch messages
+    uint32_t samples_published;  // samples in those batches
+    uint32_t samples_dropped;    // discarded while offline / before SNTP
+    uint32_t publish_failures;   // outbox full / client error
+} mqtt_stats_t;
+
+/**
+ * @brief MQTT task: owns the MQTT client.
+ *
+ * Inbound: commands on MQTT_TOPIC_BASE "/cmd/<name>" are parsed by
+ * core/mqtt_cmd and applied from the client's event callback, followed
+ * by task_control_kick(), so a remote change reaches the relays without
+ * waiting for the next sensor sample.
+ *
+ * Outbound: the task follows thermostat state on the message bus and
+ *  - publishes mode / output / setpoint / hysteresis as a retained QoS 1
+ *    message when one of them changes (rate limited, newest value wins)
+ *  - batches samples into one QoS 0 protobuf message per
+ *    MQTT_SAMPLE_BATCH samples or MQTT_SAMPLE_FLUSH_MS
+ */
+void task_mqtt(void *arg);
+
+void task_mqtt_get_stats(mqtt_stats_t *out);
+
+#endif  // TASK_MQTT_H
@@ -1,15 +1,42 @@
 #ifndef TASK_NET_H
 #define TASK_NET_H
 
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "core/error.h"
+
 /**
- * @brief Start the Wi-Fi / NET task.
+ * @brief Create the NET event group and connection state. Runs before
+ *        any task exists, so every consumer can wait on it.
+ */
+app_error_t task_net_init(void);
+
+/**
+ * @brief Wi-Fi / NET task.
  *
  * The task:
  *  - Initializes NVS (required by Wi-Fi)
  *  - Initializes esp_netif and event loop
  *  - Brings up Wi-Fi STA and attempts to connect to WIFI_SSID
+ *  - Reconnects forever with jittered exponential backoff
+ *    (WIFI_BACKOFF_BASE_MS .. WIFI_BACKOFF_MAX_MS)
  *  - Logs connection / disconnection / IP events
  */
-void task_net_start(void);
+void task_net(void *arg);
+
+/**
+ * @brief True while the station has an IP address.
+ */
+bool task_net_is_connected(void);
+
+/**
+ * @brief Block until the station has an IP address or @p timeout passes.
+ *
+ * Wakes as soon as the IP event is delivered, not on a poll tick.
+ *
+ * @return task_net_is_connected() on return.
+ */
+bool task_net_wait_connected(TickType_t timeout);
 
 #endif  // TASK_NET_H
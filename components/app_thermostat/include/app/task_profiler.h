@@ -0,0 +1,24 @@
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+/**
+ * @brief Profiler task (profiling builds only: its task table row exists
+ *        only with APP_PROFILE=1).
+ *
+ * Every PROFILE_PERIOD_MS logs one line per task:
+ *   name, priority, CPU share of one core over the period,
+ *   stack used / configured (worst case since boot), recommended stack
+ *   size (used + PROFILE_STACK_HEADROOM_PCT, rounded), and loop wakeups
+ *   per second for watchdog-supervised tasks
+ * followed by a heap / stack summary. Lines are paced so the report
+ * leaves PROFILE_LOG_FREE_SLOTS of the log queue to other tasks. Tasks
+ * created by ESP-IDF (Wi-Fi, lwIP, esp_timer, ...) get no
+ * recommendation: their size is not ours.
+ *
+ * FreeRTOS keeps no per-task context-switch count; the watchdog feed
+ * rate (one per loop iteration) stands in for it. Configured stack sizes
+ * come from the task table (app/app_tasks.h).
+ */
+void task_profiler(void *arg);
+
+#endif  // TASK_PROFILER_H
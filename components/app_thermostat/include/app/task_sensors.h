@@ -1,6 +1,12 @@
 #ifndef TASK_SENSORS_H
 #define TASK_SENSORS_H
 
-void task_sensors_start(void);
+#include <stdint.h>
+
+// Sensor acquisition task (created from the task table, app_tasks.c).
+void task_sensors(void *arg);
+
+// Currently selected (adaptive) sampling period in milliseconds.
+uint32_t task_sensors_get_period_ms(void);
 
 #endif
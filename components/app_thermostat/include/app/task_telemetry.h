@@ -0,0 +1,38 @@
+#ifndef TASK_TELEMETRY_H
+#define TASK_TELEMETRY_H
+
+#include <stdint.h>
+
+/**
+ * @brief Upload counters (for diagnostics).
+ */
+typedef struct {
+    uint32_t samples;         // states taken from the bus
+    uint32_t samples_sent;    // states acknowledged by the server
+    uint32_t batches_sent;    // successful POSTs
+    uint32_t bytes_sent;      // body bytes of successful POSTs
+    uint32_t post_failures;   // transport errors or non-2xx replies
+    uint32_t dropped;         // samples discarded (spool unavailable)
+    uint32_t bus_dropped;     // states missed on the bus (lagging reader)
+    uint32_t spooled;         // samples moved to the flash spool
+    uint32_t replayed;        // spooled samples delivered
+    uint32_t spool_pending;   // spooled samples awaiting delivery
+    uint32_t spool_lost;      // spooled samples overwritten before delivery
+    uint32_t spool_untimed;   // spooled samples dropped: their boot never got the time
+} telemetry_stats_t;
+
+/**
+ * @brief TELEMETRY task.
+ *
+ * Subscribes to thermostat state on the message bus, batches up to
+ * TELEMETRY_BATCH_MAX samples and POSTs them as one delta-coded protobuf
+ * message (JSON if the server does not accept it) over a persistent
+ * (keep-alive) HTTP connection. Samples that cannot be sent
+ * spill to the "spool" flash partition and are replayed in order at a
+ * bounded rate once the server is reachable again.
+ */
+void task_telemetry(void *arg);
+
+void task_telemetry_get_stats(telemetry_stats_t *out);
+
+#endif  // TASK_TELEMETRY_H
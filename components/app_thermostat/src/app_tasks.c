@@ -0,0 +1,222 @@
+#include "app/app_tasks.h"
+
+#include "sdkconfig.h"
+
+#include "core/boot.h"
+#include "core/config.h"
+#include "core/logging.h"
+
+#include "app/task_buttons.h"
+#include "app/task_control.h"
+#include "app/task_display.h"
+#include "app/task_heartbeat.h"
+#include "app/task_httpd.h"
+#include "app/task_logger.h"
+#include "app/task_mqtt.h"
+#include "app/task_net.h"
+#include "app/task_profiler.h"
+#include "app/task_sensors.h"
+#include "app/task_telemetry.h"
+
+static const char *TAG = "TASKS";
+
+RTOS_TASK_MEM(s_mem_net,       TASK_STACK_NET);
+RTOS_TASK_MEM(s_mem_logger,    TASK_STACK_LOGGER);
+RTOS_TASK_MEM(s_mem_sensors,   TASK_STACK_SENSORS);
+RTOS_TASK_MEM(s_mem_control,   TASK_STACK_CONTROL);
+RTOS_TASK_MEM(s_mem_buttons,   TASK_STACK_BUTTONS);
+RTOS_TASK_MEM(s_mem_display,   TASK_STACK_DISPLAY);
+RTOS_TASK_MEM(s_mem_telemetry, TASK_STACK_TELEMETRY);
+RTOS_TASK_MEM(s_mem_mqtt,      TASK_STACK_MQTT);
+RTOS_TASK_MEM(s_mem_httpd,     TASK_STACK_HTTPD_BOOT);
+RTOS_TASK_MEM(s_mem_heartbeat, TASK_STACK_HEARTBEAT);
+#if APP_PROFILE
+RTOS_TASK_MEM(s_mem_profiler,  TASK_STACK_PROFILER);
+#endif
+
+// Row order is only creation order: every row is created before any of
+// them runs (see app_tasks_start()), and dependencies are .needs. The
+// control path comes first so it is on its core first; HEARTBEAT's first
+// blink still means the whole table was created.
+static const app_task_t s_tasks[] = {
+    {
+        .entry = task_sensors, .name = "task_sensors", .mem = &s_mem_sensors,
+        .prio = TASK_PRIO_SENSORS, .core = CORE_CONTROL, .critical = true,
+        // Loop period adapts up to PERIOD_SENSORS_MAX_MS.
+        .wdt = { .name = "SENSORS", .period_ms = PERIOD_SENSORS_MS,
+                 .deadline_ms = PERIOD_SENSORS_MAX_MS + WATCHDOG_DEADLINE_MS },
+    },
+    {
+        .entry = task_control, .name = "task_control", .mem = &s_mem_control,
+        .prio = TASK_PRIO_CONTROL, .core = CORE_CONTROL, .init = task_control_init,
+        .critical = true,
+        .wdt = { .name = "CONTROL", .period_ms = 1000,
+                 .deadline_ms = WATCHDOG_DEADLINE_MS,
+                 .on_miss = task_control_safe_state,
+                 .detach = task_control_detach,
+                 .restart = app_tasks_restart },
+    },
+    {
+        .entry = task_buttons, .name = "task_buttons", .mem = &s_mem_buttons,
+        .prio = TASK_PRIO_BUTTONS, .core = CORE_CONTROL,
+        .wdt = { .name = "BUTTONS", .period_ms = 1000,
+                 .deadline_ms = WATCHDOG_DEADLINE_MS },
+    },
+    {
+        .entry = task_display, .name = "task_display", .mem = &s_mem_display,
+        .prio = TASK_PRIO_DISPLAY, .core = CORE_CONTROL,
+        .wdt = { .name = "DISPLAY", .period_ms = 1000,
+                 .deadline_ms = WATCHDOG_DEADLINE_MS },
+    },
+    {
+        .entry = task_logger, .name = "task_logger", .mem = &s_mem_logger,
+        .prio = TASK_PRIO_LOGGER, .core = CORE_NET, .critical = true,
+        .wdt = { .name = "LOGGER", .period_ms = PERIOD_LOGGER_MS,
+                 .deadline_ms = WATCHDOG_DEADLINE_MS,
+                 // Stuck means stuck in printf, holding the stdout lock:
+                 // deleting it would wedge every later printf. A silent
+                 // console is not worth a reset either; log_post() never
+                 // blocks on the full queue.
+                 .report_only = true },
+    },
+    {
+        .entry = task_net, .name = "task_net", .mem = &s_mem_net,
+        .prio = TASK_PRIO_NET, .core = CORE_NET, .init = task_net_init,
+        .wdt = { .name = "NET", .period_ms = 1000,
+                 .deadline_ms = WATCHDOG_DEADLINE_MS },
+    },
+    {
+        .entry = task_telemetry, .name = "task_telemetry", .mem = &s_mem_telemetry,
+        .prio = TASK_PRIO_TELEMETRY, .core = CORE_NET,
+        // A stalled upload only delays data (the spool keeps it); never
+        // worth a reset, and the task owns a socket and a bus subscription.
+        .wdt = { .name = "TELEMETRY", .period_ms = 1000,
+                 .deadline_ms = TELEMETRY_WDT_DEADLINE_MS,
+                 .report_only = true },
+    },
+    {
+        .entry = task_mqtt, .name = "task_mqtt", .mem = &s_mem_mqtt,
+        .prio = TASK_PRIO_MQTT, .core = CORE_NET,
+        .wdt = { .name = "MQTT", .period_ms = 1000,
+                 .deadline_ms = WATCHDOG_DEADLINE_MS + MQTT_NETWORK_TIMEOUT_MS },
+    },
+    {
+        // One-shot bootstrap; the server runs in its own task.
+        .entry = task_httpd, .name = "task_httpd", .mem = &s_mem_httpd,
+        .prio = TASK_PRIO_HTTPD, .core = CORE_NET,
+        .needs = BOOT_BIT(BOOT_STAGE_NET_UP),
+    },
+    {
+        .entry = task_heartbeat, .name = "task_heartbeat", .mem = &s_mem_heartbeat,
+        .prio = TASK_PRIO_HEARTBEAT, .core = CORE_NET,
+        .wdt = { .name = "HEARTBEAT", .period_ms = 1000,
+                 .deadline_ms = WATCHDOG_DEADLINE_MS,
+                 .restart = app_tasks_restart },
+    },
+#if APP_PROFILE
+    {
+        .entry = task_profiler, .name = "task_profiler", .mem = &s_mem_profiler,
+        .prio = TASK_PRIO_PROFILER, .core = tskNO_AFFINITY,
+    },
+#endif
+};
+
+#define APP_TASK_COUNT   (sizeof(s_tasks) / sizeof(s_tasks[0]))
+
+static TaskHandle_t s_handles[APP_TASK_COUNT];
+
+// Every task starts here: wait for the row's boot stages, register with
+// the watchdog only then (waiting is not a missed deadline), run the entry.
+static void task_gate(void *arg)
+{
+    const app_task_t *t = arg;
+
+    boot_wait(t->needs, portMAX_DELAY);
+    if (t->wdt.deadline_ms > 0) {
+        watchdog_register_current(&t->wdt);
+    }
+    t->entry(NULL);
+
+    vTaskDelete(NULL);
+}
+
+static app_error_t create_row(size_t i)
+{
+    const app_task_t *t = &s_tasks[i];
+
+    return rtos_task_create(task_gate, t->name, (void *)t, t->prio,
+                            app_tasks_core(t->core), t->mem, &s_handles[i]);
+}
+
+BaseType_t app_tasks_core(BaseType_t core)
+{
+#if APP_TASK_PINNING && !CONFIG_FREERTOS_UNICORE
+    return (core >= 0 && core < portNUM_PROCESSORS) ? core : tskNO_AFFINITY;
+#else
+    (void)core;
+    return tskNO_AFFINITY;
+#endif
+}
+
+app_error_t app_tasks_start(void)
+{
+    app_error_t errs[APP_TASK_COUNT];
+    size_t      started = 0;
+
+    // Hooks first: they only set up state the tasks share (event groups,
+    // GPIO levels), so no task can observe it half-built.
+    for (size_t i = 0; i < APP_TASK_COUNT; i++) {
+        errs[i] = (s_tasks[i].init != NULL) ? s_tasks[i].init() : ERR_OK;
+    }
+
+    // Outrank every new task while creating, so e.g. NET (same core, higher
+    // priority than app_main) cannot run its Wi-Fi bring-up before SENSORS
+    // and CONTROL even exist. The other core starts its tasks right away.
+    const UBaseType_t prio = uxTaskPriorityGet(NULL);
+    vTaskPrioritySet(NULL, configMAX_PRIORITIES - 1);
+
+    for (size_t i = 0; i < APP_TASK_COUNT; i++) {
+        if (errs[i] == ERR_OK) {
+            errs[i] = create_row(i);
+        }
+        if (errs[i] == ERR_OK) {
+            started++;
+        }
+    }
+
+    boot_mark(BOOT_STAGE_TASKS);
+    vTaskPrioritySet(NULL, prio);
+
+    for (size_t i = 0; i < APP_TASK_COUNT; i++) {
+        if (errs[i] == ERR_OK) {
+            continue;
+        }
+        if (s_tasks[i].critical) {
+            error_fatal(errs[i], s_tasks[i].name);
+        }
+        error_report(errs[i], s_tasks[i].name);
+    }
+
+    log_post(LOG_LEVEL_INFO, TAG, "%u/%u tasks started (pinning %s)",
+             (unsigned)started, (unsigned)APP_TASK_COUNT,
+             (app_tasks_core(CORE_CONTROL) == tskNO_AFFINITY) ? "off" : "on");
+    return (started == APP_TASK_COUNT) ? ERR_OK : ERR_TASK_CREATE_FAILED;
+}
+
+void app_tasks_restart(const watchdog_cfg_t *cfg)
+{
+    for (size_t i = 0; i < APP_TASK_COUNT; i++) {
+        if (&s_tasks[i].wdt == cfg) {
+            create_row(i);
+            return;
+        }
+    }
+}
+
+const app_task_t *app_tasks_table(size_t *count)
+{
+    if (count != NULL) {
+        *count = APP_TASK_COUNT;
+    }
+    return s_tasks;
+}
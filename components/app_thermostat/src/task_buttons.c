@@ -1,3 +1,5 @@
+#include <stdbool.h>
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -5,12 +7,15 @@
 #include "core/logging.h"
 #include "core/watchdog.h"
 #include "core/error.h"
+#include "core/boot.h"
 
 #include "core/thermostat_config.h"
 #include "drivers/drv_buttons.h"
 #include "core/thermostat.h" // <-- for thermostat_get_mode / thermostat_set_mode
 
 #include "app/task_buttons.h"
+#include "app/task_control.h"   // task_control_kick
+#include "app/task_common.h"    // MSGBUS_TOPIC_BUTTON
 
 static const char *TAG = "BTN_UI";
 
@@ -18,53 +23,28 @@ static const char *TAG = "BTN_UI";
 
 /* ---------------- Setpoint helper ---------------- */
 
+static void add_setpoint_delta(thermostat_config_t *cfg, void *ctx)
+{
+    cfg->setpoint_c += *(const float *)ctx;
+}
+
 static void apply_setpoint_delta(float delta_c)
 {
     thermostat_config_t cfg;
-    if (thermostat_config_get(&cfg) != ERR_OK) {
-        error_report(ERR_GENERIC, "thermostat_config_get");
-        return;
-    }
-
-    cfg.setpoint_c += delta_c;
-
-    if (thermostat_config_get(&cfg) != ERR_OK) {
-        error_report(ERR_GENERIC, "thermostat_config_get");
-        return;
-    }
-
-    cfg.setpoint_c += delta_c;
-
-    if (cfg.setpoint_c < THERMOSTAT_SP_MIN_C) {
-        cfg.setpoint_c = THERMOSTAT_SP_MIN_C;
-    } else if (cfg.setpoint_c > THERMOSTAT_SP_MAX_C) {
-        cfg.setpoint_c = THERMOSTAT_SP_MAX_C;
-    }
-
-    if (thermostat_config_set(&cfg) != ERR_OK) {
-        error_report(ERR_GENERIC, "thermostat_config_set");
+    if (thermostat_config_update(add_setpoint_delta, &delta_c, &cfg) != ERR_OK) {
+        error_report(ERR_GENERIC, "thermostat_config_update");
         return;
     }
 
-    log_post(LOG_LEVEL_INFO, TAG,
-             "Setpoint changed to %.1f C (delta=%.1f)",
+    // Settled value is logged by thermostat_config once the burst ends.
+    log_post(LOG_LEVEL_DEBUG, TAG,
+             "Setpoint %.1f C (delta=%.1f)",
              cfg.setpoint_c, delta_c);
 }
 
 /**
  * @brief Cycle mode: HEAT -> COOL -> OFF -> HEAT ...
  */
-static const char *mode_to_str(thermostat_mode_t mode)
-{
-    switch (mode) {
-    case THERMOSTAT_MODE_OFF:  return "OFF";
-    case THERMOSTAT_MODE_HEAT: return "HEAT";
-    case THERMOSTAT_MODE_COOL: return "COOL";
-    case THERMOSTAT_MODE_AUTO: return "AUTO";
-    default:                   return "UNKNOWN";
-    }
-}
- 
 static void cycle_mode(void)
 {
     thermostat_mode_t current;
@@ -97,11 +77,12 @@ static void cycle_mode(void)
         error_report(ERR_GENERIC, "thermostat_set_mode");
         return;
     }
+    task_control_kick();    // relays follow the new mode right away
 
     log_post(LOG_LEVEL_INFO, TAG,
              "Mode changed: %s -> %s",
-             mode_to_str(current),
-             mode_to_str(next));
+             thermostat_mode_to_str(current),
+             thermostat_mode_to_str(next));
 }
 
 /* ---------------- Task ---------------- */
@@ -109,60 +90,48 @@ static void cycle_mode(void)
 /**
  * @brief Task that consumes button events and adjusts thermostat setpoint / mode.
  *
- * Uses a simple time-based debounce in task context.
+ * Events arrive already debounced from the driver: one PRESS per physical
+ * press, then accelerating REPEATs while UP/DOWN are held.
  */
-static void task_buttons(void *arg)
+void task_buttons(void *arg)
 {
     (void)arg;
 
-    watchdog_register_current("BUTTONS");
-
     if (drv_buttons_init() != ERR_OK) {
         error_fatal(ERR_GENERIC, "drv_buttons_init");
     }
+    boot_mark(BOOT_STAGE_BUTTONS_INIT);
 
     QueueHandle_t q = drv_buttons_get_queue();
     if (q == NULL) {
         error_fatal(ERR_GENERIC, "drv_buttons_get_queue");
     }
 
-     // Debounce: remember last accepted event time per button
-    TickType_t last_up_ticks   = 0;
-    TickType_t last_down_ticks = 0;
-    TickType_t last_mode_ticks = 0;
-
-    const TickType_t debounce_ticks = pdMS_TO_TICKS(BUTTON_DEBOUNCE_MS);
-
     while (1) {
         button_event_t evt;
-        if (xQueueReceive(q, &evt, portMAX_DELAY) == pdTRUE) {
-            TickType_t now = xTaskGetTickCount();
-
-            switch (evt) {
-            case BUTTON_EVENT_UP:
-                if ((now - last_up_ticks) >= debounce_ticks) {
+        // Wake once a second even without input, for the watchdog.
+        const bool got = xQueueReceive(q, &evt, pdMS_TO_TICKS(1000)) == pdTRUE;
+        watchdog_loop_begin();
+        if (got) {
+            bool step = (evt.action == BUTTON_ACTION_PRESS ||
+                         evt.action == BUTTON_ACTION_REPEAT);
+
+            switch (evt.button) {
+            case BUTTON_ID_UP:
+                if (step) {
                     apply_setpoint_delta(+THERMOSTAT_SP_STEP_C);
-                    last_up_ticks = now;
-                } else {
-                    log_post(LOG_LEVEL_DEBUG, TAG, "UP ignored (debounce)");
                 }
                 break;
 
-            case BUTTON_EVENT_DOWN:
-                if ((now - last_down_ticks) >= debounce_ticks) {
+            case BUTTON_ID_DOWN:
+                if (step) {
                     apply_setpoint_delta(-THERMOSTAT_SP_STEP_C);
-                    last_down_ticks = now;
-                } else {
-                    log_post(LOG_LEVEL_DEBUG, TAG, "DOWN ignored (debounce)");
                 }
                 break;
 
-            case BUTTON_EVENT_MODE:
-                if ((now - last_mode_ticks) >= debounce_ticks) {
+            case BUTTON_ID_MODE:
+                if (evt.action == BUTTON_ACTION_PRESS) {
                     cycle_mode();
-                    last_mode_ticks = now;
-                } else {
-                    log_post(LOG_LEVEL_DEBUG, TAG, "MODE ignored (debounce)");
                 }
                 break;
 
@@ -171,20 +140,10 @@ static void task_buttons(void *arg)
                 break;
             }
 
-
-            watchdog_feed();
+            // Let other tasks follow UI activity (logging, telemetry).
+            msgbus_publish(MSGBUS_TOPIC_BUTTON, &evt);
         }
-    }
-}
 
-void task_buttons_start(void)
-{
-    xTaskCreate(
-        task_buttons,
-        "task_buttons",
-        TASK_STACK_BUTTONS,
-        NULL,
-        TASK_PRIO_BUTTONS,
-        NULL
-    );
+        watchdog_feed();
+    }
 }
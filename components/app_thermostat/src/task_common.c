@@ -1,28 +1,56 @@
 #include "app/task_common.h"
 
-// Global queues shared between tasks
-QueueHandle_t g_q_sensor_samples    = NULL;
-QueueHandle_t g_q_thermostat_state  = NULL;
+#include "core/config.h"
+#include "core/thermostat_config.h"
+#include "drivers/drv_buttons.h"    // button_event_t
+
+// Latest-value mailbox shared between SENSORS and CONTROL
+mailbox_t g_mb_sensor_samples;
+
+static sensor_sample_t s_sensor_sample_slot;
+
+history_t g_history;
+
+static history_slot_t s_history_slots[HISTORY_DEPTH];
+
+// Topic rings (depth = how far a subscriber may fall behind)
+#define RING_DEPTH_SENSOR   4
+#define RING_DEPTH_STATE    4
+#define RING_DEPTH_CONFIG   2
+#define RING_DEPTH_BUTTON   8
+
+static uint8_t s_ring_sensor[MSGBUS_RING_BYTES(sizeof(sensor_sample_t), RING_DEPTH_SENSOR)]
+    __attribute__((aligned(8)));
+static uint8_t s_ring_state[MSGBUS_RING_BYTES(sizeof(thermostat_state_t), RING_DEPTH_STATE)]
+    __attribute__((aligned(8)));
+static uint8_t s_ring_config[MSGBUS_RING_BYTES(sizeof(thermostat_config_t), RING_DEPTH_CONFIG)]
+    __attribute__((aligned(8)));
+static uint8_t s_ring_button[MSGBUS_RING_BYTES(sizeof(button_event_t), RING_DEPTH_BUTTON)]
+    __attribute__((aligned(8)));
+
+// Settled config changes go out on the bus (already coalesced by thermostat_config).
+static void on_config_changed(const thermostat_config_t *cfg, void *ctx)
+{
+    (void)ctx;
+    msgbus_publish(MSGBUS_TOPIC_CONFIG, cfg);
+}
 
 void tasks_common_init_queues(void) {
-    // Overwrite queue since control only needs latest sample
-    g_q_sensor_samples = xQueueCreate(
-        1,                         // queue length
-        sizeof(sensor_sample_t)    // element size
-    );
-
-    if (g_q_sensor_samples == NULL) {
-    error_fatal(ERR_QUEUE_CREATE_FAILED, "g_q_sensor_samples");
-    }
-
-
-    // Overwrite queue for thermostat state as well
-    g_q_thermostat_state = xQueueCreate(
-        1,                         // depth, tune as needed
-        sizeof(thermostat_state_t) //element size
-    );
-
-    if (g_q_thermostat_state == NULL){
-        error_fatal(ERR_QUEUE_CREATE_FAILED, "g_q_thermostat_state");
-    }
+    // Control only needs the latest sample
+    mailbox_init(&g_mb_sensor_samples,
+                 &s_sensor_sample_slot,
+                 sizeof(s_sensor_sample_slot));
+
+    msgbus_topic_init(MSGBUS_TOPIC_SENSOR_SAMPLE, s_ring_sensor,
+                      sizeof(sensor_sample_t), RING_DEPTH_SENSOR);
+    msgbus_topic_init(MSGBUS_TOPIC_THERMOSTAT_STATE, s_ring_state,
+                      sizeof(thermostat_state_t), RING_DEPTH_STATE);
+    msgbus_topic_init(MSGBUS_TOPIC_CONFIG, s_ring_config,
+                      sizeof(thermostat_config_t), RING_DEPTH_CONFIG);
+    msgbus_topic_init(MSGBUS_TOPIC_BUTTON, s_ring_button,
+                      sizeof(button_event_t), RING_DEPTH_BUTTON);
+
+    history_init(&g_history, s_history_slots, HISTORY_DEPTH, HISTORY_INTERVAL_MS);
+
+    thermostat_config_set_listener(on_config_changed, NULL);
 }
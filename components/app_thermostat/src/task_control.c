@@ -1,18 +1,21 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
 
 #include "driver/gpio.h"
+#include "drivers/drv_gpio_port.h"  // single-write relay changeover
 
 #include "core/config.h"
 #include "core/logging.h"
 #include "core/watchdog.h"
 #include "core/app_types.h"
 #include "core/error.h"
+#include "core/metrics.h"
+#include "core/monotime.h"
+#include "core/boot.h"
 
 #include "core/thermostat.h"      // thermostat_core_init, thermostat_core_process_sample
 
-#include "app/task_common.h"      // g_q_sensor_samples
+#include "app/task_common.h"      // g_mb_sensor_samples, g_history
 #include "app/task_control.h"
 
 #include "core/thermostat_config.h"
@@ -23,6 +26,12 @@
 
 static const char *TAG = "CONTROL";
 
+// Precomputed relay patterns, indexed by thermostat_output_t.
+static drv_gpio_port_masks_t s_output_masks[3];
+
+static volatile bool s_kick = false;    // re-evaluate without a new sample
+static volatile bool s_forced_off = false;  // relays cut behind CONTROL's back
+
 /**
  * @brief Configure the GPIO pin used to drive the heating output.
  *
@@ -50,9 +59,16 @@ static void control_gpio_init(void) {
     };
     gpio_config(&io_conf);
 
+    // One port write per output state. Clears are applied before sets, so
+    // heat and cool are never both energized during a changeover.
+    drv_gpio_port_build(&s_output_masks[THERMOSTAT_OUTPUT_OFF],     mask, 0);
+    drv_gpio_port_build(&s_output_masks[THERMOSTAT_OUTPUT_HEAT_ON], mask,
+                        1ULL << GPIO_HEAT_OUTPUT);
+    drv_gpio_port_build(&s_output_masks[THERMOSTAT_OUTPUT_COOL_ON], mask,
+                        1ULL << GPIO_COOL_OUTPUT);
+
     // Start with everything OFF so we never boot into an ON state accidentally
-    gpio_set_level(GPIO_HEAT_OUTPUT, 0);
-    gpio_set_level(GPIO_COOL_OUTPUT, 0);
+    drv_gpio_port_apply(&s_output_masks[THERMOSTAT_OUTPUT_OFF]);
 }
 
 /**
@@ -63,152 +79,179 @@ static void control_gpio_init(void) {
  */
 static void apply_outputs(thermostat_output_t output)
 {
-    int heat_level = 0;
-    int cool_level = 0;
-
     switch (output) {
         case THERMOSTAT_OUTPUT_HEAT_ON:
-            heat_level = 1;
-            cool_level = 0;
-            break;
-
         case THERMOSTAT_OUTPUT_COOL_ON:
-            heat_level = 0;
-            cool_level = 1;
             break;
 
         case THERMOSTAT_OUTPUT_OFF:
         default:
-            heat_level = 0;
-            cool_level = 0;
+            output = THERMOSTAT_OUTPUT_OFF;
             break;
         }
 
-    gpio_set_level(GPIO_HEAT_OUTPUT, heat_level);
-    gpio_set_level(GPIO_COOL_OUTPUT, cool_level);
+    drv_gpio_port_apply(&s_output_masks[output]);
+}
+
+app_error_t task_control_init(void)
+{
+    // Before the task exists: the safe-state hook uses the output masks.
+    control_gpio_init();
+    return ERR_OK;
+}
+
+void task_control_safe_state(void)
+{
+    apply_outputs(THERMOSTAT_OUTPUT_OFF);
+
+    // CONTROL's idea of the relays is stale now; if it recovers, make it
+    // drive them again instead of reporting an output that is not applied.
+    __atomic_store_n(&s_forced_off, true, __ATOMIC_RELEASE);
+}
+
+bool task_control_detach(void *task)
+{
+    // Kicks and samples both wake CONTROL through the mailbox; once it
+    // has no waiter, nothing notifies the old TCB.
+    mailbox_attach(&g_mb_sensor_samples, NULL);
+
+    // Config readers wait forever: deleting the holder would wedge the
+    // UI, MQTT and the web server with it. Reset instead.
+    return !thermostat_config_held_by(task);
 }
 
 /**
  * @brief Thermostat CONTROL task.
  *
  * Responsibilities:
- *   - Wait for new sensor samples from g_q_sensor_samples
+ *   - Wait for new sensor samples from g_mb_sensor_samples
  *   - Pass the samples into the thermostat core
  *   - Apply the resulting output to the HEAT / COOL GPIOs
- *   - Publish the state to g_q_thermostat_state for UI / telemetry
+ *   - Publish the state on MSGBUS_TOPIC_THERMOSTAT_STATE for UI / telemetry
  *   - Log decisions (INFO on state change, DEBUG on keep-state)
  *   - Feed watchdog regularly
  *
  * CONTROL is a thin adapter between:
- *   - RTOS / queues / hardware
+ *   - RTOS / mailboxes / hardware
  *   - thermostat decision logic in core/thermostat.c
  */
-static void task_control(void *arg) {
+void task_control(void *arg) {
     (void)arg;
 
-    // Register this task with the watchdog framework so the system
-    // can detect if control logic stops running.
-    watchdog_register_current("CONTROL");
-
-    // Ensure heater GPIO is configured and OFF.
-    control_gpio_init();
-
     sensor_sample_t     sample;
     thermostat_state_t  th_state;
     thermostat_output_t prev_output = THERMOSTAT_OUTPUT_OFF;
+    bool                have_sample = false;
 
     char msg_buf[128];  // Buffer for formatted log messages.
 
+    // Get woken directly by the SENSORS task on every publish, and by
+    // task_control_kick() after a mode / config change.
+    uint32_t sample_seq = 0;
+    mailbox_attach(&g_mb_sensor_samples, xTaskGetCurrentTaskHandle());
+
     while (1) {
-        // Block until we receive a new sensor sample from the SENSORS task.
-        // The SENSORS task uses xQueueOverwrite, so this will always give us
-        // the most recent reading.
-        if (xQueueReceive(g_q_sensor_samples, &sample, portMAX_DELAY) == pdTRUE) {
-
-            app_error_t err = thermostat_core_process_sample(&sample, &th_state);
-            if (err != ERR_OK) {
-                // If the brain fails, report the error and skip this cycle.
-                error_report(err, "thermostat_core_process_sample");
-                watchdog_feed();
-                continue;
-            }
+        // Both wake-up sources share the notification count; recheck both.
+        bool kicked = __atomic_exchange_n(&s_kick, false, __ATOMIC_ACQ_REL);
+        bool fresh  = mailbox_seq(&g_mb_sensor_samples) != sample_seq &&
+                      mailbox_read(&g_mb_sensor_samples, &sample, &sample_seq);
+
+        if (!fresh && !(kicked && have_sample)) {
+            // Bounded so an idle CONTROL still feeds the watchdog.
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            watchdog_feed();
+            continue;
+        }
+        have_sample = true;
+        watchdog_loop_begin();
+
+        // The mailbox only keeps the newest sample, so this is always the
+        // latest reading; a kick re-runs the decision on it with the new
+        // mode / config instead of waiting for the next sample.
+        const mono_us_t t0  = monotime_now_us();
+        app_error_t     err = thermostat_core_process_sample(&sample, &th_state);
+        if (err != ERR_OK) {
+            // If the brain fails, report the error and skip this cycle.
+            error_report(err, "thermostat_core_process_sample");
+            watchdog_feed();
+            continue;
+        }
+
+        // Publish the state snapshot for UI / telemetry (display, MQTT, etc.).
+        log_post(LOG_LEVEL_DEBUG, TAG,
+            "Publishing state: Tin=%.2f Tout=%.2f sp=%.2f hyst=%.2f out=%d",
+            th_state.tin_c,
+            th_state.tout_c,
+            th_state.setpoint_c,
+            th_state.hysteresis_c,
+            (int)th_state.output);
+        msgbus_publish(MSGBUS_TOPIC_THERMOSTAT_STATE, &th_state);
+        history_record(&g_history, &th_state);
+
+        if (__atomic_exchange_n(&s_forced_off, false, __ATOMIC_ACQ_REL)) {
+            prev_output = THERMOSTAT_OUTPUT_OFF;
+        }
+
+        // Apply new output if it changed.
+        if (th_state.output != prev_output) {
+            apply_outputs(th_state.output);
+            metrics_inc(METRIC_RELAY_SWITCHES);
 
-            // Publish the state snapshot for UI / telemetry (display, MQTT, etc.).
-            if (g_q_thermostat_state != NULL) {
-                log_post(LOG_LEVEL_DEBUG, TAG,
-                    "Publishing state to DISPLAY: Tin=%.2f Tout=%.2f sp=%.2f hyst=%.2f out=%d",
-                    th_state.tin_c,
-                    th_state.tout_c,
-                    th_state.setpoint_c,
-                    th_state.hysteresis_c,
-                    (int)th_state.output);
-                xQueueOverwrite(g_q_thermostat_state, &th_state);
+            const char *out_str = "OFF";
+            if (th_state.output == THERMOSTAT_OUTPUT_HEAT_ON) {
+                out_str = "HEAT_ON";
+            } else if (th_state.output == THERMOSTAT_OUTPUT_COOL_ON) {
+                out_str = "COOL_ON";
             }
 
-            // Apply new output if it changed.
-            if (th_state.output != prev_output) {
-                apply_outputs(th_state.output);
-
-                const char *out_str = "OFF";
-                if (th_state.output == THERMOSTAT_OUTPUT_HEAT_ON) {
-                    out_str = "HEAT_ON";
-                } else if (th_state.output == THERMOSTAT_OUTPUT_COOL_ON) {
-                    out_str = "COOL_ON";
-                }
-
-                snprintf(msg_buf, sizeof(msg_buf),
-                         "mode=%d Tin=%.2fC Tout=%.2fC sp=%.2fC hyst=%.2fC action=%s",
-                         (int)th_state.mode,
-                         th_state.tin_c,
-                         th_state.tout_c,
-                         th_state.setpoint_c,
-                         th_state.hysteresis_c,
-                         out_str);
-
-                log_post(LOG_LEVEL_INFO, TAG, "%s", msg_buf);
-                prev_output = th_state.output;
-
-            } else {
-                // Optional: log when we keep the same state.
-                const char *out_str = "OFF";
-                if (th_state.output == THERMOSTAT_OUTPUT_HEAT_ON) {
-                    out_str = "HEAT_ON";
-                } else if (th_state.output == THERMOSTAT_OUTPUT_COOL_ON) {
-                    out_str = "COOL_ON";
-                }
-
-                snprintf(msg_buf, sizeof(msg_buf),
-                         "mode=%d Tin=%.2fC Tout=%.2fC sp=%.2fC hyst=%.2fC action=KEEP_%s",
-                         (int)th_state.mode,
-                         th_state.tin_c,
-                         th_state.tout_c,
-                         th_state.setpoint_c,
-                         th_state.hysteresis_c,
-                         out_str);
-
-                log_post(LOG_LEVEL_DEBUG, TAG, "%s", msg_buf);
+            snprintf(msg_buf, sizeof(msg_buf),
+                     "mode=%d Tin=%.2fC Tout=%.2fC sp=%.2fC hyst=%.2fC action=%s",
+                     (int)th_state.mode,
+                     th_state.tin_c,
+                     th_state.tout_c,
+                     th_state.setpoint_c,
+                     th_state.hysteresis_c,
+                     out_str);
+
+            log_post(LOG_LEVEL_INFO, TAG, "%s", msg_buf);
+            prev_output = th_state.output;
+
+        } else {
+            // Optional: log when we keep the same state.
+            const char *out_str = "OFF";
+            if (th_state.output == THERMOSTAT_OUTPUT_HEAT_ON) {
+                out_str = "HEAT_ON";
+            } else if (th_state.output == THERMOSTAT_OUTPUT_COOL_ON) {
+                out_str = "COOL_ON";
             }
 
-            // Feed watchdog after completing a control cycle.
-            watchdog_feed();
+            snprintf(msg_buf, sizeof(msg_buf),
+                     "mode=%d Tin=%.2fC Tout=%.2fC sp=%.2fC hyst=%.2fC action=KEEP_%s",
+                     (int)th_state.mode,
+                     th_state.tin_c,
+                     th_state.tout_c,
+                     th_state.setpoint_c,
+                     th_state.hysteresis_c,
+                     out_str);
+
+            log_post(LOG_LEVEL_DEBUG, TAG, "%s", msg_buf);
         }
+
+        boot_mark(BOOT_STAGE_FIRST_DECISION);   // no-op after the first
+        metrics_inc(METRIC_CONTROL_CYCLES);
+        metrics_observe(METRIC_CONTROL_LOOP_US, (uint32_t)monotime_since_us(t0));
+
+        // Feed watchdog after completing a control cycle.
+        watchdog_feed();
     }
 }
 
+
 /**
- * @brief Create and start the CONTROL task.
- *
- * Called from app_main() once shared queues, logging, sensors,
- * and thermostat core have been initialized. Stack size and priority
- * are configured in config.h via TASK_STACK_CONTROL and TASK_PRIO_CONTROL.
+ * @brief Ask CONTROL to re-evaluate now.
  */
-void task_control_start(void) {
-    xTaskCreate(
-        task_control,          // Task entry function
-        "task_control",        // Task name (for debugging)
-        TASK_STACK_CONTROL,    // Stack size (words) from config.h
-        NULL,                  // Task parameter
-        TASK_PRIO_CONTROL,     // Priority from config.h
-        NULL                   // No handle stored
-    );
+void task_control_kick(void)
+{
+    __atomic_store_n(&s_kick, true, __ATOMIC_RELEASE);
+    mailbox_notify(&g_mb_sensor_samples);
 }
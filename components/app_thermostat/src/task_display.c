@@ -1,25 +1,39 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
 
 #include "core/config.h"
 #include "core/logging.h"
 #include "core/watchdog.h"
+#include "core/boot.h"
 
-#include "app/task_common.h"        // g_q_thermostat_state
+#include "app/task_common.h"        // MSGBUS_TOPIC_THERMOSTAT_STATE
 #include "app/task_display.h"
 
 #include "drivers/drv_display.h"    // drv_display_*
 #include "core/thermostat.h"        // thermostat_state_t
 
+#include <string.h>
+
 static const char *TAG = "DISPLAY";
 
-static void task_display(void *arg)
+/**
+ * @brief Push a changed frame to the LCD and remember it as shown.
+ */
+static void display_refresh(const drv_display_frame_t *frame,
+                            drv_display_frame_t       *shown)
+{
+    log_post(LOG_LEVEL_DEBUG, TAG,
+             "LCD lines -> \"%s\" | \"%s\"",
+             frame->line[0], frame->line[1]);
+
+    drv_display_show_frame(frame);
+    *shown = *frame;
+}
+
+void task_display(void *arg)
 {
     (void)arg;
 
-    // Register this task in the watchdog
-    watchdog_register_current("DISPLAY");
     log_post(LOG_LEVEL_INFO, TAG, "DISPLAY task starting");
 
     if (drv_display_init() != ERR_OK) {
@@ -30,38 +44,55 @@ static void task_display(void *arg)
             vTaskDelay(pdMS_TO_TICKS(1000));
         }
     }
+    boot_mark(BOOT_STAGE_DISPLAY_INIT);
+
+    drv_display_frame_t frame;
+    drv_display_frame_t shown;      // what the LCD shows now
+    bool                pending = false;
+    TickType_t          last_refresh = 0;
+
+    const TickType_t min_refresh = pdMS_TO_TICKS(DISPLAY_MIN_REFRESH_MS);
+
+    // Blank frame: matches the cleared LCD after init.
+    memset(&shown, 0, sizeof(shown));
 
-    thermostat_state_t state;
-    
+    // Start from the current state so the first frame isn't blank.
+    msgbus_sub_t sub;
+    msgbus_subscribe(&sub, MSGBUS_TOPIC_THERMOSTAT_STATE, "DISPLAY", true);
 
     while (1) {
-        // Block until CONTROL publishes a new state
-        if (xQueueReceive(g_q_thermostat_state, &state, portMAX_DELAY) == pdTRUE) {
+        // Block until CONTROL publishes a new state. If a changed frame is
+        // being held back by the refresh limit, wake up when it is due.
+        TickType_t wait = pdMS_TO_TICKS(1000);     // watchdog
+        if (pending) {
+            TickType_t since = xTaskGetTickCount() - last_refresh;
+            wait = (since >= min_refresh) ? 0 : (min_refresh - since);
+        }
 
-            log_post(LOG_LEVEL_DEBUG, TAG,
-                     "DISPLAY got state: Tin=%.2f Tout=%.2f sp=%.2f hyst=%.2f out=%d",
-                     state.tin_c,
-                     state.tout_c,
-                     state.setpoint_c,
-                     state.hysteresis_c,
-                     (int)state.output);
+        const thermostat_state_t *state;
+        const bool got = msgbus_peek(&sub, (const void **)&state, wait);
+        watchdog_loop_begin();
+        if (got) {
+            // Build the frame straight from the bus slot with the integer
+            // formatter; cheap enough to do for every state even if nothing
+            // visible changed.
+            drv_display_frame_t next;
+            drv_display_format_state(state, &next);
 
-            // Render that state to the LCD
-            drv_display_show_state(&state);
+            // Slot recycled while formatting: drop it, a newer state follows.
+            if (msgbus_release(&sub)) {
+                frame   = next;
+                pending = (memcmp(&frame, &shown, sizeof(frame)) != 0);
+            }
+        }
 
-            watchdog_feed();
+        if (pending &&
+            (xTaskGetTickCount() - last_refresh) >= min_refresh) {
+            display_refresh(&frame, &shown);
+            last_refresh = xTaskGetTickCount();
+            pending = false;
         }
-    }
-}
 
-void task_display_start(void)
-{
-    xTaskCreate(
-        task_display,
-        "task_display",
-        TASK_STACK_DISPLAY,   // define in core/config.h
-        NULL,
-        TASK_PRIO_DISPLAY,    // define in core/config.h
-        NULL
-    );
+        watchdog_feed();
+    }
 }
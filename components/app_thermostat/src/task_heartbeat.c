@@ -4,6 +4,7 @@
 #include "core/logging.h"
 #include "core/watchdog.h"
 #include "driver/gpio.h"
+#include "app/task_heartbeat.h"
 
 /**
  * @brief Configure the LED GPIO pin for output.
@@ -29,7 +30,6 @@ static void heartbeat_led_init(void) {
     gpio_set_level (LED_GPIO, 0);
 }
 
-
 /**
  * @brief FreeRTOS heartbeat task.
  *
@@ -40,9 +40,7 @@ static void heartbeat_led_init(void) {
  *
  * It runs forever at the priority assigned in config.h.
  */
-
-
-static void task_heartbeat(void *arg) {
+void task_heartbeat(void *arg) {
     (void)arg;        // Unused, but avoids compiler warnings
 
     int counter = 0;    // Counts how many iterations we've run
@@ -51,10 +49,9 @@ static void task_heartbeat(void *arg) {
     // Initialize hardware once inside the task
     heartbeat_led_init();
     
-    // Register this task with the watchdog system, so it must periodically call watchdog_feed()
-    watchdog_register_current("HEARTBEAT");
-
     while (1) {
+        watchdog_loop_begin();
+
         // Toggle LED state
         led_state = !led_state;
         gpio_set_level(LED_GPIO, led_state);
@@ -73,21 +70,3 @@ static void task_heartbeat(void *arg) {
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
-
-/**
- * @brief Spawn the heartbeat task.
- *
- * Called once from main (or wherever your application initializes tasks).
- * Stack size and priority come from config.h so they can be tuned centrally.
- */
-
-void task_heartbeat_start(void) {
-    xTaskCreate(
-        task_heartbeat,             // Task entry function
-        "task_heartbeat",           // Task name (for debugging)
-        TASK_STACK_HEARTBEAT,       // Stack size in words
-        NULL,                       // No parameters passed
-        TASK_PRIO_HEARTBEAT,        // Task priority
-        NULL                        // Not storing task handle
-    );
-}
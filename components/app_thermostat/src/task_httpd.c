@@ -0,0 +1,415 @@
+// components/app_thermostat/src/task_httpd.c
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_http_server.h"
+#include "esp_system.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/config.h"
+#include "core/logging.h"
+#include "core/json_writer.h"
+#include "core/history.h"
+#include "core/metrics.h"
+#include "core/msgbus.h"
+#include "core/thermostat.h"
+#include "core/thermostat_config.h"
+#include "core/timeutil.h"
+#include "core/watchdog.h"
+#include "core/monotime.h"
+#include "core/boot.h"
+
+#include "drivers/drv_buttons.h"
+#include "drivers/drv_display.h"
+#include "drivers/drv_temp_sensors.h"
+
+#include "app/task_common.h"      // g_history, bus topics
+#include "app/task_mqtt.h"
+#include "app/task_net.h"         // task_net_is_connected
+#include "app/task_telemetry.h"
+#include "app/task_httpd.h"
+#include "app/app_tasks.h"         // app_tasks_core
+
+static const char *TAG = "HTTPD";
+
+static httpd_handle_t s_server = NULL;
+
+static uint32_t s_requests = 0;      // only touched by the server task
+static uint32_t s_errors   = 0;
+
+static inline uint64_t uptime_ms(void)
+{
+    return monotime_now_ms();
+}
+
+/* ---------------- Response streaming ---------------- */
+
+static int chunk_sink(void *ctx, const char *data, size_t len)
+{
+    return (httpd_resp_send_chunk(ctx, data, (ssize_t)len) == ESP_OK) ? 0 : -1;
+}
+
+static void json_response_begin(httpd_req_t *req, json_writer_t *w,
+                                char *buf, size_t cap)
+{
+    s_requests++;
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    json_writer_init(w, buf, cap, chunk_sink, req);
+}
+
+static esp_err_t json_response_end(httpd_req_t *req, json_writer_t *w)
+{
+    if (json_writer_finish(w) != ERR_OK) {
+        // Headers are gone already; failing closes the connection.
+        s_errors++;
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/* ---------------- Handlers ---------------- */
+
+static esp_err_t handle_state(httpd_req_t *req)
+{
+    thermostat_state_t st;
+    uint32_t           seq;
+
+    if (!msgbus_read_latest(MSGBUS_TOPIC_THERMOSTAT_STATE, &st, &seq)) {
+        s_requests++;
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, "{\"error\":\"no state yet\"}", HTTPD_RESP_USE_STRLEN);
+    }
+
+    char          buf[HTTPD_CHUNK_LEN];
+    json_writer_t w;
+    json_response_begin(req, &w, buf, sizeof(buf));
+
+    json_begin_object(&w);
+    json_kv_uint  (&w, "seq",            seq);
+    json_kv_string(&w, "mode",           thermostat_mode_to_str(st.mode));
+    json_kv_string(&w, "output",         thermostat_output_to_str(st.output));
+    json_kv_fixed (&w, "setpoint_c",     st.setpoint_c, 2);
+    json_kv_fixed (&w, "hysteresis_c",   st.hysteresis_c, 2);
+    json_kv_fixed (&w, "temp_inside_c",  st.tin_c, 2);
+    json_kv_fixed (&w, "temp_outside_c", st.tout_c, 2);
+    json_kv_uint  (&w, "sample_age_ms",  (uint32_t)(monotime_since_us(st.timestamp_us) / 1000u));
+
+    char iso[32];
+    if (timeutil_get_iso8601(iso, sizeof(iso))) {
+        json_kv_string(&w, "time", iso);
+    }
+    json_end_object(&w);
+
+    return json_response_end(req, &w);
+}
+
+static esp_err_t handle_config(httpd_req_t *req)
+{
+    thermostat_config_t cfg;
+    thermostat_state_t  st;
+
+    // Newest settled change if there was one, else what CONTROL last
+    // used; both are lock-free reads.
+    if (!msgbus_read_latest(MSGBUS_TOPIC_CONFIG, &cfg, NULL)) {
+        if (msgbus_read_latest(MSGBUS_TOPIC_THERMOSTAT_STATE, &st, NULL)) {
+            cfg.setpoint_c   = st.setpoint_c;
+            cfg.hysteresis_c = st.hysteresis_c;
+        } else {
+            cfg.setpoint_c   = THERMOSTAT_SETPOINT_C;
+            cfg.hysteresis_c = THERMOSTAT_HYSTERESIS_C;
+        }
+    }
+
+    char          buf[HTTPD_CHUNK_LEN];
+    json_writer_t w;
+    json_response_begin(req, &w, buf, sizeof(buf));
+
+    json_begin_object(&w);
+    json_kv_fixed(&w, "setpoint_c",       cfg.setpoint_c, 2);
+    json_kv_fixed(&w, "hysteresis_c",     cfg.hysteresis_c, 2);
+    json_kv_fixed(&w, "setpoint_min_c",   THERMOSTAT_SP_MIN_C, 2);
+    json_kv_fixed(&w, "setpoint_max_c",   THERMOSTAT_SP_MAX_C, 2);
+    json_kv_fixed(&w, "setpoint_step_c",  THERMOSTAT_SP_STEP_C, 2);
+    json_kv_fixed(&w, "hysteresis_min_c", THERMOSTAT_HYST_MIN_C, 2);
+    json_kv_fixed(&w, "hysteresis_max_c", THERMOSTAT_HYST_MAX_C, 2);
+    json_end_object(&w);
+
+    return json_response_end(req, &w);
+}
+
+/**
+ * @brief Optional ?limit=N (default and maximum HISTORY_DEPTH).
+ */
+static uint32_t history_limit(httpd_req_t *req)
+{
+    char query[32];
+    char value[8];
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "limit", value, sizeof(value)) == ESP_OK) {
+        long n = strtol(value, NULL, 10);
+        if (n > 0 && n <= HISTORY_DEPTH) {
+            return (uint32_t)n;
+        }
+    }
+    return HISTORY_DEPTH;
+}
+
+static esp_err_t handle_history(httpd_req_t *req)
+{
+    const uint32_t limit = history_limit(req);
+    const uint32_t head  = history_head(&g_history);
+    const uint32_t now_s = (uint32_t)(monotime_now_us() / 1000000u);
+
+    char          buf[HTTPD_CHUNK_LEN];
+    json_writer_t w;
+    json_response_begin(req, &w, buf, sizeof(buf));
+
+    json_begin_object(&w);
+    json_kv_uint(&w, "interval_ms", HISTORY_INTERVAL_MS);
+    json_key(&w, "entries");
+    json_begin_array(&w);
+
+    // Oldest first. Entries recycled by CONTROL while this response is
+    // being streamed fail their slot check and are skipped.
+    uint32_t first = (head > limit) ? head - limit + 1u : 1u;
+    for (uint32_t seq = first; seq != 0 && seq <= head; seq++) {
+        history_entry_t e;
+        if (!history_read(&g_history, seq, &e)) {
+            continue;
+        }
+        json_begin_object(&w);
+        json_kv_uint  (&w, "age_s",      now_s - e.uptime_s);
+        json_kv_fixed (&w, "tin_c",      e.tin_cc / 100.0f, 2);
+        json_kv_fixed (&w, "tout_c",     e.tout_cc / 100.0f, 2);
+        json_kv_fixed (&w, "setpoint_c", e.setpoint_cc / 100.0f, 2);
+        json_kv_string(&w, "mode",       thermostat_mode_to_str((thermostat_mode_t)e.mode));
+        json_kv_string(&w, "output",     thermostat_output_to_str((thermostat_output_t)e.output));
+        json_end_object(&w);
+    }
+
+    json_end_array(&w);
+    json_end_object(&w);
+
+    return json_response_end(req, &w);
+}
+
+static esp_err_t handle_metrics(httpd_req_t *req)
+{
+    static const char *const topic_names[MSGBUS_TOPIC_COUNT] = {
+        "sensor_sample", "thermostat_state", "config", "button"
+    };
+
+    char          buf[HTTPD_CHUNK_LEN];
+    json_writer_t w;
+    json_response_begin(req, &w, buf, sizeof(buf));
+
+    json_begin_object(&w);
+    json_kv_uint64(&w, "uptime_ms",   uptime_ms());
+    json_kv_uint(&w, "heap_free",     (uint32_t)esp_get_free_heap_size());
+    json_kv_uint(&w, "heap_min_free", (uint32_t)esp_get_minimum_free_heap_size());
+    json_kv_bool(&w, "wifi_connected", task_net_is_connected());
+
+    telemetry_stats_t ts;
+    task_telemetry_get_stats(&ts);
+    json_key(&w, "telemetry");
+    json_begin_object(&w);
+    json_kv_uint(&w, "samples",       ts.samples);
+    json_kv_uint(&w, "samples_sent",  ts.samples_sent);
+    json_kv_uint(&w, "batches_sent",  ts.batches_sent);
+    json_kv_uint(&w, "bytes_sent",    ts.bytes_sent);
+    json_kv_uint(&w, "post_failures", ts.post_failures);
+    json_kv_uint(&w, "dropped",       ts.dropped);
+    json_kv_uint(&w, "bus_dropped",   ts.bus_dropped);
+    json_kv_uint(&w, "spooled",       ts.spooled);
+    json_kv_uint(&w, "replayed",      ts.replayed);
+    json_kv_uint(&w, "spool_pending", ts.spool_pending);
+    json_kv_uint(&w, "spool_lost",    ts.spool_lost);
+    json_kv_uint(&w, "spool_untimed", ts.spool_untimed);
+    json_end_object(&w);
+
+    mqtt_stats_t ms;
+    task_mqtt_get_stats(&ms);
+    json_key(&w, "mqtt");
+    json_begin_object(&w);
+    json_kv_uint(&w, "connects",          ms.connects);
+    json_kv_uint(&w, "commands",          ms.commands);
+    json_kv_uint(&w, "commands_rejected", ms.commands_rejected);
+    json_kv_uint(&w, "states_published",  ms.states_published);
+    json_kv_uint(&w, "batches_published", ms.batches_published);
+    json_kv_uint(&w, "samples_published", ms.samples_published);
+    json_kv_uint(&w, "samples_dropped",   ms.samples_dropped);
+    json_kv_uint(&w, "publish_failures",  ms.publish_failures);
+    json_end_object(&w);
+
+    drv_temp_stats_t tmp;
+    if (drv_temp_get_stats(&tmp) == ERR_OK) {
+        json_key(&w, "temp_sensor");
+        json_begin_object(&w);
+        json_kv_uint(&w, "reads_ok",     tmp.reads_ok);
+        json_kv_uint(&w, "reads_failed", tmp.reads_failed);
+        json_kv_uint(&w, "retries",      tmp.retries);
+        json_kv_uint(&w, "nacks",        tmp.nacks);
+        json_kv_uint(&w, "timeouts",     tmp.timeouts);
+        json_kv_uint(&w, "crc_errors",   tmp.crc_errors);
+        json_kv_uint(&w, "busy",         tmp.busy);
+        json_kv_uint(&w, "recoveries",   tmp.recoveries);
+        json_end_object(&w);
+    }
+
+    drv_display_stats_t ds;
+    if (drv_display_get_stats(&ds) == ERR_OK) {
+        json_key(&w, "display");
+        json_begin_object(&w);
+        json_kv_uint(&w, "frames",           ds.frames);
+        json_kv_uint(&w, "frames_unchanged", ds.frames_unchanged);
+        json_kv_uint(&w, "cmd_bytes",        ds.cmd_bytes);
+        json_kv_uint(&w, "data_bytes",       ds.data_bytes);
+        json_end_object(&w);
+    }
+
+    drv_buttons_stats_t bs;
+    drv_buttons_get_stats(&bs);
+    json_key(&w, "buttons");
+    json_begin_object(&w);
+    json_kv_uint(&w, "edges",   bs.edges);
+    json_kv_uint(&w, "events",  bs.events);
+    json_kv_uint(&w, "dropped", bs.dropped);
+    json_end_object(&w);
+
+    json_key(&w, "msgbus");
+    json_begin_object(&w);
+    for (int t = 0; t < MSGBUS_TOPIC_COUNT; t++) {
+        msgbus_topic_stats_t mt;
+        msgbus_get_topic_stats((msgbus_topic_t)t, &mt);
+        json_key(&w, topic_names[t]);
+        json_begin_object(&w);
+        json_kv_uint(&w, "published",   mt.published);
+        json_kv_uint(&w, "subscribers", mt.subscribers);
+        json_end_object(&w);
+    }
+    json_end_object(&w);
+
+    json_key(&w, "httpd");
+    json_begin_object(&w);
+    json_kv_uint(&w, "requests", s_requests);
+    json_kv_uint(&w, "errors",   s_errors);
+    json_end_object(&w);
+
+    // Supervised tasks: feed interval, work time and deadline misses.
+    watchdog_task_stats_t tasks[WATCHDOG_MAX_TASKS];
+    const size_t          ntasks = watchdog_get_stats(tasks, WATCHDOG_MAX_TASKS);
+
+    json_key(&w, "tasks");
+    json_begin_array(&w);
+    for (size_t i = 0; i < ntasks; i++) {
+        json_begin_object(&w);
+        json_kv_string(&w, "name",          tasks[i].name);
+        json_kv_uint  (&w, "period_ms",     tasks[i].period_ms);
+        json_kv_uint  (&w, "deadline_ms",   tasks[i].deadline_ms);
+        json_kv_uint  (&w, "feeds",         tasks[i].feeds);
+        json_kv_uint  (&w, "feed_interval_avg_us", tasks[i].feed_interval_avg_us);
+        json_kv_uint  (&w, "feed_interval_max_us", tasks[i].feed_interval_max_us);
+        json_kv_uint  (&w, "work_avg_us",   tasks[i].work_avg_us);
+        json_kv_uint  (&w, "work_max_us",   tasks[i].work_max_us);
+        json_kv_uint  (&w, "since_feed_ms", tasks[i].since_feed_ms);
+        json_kv_uint  (&w, "misses",        tasks[i].misses);
+        json_kv_uint  (&w, "restarts",      tasks[i].restarts);
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+
+    // Boot stages, us since boot; null until reached.
+    json_key(&w, "boot");
+    json_begin_object(&w);
+    for (int s = 0; s < BOOT_STAGE_COUNT; s++) {
+        const uint64_t us = boot_stage_us((boot_stage_t)s);
+        json_key(&w, boot_stage_name((boot_stage_t)s));
+        if (us != 0) {
+            json_uint64(&w, us);
+        } else {
+            json_null(&w);
+        }
+    }
+    json_end_object(&w);
+
+    json_end_object(&w);
+
+    return json_response_end(req, &w);
+}
+
+static esp_err_t handle_metrics_prom(httpd_req_t *req)
+{
+    char buf[HTTPD_CHUNK_LEN];
+
+    s_requests++;
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    if (metrics_export_prometheus(buf, sizeof(buf), chunk_sink, req) != ERR_OK) {
+        s_errors++;
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t handle_metrics_bin(httpd_req_t *req)
+{
+    uint8_t buf[HTTPD_CHUNK_LEN];
+
+    s_requests++;
+    const size_t len = metrics_export_binary(buf, sizeof(buf));
+    if (len == 0) {
+        s_errors++;
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, (const char *)buf, (ssize_t)len);
+}
+
+/* ---------------- Server ---------------- */
+
+static const httpd_uri_t s_uris[] = {
+    { .uri = "/state",   .method = HTTP_GET, .handler = handle_state   },
+    { .uri = "/config",  .method = HTTP_GET, .handler = handle_config  },
+    { .uri = "/history", .method = HTTP_GET, .handler = handle_history },
+    { .uri = "/metrics", .method = HTTP_GET, .handler = handle_metrics },
+    { .uri = "/metrics/prom", .method = HTTP_GET, .handler = handle_metrics_prom },
+    { .uri = "/metrics/bin",  .method = HTTP_GET, .handler = handle_metrics_bin  },
+};
+
+/**
+ * @brief One-shot bootstrap: start the server, then exit. The server runs
+ *        in its own task from then on. Its task table row waits for
+ *        BOOT_STAGE_NET_UP before this runs.
+ */
+void task_httpd(void *arg)
+{
+    (void)arg;
+
+    httpd_config_t cfg   = HTTPD_DEFAULT_CONFIG();
+    cfg.server_port      = HTTPD_PORT;
+    cfg.task_priority    = TASK_PRIO_HTTPD;
+    cfg.stack_size       = TASK_STACK_HTTPD;
+    cfg.core_id          = app_tasks_core(CORE_NET);
+    cfg.max_uri_handlers = sizeof(s_uris) / sizeof(s_uris[0]);
+    cfg.lru_purge_enable = true;
+
+    if (httpd_start(&s_server, &cfg) != ESP_OK) {
+        log_post(LOG_LEVEL_ERROR, TAG, "httpd_start failed, local API disabled");
+    } else {
+        for (size_t i = 0; i < sizeof(s_uris) / sizeof(s_uris[0]); i++) {
+            httpd_register_uri_handler(s_server, &s_uris[i]);
+        }
+        log_post(LOG_LEVEL_INFO, TAG, "Local API on port %d", HTTPD_PORT);
+    }
+
+    vTaskDelete(NULL);
+}
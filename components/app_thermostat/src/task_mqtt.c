@@ -0,0 +1,349 @@
+// components/app_thermostat/src/task_mqtt.c
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "mqtt_client.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/config.h"
+#include "core/logging.h"
+#include "core/watchdog.h"
+#include "core/timeutil.h"
+#include "core/monotime.h"
+#include "core/mqtt_cmd.h"
+#include "core/telemetry_codec.h"
+#include "core/thermostat.h"
+#include "core/thermostat_config.h"
+
+#include "app/task_common.h"      // MSGBUS_TOPIC_THERMOSTAT_STATE
+#include "app/task_control.h"     // task_control_kick
+#include "app/task_net.h"         // task_net_wait_connected
+#include "app/task_mqtt.h"
+
+static const char *TAG = "MQTT";
+
+#define TOPIC_STATUS    MQTT_TOPIC_BASE "/status"
+#define TOPIC_STATE     MQTT_TOPIC_BASE "/state"
+#define TOPIC_SAMPLES   MQTT_TOPIC_BASE "/samples"
+#define TOPIC_CMD       MQTT_TOPIC_BASE "/cmd/"
+
+// Worst case per protobuf sample is 2 bytes of framing + 6 varint fields.
+#define MQTT_SAMPLES_BODY_MAX   (64 + MQTT_SAMPLE_BATCH * 40)
+
+static esp_mqtt_client_handle_t s_client    = NULL;
+static volatile bool            s_connected = false;
+static volatile bool            s_resync    = false;   // republish state after (re)connect
+
+// Samples waiting for the next batch publish (owned by the MQTT task).
+static telemetry_record_t s_samples[MQTT_SAMPLE_BATCH];
+static uint16_t           s_sample_count = 0;
+static TickType_t         s_sample_since = 0;
+static uint8_t            s_samples_body[MQTT_SAMPLES_BODY_MAX];
+
+// Retained state: last published and newest seen (owned by the MQTT task).
+static thermostat_state_t s_state_pub;
+static thermostat_state_t s_state_next;
+static bool               s_state_seen   = false;    // s_state_next is valid
+static bool               s_state_valid  = false;    // s_state_pub is on the broker
+static TickType_t         s_state_pub_at = 0;
+
+static mqtt_stats_t s_stats;
+
+/* ---------------- Commands (client event context) ---------------- */
+
+static void set_setpoint(thermostat_config_t *cfg, void *ctx)
+{
+    cfg->setpoint_c = *(const float *)ctx;
+}
+
+static void set_hysteresis(thermostat_config_t *cfg, void *ctx)
+{
+    cfg->hysteresis_c = *(const float *)ctx;
+}
+
+/**
+ * @brief Parse and apply one command message.
+ *
+ * Runs in the MQTT client task: the change is applied and CONTROL is
+ * kicked before the next message is read, so command-to-relay latency is
+ * one control cycle rather than one sensor period.
+ */
+static void handle_command(const esp_mqtt_event_t *ev)
+{
+    const size_t prefix_len = sizeof(TOPIC_CMD) - 1;
+
+    if (ev->topic_len <= (int)prefix_len ||
+        memcmp(ev->topic, TOPIC_CMD, prefix_len) != 0) {
+        return;
+    }
+
+    const char *name     = ev->topic + prefix_len;
+    const int   name_len = ev->topic_len - (int)prefix_len;
+
+    // Commands are a few bytes; a fragmented message is not one of ours.
+    mqtt_cmd_t  cmd;
+    app_error_t err = ERR_GENERIC;
+    if (ev->current_data_offset == 0 && ev->data_len == ev->total_data_len) {
+        err = mqtt_cmd_parse(name, (size_t)name_len,
+                             ev->data, (size_t)ev->data_len, &cmd);
+    }
+
+    if (err == ERR_OK) {
+        switch (cmd.type) {
+        case MQTT_CMD_MODE:
+            err = thermostat_set_mode(cmd.mode);
+            break;
+        case MQTT_CMD_SETPOINT:
+            err = thermostat_config_update(set_setpoint, &cmd.value_c, NULL);
+            break;
+        case MQTT_CMD_HYSTERESIS:
+            err = thermostat_config_update(set_hysteresis, &cmd.value_c, NULL);
+            break;
+        default:
+            err = ERR_GENERIC;
+            break;
+        }
+    }
+
+    if (err != ERR_OK) {
+        s_stats.commands_rejected++;
+        log_post(LOG_LEVEL_WARN, TAG, "Rejected command %.*s=\"%.*s\"",
+                 name_len, name, ev->data_len, ev->data);
+        return;
+    }
+
+    task_control_kick();
+    s_stats.commands++;
+    log_post(LOG_LEVEL_INFO, TAG, "Command %.*s=%.*s",
+             name_len, name, ev->data_len, ev->data);
+}
+
+static void mqtt_event_handler(void *arg, esp_event_base_t base,
+                               int32_t event_id, void *event_data)
+{
+    (void)arg;
+    (void)base;
+
+    esp_mqtt_event_handle_t ev = event_data;
+
+    switch ((esp_mqtt_event_id_t)event_id) {
+    case MQTT_EVENT_CONNECTED:
+        s_stats.connects++;
+        log_post(LOG_LEVEL_INFO, TAG, "Connected to %s", MQTT_BROKER_URI);
+        esp_mqtt_client_subscribe(s_client, TOPIC_CMD "+", 1);
+        esp_mqtt_client_enqueue(s_client, TOPIC_STATUS, "online", 0, 1, 1, true);
+        s_connected = true;
+        s_resync    = true;
+        break;
+
+    case MQTT_EVENT_DISCONNECTED:
+        if (s_connected) {
+            log_post(LOG_LEVEL_WARN, TAG, "Disconnected (client reconnects)");
+        }
+        s_connected = false;
+        break;
+
+    case MQTT_EVENT_DATA:
+        handle_command(ev);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/* ---------------- Outbound (MQTT task) ---------------- */
+
+/**
+ * @brief True if the retained state on the broker is out of date.
+ *
+ * Only the control-relevant fields count; temperatures go out as samples.
+ */
+static bool state_pending(void)
+{
+    if (!s_state_seen) {
+        return false;
+    }
+    if (!s_state_valid) {
+        return true;
+    }
+
+    const thermostat_state_t *a = &s_state_next;
+    const thermostat_state_t *b = &s_state_pub;
+    return a->mode != b->mode || a->output != b->output ||
+           a->setpoint_c != b->setpoint_c || a->hysteresis_c != b->hysteresis_c;
+}
+
+static void publish_state(TickType_t now)
+{
+    char body[128];
+    size_t len = telemetry_encode_state_json(&s_state_next, body, sizeof(body));
+
+    if (len == 0 ||
+        esp_mqtt_client_enqueue(s_client, TOPIC_STATE, body, (int)len, 1, 1, true) < 0) {
+        s_stats.publish_failures++;
+        return;
+    }
+
+    s_state_pub    = s_state_next;
+    s_state_valid  = true;
+    s_state_pub_at = now;
+    s_stats.states_published++;
+}
+
+static void publish_samples(void)
+{
+    const uint16_t n = s_sample_count;
+    s_sample_count = 0;
+
+    if (!s_connected) {
+        // QoS 0 data: the HTTP uploader is the durable path.
+        s_stats.samples_dropped += n;
+        return;
+    }
+
+    size_t len = telemetry_encode_pb(TELEMETRY_DEVICE_ID, s_samples, n,
+                                     s_samples_body, sizeof(s_samples_body));
+    if (len == 0 ||
+        esp_mqtt_client_enqueue(s_client, TOPIC_SAMPLES, (const char *)s_samples_body,
+                                (int)len, 0, 0, true) < 0) {
+        s_stats.publish_failures++;
+        s_stats.samples_dropped += n;
+        return;
+    }
+
+    s_stats.batches_published++;
+    s_stats.samples_published += n;
+}
+
+static void on_state(const thermostat_state_t *st)
+{
+    // Retained state: newest wins; published if it differs from the last one.
+    s_state_next = *st;
+    s_state_seen = true;
+
+    // Samples need a wall-clock time.
+    if (!timeutil_is_time_set()) {
+        s_stats.samples_dropped++;
+        return;
+    }
+
+    if (s_sample_count == 0) {
+        s_sample_since = xTaskGetTickCount();
+    }
+    telemetry_record_from_state(st, timeutil_now(), monotime_now_us(), &s_samples[s_sample_count++]);
+    if (s_sample_count >= MQTT_SAMPLE_BATCH) {
+        publish_samples();
+    }
+}
+
+/**
+ * @brief Create and start the client.
+ *
+ * The client task reconnects on its own from then on, also across Wi-Fi
+ * drops; it only has to be started once the network stack is up.
+ */
+static bool mqtt_client_start(void)
+{
+    esp_mqtt_client_config_t cfg = {
+        .broker.address.uri    = MQTT_BROKER_URI,
+        .credentials.client_id = TELEMETRY_DEVICE_ID,
+        .session = {
+            .keepalive = MQTT_KEEPALIVE_S,
+            .last_will = {
+                .topic  = TOPIC_STATUS,
+                .msg    = "offline",
+                .qos    = 1,
+                .retain = 1,
+            },
+        },
+        .network.timeout_ms = MQTT_NETWORK_TIMEOUT_MS,
+    };
+
+    s_client = esp_mqtt_client_init(&cfg);
+    if (s_client == NULL) {
+        log_post(LOG_LEVEL_ERROR, TAG, "esp_mqtt_client_init failed");
+        return false;
+    }
+
+    esp_mqtt_client_register_event(s_client, MQTT_EVENT_ANY, mqtt_event_handler, NULL);
+    if (esp_mqtt_client_start(s_client) != ESP_OK) {
+        log_post(LOG_LEVEL_ERROR, TAG, "esp_mqtt_client_start failed");
+        return false;
+    }
+    return true;
+}
+
+// esp_mqtt_client_enqueue() never touches the socket, but it takes the
+// client's API lock, which the client task holds across its own socket
+// writes; a stalled write holds it for up to MQTT_NETWORK_TIMEOUT_MS
+// (see the MQTT row in app_tasks.c).
+void task_mqtt(void *arg)
+{
+    (void)arg;
+
+    while (!task_net_wait_connected(pdMS_TO_TICKS(1000))) {
+        watchdog_feed();
+    }
+
+    if (!mqtt_client_start()) {
+        // Stay alive for the watchdog; commands and state stay local.
+        while (1) {
+            watchdog_feed();
+            vTaskDelay(pdMS_TO_TICKS(1000));
+        }
+    }
+
+    msgbus_sub_t sub;
+    msgbus_subscribe(&sub, MSGBUS_TOPIC_THERMOSTAT_STATE, "MQTT", true);
+
+    const TickType_t flush_ticks = pdMS_TO_TICKS(MQTT_SAMPLE_FLUSH_MS);
+    const TickType_t state_ticks = pdMS_TO_TICKS(MQTT_STATE_MIN_INTERVAL_MS);
+
+    while (1) {
+        // Short timeout while a state publish is held back by the rate
+        // limit; otherwise wake once a second for the watchdog.
+        TickType_t wait = state_pending() ? state_ticks : pdMS_TO_TICKS(1000);
+
+        const thermostat_state_t *st;
+        const bool got = msgbus_peek(&sub, (const void **)&st, wait);
+        watchdog_loop_begin();
+        if (got) {
+            thermostat_state_t copy = *st;
+            if (msgbus_release(&sub)) {
+                on_state(&copy);
+            }
+        }
+
+        TickType_t now = xTaskGetTickCount();
+
+        if (s_resync) {
+            // New session: the broker may have lost the retained copy.
+            s_resync      = false;
+            s_state_valid = false;
+        }
+
+        if (s_connected && state_pending() &&
+            (!s_state_valid || (now - s_state_pub_at) >= state_ticks)) {
+            publish_state(now);
+        }
+
+        if (s_sample_count > 0 && (now - s_sample_since) >= flush_ticks) {
+            publish_samples();
+        }
+
+        watchdog_feed();
+    }
+}
+
+void task_mqtt_get_stats(mqtt_stats_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+    *out = s_stats;
+}
@@ -2,13 +2,14 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/event_groups.h"
 
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_netif.h"
 #include "nvs_flash.h"
 #include "esp_system.h"
-#include "esp_http_client.h"
+#include "esp_random.h"
 
 #include <string.h>
 
@@ -16,14 +17,34 @@
 #include "core/logging.h"
 #include "core/watchdog.h"
 #include "core/timeutil.h"
+#include "core/metrics.h"
+#include "core/wifi_conn.h"
+#include "core/boot.h"
 
 #include "app/task_net.h"
 
 static const char *TAG = "NET";
 
-static int  s_retry_count     = 0;
-static bool s_wifi_ready      = false;  // got IP
-static bool s_sent_telemetry  = false;  // send test telemetry once per connection
+// Event group shared by the driver event handler and the NET task.
+// NET_EVT_* are edge bits consumed by the task; NET_BIT_CONNECTED is
+// level state kept by the handler, which is what consumers wait on.
+#define NET_EVT_START         (1u << 0)
+#define NET_EVT_DISCONNECTED  (1u << 1)
+#define NET_EVT_GOT_IP        (1u << 2)
+#define NET_EVT_LOST_IP       (1u << 3)
+#define NET_EVT_ALL           (NET_EVT_START | NET_EVT_DISCONNECTED | \
+                               NET_EVT_GOT_IP | NET_EVT_LOST_IP)
+#define NET_BIT_CONNECTED     (1u << 8)
+
+static StaticEventGroup_t s_events_buf;
+static EventGroupHandle_t s_events = NULL;
+
+static wifi_conn_t s_conn;      // only touched by the NET task
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
 
 /**
  * @brief Initialize NVS (required by Wi-Fi stack).
@@ -43,147 +64,92 @@ static void init_nvs(void)
 }
 
 /**
- * @brief Send a single test telemetry snapshot to the Django backend.
+ * @brief Common Wi-Fi event handler (WIFI_EVENT + IP_EVENT).
  *
- * For now this uses dummy values for temperatures and setpoint.
- * Later this will be replaced with real thermostat_state_t data.
+ * Runs in the default event loop task: it only records the event and
+ * updates NET_BIT_CONNECTED, so waiters wake the moment the link is up.
+ * Reconnect decisions are made by the NET task.
  */
-static void net_send_test_telemetry(void)
+static void wifi_event_handler(void *arg,
+                               esp_event_base_t event_base,
+                               int32_t event_id,
+                               void *event_data)
 {
-    // TODO: replace with your PC's LAN IP
-    // Make sure Django is running:
-    //   python manage.py runserver 0.0.0.0:8000
-    const char *url =
-        "http://10.0.0.79:8000/api/telemetry/ingest/";
-
-    // Get ISO8601 local timestamp from SNTP/RTC
-    char iso[32];
-    if (!timeutil_get_iso8601(iso, sizeof(iso))) {
-        log_post(LOG_LEVEL_WARN, TAG,
-                 "Time not set yet, skipping telemetry send");
-        return;
-    }
-
-    // Build JSON body matching Django's expected schema
-    // For now, dummy values for temps and setpoint.
-    char json_body[256];
-    int len = snprintf(
-        json_body,
-        sizeof(json_body),
-        "{"
-          "\"device_id\":\"esp32-thermostat-1\","
-          "\"mode\":\"AUTO\","
-          "\"temp_inside_c\":%.2f,"
-          "\"temp_outside_c\":%.2f,"
-          "\"setpoint_c\":%.2f,"
-          "\"hysteresis_c\":%.2f,"
-          "\"output\":\"COOL_ON\","
-          "\"timestamp\":\"%s\""
-        "}",
-        25.0f,   // TODO: replace with real th_state.tin_c
-        25.0f,   // TODO: replace with real th_state.tout_c
-        22.0f,   // TODO: replace with real th_state.setpoint_c
-        0.5f,    // TODO: replace with real th_state.hysteresis_c
-        iso
-    );
-
-    if (len <= 0 || len >= (int)sizeof(json_body)) {
-        log_post(LOG_LEVEL_ERROR, TAG, "Failed to build telemetry JSON");
-        return;
-    }
-
-    esp_http_client_config_t cfg = {
-        .url           = url,
-        .method        = HTTP_METHOD_POST,
-        .transport_type = HTTP_TRANSPORT_OVER_TCP, // plain HTTP on LAN
-    };
-
-    esp_http_client_handle_t client = esp_http_client_init(&cfg);
-    if (!client) {
-        log_post(LOG_LEVEL_ERROR, TAG, "HTTP client init failed");
-        return;
-    }
-
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_header(client, "X-API-Key", "super-secret-token");
-    esp_http_client_set_post_field(client, json_body, strlen(json_body));
+    (void)arg;
+    (void)event_data;
 
-    log_post(LOG_LEVEL_INFO, TAG, "Sending telemetry to %s", url);
-    log_post(LOG_LEVEL_DEBUG, TAG, "Payload: %s", json_body);
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        xEventGroupSetBits(s_events, NET_EVT_START);
 
-    esp_err_t err = esp_http_client_perform(client);
-    if (err == ESP_OK) {
-        int       status      = esp_http_client_get_status_code(client);
-        long long content_len = esp_http_client_get_content_length(client);
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        EventBits_t prev = xEventGroupClearBits(s_events, NET_BIT_CONNECTED);
+        if (prev & NET_BIT_CONNECTED) {
+            metrics_inc(METRIC_WIFI_DISCONNECTS);
+        }
+        metrics_gauge_set(METRIC_WIFI_CONNECTED, 0);
+        xEventGroupSetBits(s_events, NET_EVT_DISCONNECTED);
 
-        log_post(LOG_LEVEL_INFO, TAG,
-                 "Telemetry POST OK, status=%d len=%lld",
-                 status, content_len);
-    } else {
-        log_post(LOG_LEVEL_ERROR, TAG,
-                 "Telemetry POST failed: %s",
-                 esp_err_to_name(err));
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        metrics_gauge_set(METRIC_WIFI_CONNECTED, 1);
+        xEventGroupSetBits(s_events, NET_EVT_GOT_IP | NET_BIT_CONNECTED);
+        boot_mark(BOOT_STAGE_NET_UP);
+
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_LOST_IP) {
+        xEventGroupClearBits(s_events, NET_BIT_CONNECTED);
+        metrics_gauge_set(METRIC_WIFI_CONNECTED, 0);
+        xEventGroupSetBits(s_events, NET_EVT_LOST_IP);
     }
-
-    esp_http_client_cleanup(client);
 }
 
 /**
- * @brief Common Wi-Fi event handler (WIFI_EVENT + IP_EVENT).
+ * @brief Feed one event to the connection state machine.
  */
-static void wifi_event_handler(void *arg,
-                               esp_event_base_t event_base,
-                               int32_t event_id,
-                               void *event_data)
+static void net_apply(wifi_conn_event_t ev)
 {
-    (void)arg;
-    (void)event_data;
+    const wifi_conn_state_t prev = s_conn.state;
+    const bool connect = wifi_conn_on_event(&s_conn, ev, now_ms());
 
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+    switch (ev) {
+    case WIFI_CONN_EV_START:
         log_post(LOG_LEVEL_INFO, TAG,
                  "Wi-Fi STA started, connecting to SSID \"%s\"", WIFI_SSID);
-        esp_wifi_connect();
-    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-
-        s_wifi_ready = false;
-
-        if (s_retry_count < WIFI_MAX_RETRY) {
+        break;
+    case WIFI_CONN_EV_DISCONNECTED:
+        if (s_conn.state == WIFI_CONN_BACKOFF && prev != WIFI_CONN_BACKOFF) {
             log_post(LOG_LEVEL_WARN, TAG,
-                     "Wi-Fi disconnected, retrying (%d/%d)",
-                     s_retry_count + 1, WIFI_MAX_RETRY);
-            esp_wifi_connect();
-            s_retry_count++;
-        } else {
-            log_post(LOG_LEVEL_ERROR, TAG,
-                     "Wi-Fi failed to connect after %d retries", WIFI_MAX_RETRY);
+                     "Wi-Fi disconnected, retry %u in %u ms",
+                     (unsigned)s_conn.attempt,
+                     (unsigned)(s_conn.retry_at_ms - now_ms()));
         }
-
-    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-
+        break;
+    case WIFI_CONN_EV_GOT_IP:
         log_post(LOG_LEVEL_INFO, TAG, "Wi-Fi connected, got IP address");
         log_post(LOG_LEVEL_INFO, TAG, "Starting SNTP...");
         timeutil_init_sntp();
+        break;
+    case WIFI_CONN_EV_LOST_IP:
+        log_post(LOG_LEVEL_WARN, TAG, "Wi-Fi lost IP address");
+        break;
+    }
 
-        s_retry_count     = 0;
-        s_wifi_ready      = true;
-        s_sent_telemetry  = false; // allow test send once per connection
+    if (connect) {
+        esp_wifi_connect();
     }
 }
 
 /**
- * @brief NET task: bring up Wi-Fi station and keep it running.
+ * @brief NET task: bring up Wi-Fi station and keep it connected.
  *
- * For now, once Wi-Fi is started we just sleep and let the
- * event handler manage reconnects. This task also sends
- * a one-shot test telemetry after Wi-Fi and SNTP are ready.
+ * Sleeps on the event group until the driver reports something or the
+ * reconnect backoff expires (waking at least once a second for the
+ * watchdog), and drives the wifi_conn state machine.
  */
-static void task_net(void *arg)
+void task_net(void *arg)
 {
     (void)arg;
 
-    watchdog_register_current("NET");
-
     init_nvs();
+    boot_mark(BOOT_STAGE_NVS);
 
     // Initialize TCP/IP stack and default event loop
     ESP_ERROR_CHECK(esp_netif_init());
@@ -210,6 +176,13 @@ static void task_net(void *arg)
         NULL,
         NULL));
 
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(
+        IP_EVENT,
+        IP_EVENT_STA_LOST_IP,
+        &wifi_event_handler,
+        NULL,
+        NULL));
+
     wifi_config_t wifi_config = {
         .sta = {
             // SSID and password will be copied below
@@ -232,31 +205,71 @@ static void task_net(void *arg)
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
+    boot_mark(BOOT_STAGE_WIFI_INIT);
 
     log_post(LOG_LEVEL_INFO, TAG,
              "Wi-Fi STA init finished, waiting for connection...");
 
     while (1) {
-        if (s_wifi_ready && !s_sent_telemetry && timeutil_is_time_set()) {
-            log_post(LOG_LEVEL_INFO, TAG,
-                    "Wi-Fi + time ready, sending test telemetry...");
-            net_send_test_telemetry();
-            s_sent_telemetry = true;
+        const uint32_t wait = wifi_conn_wait_ms(&s_conn, now_ms(), 1000);
+
+        EventBits_t bits = xEventGroupWaitBits(s_events, NET_EVT_ALL,
+                                               pdTRUE, pdFALSE,
+                                               pdMS_TO_TICKS(wait));
+        watchdog_loop_begin();
+
+        if (bits & NET_EVT_START) {
+            net_apply(WIFI_CONN_EV_START);
+        }
+
+        // Edges that arrived together lost their order; the level bit
+        // tells which side the link ended up on, so apply that one last.
+        const bool up    = (bits & NET_EVT_GOT_IP) != 0;
+        const bool is_up = (bits & NET_BIT_CONNECTED) != 0;
+
+        if (up && !is_up) {
+            net_apply(WIFI_CONN_EV_GOT_IP);
+        }
+        if (bits & NET_EVT_LOST_IP) {
+            net_apply(WIFI_CONN_EV_LOST_IP);
+        }
+        if (bits & NET_EVT_DISCONNECTED) {
+            net_apply(WIFI_CONN_EV_DISCONNECTED);
+        }
+        if (up && is_up) {
+            net_apply(WIFI_CONN_EV_GOT_IP);
+        }
+
+        if (wifi_conn_poll(&s_conn, now_ms())) {
+            log_post(LOG_LEVEL_INFO, TAG, "Wi-Fi reconnecting (attempt %u)",
+                     (unsigned)s_conn.attempt + 1u);
+            esp_wifi_connect();
         }
 
         watchdog_feed();
-        vTaskDelay(pdMS_TO_TICKS(1000));
     }
+}
 
+bool task_net_is_connected(void)
+{
+    return (s_events != NULL) &&
+           (xEventGroupGetBits(s_events) & NET_BIT_CONNECTED) != 0;
 }
 
-void task_net_start(void)
+bool task_net_wait_connected(TickType_t timeout)
 {
-    xTaskCreate(
-        task_net,
-        "task_net",
-        TASK_STACK_NET,
-        NULL,
-        TASK_PRIO_NET,
-        NULL);
+    if (s_events == NULL) {
+        return false;
+    }
+    EventBits_t bits = xEventGroupWaitBits(s_events, NET_BIT_CONNECTED,
+                                           pdFALSE, pdTRUE, timeout);
+    return (bits & NET_BIT_CONNECTED) != 0;
+}
+
+app_error_t task_net_init(void)
+{
+    s_events = xEventGroupCreateStatic(&s_events_buf);
+    wifi_conn_init(&s_conn, WIFI_BACKOFF_BASE_MS, WIFI_BACKOFF_MAX_MS,
+                   esp_random());
+    return ERR_OK;
 }
@@ -0,0 +1,247 @@
+// components/app_thermostat/src/task_profiler.c
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "sdkconfig.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/config.h"
+#include "core/logging.h"
+#include "core/watchdog.h"
+
+#include "app/app_tasks.h"
+#include "app/task_profiler.h"
+
+#if APP_PROFILE
+
+#if !configUSE_TRACE_FACILITY || !configGENERATE_RUN_TIME_STATS
+#error "APP_PROFILE needs CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS"
+#endif
+
+static const char *TAG = "PROFILE";
+
+// Stack sizes we chose for tasks outside the task table.
+typedef struct {
+    const char *name;
+    uint32_t    stack;
+} prof_stack_t;
+
+static const prof_stack_t s_stacks[] = {
+    { "httpd",          TASK_STACK_HTTPD     },
+    { "task_watchdog",  TASK_STACK_WATCHDOG  },
+    { "Tmr Svc",        CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH },  // config notify
+};
+
+// Previous sample, to turn the cumulative counters into rates.
+typedef struct {
+    UBaseType_t number;
+    uint32_t    runtime;
+    uint32_t    feeds;
+} prof_prev_t;
+
+// Sized from uxTaskGetNumberOfTasks() + PROFILE_TASK_MARGIN, grown when
+// more tasks show up (profiling builds only, so the heap is fine here).
+static TaskStatus_t         *s_status     = NULL;
+static prof_prev_t          *s_prev       = NULL;
+static size_t                s_cap        = 0;
+static size_t                s_prev_count = 0;
+static watchdog_task_stats_t s_wdt[WATCHDOG_MAX_TASKS];
+
+static bool ensure_capacity(void)
+{
+    const size_t need = (size_t)uxTaskGetNumberOfTasks();
+    if (need <= s_cap) {
+        return true;
+    }
+
+    const size_t  cap    = need + PROFILE_TASK_MARGIN;
+    TaskStatus_t *status = malloc(cap * sizeof(*status));
+    prof_prev_t  *prev   = malloc(cap * sizeof(*prev));
+    if (status == NULL || prev == NULL) {
+        free(status);
+        free(prev);
+        return false;
+    }
+    if (s_prev_count > 0) {
+        memcpy(prev, s_prev, s_prev_count * sizeof(*prev));
+    }
+    free(s_status);
+    free(s_prev);
+    s_status = status;
+    s_prev   = prev;
+    s_cap    = cap;
+    return true;
+}
+
+/**
+ * Wait until the log queue has PROFILE_LOG_FREE_SLOTS free, so the
+ * report never crowds out other tasks' records. Gives up after
+ * PROFILE_LOG_MAX_WAIT_MS and posts anyway (log_post drops if full).
+ */
+static void pace_log(void)
+{
+    uint32_t waited = 0;
+    while (g_log_queue != NULL &&
+           uxQueueSpacesAvailable(g_log_queue) < PROFILE_LOG_FREE_SLOTS &&
+           waited < PROFILE_LOG_MAX_WAIT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(PROFILE_LOG_PACE_MS));
+        waited += PROFILE_LOG_PACE_MS;
+    }
+}
+
+static uint32_t configured_stack(const char *name)
+{
+    size_t            n    = 0;
+    const app_task_t *rows = app_tasks_table(&n);
+    for (size_t i = 0; i < n; i++) {
+        if (strcmp(rows[i].name, name) == 0) {
+            return rows[i].mem->stack_size;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(s_stacks) / sizeof(s_stacks[0]); i++) {
+        if (strcmp(s_stacks[i].name, name) == 0) {
+            return s_stacks[i].stack;
+        }
+    }
+    return 0;
+}
+
+static uint32_t recommended_stack(uint32_t used)
+{
+    uint32_t rec = used + used * PROFILE_STACK_HEADROOM_PCT / 100u;
+    rec = (rec + PROFILE_STACK_ROUND - 1u) / PROFILE_STACK_ROUND * PROFILE_STACK_ROUND;
+    return (rec < PROFILE_STACK_MIN) ? PROFILE_STACK_MIN : rec;
+}
+
+static const prof_prev_t *find_prev(UBaseType_t number)
+{
+    for (size_t i = 0; i < s_prev_count; i++) {
+        if (s_prev[i].number == number) {
+            return &s_prev[i];
+        }
+    }
+    return NULL;
+}
+
+static const watchdog_task_stats_t *find_wdt(TaskHandle_t task, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (s_wdt[i].task == task) {
+            return &s_wdt[i];
+        }
+    }
+    return NULL;
+}
+
+static void profile_report(uint32_t *prev_total)
+{
+    uint32_t    total = 0;
+    UBaseType_t n     = 0;
+
+    // A task created between sizing and sampling makes the call return 0:
+    // grow and try once more.
+    for (int attempt = 0; attempt < 2 && n == 0; attempt++) {
+        if (!ensure_capacity()) {
+            log_post(LOG_LEVEL_WARN, TAG, "No memory for %u task records",
+                     (unsigned)(uxTaskGetNumberOfTasks() + PROFILE_TASK_MARGIN));
+            return;
+        }
+        n = uxTaskGetSystemState(s_status, (UBaseType_t)s_cap, &total);
+    }
+    if (n == 0) {
+        log_post(LOG_LEVEL_WARN, TAG, "Task count changed while sampling, skipped");
+        return;
+    }
+
+    const size_t   nwdt     = watchdog_get_stats(s_wdt, WATCHDOG_MAX_TASKS);
+    const uint32_t dt_total = total - *prev_total;    // us, one core's worth
+    *prev_total = total;
+
+    uint32_t ours_cfg = 0;
+    uint32_t ours_rec = 0;
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t *t    = &s_status[i];
+        const prof_prev_t  *prev = find_prev(t->xTaskNumber);
+
+        // CPU share over the period, in 0.1 % of one core.
+        uint32_t cpu_pm = 0;
+        if (prev != NULL && dt_total > 0) {
+            cpu_pm = (uint32_t)((uint64_t)(t->ulRunTimeCounter - prev->runtime) * 1000u / dt_total);
+        }
+
+        // Wakeups per second (0.1 resolution) for supervised tasks.
+        const watchdog_task_stats_t *w = find_wdt(t->xHandle, nwdt);
+        char loops[16] = "-";
+        if (w != NULL && prev != NULL) {
+            const uint32_t d = (w->feeds - prev->feeds) * 10000u / PROFILE_PERIOD_MS;
+            snprintf(loops, sizeof(loops), "%u.%u", (unsigned)(d / 10u), (unsigned)(d % 10u));
+        }
+
+        // ESP-IDF: the high-water mark is in bytes.
+        const uint32_t hwm = (uint32_t)t->usStackHighWaterMark;
+        const uint32_t cfg = configured_stack(t->pcTaskName);
+
+        if (cfg > 0) {
+            const uint32_t used = (cfg > hwm) ? cfg - hwm : 0u;
+            const uint32_t rec  = recommended_stack(used);
+            ours_cfg += cfg;
+            ours_rec += rec;
+
+            pace_log();
+            log_post(LOG_LEVEL_INFO, TAG,
+                     "%-14s p%u cpu %3u.%u%% stack %5u/%5u rec %5u loops/s %s",
+                     t->pcTaskName, (unsigned)t->uxCurrentPriority,
+                     (unsigned)(cpu_pm / 10u), (unsigned)(cpu_pm % 10u),
+                     (unsigned)used, (unsigned)cfg, (unsigned)rec, loops);
+        } else {
+            pace_log();
+            log_post(LOG_LEVEL_INFO, TAG,
+                     "%-14s p%u cpu %3u.%u%% stack free %5u (IDF)",
+                     t->pcTaskName, (unsigned)t->uxCurrentPriority,
+                     (unsigned)(cpu_pm / 10u), (unsigned)(cpu_pm % 10u),
+                     (unsigned)hwm);
+        }
+    }
+
+    // Remember this sample for the next period's deltas.
+    s_prev_count = 0;
+    for (UBaseType_t i = 0; i < n; i++) {
+        const watchdog_task_stats_t *w = find_wdt(s_status[i].xHandle, nwdt);
+        s_prev[s_prev_count++] = (prof_prev_t){
+            .number  = s_status[i].xTaskNumber,
+            .runtime = s_status[i].ulRunTimeCounter,
+            .feeds   = (w != NULL) ? w->feeds : 0u,
+        };
+    }
+
+    pace_log();
+    log_post(LOG_LEVEL_INFO, TAG,
+             "heap free %u min %u largest %u | our stacks %u B, recommended %u B",
+             (unsigned)esp_get_free_heap_size(),
+             (unsigned)esp_get_minimum_free_heap_size(),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+             (unsigned)ours_cfg, (unsigned)ours_rec);
+}
+
+void task_profiler(void *arg)
+{
+    (void)arg;
+
+    uint32_t   prev_total = 0;
+    TickType_t last_wake  = xTaskGetTickCount();
+
+    while (1) {
+        profile_report(&prev_total);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(PROFILE_PERIOD_MS));
+    }
+}
+
+#endif  // APP_PROFILE
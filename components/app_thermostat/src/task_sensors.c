@@ -4,12 +4,44 @@
 #include "core/logging.h"
 #include "core/watchdog.h"
 #include "core/error.h"
+#include "core/metrics.h"
+#include "core/monotime.h"
+#include "core/boot.h"
 #include "app/task_common.h"
 #include "drivers/drv_temp_sensors.h"
 
 #include "core/timeutil.h" //for real time clock (RTO)
+#include "core/thermostat_config.h" // setpoint / hysteresis for scheduling
+#include "core/sample_scheduler.h"  // adaptive sampling period
+#include "app/task_sensors.h"
 
-//Gonzalo
+// Currently selected sampling period, exported as a metric.
+static volatile uint32_t s_period_ms = PERIOD_SENSORS_MS;
+
+uint32_t task_sensors_get_period_ms(void)
+{
+    return s_period_ms;
+}
+
+/**
+ * @brief Choose the next sampling period from the latest sample.
+ *
+ * Reads setpoint and hysteresis from thermostat_config, the same source
+ * the core decides on, so a setpoint change moves the band right away
+ * rather than after CONTROL's next cycle. Falls back to the fastest rate
+ * if the config is not available.
+ */
+static uint32_t sensors_next_period(sample_scheduler_t *sched,
+                                    const sensor_sample_t *sample)
+{
+    thermostat_config_t cfg;
+    if (thermostat_config_get(&cfg) != ERR_OK) {
+        return sched->min_period_ms;
+    }
+
+    return sample_scheduler_next_period(sched, sample,
+                                        cfg.setpoint_c, cfg.hysteresis_c);
+}
 
 /**
  * @brief FreeRTOS task responsible for reading temperature sensors.
@@ -18,92 +50,100 @@
  *   1. Reads indoor/outdoor temperature samples from the driver
  *   2. Pushes the sample into a shared queue for the control task
  *   3. Logs raw sensor data (debug level)
- *   4. Feeds the watchdog to indicate it is alive
+ *   4. Picks the next sampling period (adaptive, see sample_scheduler.h)
+ *   5. Feeds the watchdog to indicate it is alive
  *
  * The driver currently generates fake data (stub) until real hardware
  * support (I2C/ADC sensors) is implemented. The rest of the system can
  * be developed independently thanks to this stub behavior.
  */
-static void task_sensors(void *arg) {
+void task_sensors(void *arg) {
     (void)arg;   // Prevent unused parameter warning
 
-    // Register this task in the watchdog framework.
-    // If this task stops feeding the watchdog, the system will reset.
-    watchdog_register_current("SENSORS");
-
     // Initialize sensor driver (stub today, real hardware later).
     if (drv_temp_sensors_init() != ERR_OK) {
         error_report(ERR_GENERIC, "drv_temp_sensors_init");
+    } else {
+        boot_mark(BOOT_STAGE_SENSOR_INIT);
     }
 
     // Using vTaskDelayUntil ensures consistent periodic execution,
     // removing drift that occurs with vTaskDelay.
     TickType_t last_wake = xTaskGetTickCount();
 
+    sample_scheduler_t sched;
+    sample_scheduler_init(&sched, PERIOD_SENSORS_MIN_MS, PERIOD_SENSORS_MAX_MS);
+
+    uint32_t period_ms = PERIOD_SENSORS_MS;
+
     while (1) {
+        watchdog_loop_begin();
 
         // Structure to hold the temperature sample.
         // Zero-initialize to avoid garbage if fields are added later.
         sensor_sample_t sample = {0};
 
         // Ask driver for new readings (stub simulates drifting values)
+        mono_us_t   t0  = monotime_now_us();
         app_error_t err = drv_temp_read(&sample);
+        metrics_observe(METRIC_SENSOR_READ_MS, (uint32_t)(monotime_since_us(t0) / 1000u));
+
         if (err == ERR_OK) {
+            metrics_inc(METRIC_SENSOR_SAMPLES);
 
-            // If the queue exists, overwrite with the latest sample.
-            // Overwrite is intentional: control logic needs ONLY
-            // the newest sample, not a backlog of old temperatures.
-            if (g_q_sensor_samples) {
-                xQueueOverwrite(g_q_sensor_samples, &sample);
-            }
+            // Publish as the latest sample. Overwrite is intentional:
+            // control logic needs ONLY the newest sample, not a backlog
+            // of old temperatures.
+            mailbox_publish(&g_mb_sensor_samples, &sample);
+            msgbus_publish(MSGBUS_TOPIC_SENSOR_SAMPLE, &sample);
+            boot_mark(BOOT_STAGE_FIRST_SAMPLE);
 
             // Log raw sensor readings for debugging / calibration
             char iso[32];
             if(timeutil_get_iso8601(iso, sizeof(iso))){
                 log_post(LOG_LEVEL_DEBUG, "SENSORS",
-                    "Tin=%.2fC Tout=%.2fC t=%lu ms local=%s",
+                    "Tin=%.2fC Tout=%.2fC t=%llu us local=%s",
                     sample.temp_inside_c,
                     sample.temp_outside_c,
-                    (unsigned long)sample.timestamp_ms,
+                    (unsigned long long)sample.timestamp_us,
                     iso);
             } else {
                 //Time not set yet, log without Local time
                 log_post(LOG_LEVEL_DEBUG, "SENSORS",
-                    "Tin=%.2fC Tout=%.2fC t=%lu ms (no RTC yet)",
+                    "Tin=%.2fC Tout=%.2fC t=%llu us (no RTC yet)",
                     sample.temp_inside_c,
                     sample.temp_outside_c,
-                    (unsigned long)sample.timestamp_ms);
+                    (unsigned long long)sample.timestamp_us);
+            }
+
+            uint32_t next = sensors_next_period(&sched, &sample);
+            if (next != period_ms) {
+                log_post(LOG_LEVEL_DEBUG, "SENSORS",
+                         "Sampling period %lu -> %lu ms (slope=%.4fC/s)",
+                         (unsigned long)period_ms,
+                         (unsigned long)next,
+                         sched.slope_c_per_s);
+                period_ms   = next;
+                s_period_ms = next;
             }
- 
 
         } else {
             // If driver fails, report non-fatal error (logged only)
+            metrics_inc(METRIC_SENSOR_FAILURES);
             error_report(err, "drv_temp_read");
+
+            // Retry at the fastest rate so we do not sit blind for a
+            // full max period after a transient failure.
+            period_ms   = PERIOD_SENSORS_MIN_MS;
+            s_period_ms = period_ms;
         }
 
+        metrics_gauge_set(METRIC_SENSOR_PERIOD_MS, (int32_t)period_ms);
+
         // Notify watchdog that this task is alive and progressing
         watchdog_feed();
 
-        // Sleep until next cycle (e.g., PERIOD_SENSORS_MS = 500 ms)
-        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(PERIOD_SENSORS_MS));
+        // Sleep until next cycle (adaptive, PERIOD_SENSORS_MIN_MS..MAX_MS)
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(period_ms));
     }
 }
-
-
-/**
- * @brief Create and start the sensor task.
- *
- * Called during system initialization (from app_main).
- * Stack size and priority are configured centrally in config.h to keep
- * tuning easy and consistent across the application.
- */
-void task_sensors_start(void) {
-    xTaskCreate(
-        task_sensors,         // Task function
-        "task_sensors",       // Task name (debugging)
-        TASK_STACK_SENSORS,   // Stack size (words)
-        NULL,                 // No parameters
-        TASK_PRIO_SENSORS,    // Task priority
-        NULL                  // No task handle needed
-    );
-}
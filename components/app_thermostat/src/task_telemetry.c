@@ -0,0 +1,545 @@
+// components/app_thermostat/src/task_telemetry.c
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_http_client.h"
+#include "esp_partition.h"
+#include "nvs.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/boot.h"
+#include "core/config.h"
+#include "core/logging.h"
+#include "core/watchdog.h"
+#include "core/timeutil.h"
+#include "core/monotime.h"
+#include "core/spool.h"
+#include "core/telemetry_codec.h"
+
+#include "app/task_common.h"      // MSGBUS_TOPIC_THERMOSTAT_STATE
+#include "app/task_net.h"         // task_net_is_connected
+#include "app/task_telemetry.h"
+
+static const char *TAG = "TELEMETRY";
+
+// Sized for the JSON fallback (~200 bytes per sample, with headroom);
+// the protobuf encoding of the same batch needs ~10 bytes per sample.
+#define TELEMETRY_SAMPLE_JSON_MAX   256
+#define TELEMETRY_BODY_MAX          (64 + TELEMETRY_BATCH_MAX * TELEMETRY_SAMPLE_JSON_MAX)
+
+// Pending samples, oldest first. Bounded: while offline the oldest
+// samples spill to the flash spool (or are dropped if it is unavailable).
+static thermostat_state_t s_batch[TELEMETRY_BATCH_MAX];
+static uint16_t           s_batch_head  = 0;   // index of oldest
+static uint16_t           s_batch_count = 0;
+static TickType_t         s_batch_since = 0;   // when the oldest pending sample arrived
+
+_Static_assert(TELEMETRY_REPLAY_BATCH <= TELEMETRY_BATCH_MAX,
+               "replay chunk must fit the record/body buffers");
+_Static_assert(sizeof(telemetry_record_t) <= SPOOL_MAX_PAYLOAD,
+               "telemetry record must fit a spool frame");
+
+// Records of the POST being built (live batch or spool replay).
+static telemetry_record_t s_records[TELEMETRY_BATCH_MAX];
+
+static char s_body[TELEMETRY_BODY_MAX];
+
+// Body format: protobuf unless the server answered 415 to it.
+static bool s_use_pb = TELEMETRY_PREFER_PROTOBUF;
+
+// One client for the lifetime of the task so the TCP connection is reused.
+static esp_http_client_handle_t s_client = NULL;
+
+// Flash spool (opened once NVS is up).
+typedef enum {
+    SPOOL_STATE_CLOSED = 0,
+    SPOOL_STATE_OPEN,
+    SPOOL_STATE_UNAVAILABLE
+} spool_state_t;
+
+static spool_state_t          s_spool_state = SPOOL_STATE_CLOSED;
+static spool_t                s_spool;
+static spool_flash_t          s_spool_flash;
+static const esp_partition_t *s_spool_part = NULL;
+
+// Boot counter and wall-clock time of boot start, for samples spooled
+// before SNTP: they are stamped with uptime and this boot's id, and
+// converted when the start time of their boot is known. NVS keeps the
+// start time of the latest boot that got the clock, so samples from a
+// boot that reset before its first sync can still be placed.
+static uint8_t  s_boot_id       = 0;
+static uint32_t s_boot_t0       = 0;       // 0 until the clock is set
+static bool     s_boot_t0_saved = false;
+static uint8_t  s_known_boot_id = 0;       // boot of s_known_t0 (from NVS)
+static uint32_t s_known_t0      = 0;
+
+static telemetry_stats_t s_stats;
+
+/* ---------------- Flash spool ---------------- */
+
+static int spool_part_read(void *ctx, size_t off, void *buf, size_t len)
+{
+    return (esp_partition_read(ctx, off, buf, len) == ESP_OK) ? 0 : -1;
+}
+
+static int spool_part_write(void *ctx, size_t off, const void *buf, size_t len)
+{
+    return (esp_partition_write(ctx, off, buf, len) == ESP_OK) ? 0 : -1;
+}
+
+static int spool_part_erase(void *ctx, size_t off)
+{
+    const esp_partition_t *part = ctx;
+    return (esp_partition_erase_range(part, off, part->erase_size) == ESP_OK) ? 0 : -1;
+}
+
+static uint32_t nvs_load_u32(const char *key)
+{
+    nvs_handle_t h;
+    uint32_t     v = 0;
+
+    if (nvs_open(TELEMETRY_NVS_NAMESPACE, NVS_READONLY, &h) == ESP_OK) {
+        if (nvs_get_u32(h, key, &v) != ESP_OK) {
+            v = 0;
+        }
+        nvs_close(h);
+    }
+    return v;
+}
+
+static bool nvs_store_u32(const char *key, uint32_t v)
+{
+    nvs_handle_t h;
+    bool         ok = false;
+
+    if (nvs_open(TELEMETRY_NVS_NAMESPACE, NVS_READWRITE, &h) == ESP_OK) {
+        ok = (nvs_set_u32(h, key, v) == ESP_OK) && (nvs_commit(h) == ESP_OK);
+        nvs_close(h);
+    }
+    if (!ok) {
+        log_post(LOG_LEVEL_WARN, TAG, "NVS key \"%s\" not saved", key);
+    }
+    return ok;
+}
+
+static void spool_store_ack(uint32_t ack)
+{
+    nvs_store_u32("spool_ack", ack);
+}
+
+/**
+ * @brief Remember when this boot started in wall-clock time, once known.
+ */
+static void boot_clock_update(void)
+{
+    if (s_boot_t0 == 0 && timeutil_is_time_set()) {
+        s_boot_t0 = (uint32_t)(timeutil_now() - (time_t)(monotime_now_us() / 1000000u));
+    }
+    if (s_boot_t0 != 0 && !s_boot_t0_saved && s_spool_state == SPOOL_STATE_OPEN) {
+        s_boot_t0_saved = nvs_store_u32("t0", s_boot_t0) &&
+                          nvs_store_u32("t0_boot", s_boot_id);
+    }
+}
+
+/**
+ * @brief Turn an uptime-stamped record into wall-clock time.
+ *
+ * @return false if the start time of its boot is unknown.
+ */
+static bool record_fix_time(telemetry_record_t *rec)
+{
+    if (!(rec->flags & TELEMETRY_REC_UPTIME)) {
+        return true;
+    }
+
+    uint32_t t0 = 0;
+    if (rec->boot_id == s_boot_id) {
+        t0 = s_boot_t0;
+    } else if (rec->boot_id == s_known_boot_id) {
+        t0 = s_known_t0;
+    }
+    if (t0 == 0) {
+        return false;
+    }
+
+    rec->epoch_s += t0;
+    rec->flags   &= (uint8_t)~TELEMETRY_REC_UPTIME;
+    return true;
+}
+
+/**
+ * @brief Open the spool on first use.
+ *
+ * Deferred until the NET task has initialized NVS (the replay cursor and
+ * boot counter live there). The clock is not needed: samples spooled
+ * before SNTP are stamped with uptime (see record_fix_time()).
+ */
+static bool spool_ready(void)
+{
+    if (s_spool_state != SPOOL_STATE_CLOSED) {
+        return s_spool_state == SPOOL_STATE_OPEN;
+    }
+    if (!boot_wait(BOOT_BIT(BOOT_STAGE_NVS), 0)) {
+        return false;
+    }
+
+    s_spool_state = SPOOL_STATE_UNAVAILABLE;
+
+    s_spool_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                            ESP_PARTITION_SUBTYPE_ANY,
+                                            TELEMETRY_SPOOL_PARTITION);
+    if (s_spool_part == NULL) {
+        log_post(LOG_LEVEL_WARN, TAG, "No \"%s\" partition, spooling disabled",
+                 TELEMETRY_SPOOL_PARTITION);
+        return false;
+    }
+
+    s_spool_flash = (spool_flash_t){
+        .ctx          = (void *)s_spool_part,
+        .size         = s_spool_part->size - (s_spool_part->size % s_spool_part->erase_size),
+        .sector_size  = s_spool_part->erase_size,
+        .read         = spool_part_read,
+        .write        = spool_part_write,
+        .erase_sector = spool_part_erase,
+    };
+
+    if (spool_open(&s_spool, &s_spool_flash, nvs_load_u32("spool_ack")) != ERR_OK) {
+        log_post(LOG_LEVEL_ERROR, TAG, "spool_open failed, spooling disabled");
+        return false;
+    }
+
+    s_boot_id       = (uint8_t)(nvs_load_u32("boot_id") + 1u);
+    s_known_t0      = nvs_load_u32("t0");
+    s_known_boot_id = (uint8_t)nvs_load_u32("t0_boot");
+    nvs_store_u32("boot_id", s_boot_id);
+
+    s_spool_state = SPOOL_STATE_OPEN;
+    boot_clock_update();
+    return true;
+}
+
+/* ---------------- Batch buffer ---------------- */
+
+/**
+ * @brief Move the oldest pending sample to flash (or drop it).
+ */
+static void batch_evict_oldest(void)
+{
+    const thermostat_state_t *oldest = &s_batch[s_batch_head];
+
+    if (spool_ready()) {
+        const uint64_t     now_us = monotime_now_us();
+        telemetry_record_t rec;
+        if (timeutil_is_time_set()) {
+            telemetry_record_from_state(oldest, timeutil_now(), now_us, &rec);
+        } else {
+            telemetry_record_from_state(oldest, (time_t)(now_us / 1000000u), now_us, &rec);
+            rec.flags = TELEMETRY_REC_UPTIME;
+        }
+        rec.boot_id = s_boot_id;
+        if (spool_append(&s_spool, &rec, sizeof(rec)) == ERR_OK) {
+            s_stats.spooled++;
+        } else {
+            s_stats.dropped++;
+        }
+    } else {
+        s_stats.dropped++;
+    }
+
+    s_batch_head = (uint16_t)((s_batch_head + 1) % TELEMETRY_BATCH_MAX);
+    s_batch_count--;
+}
+
+/**
+ * @brief Append a sample; evicts the oldest one if the batch is full.
+ *
+ * Only for samples already released from the bus: a copy that turned out
+ * to be overwritten must not cost the oldest pending sample as well.
+ */
+static void batch_push(const thermostat_state_t *st)
+{
+    if (s_batch_count == TELEMETRY_BATCH_MAX) {
+        batch_evict_oldest();
+    }
+    if (s_batch_count == 0) {
+        s_batch_since = xTaskGetTickCount();
+    }
+    s_batch[(s_batch_head + s_batch_count) % TELEMETRY_BATCH_MAX] = *st;
+    s_batch_count++;
+    s_stats.samples++;
+}
+
+/* ---------------- HTTP ---------------- */
+
+static bool telemetry_client_init(void)
+{
+    esp_http_client_config_t cfg = {
+        .url               = TELEMETRY_URL,
+        .method            = HTTP_METHOD_POST,
+        .transport_type    = HTTP_TRANSPORT_OVER_TCP, // plain HTTP on LAN
+        .timeout_ms        = TELEMETRY_HTTP_TIMEOUT_MS,
+        .keep_alive_enable = true,
+        .buffer_size_tx    = 1024,
+    };
+
+    s_client = esp_http_client_init(&cfg);
+    if (s_client == NULL) {
+        log_post(LOG_LEVEL_ERROR, TAG, "HTTP client init failed");
+        return false;
+    }
+
+    // Headers persist across requests on the same handle; Content-Type
+    // is set per request by telemetry_post().
+    esp_http_client_set_header(s_client, "X-API-Key", TELEMETRY_API_KEY);
+    return true;
+}
+
+static int encode_body(const telemetry_record_t *recs, uint16_t n)
+{
+    size_t len = s_use_pb
+        ? telemetry_encode_pb(TELEMETRY_DEVICE_ID, recs, n, (uint8_t *)s_body, sizeof(s_body))
+        : telemetry_encode_json(TELEMETRY_DEVICE_ID, recs, n, s_body, sizeof(s_body));
+
+    if (len == 0) {
+        log_post(LOG_LEVEL_ERROR, TAG, "Telemetry body overflow (%u samples)", (unsigned)n);
+        return -1;
+    }
+    return (int)len;
+}
+
+static int http_post_body(int len)
+{
+    esp_http_client_set_header(s_client, "Content-Type",
+                               s_use_pb ? TELEMETRY_CONTENT_TYPE_PB
+                                        : TELEMETRY_CONTENT_TYPE_JSON);
+    esp_http_client_set_post_field(s_client, s_body, len);
+
+    esp_err_t err = esp_http_client_perform(s_client);
+    if (err != ESP_OK) {
+        log_post(LOG_LEVEL_WARN, TAG, "Telemetry POST failed: %s", esp_err_to_name(err));
+        return 0;
+    }
+    return esp_http_client_get_status_code(s_client);
+}
+
+typedef enum {
+    POST_OK = 0,
+    POST_RETRY,         // format switched; send the same records again now
+    POST_FAILED,        // transport error or rejected; back off
+} post_result_t;
+
+/**
+ * @brief Encode and POST @p n records. The connection is left open for reuse.
+ *
+ * Content negotiation: the binary format is tried first; a 415 reply
+ * switches this device to JSON for the rest of the session and asks the
+ * caller to re-send on its next loop, so one loop never does more than
+ * one POST (see TELEMETRY_WDT_DEADLINE_MS).
+ */
+static post_result_t telemetry_post(const telemetry_record_t *recs, uint16_t n)
+{
+    int len = encode_body(recs, n);
+    if (len < 0) {
+        return POST_FAILED;
+    }
+
+    int status = http_post_body(len);
+
+    if (status == 415 && s_use_pb) {
+        log_post(LOG_LEVEL_WARN, TAG, "Server rejected protobuf, falling back to JSON");
+        s_use_pb = false;
+        return POST_RETRY;
+    }
+
+    if (status < 200 || status >= 300) {
+        log_post(LOG_LEVEL_WARN, TAG, "Telemetry POST rejected, status=%d", status);
+        // Drop the socket; the next perform reconnects.
+        esp_http_client_close(s_client);
+        s_stats.post_failures++;
+        return POST_FAILED;
+    }
+
+    s_stats.batches_sent++;
+    s_stats.bytes_sent += (uint32_t)len;
+    log_post(LOG_LEVEL_DEBUG, TAG, "Telemetry POST OK: %u samples, %d bytes (%s)",
+             (unsigned)n, len, s_use_pb ? "pb" : "json");
+    return POST_OK;
+}
+
+/**
+ * @brief Send the live RAM batch.
+ */
+static post_result_t telemetry_send_batch(void)
+{
+    const time_t   now_epoch = timeutil_now();
+    const uint64_t now_us    = monotime_now_us();
+    const uint16_t n         = s_batch_count;
+
+    for (uint16_t i = 0; i < n; i++) {
+        telemetry_record_from_state(&s_batch[(s_batch_head + i) % TELEMETRY_BATCH_MAX],
+                                    now_epoch, now_us, &s_records[i]);
+    }
+
+    const post_result_t r = telemetry_post(s_records, n);
+    if (r != POST_OK) {
+        return r;
+    }
+
+    s_stats.samples_sent += n;
+    s_batch_head  = 0;
+    s_batch_count = 0;
+    return POST_OK;
+}
+
+/**
+ * @brief Replay the next chunk of spooled records, oldest first.
+ *
+ * The acknowledged position is persisted only after the server accepted
+ * the chunk, so a reset mid-replay re-sends at most one chunk.
+ */
+static post_result_t telemetry_replay_chunk(void)
+{
+    spool_iter_t it;
+    uint16_t     n = 0;
+
+    spool_iter_begin(&s_spool, &it);
+    while (n < TELEMETRY_REPLAY_BATCH) {
+        uint8_t buf[SPOOL_MAX_PAYLOAD];
+        size_t  len = 0;
+        if (!spool_read_next(&s_spool, &it, buf, &len)) {
+            break;
+        }
+        if (len != sizeof(telemetry_record_t)) {
+            continue;
+        }
+        memcpy(&s_records[n], buf, len);
+        if (record_fix_time(&s_records[n])) {
+            n++;
+        } else {
+            s_stats.spool_untimed++;
+        }
+    }
+
+    if (n > 0) {
+        const post_result_t r = telemetry_post(s_records, n);
+        if (r != POST_OK) {
+            return r;
+        }
+        s_stats.replayed += n;
+    }
+
+    // Also acknowledges records skipped as corrupt.
+    spool_ack(&s_spool, &it);
+    spool_store_ack(spool_ack_seq(&s_spool));
+    return POST_OK;
+}
+
+/* ---------------- Task ---------------- */
+
+// One loop runs at most one POST (live batch first, else a replay chunk),
+// so the watchdog deadline only has to cover one HTTP exchange.
+void task_telemetry(void *arg)
+{
+    (void)arg;
+
+    if (!telemetry_client_init()) {
+        // Nothing useful to do without a client; stay alive for the watchdog.
+        while (1) {
+            watchdog_feed();
+            vTaskDelay(pdMS_TO_TICKS(1000));
+        }
+    }
+
+    msgbus_sub_t sub;
+    msgbus_subscribe(&sub, MSGBUS_TOPIC_THERMOSTAT_STATE, "TELEMETRY", false);
+
+    const TickType_t flush_ticks  = pdMS_TO_TICKS(TELEMETRY_FLUSH_MS);
+    const TickType_t retry_ticks  = pdMS_TO_TICKS(TELEMETRY_RETRY_MS);
+    const TickType_t replay_ticks = pdMS_TO_TICKS(TELEMETRY_REPLAY_INTERVAL_MS);
+    TickType_t       retry_at     = 0;
+    TickType_t       last_replay  = 0;
+    bool             backoff      = false;
+    bool             again        = false;   // re-send right away (415 fallback)
+
+    while (1) {
+        // Wake at least once a second to feed the watchdog and check the
+        // flush deadline. With data waiting only on the link (or on SNTP),
+        // sleep on that instead so the upload starts the moment it is up;
+        // samples published meanwhile stay on the bus and are drained below.
+        TickType_t bus_wait = again ? 0 : pdMS_TO_TICKS(1000);
+        again = false;
+        const bool has_work = (s_batch_count > 0) ||
+                              (spool_ready() && spool_pending(&s_spool) > 0);
+        if (!backoff && has_work) {
+            if (!task_net_is_connected()) {
+                task_net_wait_connected(pdMS_TO_TICKS(1000));
+                bus_wait = 0;
+            } else if (!timeutil_is_time_set()) {
+                timeutil_wait_time_set(1000);
+                bus_wait = 0;
+            }
+        }
+
+        const thermostat_state_t *st;
+        while (msgbus_peek(&sub, (const void **)&st, bus_wait)) {
+            thermostat_state_t copy = *st;
+            if (msgbus_release(&sub)) {
+                batch_push(&copy);
+            }
+            s_stats.bus_dropped = sub.dropped;
+            if (s_batch_count >= TELEMETRY_BATCH_MAX) {
+                break;      // send (or spool) before taking more
+            }
+            bus_wait = 0;
+        }
+        watchdog_loop_begin();
+
+        boot_clock_update();
+
+        TickType_t now = xTaskGetTickCount();
+        if (backoff && (int32_t)(now - retry_at) >= 0) {
+            backoff = false;
+        }
+
+        bool due = (s_batch_count >= TELEMETRY_BATCH_MAX) ||
+                   (s_batch_count > 0 && (now - s_batch_since) >= flush_ticks);
+
+        const bool online = !backoff && task_net_is_connected() && timeutil_is_time_set();
+
+        post_result_t r = POST_OK;
+        if (due && online) {
+            r = telemetry_send_batch();
+        } else if (online && spool_ready() && spool_pending(&s_spool) > 0 &&
+                   (now - last_replay) >= replay_ticks) {
+            // Drain the backlog at a bounded rate, interleaved with live data.
+            last_replay = now;
+            r = telemetry_replay_chunk();
+        }
+
+        if (r == POST_RETRY) {
+            again = true;
+        } else if (r == POST_FAILED) {
+            backoff  = true;
+            retry_at = now + retry_ticks;
+        }
+
+        if (s_spool_state == SPOOL_STATE_OPEN) {
+            s_stats.spool_pending = spool_pending(&s_spool);
+            s_stats.spool_lost    = s_spool.stats.lost;
+        }
+
+        watchdog_feed();
+    }
+}
+
+void task_telemetry_get_stats(telemetry_stats_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+    *out = s_stats;
+}
@@ -7,7 +7,7 @@
 typedef struct {
     float temp_inside_c;
     float temp_outside_c;
-    uint32_t timestamp_ms;
+    uint64_t timestamp_us;      // monotime_now_us() at acquisition
 } sensor_sample_t;
 
 #endif
@@ -0,0 +1,70 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @file boot.h
+ * @brief Boot stages: microsecond markers and the readiness bits the
+ *        task table's dependencies wait on.
+ *
+ * Each stage is reached once. boot_mark() records the monotime_now_us()
+ * of the first call (later calls are a cheap no-op), logs it and sets
+ * the stage's bit, so tasks can declare "start me after X" instead of
+ * relying on creation order. When the first relay decision is made, the
+ * boot report is logged once: time to first sample / first decision, the
+ * longest and summed driver init times (counted from the "tasks" stage;
+ * the difference is what initializing them concurrently saves), and
+ * every stage reached so far. /metrics shows all stages.
+ *
+ * Times count from esp_timer start, i.e. they exclude ROM and
+ * bootloader time (add the bootloader's own log timestamp for that).
+ */
+
+typedef enum {
+    BOOT_STAGE_APP_MAIN = 0,      // app_main() entered
+    BOOT_STAGE_CORE,              // logging, watchdog, config, thermostat core up
+    BOOT_STAGE_TASKS,             // every task table row created
+    BOOT_STAGE_SENSOR_INIT,       // I2C + AHT20 ready
+    BOOT_STAGE_DISPLAY_INIT,      // LCD init sequence queued
+    BOOT_STAGE_BUTTONS_INIT,      // button GPIOs / timers ready
+    BOOT_STAGE_FIRST_SAMPLE,      // first valid sample published
+    BOOT_STAGE_FIRST_DECISION,    // first relay decision applied
+    BOOT_STAGE_NVS,               // NVS flash initialized (NET task)
+    BOOT_STAGE_WIFI_INIT,         // Wi-Fi driver started
+    BOOT_STAGE_NET_UP,            // first IP address
+    BOOT_STAGE_TIME_SET,          // first SNTP sync
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+#define BOOT_BIT(stage)   (1u << (stage))
+
+/**
+ * @brief Create the stage bits and mark BOOT_STAGE_APP_MAIN. Call first
+ *        thing in app_main(); boot_mark() before it only records time.
+ */
+void boot_init(void);
+
+/**
+ * @brief Record that @p stage has been reached (first call wins).
+ */
+void boot_mark(boot_stage_t stage);
+
+/**
+ * @brief Block until every stage in @p mask (BOOT_BIT()s) is reached.
+ *
+ * @return true if they all were before @p timeout.
+ */
+bool boot_wait(uint32_t mask, TickType_t timeout);
+
+/**
+ * @brief Time @p stage was reached, in us since boot; 0 if not yet.
+ */
+uint64_t boot_stage_us(boot_stage_t stage);
+
+const char *boot_stage_name(boot_stage_t stage);
+
+#endif  // BOOT_H
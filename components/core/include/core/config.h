@@ -16,18 +16,82 @@
 #define TASK_PRIO_CONTROL     5   // Control is as important as logging
 
 // -----------------------------------------------------------------------------
-// Task stack sizes (in words, ESP-IDF expects words for xTaskCreate)
+// Task stack sizes (in bytes: ESP-IDF's xTaskCreate takes bytes, not words)
 // -----------------------------------------------------------------------------
 #define TASK_STACK_LOGGER     4096
 #define TASK_STACK_SENSORS    4096
 #define TASK_STACK_HEARTBEAT  4096
 #define TASK_STACK_CONTROL    4096
 
+// -----------------------------------------------------------------------------
+// Core affinity (task plan in app/app_tasks.h)
+// -----------------------------------------------------------------------------
+// Core 0 also runs Wi-Fi, lwIP and esp_timer; core 1 is kept for the
+// control path. APP_TASK_PINNING=0 leaves every task unpinned.
+#ifndef APP_TASK_PINNING
+#define APP_TASK_PINNING      1
+#endif
+#define CORE_NET              0
+#define CORE_CONTROL          1
+
+// -----------------------------------------------------------------------------
+// Kernel object allocation (see core/rtos_alloc.h)
+// -----------------------------------------------------------------------------
+// 1: every application task stack/TCB, queue, mutex and timer is a static
+// buffer sized at compile time (RAM budget readable from the link map,
+// no heap use for the RTOS skeleton). 0: same objects from the heap.
+#ifndef APP_STATIC_ALLOC
+#define APP_STATIC_ALLOC      0
+#endif
+
+// -----------------------------------------------------------------------------
+// Watchdog supervisor
+// -----------------------------------------------------------------------------
+#define TASK_PRIO_WATCHDOG       6      // above every supervised task
+#define TASK_STACK_WATCHDOG      3072
+#define WATCHDOG_CHECK_MS        200
+#define WATCHDOG_HW_TIMEOUT_MS   5000   // hardware TWDT guarding the supervisor
+#define WATCHDOG_MAX_TASKS       12
+#define WATCHDOG_MAX_RESTARTS    3      // per task, then reset
+
+// Default deadline for tasks that wake at least once a second. Tasks with
+// longer blocking calls in their loop add those on top.
+#define WATCHDOG_DEADLINE_MS     3000
+
+// -----------------------------------------------------------------------------
+// Profiling mode
+// -----------------------------------------------------------------------------
+// Build with APP_PROFILE=1 to start the profiler task: every
+// PROFILE_PERIOD_MS it logs CPU share, stack high-water mark and a
+// recommended stack size per task, plus heap minimum-free. Needs
+// CONFIG_FREERTOS_USE_TRACE_FACILITY and _GENERATE_RUN_TIME_STATS.
+#ifndef APP_PROFILE
+#define APP_PROFILE                  0
+#endif
+#define PROFILE_PERIOD_MS            10000
+#define PROFILE_TASK_MARGIN          8      // task records beyond the current count
+#define PROFILE_LOG_FREE_SLOTS       (LOG_QUEUE_LENGTH / 2)  // left for other tasks
+#define PROFILE_LOG_PACE_MS          20     // recheck the log queue this often
+#define PROFILE_LOG_MAX_WAIT_MS      1000   // per line, then post anyway
+#define PROFILE_STACK_HEADROOM_PCT   25     // on top of the worst use seen
+#define PROFILE_STACK_MIN            2048   // never recommend below this
+#define PROFILE_STACK_ROUND          256
+#define TASK_PRIO_PROFILER           1
+#define TASK_STACK_PROFILER          3072
+
 // -----------------------------------------------------------------------------
 // Periods (milliseconds)
 // -----------------------------------------------------------------------------
 #define PERIOD_LOGGER_MS      50    // how often logger wakes when idle
-#define PERIOD_SENSORS_MS     500   // sensor sampling period
+#define PERIOD_SENSORS_MS     500   // initial / fallback sensor sampling period
+
+// Adaptive sampling bounds (see core/sample_scheduler.h).
+// The AHT20 conversion alone takes AHT20_MEASURE_DELAY_MS, so the minimum
+// must stay comfortably above it.
+#define PERIOD_SENSORS_MIN_MS           250   // near a switching threshold
+#define PERIOD_SENSORS_MAX_MS           5000  // steady, far from thresholds
+#define SENSORS_ADAPT_FAR_C             2.0f  // distance (C) at which we use max period
+#define SENSORS_ADAPT_SAMPLES_TO_EDGE   4     // samples wanted before reaching an edge
 
 // -----------------------------------------------------------------------------
 // Logging subsystem
@@ -40,6 +104,7 @@
 // -----------------------------------------------------------------------------
 #define THERMOSTAT_SETPOINT_C       22.0f   // default target temp (°C)
 #define THERMOSTAT_HYSTERESIS_C      0.5f   // +/- hysteresis band (°C)
+#define THERMOSTAT_CONFIG_COALESCE_MS 300    // updates within this window -> one notification
 
 // -----------------------------------------------------------------------------
 // Board pins
@@ -51,6 +116,23 @@
 // -----------------------------------------------------------------------------
 // LCD 16x2 (HD44780) in 4-bit mode 
 // -----------------------------------------------------------------------------
+// Backend (build time):
+//   LCD_BACKEND_GPIO     HD44780 wired to RS/EN/D4..D7 GPIOs below
+//   LCD_BACKEND_PCF8574  HD44780 behind a PCF8574 I2C backpack on the
+//                        shared I2C bus (same bus as the AHT20)
+// Override from the build, e.g. -DLCD_BACKEND=1 for the backpack.
+#define LCD_BACKEND_GPIO     0
+#define LCD_BACKEND_PCF8574  1
+
+#ifndef LCD_BACKEND
+#define LCD_BACKEND          LCD_BACKEND_GPIO
+#endif
+
+// PCF8574 backpack: 7-bit address (0x27 typical, 0x3F on PCF8574A boards)
+// and burst buffer size. A full 16x2 redraw is 34 LCD bytes = 136 I2C bytes.
+#define LCD_PCF8574_ADDR       0x27
+#define LCD_PCF8574_BURST_LEN  160
+
 // #define LCD_PIN_RS           32
 // #define LCD_PIN_EN           33
 
@@ -67,6 +149,10 @@
 #define LCD_PIN_D6           16
 #define LCD_PIN_D7           4
 
+// Depth of the LCD transfer queue (commands / characters / init steps).
+// A full redraw of a 16x2 display is 34 entries.
+#define LCD_XFER_QUEUE_LEN   128
+
 // -----------------------------------------------------------------------------
 // Buttons 
 // -----------------------------------------------------------------------------
@@ -85,8 +171,20 @@
 #define THERMOSTAT_SP_MIN_C      15.0f
 #define THERMOSTAT_SP_MAX_C      28.0f
 
-// Button debounce time (in ms)
-#define BUTTON_DEBOUNCE_MS       200
+// Accepted range for remotely set hysteresis
+#define THERMOSTAT_HYST_MIN_C    0.1f
+#define THERMOSTAT_HYST_MAX_C    3.0f
+
+// Button debounce: contact must be quiet this long before a level is accepted
+#define BUTTON_DEBOUNCE_MS       20
+
+// Hold behaviour (all in ms)
+#define BUTTON_LONG_PRESS_MS     800   // LONG_PRESS event after this hold time
+#define BUTTON_REPEAT_DELAY_MS   400   // first auto-repeat after this hold time
+#define BUTTON_REPEAT_START_MS   200   // initial auto-repeat interval
+#define BUTTON_REPEAT_MIN_MS     40    // fastest auto-repeat interval
+#define BUTTON_REPEAT_ACCEL_PCT  80    // each repeat interval = previous * PCT / 100
+#define BUTTON_HOLD_POLL_MS      100   // level re-check while held (missed release edge)
 
 // Task for button handling
 #define TASK_PRIO_BUTTONS        4
@@ -118,10 +216,21 @@
 // Typical measurement time is around 80 ms, we wait a bit more for safety
 #define AHT20_MEASURE_DELAY_MS   100
 
+// Read retry policy: attempts per sample, first retry spacing (doubles
+// per attempt), and the attempt from which the bus is cleared and the
+// sensor re-initialized before retrying.
+#define AHT20_MAX_ATTEMPTS              4
+#define AHT20_RETRY_BASE_MS             10
+#define AHT20_RECOVER_AFTER_ATTEMPTS    2
+
 // Display/UI
 #define TASK_PRIO_DISPLAY 3
 #define TASK_STACK_DISPLAY 4096
 
+// Minimum time between two LCD refreshes. Unchanged frames are never
+// redrawn; changed frames arriving faster than this are coalesced.
+#define DISPLAY_MIN_REFRESH_MS   250
+
 
 
 // -----------------------------------------------------------------------------
@@ -131,13 +240,82 @@
 #define WIFI_SSID           "DUPA_2_4_G"
 #define WIFI_PASS           "6045270435"
 
-// Number of reconnect attempts before giving up (for now just log)
-#define WIFI_MAX_RETRY      5
+// Reconnect backoff: the ceiling starts at BASE and doubles per failed
+// attempt up to MAX; each delay is jittered within [ceiling/2, ceiling].
+// Reconnects never stop.
+#define WIFI_BACKOFF_BASE_MS    500
+#define WIFI_BACKOFF_MAX_MS     60000
 
 // NET task
 #define TASK_PRIO_NET       4
 #define TASK_STACK_NET      4096
 
+// -----------------------------------------------------------------------------
+// Telemetry uploader
+// -----------------------------------------------------------------------------
+// Make sure the backend is running:
+//   python manage.py runserver 0.0.0.0:8000
+#define TELEMETRY_URL               "http://10.0.0.79:8000/api/telemetry/ingest/"
+#define TELEMETRY_DEVICE_ID         "esp32-thermostat-1"
+#define TELEMETRY_API_KEY           "super-secret-token"
+
+#define TELEMETRY_BATCH_MAX         20      // samples per POST (and buffer size)
+#define TELEMETRY_FLUSH_MS          30000   // send a partial batch after this long
+#define TELEMETRY_HTTP_TIMEOUT_MS   5000    // per connect / send / receive step
+#define TELEMETRY_RETRY_MS          5000    // back-off after a failed POST
+#define TELEMETRY_PREFER_PROTOBUF   1       // binary batches; JSON after a 415
+
+// Offline spool (flash partition "spool", see partitions.csv)
+#define TELEMETRY_SPOOL_PARTITION   "spool"
+#define TELEMETRY_NVS_NAMESPACE     "telemetry"   // persisted replay cursor
+#define TELEMETRY_REPLAY_BATCH      20      // spooled samples per replay POST
+#define TELEMETRY_REPLAY_INTERVAL_MS 2000   // min time between replay POSTs
+
+// One loop does at most one POST (connect + send + response, each bounded
+// by TELEMETRY_HTTP_TIMEOUT_MS) on top of its 1 s wait.
+#define TELEMETRY_WDT_DEADLINE_MS   (3 * TELEMETRY_HTTP_TIMEOUT_MS + WATCHDOG_DEADLINE_MS)
+
+#define TASK_PRIO_TELEMETRY         2
+#define TASK_STACK_TELEMETRY        6144
+
+// -----------------------------------------------------------------------------
+// MQTT (commands in, state + samples out)
+// -----------------------------------------------------------------------------
+// Topics live under MQTT_TOPIC_BASE:
+//   status       "online" / "offline" (retained, last will)
+//   state        mode/output/setpoint/hysteresis JSON (retained, QoS 1)
+//   samples      protobuf Batch, see proto/telemetry.proto (QoS 0)
+//   cmd/<name>   commands, see core/mqtt_cmd.h
+// The broker can be overridden from the build, e.g. to point a bench
+// device at a broker on the development machine:
+//   -DMQTT_BROKER_URI=\"mqtt://192.168.1.10:1883\"
+#ifndef MQTT_BROKER_URI
+#define MQTT_BROKER_URI             "mqtt://10.0.0.79:1883"
+#endif
+#define MQTT_TOPIC_BASE             "thermostat/" TELEMETRY_DEVICE_ID
+#define MQTT_KEEPALIVE_S            30
+#define MQTT_NETWORK_TIMEOUT_MS     10000   // client socket read/write timeout
+
+#define MQTT_SAMPLE_BATCH           10      // samples per publish
+#define MQTT_SAMPLE_FLUSH_MS        10000   // publish a partial batch after this long
+#define MQTT_STATE_MIN_INTERVAL_MS  200     // retained state: at most one publish per window
+
+#define TASK_PRIO_MQTT              3
+#define TASK_STACK_MQTT             4096
+
+// -----------------------------------------------------------------------------
+// Local HTTP API (/state, /config, /history, /metrics)
+// -----------------------------------------------------------------------------
+#define HTTPD_PORT                  80
+#define HTTPD_CHUNK_LEN             512     // response buffer; bodies are streamed in chunks
+#define TASK_PRIO_HTTPD             1       // below every control-path task
+#define TASK_STACK_HTTPD            6144    // server task (created by esp_http_server)
+#define TASK_STACK_HTTPD_BOOT       2048    // one-shot task that starts the server
+
+// State history served on /history (recorded by CONTROL)
+#define HISTORY_DEPTH               120     // entries kept
+#define HISTORY_INTERVAL_MS         60000   // one entry per minute -> 2 hours
+
 
 
 
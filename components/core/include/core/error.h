@@ -7,6 +7,7 @@ typedef enum {
     ERR_GENERIC = 1,
     ERR_WATCHDOG_INIT_FAILED = 2,
     ERR_QUEUE_CREATE_FAILED = 3,
+    ERR_TASK_CREATE_FAILED = 4,
     
    
     // Add more error codes as needed
@@ -0,0 +1,70 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/thermostat.h"      // thermostat_state_t
+
+/**
+ * @file history.h
+ * @brief Down-sampled ring of recent thermostat states.
+ *
+ * One writer (CONTROL) records at most one entry per interval; any
+ * number of readers (HTTP) walk the ring without locks. Entries are
+ * numbered from 1 like bus messages; a slot header of 0 means "being
+ * written", so a reader can tell whether a slot still holds the entry it
+ * asked for and never blocks the writer.
+ */
+
+typedef struct {
+    uint32_t uptime_s;         // monotime of the sample, seconds
+    int16_t  tin_cc;           // temperatures in centi-degrees C
+    int16_t  tout_cc;
+    int16_t  setpoint_cc;
+    uint8_t  mode;             // thermostat_mode_t
+    uint8_t  output;           // thermostat_output_t
+} history_entry_t;
+
+typedef struct {
+    volatile uint32_t seq;     // entry number held, 0 while being written
+    history_entry_t   entry;
+} history_slot_t;
+
+typedef struct {
+    history_slot_t    *slots;
+    uint16_t           depth;
+    uint32_t           interval_ms;
+    volatile uint32_t  head;       // number of the newest entry (0: empty)
+    uint64_t           last_us;    // timestamp of the newest entry
+} history_t;
+
+/**
+ * @param slots       Caller storage for @p depth slots
+ * @param interval_ms Minimum spacing between recorded entries
+ */
+void history_init(history_t *h, history_slot_t *slots, uint16_t depth,
+                  uint32_t interval_ms);
+
+/**
+ * @brief Offer a state; stored if @p interval_ms has passed since the
+ *        last entry. Single writer only.
+ *
+ * @return true if an entry was recorded.
+ */
+bool history_record(history_t *h, const thermostat_state_t *st);
+
+/**
+ * @brief Number of the newest entry (0 if none). Entries
+ *        head - depth + 1 .. head may still be available.
+ */
+uint32_t history_head(const history_t *h);
+
+/**
+ * @brief Copy entry number @p seq.
+ *
+ * @return false if it was never written or has been overwritten.
+ */
+bool history_read(const history_t *h, uint32_t seq, history_entry_t *out);
+
+#endif  // HISTORY_H
@@ -0,0 +1,91 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/error.h"
+
+/**
+ * @file json_writer.h
+ * @brief Streaming JSON writer over a fixed buffer.
+ *
+ * Output is built in a caller buffer and handed to a sink whenever the
+ * buffer fills (and once more at the end), so a response of any length
+ * needs only the one buffer. Commas and nesting are tracked by the
+ * writer; numbers are formatted with integer math (core/numfmt.h).
+ *
+ *   json_writer_t w;
+ *   json_writer_init(&w, buf, sizeof(buf), sink, ctx);
+ *   json_begin_object(&w);
+ *   json_kv_fixed(&w, "tin_c", 21.37f, 2);
+ *   json_end_object(&w);
+ *   err = json_writer_finish(&w);
+ *
+ * After a sink error or a nesting error every further call is a no-op and
+ * json_writer_finish() reports the failure.
+ */
+
+#define JSON_WRITER_MAX_DEPTH   8
+
+/**
+ * @brief Output callback. Returns 0 on success.
+ */
+typedef int (*json_sink_t)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+    char        *buf;
+    size_t       cap;
+    size_t       len;
+    json_sink_t  sink;
+    void        *ctx;
+    uint32_t     bytes;       // total bytes handed to the sink
+    uint8_t      depth;
+    uint8_t      has_items;   // bit d: container at depth d is non-empty
+    bool         after_key;   // next value completes a "key": pair
+    bool         error;
+} json_writer_t;
+
+void json_writer_init(json_writer_t *w, char *buf, size_t cap,
+                      json_sink_t sink, void *ctx);
+
+/**
+ * @brief Flush what is left in the buffer.
+ *
+ * @return ERR_OK, or ERR_GENERIC after a sink error or unbalanced nesting.
+ */
+app_error_t json_writer_finish(json_writer_t *w);
+
+void json_begin_object(json_writer_t *w);
+void json_end_object(json_writer_t *w);
+void json_begin_array(json_writer_t *w);
+void json_end_array(json_writer_t *w);
+
+/**
+ * @brief Object key; must be followed by exactly one value.
+ */
+void json_key(json_writer_t *w, const char *key);
+
+void json_string(json_writer_t *w, const char *s);
+void json_uint(json_writer_t *w, uint32_t v);
+void json_uint64(json_writer_t *w, uint64_t v);
+void json_int(json_writer_t *w, int32_t v);
+void json_bool(json_writer_t *w, bool v);
+void json_null(json_writer_t *w);
+
+/**
+ * @brief Fixed-point number with @p decimals (0..3) digits after the
+ *        point. Non-finite values are written as null.
+ */
+void json_fixed(json_writer_t *w, float v, uint8_t decimals);
+
+// key + value shorthands
+void json_kv_string(json_writer_t *w, const char *key, const char *s);
+void json_kv_uint(json_writer_t *w, const char *key, uint32_t v);
+void json_kv_uint64(json_writer_t *w, const char *key, uint64_t v);
+void json_kv_int(json_writer_t *w, const char *key, int32_t v);
+void json_kv_bool(json_writer_t *w, const char *key, bool v);
+void json_kv_fixed(json_writer_t *w, const char *key, float v, uint8_t decimals);
+
+#endif  // JSON_WRITER_H
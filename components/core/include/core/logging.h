@@ -14,6 +14,7 @@ typedef enum {
 } log_level_t;
 
 typedef struct {
+    uint64_t    t_us;           // monotime_now_us() when posted
     log_level_t level;
     char tag[12];
     char msg[LOG_BUFFER_LEN];
@@ -0,0 +1,103 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * @file mailbox.h
+ * @brief Latest-value mailbox (seqlock slot + direct-to-task notification).
+ *
+ * Replacement for length-1 queues used with xQueueOverwrite(). The slot
+ * holds only the newest value and a sequence number that counts
+ * publishes:
+ *   - publish: one memcpy into the slot between two sequence bumps, then
+ *     xTaskNotifyGive() to the attached consumer (if any)
+ *   - read:    lock-free; copies the slot and retries only if a publish
+ *     overlapped the copy
+ *
+ * Readers never take a lock and never consume the value, so any number
+ * of tasks may read. The writer holds a spinlock for the duration of the
+ * copy so it cannot be preempted half-way (a same-core reader would
+ * otherwise spin until the writer ran again), which also makes concurrent
+ * publishers safe.
+ *
+ * mailbox_wait() uses the calling task's notification value; a task
+ * should wait on at most one mailbox.
+ */
+
+typedef struct {
+    volatile uint32_t seq;      // even: stable, odd: write in progress
+    size_t            size;     // bytes per value
+    void             *slot;     // caller storage, @ref size bytes
+    TaskHandle_t      waiter;   // consumer woken on publish (optional)
+    volatile uint32_t waking[2];    // notifications in flight, per generation
+    volatile uint32_t wake_gen;     // bit 0: slot new notifications count in
+    portMUX_TYPE      lock;     // serializes writers only
+} mailbox_t;
+
+/**
+ * @brief Initialize a mailbox over caller-provided storage.
+ *
+ * @param mb      Mailbox to initialize
+ * @param storage Storage for one value (must outlive the mailbox)
+ * @param size    Size of one value in bytes
+ */
+void mailbox_init(mailbox_t *mb, void *storage, size_t size);
+
+/**
+ * @brief Register the task to notify on every publish.
+ *
+ * Typically called by the consumer itself with xTaskGetCurrentTaskHandle().
+ * Returns only once no publish is still about to notify the previous
+ * waiter, so attaching NULL and then deleting that task is safe. May
+ * sleep a tick; not for ISRs.
+ */
+void mailbox_attach(mailbox_t *mb, TaskHandle_t task);
+
+/**
+ * @brief Wake the attached consumer (if any) without publishing.
+ */
+void mailbox_notify(mailbox_t *mb);
+
+/**
+ * @brief Store a new value and wake the attached consumer.
+ *
+ * @return Sequence number of the published value (1 for the first one).
+ */
+uint32_t mailbox_publish(mailbox_t *mb, const void *value);
+
+/**
+ * @brief Sequence number of the newest value (0 if none published yet).
+ */
+uint32_t mailbox_seq(const mailbox_t *mb);
+
+/**
+ * @brief Copy the newest value.
+ *
+ * @param[out] out     Destination, mb->size bytes
+ * @param[out] out_seq Optional: sequence number of the copied value
+ * @return false if nothing has been published yet.
+ */
+bool mailbox_read(const mailbox_t *mb, void *out, uint32_t *out_seq);
+
+/**
+ * @brief Wait for a value newer than @p io_seq and copy it.
+ *
+ * Returns immediately if a newer value is already present. The caller
+ * must be the attached task to be woken; otherwise this degrades to a
+ * timeout-only wait.
+ *
+ * @param[out]   out     Destination, mb->size bytes
+ * @param[inout] io_seq  Last sequence seen; updated on success
+ * @param        timeout Ticks to wait (portMAX_DELAY for forever)
+ * @return true if a newer value was copied, false on timeout.
+ */
+bool mailbox_wait(const mailbox_t *mb, void *out, uint32_t *io_seq,
+                  TickType_t timeout);
+
+#endif  // MAILBOX_H
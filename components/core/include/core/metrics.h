@@ -0,0 +1,131 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/error.h"
+
+/**
+ * @file metrics.h
+ * @brief Statically registered counters, gauges and histograms.
+ *
+ * Every metric is declared once in metric_id_t and described in the
+ * table in metrics.c (name, help text, type, histogram bucket bounds).
+ *
+ * Hot path: counters and histograms live in one row of cells per CPU
+ * core. An update is a single relaxed atomic add on the calling core's
+ * row, so there are no locks and the two cores never write the same
+ * cache line. Readers sum the rows. Gauges are one atomic value each.
+ * All update functions are safe from ISRs.
+ *
+ * Counters and histogram sums are uint32 and wrap; Prometheus treats a
+ * decrease as a counter reset.
+ */
+
+typedef enum {
+    METRIC_TYPE_COUNTER = 0,
+    METRIC_TYPE_GAUGE,
+    METRIC_TYPE_HISTOGRAM
+} metric_type_t;
+
+typedef enum {
+    // CONTROL
+    METRIC_CONTROL_CYCLES = 0,     // counter: control decisions
+    METRIC_CONTROL_LOOP_US,        // histogram: decision + publish + relay time
+    METRIC_RELAY_SWITCHES,         // counter: relay output changes
+
+    // SENSORS
+    METRIC_SENSOR_SAMPLES,         // counter: samples published
+    METRIC_SENSOR_FAILURES,        // counter: reads failed after all retries
+    METRIC_SENSOR_READ_MS,         // histogram: drv_temp_read() duration
+    METRIC_SENSOR_PERIOD_MS,       // gauge: current sampling period
+
+    // AHT20 / I2C
+    METRIC_I2C_ERRORS,             // counter: failed transfer attempts
+    METRIC_I2C_RETRIES,            // counter
+    METRIC_I2C_RECOVERIES,         // counter: bus clear + re-init
+
+    // Logging
+    METRIC_LOG_POSTED,             // counter
+    METRIC_LOG_DROPPED,            // counter: log queue full
+    METRIC_LOG_QUEUE_DEPTH,        // gauge: records waiting after the last post
+
+    // NET
+    METRIC_WIFI_CONNECTED,         // gauge: 1 while the station has an IP
+    METRIC_WIFI_DISCONNECTS,       // counter
+
+    METRIC_COUNT
+} metric_id_t;
+
+// Upper bucket bounds per histogram (the +Inf bucket is implicit).
+#define METRICS_HIST_MAX_BOUNDS   10
+
+typedef struct {
+    uint8_t  nbounds;
+    uint32_t bounds[METRICS_HIST_MAX_BOUNDS];
+    uint32_t buckets[METRICS_HIST_MAX_BOUNDS + 1];  // per bucket, not cumulative
+    uint32_t count;
+    uint32_t sum;
+} metrics_hist_t;
+
+/**
+ * @brief Output callback for the text export. Returns 0 on success.
+ */
+typedef int (*metrics_sink_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * @brief Lay out the cell rows. Call once, before the tasks start;
+ *        updates made earlier are ignored.
+ */
+app_error_t metrics_init(void);
+
+/* ---------------- Updates (hot path) ---------------- */
+
+void metrics_add(metric_id_t id, uint32_t n);
+
+static inline void metrics_inc(metric_id_t id)
+{
+    metrics_add(id, 1u);
+}
+
+void metrics_gauge_set(metric_id_t id, int32_t value);
+
+void metrics_observe(metric_id_t id, uint32_t value);
+
+/* ---------------- Reads ---------------- */
+
+metric_type_t metrics_type(metric_id_t id);
+const char   *metrics_name(metric_id_t id);
+
+uint32_t metrics_counter(metric_id_t id);
+int32_t  metrics_gauge(metric_id_t id);
+void     metrics_histogram(metric_id_t id, metrics_hist_t *out);
+
+/* ---------------- Export ---------------- */
+
+/**
+ * @brief Write all metrics in the Prometheus text format (0.0.4).
+ *
+ * Output is staged in @p buf and handed to @p sink whenever it fills.
+ */
+app_error_t metrics_export_prometheus(char *buf, size_t cap,
+                                      metrics_sink_t sink, void *ctx);
+
+/**
+ * @brief Write all metrics in a compact binary form.
+ *
+ *   "MT" | version u8 (1) | metric count varint
+ *   per metric: id varint | type u8 | value
+ *     counter   varint
+ *     gauge     zigzag varint
+ *     histogram nbounds varint | bounds varint... |
+ *               buckets varint (nbounds + 1, not cumulative) | sum varint
+ *
+ * Varints are unsigned LEB128 (protobuf style).
+ *
+ * @return Bytes written, or 0 if @p cap is too small.
+ */
+size_t metrics_export_binary(uint8_t *buf, size_t cap);
+
+#endif  // METRICS_H
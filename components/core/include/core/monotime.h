@@ -0,0 +1,39 @@
+#ifndef MONOTIME_H
+#define MONOTIME_H
+
+#include <stdint.h>
+
+/**
+ * @file monotime.h
+ * @brief The one monotonic time base: microseconds since boot, 64-bit.
+ *
+ * Used for every timestamp that crosses a module boundary (samples,
+ * thermostat state, history, log records, telemetry age). Unlike
+ * xTaskGetTickCount() * portTICK_PERIOD_MS it has microsecond resolution,
+ * so stage-to-stage latencies are measurable, and it does not wrap
+ * (uint32 ms wraps after 49.7 days; this after ~584 000 years), so plain
+ * subtraction is always valid.
+ *
+ * Backed by esp_timer on target and CLOCK_MONOTONIC on the host.
+ * Safe from any task or ISR.
+ */
+
+typedef uint64_t mono_us_t;
+
+mono_us_t monotime_now_us(void);
+
+static inline uint64_t monotime_now_ms(void)
+{
+    return monotime_now_us() / 1000u;
+}
+
+/**
+ * @brief Microseconds elapsed since @p since (0 if @p since is later).
+ */
+static inline uint64_t monotime_since_us(mono_us_t since)
+{
+    const mono_us_t now = monotime_now_us();
+    return (now > since) ? now - since : 0u;
+}
+
+#endif  // MONOTIME_H
@@ -0,0 +1,51 @@
+#ifndef MQTT_CMD_H
+#define MQTT_CMD_H
+
+#include <stddef.h>
+
+#include "core/error.h"
+#include "core/thermostat.h"      // thermostat_mode_t
+
+/**
+ * @file mqtt_cmd.h
+ * @brief Remote command parsing (MQTT topic + payload -> command).
+ *
+ * Commands arrive on "<base>/cmd/<name>" with a plain-text payload:
+ *
+ *   cmd/mode        "off" | "heat" | "cool" | "auto"
+ *   cmd/setpoint    absolute setpoint in C, e.g. "21.5"
+ *   cmd/hysteresis  hysteresis in C, e.g. "0.5"
+ *
+ * Parsing is pure (no RTOS, no I/O) so it can be exercised on the host.
+ * Neither the topic nor the payload needs to be NUL-terminated.
+ */
+
+typedef enum {
+    MQTT_CMD_MODE = 0,
+    MQTT_CMD_SETPOINT,
+    MQTT_CMD_HYSTERESIS
+} mqtt_cmd_type_t;
+
+typedef struct {
+    mqtt_cmd_type_t type;
+    union {
+        thermostat_mode_t mode;
+        float             value_c;
+    };
+} mqtt_cmd_t;
+
+/**
+ * @brief Parse one command.
+ *
+ * @param name        Topic part after "<base>/cmd/"
+ * @param name_len    Its length
+ * @param payload     Message payload
+ * @param payload_len Its length
+ * @param[out] out    Parsed command
+ * @return ERR_OK, or ERR_GENERIC for an unknown command or bad value.
+ */
+app_error_t mqtt_cmd_parse(const char *name, size_t name_len,
+                           const char *payload, size_t payload_len,
+                           mqtt_cmd_t *out);
+
+#endif  // MQTT_CMD_H
@@ -0,0 +1,147 @@
+#ifndef MSGBUS_H
+#define MSGBUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * @file msgbus.h
+ * @brief In-process publish/subscribe bus with per-subscriber cursors.
+ *
+ * Each topic owns a ring of fixed-size message slots. A publish writes
+ * into the next slot once (or in place via claim/commit) and wakes the
+ * subscribed tasks; it never copies per subscriber. Subscribers keep
+ * their own cursor and read messages in place:
+ *
+ *   const thermostat_state_t *st;
+ *   if (msgbus_peek(&sub, (const void **)&st, timeout)) {
+ *       ... use *st ...
+ *       if (!msgbus_release(&sub)) { discard: slot was overwritten }
+ *   }
+ *
+ * A slow subscriber never blocks the producer. If it falls more than
+ * one ring behind, the oldest messages are skipped and counted as drops.
+ * release() tells the reader whether the slot was recycled while it
+ * was being read.
+ *
+ * Each topic has a single producer. Subscribers wait on their task
+ * notification value, so a task can follow several topics or mailboxes
+ * as long as it rechecks all of them after each wake-up.
+ */
+
+typedef enum {
+    MSGBUS_TOPIC_SENSOR_SAMPLE = 0,  // sensor_sample_t      (SENSORS)
+    MSGBUS_TOPIC_THERMOSTAT_STATE,   // thermostat_state_t   (CONTROL)
+    MSGBUS_TOPIC_CONFIG,             // thermostat_config_t  (config notifier)
+    MSGBUS_TOPIC_BUTTON,             // button_event_t       (BUTTONS)
+    MSGBUS_TOPIC_COUNT
+} msgbus_topic_t;
+
+// Ring storage for a topic: 8-byte slot header (sequence) + message,
+// rounded up to keep every slot 8-byte aligned.
+#define MSGBUS_SLOT_HDR   8u
+#define MSGBUS_SLOT_STRIDE(msg_size) \
+    ((((size_t)(msg_size) + MSGBUS_SLOT_HDR) + 7u) & ~(size_t)7u)
+#define MSGBUS_RING_BYTES(msg_size, depth) \
+    ((size_t)(depth) * MSGBUS_SLOT_STRIDE(msg_size))
+
+/**
+ * @brief Subscriber state. Owned by the subscribing task.
+ */
+typedef struct msgbus_sub {
+    const char        *name;
+    msgbus_topic_t     topic;
+    TaskHandle_t       task;       // woken on publish
+    uint32_t           next;       // sequence number of the next message to read
+    uint32_t           delivered;  // messages released intact
+    uint32_t           dropped;    // skipped (ring overrun) or torn on release
+    uint32_t           max_lag;    // worst backlog seen at peek time
+    struct msgbus_sub *link;       // topic subscriber list
+} msgbus_sub_t;
+
+typedef struct {
+    uint32_t published;    // messages published on the topic
+    uint32_t subscribers;
+} msgbus_topic_stats_t;
+
+typedef struct {
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t lag;          // messages currently waiting
+    uint32_t max_lag;
+} msgbus_sub_stats_t;
+
+/**
+ * @brief Set up a topic ring over caller storage.
+ *
+ * @param topic    Topic id
+ * @param storage  MSGBUS_RING_BYTES(msg_size, depth) bytes, 8-byte aligned
+ * @param msg_size Size of one message
+ * @param depth    Number of slots (messages a subscriber may lag behind)
+ */
+void msgbus_topic_init(msgbus_topic_t topic, void *storage,
+                       size_t msg_size, uint16_t depth);
+
+/**
+ * @brief Copy one message into the topic and wake subscribers.
+ *
+ * @return Sequence number of the message (0 if the topic is not set up).
+ */
+uint32_t msgbus_publish(msgbus_topic_t topic, const void *msg);
+
+/**
+ * @brief Zero-copy publish: get the next slot to fill in place.
+ *
+ * Must be followed by msgbus_commit() from the same task.
+ * @return Slot pointer, or NULL if the topic is not set up.
+ */
+void *msgbus_claim(msgbus_topic_t topic);
+
+/**
+ * @brief Make the claimed slot visible and wake subscribers.
+ */
+uint32_t msgbus_commit(msgbus_topic_t topic);
+
+/**
+ * @brief Copy the newest message on a topic without subscribing.
+ *
+ * @return false if nothing has been published yet.
+ */
+bool msgbus_read_latest(msgbus_topic_t topic, void *out, uint32_t *out_seq);
+
+/**
+ * @brief Subscribe the calling task to a topic.
+ *
+ * @param sub           Caller-owned subscriber state (must stay valid)
+ * @param topic         Topic to follow
+ * @param name          Name for diagnostics
+ * @param replay_latest Start at the newest existing message instead of
+ *                      the next one (useful for state topics)
+ */
+void msgbus_subscribe(msgbus_sub_t *sub, msgbus_topic_t topic,
+                      const char *name, bool replay_latest);
+
+/**
+ * @brief Get the next message in place, waiting up to @p timeout.
+ *
+ * @param[out] out_msg Pointer into the ring; valid until msgbus_release()
+ * @return false on timeout.
+ */
+bool msgbus_peek(msgbus_sub_t *sub, const void **out_msg, TickType_t timeout);
+
+/**
+ * @brief Finish with the message returned by msgbus_peek().
+ *
+ * @return true if the message was intact for the whole read; false if the
+ *         producer recycled the slot meanwhile (the data must be discarded).
+ */
+bool msgbus_release(msgbus_sub_t *sub);
+
+void msgbus_get_topic_stats(msgbus_topic_t topic, msgbus_topic_stats_t *out);
+void msgbus_get_sub_stats(const msgbus_sub_t *sub, msgbus_sub_stats_t *out);
+
+#endif  // MSGBUS_H
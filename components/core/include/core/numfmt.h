@@ -0,0 +1,62 @@
+#ifndef NUMFMT_H
+#define NUMFMT_H
+
+#include <stdint.h>
+
+/**
+ * @file numfmt.h
+ * @brief Small integer-only number formatting helpers.
+ *
+ * Cheap replacements for snprintf("%d") / snprintf("%.1f") in hot paths
+ * (display frames, telemetry). No floating point printf, no locale, no
+ * heap. Each function writes at @p p, never past @p end, does NOT
+ * NUL-terminate, and returns the new write position.
+ */
+
+/**
+ * @brief Write an unsigned decimal, right-aligned in at least @p width
+ *        characters (padded with spaces).
+ */
+char *numfmt_u32(char *p, char *end, uint32_t value, int width);
+
+/**
+ * @brief 64-bit variant of numfmt_u32().
+ */
+char *numfmt_u64(char *p, char *end, uint64_t value, int width);
+
+/**
+ * @brief Write a signed decimal, right-aligned in at least @p width chars.
+ */
+char *numfmt_i32(char *p, char *end, int32_t value, int width);
+
+/**
+ * @brief Return |@p value| * @p scale rounded to an integer the way
+ *        printf rounds: to nearest, ties to even, on the exact binary
+ *        value (22.5 -> 22, 23.5 -> 24, 0.25 * 10 -> 2).
+ *
+ * Integer-only. Saturates at UINT32_MAX (and for +/-Inf); NaN gives 0.
+ */
+uint32_t numfmt_round_scaled(float value, uint32_t scale);
+
+/**
+ * @brief Return @p value in hundredths (centi-degrees), rounded like
+ *        numfmt_round_scaled() and saturated to the int16_t range.
+ *
+ * NaN and values below the range give INT16_MIN, so a failed sensor
+ * reading stays recognisable and never reaches a float-to-int cast.
+ */
+int16_t numfmt_centi(float value);
+
+/**
+ * @brief Write @p value rounded to one decimal ("21.5", "-3.0"),
+ *        right-aligned in at least @p width characters. Rounds like
+ *        "%.1f" (see numfmt_round_scaled()).
+ */
+char *numfmt_fixed1(char *p, char *end, float value, int width);
+
+/**
+ * @brief Copy a NUL-terminated string (truncated at @p end).
+ */
+char *numfmt_str(char *p, char *end, const char *s);
+
+#endif  // NUMFMT_H
@@ -0,0 +1,128 @@
+#ifndef RTOS_ALLOC_H
+#define RTOS_ALLOC_H
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+
+#include "core/config.h"
+#include "core/error.h"
+
+/**
+ * @file rtos_alloc.h
+ * @brief Where the application's tasks, queues, mutexes and timers live.
+ *
+ * Every kernel object the application creates is declared next to its
+ * owner with one of the RTOS_*_MEM() macros and created through the
+ * matching rtos_*_create() call:
+ *
+ *   APP_STATIC_ALLOC=0  storage descriptors are empty and the objects
+ *                       come from the heap (xTaskCreate, xQueueCreate...)
+ *   APP_STATIC_ALLOC=1  the macros also reserve the stack / TCB / queue
+ *                       buffers as zero-initialized statics and the
+ *                       ...Static() APIs are used: no heap at boot, and
+ *                       the link map lists each subsystem's RAM as
+ *                       <name>_stack / _tcb / _buf symbols in .bss.
+ *
+ * Objects created by ESP-IDF itself (Wi-Fi, lwIP, esp_timer, httpd and
+ * MQTT client tasks) still come from the heap in both modes.
+ *
+ * A statically allocated task deleted while running on the other core
+ * is reaped by that core's idle task; its storage must not be handed to
+ * rtos_task_create() again before then (see the watchdog restart path).
+ */
+
+typedef struct {
+    StackType_t  *stack;
+    StaticTask_t *tcb;
+    uint32_t      stack_size;       // bytes, as xTaskCreate takes it
+} rtos_task_mem_t;
+
+typedef struct {
+    uint8_t       *buf;
+    StaticQueue_t *queue;
+    uint32_t       length;
+    uint32_t       item_size;
+} rtos_queue_mem_t;
+
+typedef struct {
+    StaticSemaphore_t *sem;
+} rtos_mutex_mem_t;
+
+typedef struct {
+    StaticTimer_t *timer;
+} rtos_timer_mem_t;
+
+#if APP_STATIC_ALLOC
+
+#define RTOS_TASK_MEM(name, stack_bytes)                                        \
+    static StackType_t     name##_stack[(stack_bytes) / sizeof(StackType_t)]   \
+        __attribute__((aligned(16)));                                           \
+    static StaticTask_t    name##_tcb;                                          \
+    static rtos_task_mem_t name = { name##_stack, &name##_tcb, (stack_bytes) }
+
+#define RTOS_QUEUE_MEM(name, len, item_size)                                    \
+    static uint8_t          name##_buf[(len) * (item_size)]                     \
+        __attribute__((aligned(4)));                                            \
+    static StaticQueue_t    name##_queue;                                       \
+    static rtos_queue_mem_t name = { name##_buf, &name##_queue, (len), (item_size) }
+
+#define RTOS_MUTEX_MEM(name)                                                    \
+    static StaticSemaphore_t name##_sem;                                        \
+    static rtos_mutex_mem_t  name = { &name##_sem }
+
+#define RTOS_TIMER_MEM(name)                                                    \
+    static StaticTimer_t    name##_timer;                                       \
+    static rtos_timer_mem_t name = { &name##_timer }
+
+#else  // !APP_STATIC_ALLOC
+
+#define RTOS_TASK_MEM(name, stack_bytes)                                        \
+    static rtos_task_mem_t name = { NULL, NULL, (stack_bytes) }
+
+#define RTOS_QUEUE_MEM(name, len, item_size)                                    \
+    static rtos_queue_mem_t name = { NULL, NULL, (len), (item_size) }
+
+#define RTOS_MUTEX_MEM(name)                                                    \
+    static rtos_mutex_mem_t name = { NULL }
+
+#define RTOS_TIMER_MEM(name)                                                    \
+    static rtos_timer_mem_t name = { NULL }
+
+#endif  // APP_STATIC_ALLOC
+
+/**
+ * @brief Create a task in @p mem's storage and log a failure.
+ *
+ * @param core  Core to pin the task to, or tskNO_AFFINITY.
+ * @param out   Receives the handle (NULL on failure); may be NULL.
+ * @return ERR_OK, or ERR_TASK_CREATE_FAILED.
+ */
+app_error_t rtos_task_create(TaskFunction_t fn, const char *name, void *arg,
+                             UBaseType_t prio, BaseType_t core,
+                             rtos_task_mem_t *mem, TaskHandle_t *out);
+
+/**
+ * @brief Create a queue of mem->length items of mem->item_size bytes.
+ *
+ * @return The queue, or NULL (logged).
+ */
+QueueHandle_t rtos_queue_create(rtos_queue_mem_t *mem);
+
+/**
+ * @brief Create a (non-recursive) mutex. @return NULL on failure (logged).
+ */
+SemaphoreHandle_t rtos_mutex_create(rtos_mutex_mem_t *mem);
+
+/**
+ * @brief Create a software timer. @return NULL on failure (logged).
+ */
+TimerHandle_t rtos_timer_create(rtos_timer_mem_t *mem, const char *name,
+                                TickType_t period, UBaseType_t auto_reload,
+                                void *id, TimerCallbackFunction_t cb);
+
+#endif  // RTOS_ALLOC_H
@@ -0,0 +1,59 @@
+#ifndef SAMPLE_SCHEDULER_H
+#define SAMPLE_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/app_types.h"     // sensor_sample_t
+
+/**
+ * @file sample_scheduler.h
+ * @brief Adaptive sensor sampling period selection.
+ *
+ * Picks the next sensor sampling interval from how close the indoor
+ * temperature is to a switching threshold (sp - hyst / sp + hyst) and
+ * how fast it is moving towards it:
+ *   - far from both thresholds and steady  -> slow down (max period)
+ *   - near a threshold or moving quickly   -> speed up (min period)
+ *
+ * Pure logic with no RTOS dependencies, so it can be driven from a host
+ * simulation as well as from the SENSORS task.
+ */
+
+typedef struct {
+    uint32_t min_period_ms;    // fastest allowed sampling interval
+    uint32_t max_period_ms;    // slowest allowed sampling interval
+    uint32_t period_ms;        // last chosen interval
+
+    float    slope_c_per_s;    // smoothed dTin/dt
+    float    prev_tin_c;       // previous sample (for slope)
+    uint64_t prev_ts_us;
+    bool     have_prev;
+} sample_scheduler_t;
+
+/**
+ * @brief Initialize scheduler state.
+ *
+ * The first period returned before any sample is seen is @p min_ms so
+ * the system starts responsive and backs off once it knows the trend.
+ */
+void sample_scheduler_init(sample_scheduler_t *s,
+                           uint32_t min_ms,
+                           uint32_t max_ms);
+
+/**
+ * @brief Feed a new sample and compute the next sampling interval.
+ *
+ * @param s             Scheduler state.
+ * @param sample        Latest sensor sample (Tin + timestamp are used).
+ * @param setpoint_c    Current setpoint.
+ * @param hysteresis_c  Current hysteresis (band half-width).
+ *
+ * @return Next interval in milliseconds, within [min_ms, max_ms].
+ */
+uint32_t sample_scheduler_next_period(sample_scheduler_t    *s,
+                                      const sensor_sample_t *sample,
+                                      float                  setpoint_c,
+                                      float                  hysteresis_c);
+
+#endif  // SAMPLE_SCHEDULER_H
@@ -0,0 +1,118 @@
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/error.h"
+
+/**
+ * @file spool.h
+ * @brief Append-only record log on a circular flash region.
+ *
+ * Store-and-forward buffer for telemetry. Records are framed as
+ *
+ *   | magic u16 | len u16 | seq u32 | crc32 u32 | payload (padded to 4) |
+ *
+ * and appended sector by sector; a record never straddles a sector.
+ * When the log wraps, the oldest sector is erased and any records in it
+ * that were never acknowledged are counted as lost.
+ *
+ * Sequence numbers increase across reboots. The owner persists the last
+ * acknowledged sequence number (e.g. in NVS) and passes it back to
+ * spool_open(), which rebuilds the write and replay positions by
+ * scanning the region. A record torn by power loss fails its CRC and is
+ * skipped; appends resume at the next sector. Replay is at-least-once:
+ * records sent but not yet acknowledged are sent again after a reset.
+ *
+ * Storage access goes through spool_flash_t so the same code runs on a
+ * flash partition or on a file-backed stand-in.
+ */
+
+#define SPOOL_MAX_PAYLOAD   64
+
+/**
+ * @brief Storage callbacks. All return 0 on success.
+ */
+typedef struct {
+    void   *ctx;
+    size_t  size;           // region size, multiple of sector_size
+    size_t  sector_size;    // erase unit
+    int (*read)(void *ctx, size_t off, void *buf, size_t len);
+    int (*write)(void *ctx, size_t off, const void *buf, size_t len);
+    int (*erase_sector)(void *ctx, size_t off);
+} spool_flash_t;
+
+typedef struct {
+    uint32_t appended;      // records written
+    uint32_t replayed;      // records acknowledged
+    uint32_t lost;          // unacknowledged records erased by wrap-around
+    uint32_t crc_errors;    // torn / corrupt records skipped
+    uint32_t io_errors;
+} spool_stats_t;
+
+typedef struct {
+    const spool_flash_t *flash;
+    size_t   write_off;     // next append position
+    size_t   read_off;      // oldest unacknowledged record (if any pending)
+    uint32_t read_seq;      // its sequence number (== next_seq when none)
+    uint32_t next_seq;      // sequence number of the next append
+    uint32_t ack_seq;       // last acknowledged sequence number
+    spool_stats_t stats;
+} spool_t;
+
+/**
+ * @brief Replay cursor returned by spool_read_next().
+ */
+typedef struct {
+    size_t   off;           // position after the last record read
+    uint32_t last_seq;      // sequence number of the last record read
+} spool_iter_t;
+
+/**
+ * @brief Scan the region and rebuild the log state.
+ *
+ * @param ack_seq Last acknowledged sequence number (0 if none)
+ */
+app_error_t spool_open(spool_t *sp, const spool_flash_t *flash, uint32_t ack_seq);
+
+/**
+ * @brief Append one record.
+ *
+ * @param len Payload length, at most SPOOL_MAX_PAYLOAD
+ */
+app_error_t spool_append(spool_t *sp, const void *payload, size_t len);
+
+/**
+ * @brief Number of records not yet acknowledged.
+ */
+uint32_t spool_pending(const spool_t *sp);
+
+/**
+ * @brief Start a replay pass at the oldest unacknowledged record.
+ */
+void spool_iter_begin(const spool_t *sp, spool_iter_t *it);
+
+/**
+ * @brief Read the next record of a replay pass.
+ *
+ * @param[out] buf     Payload destination (SPOOL_MAX_PAYLOAD bytes)
+ * @param[out] out_len Payload length
+ * @return false when there are no more records.
+ */
+bool spool_read_next(spool_t *sp, spool_iter_t *it, void *buf, size_t *out_len);
+
+/**
+ * @brief Mark everything up to the iterator as delivered.
+ *
+ * The caller should persist spool_ack_seq() afterwards.
+ */
+void spool_ack(spool_t *sp, const spool_iter_t *it);
+
+static inline uint32_t spool_ack_seq(const spool_t *sp)
+{
+    return sp->ack_seq;
+}
+
+#endif  // SPOOL_H
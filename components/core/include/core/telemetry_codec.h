@@ -0,0 +1,84 @@
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "core/thermostat.h"      // thermostat_state_t
+
+/**
+ * @file telemetry_codec.h
+ * @brief Telemetry batch encoders (protobuf wire format and JSON).
+ *
+ * Both encoders write into a caller buffer and never allocate. The
+ * binary format is described by proto/telemetry.proto: a base timestamp
+ * and base values, then per-sample deltas as zigzag varints.
+ */
+
+#define TELEMETRY_CONTENT_TYPE_PB    "application/x-protobuf"
+#define TELEMETRY_CONTENT_TYPE_JSON  "application/json"
+
+// telemetry_record_t.flags
+#define TELEMETRY_REC_UPTIME   0x01u   // epoch_s is uptime seconds of boot_id
+
+/**
+ * @brief One sample as uploaded and as stored in the flash spool.
+ *
+ * Samples spooled before the clock was set carry TELEMETRY_REC_UPTIME:
+ * epoch_s then counts from the start of boot @ref boot_id and is turned
+ * into wall-clock time before upload, once that boot's start time is known.
+ */
+typedef struct {
+    uint32_t epoch_s;          // wall-clock time of the sample
+    uint8_t  mode;             // thermostat_mode_t
+    uint8_t  output;           // thermostat_output_t
+    uint8_t  flags;            // TELEMETRY_REC_*
+    uint8_t  boot_id;          // boot counter (low 8 bits) at spool time
+    float    setpoint_c;
+    float    hysteresis_c;
+    float    tin_c;
+    float    tout_c;
+} telemetry_record_t;
+
+/**
+ * @brief Convert a state snapshot to a record.
+ *
+ * State timestamps are monotime (uptime) based; they are back-dated from the
+ * current wall clock so samples taken before SNTP sync still get a
+ * correct time.
+ *
+ * @param now_epoch Current wall-clock time
+ * @param now_us    monotime_now_us() (same clock as st->timestamp_us)
+ */
+void telemetry_record_from_state(const thermostat_state_t *st, time_t now_epoch,
+                                 uint64_t now_us, telemetry_record_t *rec);
+
+/**
+ * @brief Encode a batch as a protobuf `Batch` message.
+ *
+ * @return Bytes written, or 0 if @p cap is too small.
+ */
+size_t telemetry_encode_pb(const char *device_id,
+                           const telemetry_record_t *recs, size_t n,
+                           uint8_t *buf, size_t cap);
+
+/**
+ * @brief Encode a batch as JSON ({device_id, samples:[...]}).
+ *
+ * @return Bytes written (excluding the NUL), or 0 if @p cap is too small.
+ */
+size_t telemetry_encode_json(const char *device_id,
+                             const telemetry_record_t *recs, size_t n,
+                             char *buf, size_t cap);
+
+/**
+ * @brief Encode the control state (mode, output, setpoint, hysteresis)
+ *        as a small JSON object.
+ *
+ * @return Bytes written (excluding the NUL), or 0 if @p cap is too small.
+ */
+size_t telemetry_encode_state_json(const thermostat_state_t *st,
+                                   char *buf, size_t cap);
+
+#endif  // TELEMETRY_CODEC_H
@@ -55,7 +55,7 @@ typedef struct {
     float tin_c;                       // indoor temp from last sample
     float tout_c;                      // outdoor temp (if available)
 
-    uint32_t timestamp_ms;             // timestamp of last sample
+    uint64_t timestamp_us;             // monotime of last sample
 } thermostat_state_t;
 
 /**
@@ -94,6 +94,11 @@ app_error_t thermostat_core_process_sample(
  *  - MQTT command handler
  *  - UI task
  *
+ * A single atomic store: the decision in progress (if any) finishes with
+ * the mode it started with, and the next one uses the new mode; call
+ * task_control_kick() to make that happen now. Never reverted by a
+ * concurrent decision.
+ *
  * @param mode New mode to apply.
  * @return ERR_OK on success, ERR_GENERIC if core not initialized or mode invalid.
  */
@@ -112,4 +117,10 @@ app_error_t thermostat_get_mode(thermostat_mode_t *out_mode);
  */
 app_error_t thermostat_get_state(thermostat_state_t *out_state);
 
+/**
+ * @brief Names used in logs, telemetry and the local API ("HEAT", "HEAT_ON", ...).
+ */
+const char *thermostat_mode_to_str(thermostat_mode_t mode);
+const char *thermostat_output_to_str(thermostat_output_t output);
+
 #endif  // THERMOSTAT_H
@@ -4,6 +4,8 @@
 #include "core/app_types.h"   // if you want app_error_t here
 #include "core/error.h"
 
+#include <stdbool.h>
+
 /**
  * @brief Structure holding thermostat control configuration.
  *
@@ -49,4 +51,54 @@ app_error_t thermostat_config_get(thermostat_config_t *out_cfg);
  */
 app_error_t thermostat_config_set(const thermostat_config_t *new_cfg);
 
+/**
+ * @brief Mutation applied inside a config transaction.
+ *
+ * Called with the config mutex held; must not block or call back into
+ * thermostat_config_*.
+ */
+typedef void (*thermostat_config_mutator_t)(thermostat_config_t *cfg, void *ctx);
+
+/**
+ * @brief Change notification, called once per coalescing window.
+ *
+ * Runs in the FreeRTOS timer service task: must not block, and must fit
+ * its stack (CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH).
+ */
+typedef void (*thermostat_config_listener_t)(const thermostat_config_t *cfg, void *ctx);
+
+/**
+ * @brief Atomically read-modify-write the configuration.
+ *
+ * Runs @p fn on the current config, clamps the result to
+ * THERMOSTAT_SP_MIN_C..THERMOSTAT_SP_MAX_C and
+ * THERMOSTAT_HYST_MIN_C..THERMOSTAT_HYST_MAX_C and publishes it, all in
+ * one mutex section. A result with a non-finite setpoint or hysteresis
+ * is rejected and the current config is left unchanged. The change
+ * notification (log + listener) is deferred by
+ * THERMOSTAT_CONFIG_COALESCE_MS so a burst of updates (auto-repeat,
+ * remote commands) produces a single notification with the final value.
+ *
+ * @param[in]  fn      Mutation to apply.
+ * @param[in]  ctx     Opaque pointer passed to @p fn.
+ * @param[out] out_cfg Optional: receives the published config.
+ * @return ERR_OK on success, ERR_GENERIC on bad args / not initialized /
+ *         non-finite values.
+ */
+app_error_t thermostat_config_update(thermostat_config_mutator_t fn, void *ctx,
+                                     thermostat_config_t *out_cfg);
+
+/**
+ * @brief True if @p task (a TaskHandle_t) holds the config mutex.
+ *
+ * For the watchdog's detach hooks: every reader waits on that mutex
+ * forever, so a task deleted while holding it would wedge them all.
+ */
+bool thermostat_config_held_by(void *task);
+
+/**
+ * @brief Register the (single) change listener. Pass NULL to remove it.
+ */
+void thermostat_config_set_listener(thermostat_config_listener_t fn, void *ctx);
+
 #endif  // THERMOSTAT_CONFIG_H
@@ -0,0 +1,45 @@
+#ifndef TIMEFMT_H
+#define TIMEFMT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @file timefmt.h
+ * @brief Calendar math and cached ISO 8601 formatting of epoch times.
+ *
+ * The formatting half of timeutil, kept apart from SNTP so it builds and
+ * can be checked against libc on the host. Local time follows the TZ
+ * environment variable; call timefmt_tz_changed() after tzset().
+ */
+
+/**
+ * @brief Days since 1970-01-01 to a proleptic Gregorian date (UTC).
+ */
+void timefmt_civil_from_days(int64_t days, int32_t *y, uint32_t *m, uint32_t *d);
+
+/**
+ * @brief Proleptic Gregorian date to days since 1970-01-01.
+ */
+int64_t timefmt_days_from_civil(int32_t y, uint32_t m, uint32_t d);
+
+/**
+ * @brief Drop the cached UTC offset (the TZ rules changed).
+ */
+void timefmt_tz_changed(void);
+
+/**
+ * @brief Format @p t as local "YYYY-MM-DDTHH:MM:SS+hhmm" (strftime
+ *        "%Y-%m-%dT%H:%M:%S%z").
+ *
+ * Integer calendar math; the TZ rules are evaluated only when @p t
+ * leaves the cached DST period, and the string is cached per second (a
+ * new second in the same minute rewrites two digits).
+ *
+ * @param buf_len Must be >= 32
+ */
+bool timefmt_iso8601(time_t t, char *buf, size_t buf_len);
+
+#endif  // TIMEFMT_H
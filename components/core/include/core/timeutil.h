@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <time.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,11 +15,25 @@ void timeutil_init_sntp(void);
 // Returns true once SNTP has set the clock
 bool timeutil_is_time_set(void);
 
+// Block until SNTP has set the clock or timeout_ms passes (UINT32_MAX =
+// forever). Returns timeutil_is_time_set().
+bool timeutil_wait_time_set(uint32_t timeout_ms);
+
+// UTC now, derived from the monotime clock plus the offset
+// captured at the last SNTP sync (no syscall, immune to later settimeofday
+// steps between syncs). 0 until the first sync.
+int64_t timeutil_now_us(void);
+time_t  timeutil_now(void);
+
 // Write current local time into buf as ISO8601 format
-// Example: "2025-11-20T06:32:47-08:00"
+// Example: "2025-11-20T06:32:47-0800"
 // buf_len must be >= 32
 bool timeutil_get_iso8601(char *buf, size_t buf_len);
 
+// Same format for an arbitrary epoch time (e.g. a back-dated sample).
+// See timefmt_iso8601() (core/timefmt.h).
+bool timeutil_format_iso8601(time_t t, char *buf, size_t buf_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,15 +1,119 @@
 #ifndef WATCHDOG_H
 #define WATCHDOG_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "esp_err.h"
 
-// Initialize task watchdog (stub for now)
+/**
+ * @file watchdog.h
+ * @brief Deadline-based task supervisor.
+ *
+ * Every long-running task registers once with its expected loop period
+ * and a deadline, then calls watchdog_feed() once per loop. A supervisor
+ * task (TASK_PRIO_WATCHDOG, every WATCHDOG_CHECK_MS) escalates when a
+ * task goes longer than its deadline without feeding:
+ *
+ *   1 x deadline  log, run the task's on_miss hook (e.g. relays off)
+ *   2 x deadline  suspend the task, run its detach hook, delete it and
+ *                 restart it via its restart hook; without one, after
+ *                 WATCHDOG_MAX_RESTARTS, or if detach refuses, reset
+ *                 (skipped for report_only tasks)
+ *
+ * A task that feeds again is back to healthy. The supervisor is itself
+ * the only subscriber of the hardware task watchdog
+ * (WATCHDOG_HW_TIMEOUT_MS, panics), so a wedged supervisor or scheduler
+ * still ends in a reset.
+ *
+ * Feeds also record the feed-to-feed interval (period and wake-up
+ * jitter, including the blocking wait) and, for tasks that call
+ * watchdog_loop_begin() when they wake, the work time from there to the
+ * feed. watchdog_get_stats() reports average / worst of both per task
+ * for tuning periods, priorities and core placement.
+ */
+
+typedef struct watchdog_cfg {
+    const char *name;           // <= 11 chars kept
+    uint32_t    period_ms;      // expected feed interval (reporting only)
+    uint32_t    deadline_ms;    // late once this long without a feed
+
+    // Called from the supervisor task on the first missed deadline. Must
+    // not block and must be safe while the task itself is stuck.
+    void      (*on_miss)(void);
+
+    // Called from the supervisor with the task (a TaskHandle_t)
+    // suspended, right before deleting it. Must drop every handle other
+    // tasks keep to it (mailbox waiters, notification targets) so nothing
+    // notifies the deleted TCB. Return false if deleting it is unsafe,
+    // e.g. it holds a mutex others take with portMAX_DELAY (the config
+    // mutex): that mutex would stay taken forever, so the supervisor
+    // resets instead. NULL: nothing to drop.
+    bool      (*detach)(void *task);
+
+    // Recreates the task after the supervisor deleted it; gets this
+    // config back. NULL if the task cannot be restarted safely (owns
+    // locks / subscriptions).
+    void      (*restart)(const struct watchdog_cfg *cfg);
+
+    // Stop after the first level: log and on_miss only, never delete or
+    // reset. For tasks whose stall cannot hurt the control path.
+    bool        report_only;
+} watchdog_cfg_t;
+
+typedef struct {
+    char     name[12];
+    void    *task;              // TaskHandle_t (NULL while restarting)
+    uint32_t period_ms;
+    uint32_t deadline_ms;
+    uint32_t feeds;
+    uint32_t feed_interval_avg_us;  // feed to feed, including the wait
+    uint32_t feed_interval_max_us;
+    uint32_t work_avg_us;       // watchdog_loop_begin() to feed (0: not used)
+    uint32_t work_max_us;
+    uint32_t since_feed_ms;
+    uint32_t misses;            // deadlines missed
+    uint32_t restarts;
+    uint8_t  level;             // 0 healthy, 1 late, 2 restarting
+} watchdog_task_stats_t;
+
+/**
+ * @brief Configure the hardware TWDT and start the supervisor task.
+ */
 esp_err_t watchdog_init(void);
 
-// Register the current task with the watchdog (stub)
-esp_err_t watchdog_register_current(const char *task_name);
+/**
+ * @brief Register @p task (a TaskHandle_t). Re-registering under the same
+ *        name (after a restart) reuses the slot and keeps its statistics.
+ *
+ * The deadline starts counting now. @p cfg must stay valid for the
+ * lifetime of the program.
+ */
+esp_err_t watchdog_register(void *task, const watchdog_cfg_t *cfg);
+
+/**
+ * @brief watchdog_register() for the calling task.
+ */
+esp_err_t watchdog_register_current(const watchdog_cfg_t *cfg);
 
-//Feed (reset) the watchdog (stub)
+/**
+ * @brief Mark the start of the calling task's work for this loop; call
+ *        right after its blocking wait returns. The next watchdog_feed()
+ *        records the time since as work time.
+ */
+void watchdog_loop_begin(void);
+
+/**
+ * @brief Mark the calling task alive and record its loop times.
+ */
 esp_err_t watchdog_feed(void);
 
-#endif
\ No newline at end of file
+/**
+ * @brief Copy per-task statistics.
+ *
+ * @return Number of entries written (at most @p max).
+ */
+size_t watchdog_get_stats(watchdog_task_stats_t *out, size_t max);
+
+#endif  // WATCHDOG_H
@@ -0,0 +1,81 @@
+#ifndef WIFI_CONN_H
+#define WIFI_CONN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file wifi_conn.h
+ * @brief Wi-Fi station connection state machine.
+ *
+ * Pure logic, no ESP-IDF calls: the NET task feeds it driver events and
+ * the current time, and it answers "call esp_wifi_connect() now" or "wait
+ * this long". Reconnects never stop; each failed attempt doubles the
+ * backoff ceiling (up to max_ms) and the actual delay is drawn uniformly
+ * from [ceiling/2, ceiling] so a room full of thermostats coming back
+ * after an AP reboot does not reconnect in lockstep.
+ *
+ *   IDLE --START--> CONNECTING --GOT_IP--> CONNECTED
+ *                     ^    |                  |
+ *            deadline |    | DISCONNECTED     | DISCONNECTED
+ *                     |    v                  v
+ *                     +-- BACKOFF <-----------+
+ *
+ * LOST_IP while CONNECTED goes back to CONNECTING (still associated,
+ * waiting for DHCP).
+ */
+
+typedef enum {
+    WIFI_CONN_IDLE = 0,
+    WIFI_CONN_CONNECTING,
+    WIFI_CONN_CONNECTED,
+    WIFI_CONN_BACKOFF
+} wifi_conn_state_t;
+
+typedef enum {
+    WIFI_CONN_EV_START = 0,        // WIFI_EVENT_STA_START
+    WIFI_CONN_EV_DISCONNECTED,     // WIFI_EVENT_STA_DISCONNECTED
+    WIFI_CONN_EV_GOT_IP,           // IP_EVENT_STA_GOT_IP
+    WIFI_CONN_EV_LOST_IP           // IP_EVENT_STA_LOST_IP
+} wifi_conn_event_t;
+
+typedef struct {
+    wifi_conn_state_t state;
+    uint32_t          attempt;      // consecutive failed attempts
+    uint32_t          retry_at_ms;  // valid in BACKOFF
+    uint32_t          base_ms;
+    uint32_t          max_ms;
+    uint32_t          rng;          // xorshift32 state, never 0
+} wifi_conn_t;
+
+/**
+ * @brief Reset to IDLE. @p seed only feeds the jitter (0 is remapped).
+ */
+void wifi_conn_init(wifi_conn_t *c, uint32_t base_ms, uint32_t max_ms,
+                    uint32_t seed);
+
+/**
+ * @brief Apply a driver event.
+ *
+ * @return true if the caller must call esp_wifi_connect() now.
+ */
+bool wifi_conn_on_event(wifi_conn_t *c, wifi_conn_event_t ev, uint32_t now_ms);
+
+/**
+ * @brief Check the backoff deadline.
+ *
+ * @return true if the deadline passed; the machine is now CONNECTING and
+ *         the caller must call esp_wifi_connect().
+ */
+bool wifi_conn_poll(wifi_conn_t *c, uint32_t now_ms);
+
+/**
+ * @brief Time until the next wifi_conn_poll() can do anything, capped at
+ *        @p cap_ms (which is returned outside BACKOFF).
+ */
+uint32_t wifi_conn_wait_ms(const wifi_conn_t *c, uint32_t now_ms,
+                           uint32_t cap_ms);
+
+const char *wifi_conn_state_to_str(wifi_conn_state_t s);
+
+#endif  // WIFI_CONN_H
@@ -0,0 +1,158 @@
+#include "core/boot.h"
+#include "core/logging.h"
+#include "core/monotime.h"
+
+#include "freertos/event_groups.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "BOOT";
+
+static const char *const s_names[BOOT_STAGE_COUNT] = {
+    [BOOT_STAGE_APP_MAIN]       = "app_main",
+    [BOOT_STAGE_CORE]           = "core",
+    [BOOT_STAGE_TASKS]          = "tasks",
+    [BOOT_STAGE_SENSOR_INIT]    = "sensor_init",
+    [BOOT_STAGE_DISPLAY_INIT]   = "display_init",
+    [BOOT_STAGE_BUTTONS_INIT]   = "buttons_init",
+    [BOOT_STAGE_FIRST_SAMPLE]   = "first_sample",
+    [BOOT_STAGE_FIRST_DECISION] = "first_decision",
+    [BOOT_STAGE_NVS]            = "nvs",
+    [BOOT_STAGE_WIFI_INIT]      = "wifi_init",
+    [BOOT_STAGE_NET_UP]         = "net_up",
+    [BOOT_STAGE_TIME_SET]       = "time_set",
+};
+
+static StaticEventGroup_t s_events_buf;
+static EventGroupHandle_t s_events = NULL;
+
+// 64-bit stamps: guarded by s_lock (no native 64-bit atomics on Xtensa).
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t     s_stage_us[BOOT_STAGE_COUNT];   // 0: not reached
+
+static const boot_stage_t s_driver_stages[] = {
+    BOOT_STAGE_SENSOR_INIT, BOOT_STAGE_DISPLAY_INIT, BOOT_STAGE_BUTTONS_INIT,
+};
+
+/**
+ * Three records rather than one per stage, so the report does not crowd
+ * the log queue right when every task is starting up.
+ */
+static void boot_report(void)
+{
+    // Driver inits run concurrently from task creation; "sum" is what
+    // running them one after another would take at least.
+    const uint64_t tasks_us   = boot_stage_us(BOOT_STAGE_TASKS);
+    uint64_t       longest_us = 0;
+    uint64_t       sum_us     = 0;
+    for (size_t i = 0; i < sizeof(s_driver_stages) / sizeof(s_driver_stages[0]); i++) {
+        const uint64_t us = boot_stage_us(s_driver_stages[i]);
+        if (tasks_us != 0 && us > tasks_us) {
+            sum_us += us - tasks_us;
+            if (us - tasks_us > longest_us) {
+                longest_us = us - tasks_us;
+            }
+        }
+    }
+
+    log_post(LOG_LEVEL_INFO, TAG,
+             "first sample %llu us, first relay decision %llu us; "
+             "driver init longest %llu us, sum %llu us",
+             (unsigned long long)boot_stage_us(BOOT_STAGE_FIRST_SAMPLE),
+             (unsigned long long)boot_stage_us(BOOT_STAGE_FIRST_DECISION),
+             (unsigned long long)longest_us, (unsigned long long)sum_us);
+
+    // Stages as "name us" pairs, split so each record fits LOG_BUFFER_LEN
+    // with its prefix.
+    char   line[LOG_BUFFER_LEN - sizeof("stages (us):")];
+    size_t len = 0;
+    for (int s = 0; s < BOOT_STAGE_COUNT; s++) {
+        char           item[40];
+        const uint64_t us = boot_stage_us((boot_stage_t)s);
+        const int      n  = (us != 0)
+            ? snprintf(item, sizeof(item), " %s %llu", s_names[s], (unsigned long long)us)
+            : snprintf(item, sizeof(item), " %s -", s_names[s]);
+        if (n <= 0) {
+            continue;
+        }
+        if (len + (size_t)n >= sizeof(line)) {
+            log_post(LOG_LEVEL_INFO, TAG, "stages (us):%s", line);
+            len = 0;
+        }
+        memcpy(&line[len], item, (size_t)n + 1u);
+        len += (size_t)n;
+    }
+    if (len > 0) {
+        log_post(LOG_LEVEL_INFO, TAG, "stages (us):%s", line);
+    }
+}
+
+void boot_init(void)
+{
+    s_events = xEventGroupCreateStatic(&s_events_buf);
+    boot_mark(BOOT_STAGE_APP_MAIN);
+}
+
+void boot_mark(boot_stage_t stage)
+{
+    if ((unsigned)stage >= BOOT_STAGE_COUNT) {
+        return;
+    }
+
+    uint64_t now = monotime_now_us();
+    if (now == 0) {
+        now = 1;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    const bool first = (s_stage_us[stage] == 0);
+    if (first) {
+        s_stage_us[stage] = now;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (!first) {
+        return;
+    }
+
+    if (s_events != NULL) {
+        xEventGroupSetBits(s_events, BOOT_BIT(stage));
+    }
+    log_post(LOG_LEVEL_INFO, TAG, "%s at %llu us", s_names[stage],
+             (unsigned long long)now);
+
+    if (stage == BOOT_STAGE_FIRST_DECISION) {
+        boot_report();
+    }
+}
+
+bool boot_wait(uint32_t mask, TickType_t timeout)
+{
+    if (mask == 0) {
+        return true;
+    }
+    if (s_events == NULL) {
+        return false;
+    }
+    const EventBits_t bits = xEventGroupWaitBits(s_events, mask, pdFALSE,
+                                                 pdTRUE, timeout);
+    return (bits & mask) == mask;
+}
+
+uint64_t boot_stage_us(boot_stage_t stage)
+{
+    if ((unsigned)stage >= BOOT_STAGE_COUNT) {
+        return 0;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    const uint64_t us = s_stage_us[stage];
+    taskEXIT_CRITICAL(&s_lock);
+    return us;
+}
+
+const char *boot_stage_name(boot_stage_t stage)
+{
+    return ((unsigned)stage < BOOT_STAGE_COUNT) ? s_names[stage] : "?";
+}
@@ -0,0 +1,75 @@
+#include "core/history.h"
+#include "core/numfmt.h"
+
+#include <string.h>
+
+static inline history_slot_t *slot_of(const history_t *h, uint32_t seq)
+{
+    return &h->slots[(seq - 1u) % h->depth];
+}
+
+void history_init(history_t *h, history_slot_t *slots, uint16_t depth,
+                  uint32_t interval_ms)
+{
+    memset(slots, 0, sizeof(*slots) * depth);
+    h->slots       = slots;
+    h->depth       = depth;
+    h->interval_ms = interval_ms;
+    h->head        = 0;
+    h->last_us     = 0;
+}
+
+bool history_record(history_t *h, const thermostat_state_t *st)
+{
+    if (h->slots == NULL || st == NULL) {
+        return false;
+    }
+    if (h->head != 0 && (st->timestamp_us - h->last_us) < (uint64_t)h->interval_ms * 1000u) {
+        return false;
+    }
+
+    const uint32_t  seq  = h->head + 1u;
+    history_slot_t *slot = slot_of(h, seq);
+
+    // Invalidate first so a reader copying the old entry notices.
+    __atomic_store_n(&slot->seq, 0u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->entry = (history_entry_t){
+        .uptime_s     = (uint32_t)(st->timestamp_us / 1000000u),
+        .tin_cc       = numfmt_centi(st->tin_c),
+        .tout_cc      = numfmt_centi(st->tout_c),
+        .setpoint_cc  = numfmt_centi(st->setpoint_c),
+        .mode         = (uint8_t)st->mode,
+        .output       = (uint8_t)st->output,
+    };
+
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+    __atomic_store_n(&h->head, seq, __ATOMIC_RELEASE);
+
+    h->last_us = st->timestamp_us;
+    return true;
+}
+
+uint32_t history_head(const history_t *h)
+{
+    return __atomic_load_n(&h->head, __ATOMIC_ACQUIRE);
+}
+
+bool history_read(const history_t *h, uint32_t seq, history_entry_t *out)
+{
+    if (h->slots == NULL || seq == 0) {
+        return false;
+    }
+
+    const history_slot_t *slot = slot_of(h, seq);
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) {
+        return false;
+    }
+
+    memcpy(out, (const void *)&slot->entry, sizeof(*out));
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq;
+}
@@ -0,0 +1,276 @@
+#include "core/json_writer.h"
+#include "core/numfmt.h"
+
+#include <math.h>
+#include <string.h>
+
+/* ---------------- Output ---------------- */
+
+static void flush(json_writer_t *w)
+{
+    if (w->len == 0 || w->error) {
+        return;
+    }
+    if (w->sink(w->ctx, w->buf, w->len) != 0) {
+        w->error = true;
+        return;
+    }
+    w->bytes += (uint32_t)w->len;
+    w->len    = 0;
+}
+
+static void put(json_writer_t *w, const char *data, size_t len)
+{
+    while (len > 0 && !w->error) {
+        if (w->len == w->cap) {
+            flush(w);
+            continue;
+        }
+        size_t n = w->cap - w->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        data   += n;
+        len    -= n;
+    }
+}
+
+static inline void put_c(json_writer_t *w, char c)
+{
+    put(w, &c, 1);
+}
+
+/**
+ * @brief Separator before a value or key at the current level.
+ */
+static bool begin_item(json_writer_t *w)
+{
+    if (w->error) {
+        return false;
+    }
+    if (w->after_key) {
+        w->after_key = false;
+        return true;
+    }
+
+    const uint8_t bit = (uint8_t)(1u << w->depth);
+    if (w->has_items & bit) {
+        put_c(w, ',');
+    }
+    w->has_items |= bit;
+    return true;
+}
+
+static void put_escaped(json_writer_t *w, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    put_c(w, '"');
+    for (const char *run = s; ; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c != '\0' && c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+
+        // Copy the plain run in one go, then the escape.
+        put(w, run, (size_t)(s - run));
+        if (c == '\0') {
+            break;
+        }
+        if (c == '"' || c == '\\') {
+            char esc[2] = { '\\', (char)c };
+            put(w, esc, sizeof(esc));
+        } else {
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+            put(w, esc, sizeof(esc));
+        }
+        run = s + 1;
+    }
+    put_c(w, '"');
+}
+
+/* ---------------- Public API ---------------- */
+
+void json_writer_init(json_writer_t *w, char *buf, size_t cap,
+                      json_sink_t sink, void *ctx)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf  = buf;
+    w->cap  = cap;
+    w->sink = sink;
+    w->ctx  = ctx;
+    w->error = (buf == NULL || cap == 0 || sink == NULL);
+}
+
+app_error_t json_writer_finish(json_writer_t *w)
+{
+    if (w->depth != 0 || w->after_key) {
+        w->error = true;
+    }
+    flush(w);
+    return w->error ? ERR_GENERIC : ERR_OK;
+}
+
+static void open_container(json_writer_t *w, char c)
+{
+    if (!begin_item(w)) {
+        return;
+    }
+    if (w->depth + 1 >= JSON_WRITER_MAX_DEPTH) {
+        w->error = true;
+        return;
+    }
+    put_c(w, c);
+    w->depth++;
+    w->has_items &= (uint8_t)~(1u << w->depth);
+}
+
+static void close_container(json_writer_t *w, char c)
+{
+    if (w->error) {
+        return;
+    }
+    if (w->depth == 0 || w->after_key) {
+        w->error = true;
+        return;
+    }
+    w->depth--;
+    put_c(w, c);
+}
+
+void json_begin_object(json_writer_t *w) { open_container(w, '{'); }
+void json_end_object(json_writer_t *w)   { close_container(w, '}'); }
+void json_begin_array(json_writer_t *w)  { open_container(w, '['); }
+void json_end_array(json_writer_t *w)    { close_container(w, ']'); }
+
+void json_key(json_writer_t *w, const char *key)
+{
+    if (!begin_item(w)) {
+        return;
+    }
+    put_escaped(w, key);
+    put_c(w, ':');
+    w->after_key = true;
+}
+
+void json_string(json_writer_t *w, const char *s)
+{
+    if (begin_item(w)) {
+        put_escaped(w, (s != NULL) ? s : "");
+    }
+}
+
+void json_uint(json_writer_t *w, uint32_t v)
+{
+    char tmp[12];
+    if (begin_item(w)) {
+        put(w, tmp, (size_t)(numfmt_u32(tmp, tmp + sizeof(tmp), v, 0) - tmp));
+    }
+}
+
+void json_uint64(json_writer_t *w, uint64_t v)
+{
+    char tmp[21];
+    if (begin_item(w)) {
+        put(w, tmp, (size_t)(numfmt_u64(tmp, tmp + sizeof(tmp), v, 0) - tmp));
+    }
+}
+
+void json_int(json_writer_t *w, int32_t v)
+{
+    char tmp[12];
+    if (begin_item(w)) {
+        put(w, tmp, (size_t)(numfmt_i32(tmp, tmp + sizeof(tmp), v, 0) - tmp));
+    }
+}
+
+void json_bool(json_writer_t *w, bool v)
+{
+    if (begin_item(w)) {
+        put(w, v ? "true" : "false", v ? 4 : 5);
+    }
+}
+
+void json_null(json_writer_t *w)
+{
+    if (begin_item(w)) {
+        put(w, "null", 4);
+    }
+}
+
+void json_fixed(json_writer_t *w, float v, uint8_t decimals)
+{
+    static const uint32_t pow10[] = { 1u, 10u, 100u, 1000u };
+
+    if (!isfinite(v)) {
+        json_null(w);
+        return;
+    }
+    if (!begin_item(w)) {
+        return;
+    }
+    if (decimals > 3) {
+        decimals = 3;
+    }
+
+    // Round like "%.*f" (same helper as the LCD), then integers only.
+    const uint32_t scale = pow10[decimals];
+    const bool     neg   = v < 0.0f;
+    const uint32_t q     = numfmt_round_scaled(v, scale);
+
+    char  tmp[16];
+    char *p   = tmp;
+    char *end = tmp + sizeof(tmp);
+
+    if (neg && q != 0) {
+        *p++ = '-';
+    }
+    p = numfmt_u32(p, end, q / scale, 0);
+    if (decimals > 0) {
+        uint32_t frac = q % scale;
+        *p++ = '.';
+        for (uint32_t d = scale / 10u; d > 0; d /= 10u) {
+            *p++ = (char)('0' + (frac / d) % 10u);
+        }
+    }
+
+    put(w, tmp, (size_t)(p - tmp));
+}
+
+void json_kv_string(json_writer_t *w, const char *key, const char *s)
+{
+    json_key(w, key);
+    json_string(w, s);
+}
+
+void json_kv_uint(json_writer_t *w, const char *key, uint32_t v)
+{
+    json_key(w, key);
+    json_uint(w, v);
+}
+
+void json_kv_uint64(json_writer_t *w, const char *key, uint64_t v)
+{
+    json_key(w, key);
+    json_uint64(w, v);
+}
+
+void json_kv_int(json_writer_t *w, const char *key, int32_t v)
+{
+    json_key(w, key);
+    json_int(w, v);
+}
+
+void json_kv_bool(json_writer_t *w, const char *key, bool v)
+{
+    json_key(w, key);
+    json_bool(w, v);
+}
+
+void json_kv_fixed(json_writer_t *w, const char *key, float v, uint8_t decimals)
+{
+    json_key(w, key);
+    json_fixed(w, v, decimals);
+}
@@ -1,4 +1,7 @@
 #include "core/logging.h"
+#include "core/metrics.h"
+#include "core/monotime.h"
+#include "core/rtos_alloc.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
@@ -8,10 +11,12 @@
 // (running in another component) will pull and process them.
 QueueHandle_t g_log_queue = NULL;
 
+RTOS_QUEUE_MEM(s_log_queue_mem, LOG_QUEUE_LENGTH, sizeof(log_record_t));
+
 void logging_init(void) {
     // Allocate a queue that holds LOG_QUEUE_LENGTH number of Log_record_t entries.
     // If this queue is NULL, Logging falls back to printf.
-    g_log_queue = xQueueCreate(LOG_QUEUE_LENGTH, sizeof(log_record_t));
+    g_log_queue = rtos_queue_create(&s_log_queue_mem);
 }
 
 void log_post(log_level_t level, const char *tag, const char *fmt, ...) {
@@ -33,6 +38,7 @@ void log_post(log_level_t level, const char *tag, const char *fmt, ...) {
 
     // Prepare a Log record and zero-fill all fields
     log_record_t rec = {0};
+    rec.t_us  = monotime_now_us();
     rec.level = level;
 
     // Copy tag into the struct safely (bounded copy)
@@ -53,5 +59,10 @@ void log_post(log_level_t level, const char *tag, const char *fmt, ...) {
     // This avoids blocking a high-priority task just because Logging is busy
 
     // Do not block forever, drop if queue is full
-    xQueueSend(g_log_queue, &rec, 0);
+    if (xQueueSend(g_log_queue, &rec, 0) == pdTRUE) {
+        metrics_inc(METRIC_LOG_POSTED);
+    } else {
+        metrics_inc(METRIC_LOG_DROPPED);
+    }
+    metrics_gauge_set(METRIC_LOG_QUEUE_DEPTH, (int32_t)uxQueueMessagesWaiting(g_log_queue));
 }
@@ -0,0 +1,118 @@
+#include "core/mailbox.h"
+
+#include <string.h>
+
+void mailbox_init(mailbox_t *mb, void *storage, size_t size)
+{
+    mb->seq    = 0;
+    mb->size   = size;
+    mb->slot   = storage;
+    mb->waiter = NULL;
+    mb->waking[0] = 0;
+    mb->waking[1] = 0;
+    mb->wake_gen  = 0;
+    portMUX_INITIALIZE(&mb->lock);
+}
+
+void mailbox_attach(mailbox_t *mb, TaskHandle_t task)
+{
+    __atomic_store_n(&mb->waiter, task, __ATOMIC_SEQ_CST);
+
+    // A notifier that loaded the previous waiter may not have woken it
+    // yet. New notifiers count in the other slot from here on (and load
+    // the new waiter), so the old slot only drains; once it is empty the
+    // caller may delete the previous waiter.
+    const uint32_t old = __atomic_fetch_xor(&mb->wake_gen, 1u, __ATOMIC_SEQ_CST) & 1u;
+    while (__atomic_load_n(&mb->waking[old], __ATOMIC_SEQ_CST) != 0) {
+        vTaskDelay(1);
+    }
+}
+
+void mailbox_notify(mailbox_t *mb)
+{
+    const uint32_t g = __atomic_load_n(&mb->wake_gen, __ATOMIC_SEQ_CST) & 1u;
+
+    __atomic_add_fetch(&mb->waking[g], 1u, __ATOMIC_SEQ_CST);
+    TaskHandle_t waiter = __atomic_load_n(&mb->waiter, __ATOMIC_SEQ_CST);
+    if (waiter != NULL) {
+        xTaskNotifyGive(waiter);
+    }
+    __atomic_sub_fetch(&mb->waking[g], 1u, __ATOMIC_SEQ_CST);
+}
+
+uint32_t mailbox_publish(mailbox_t *mb, const void *value)
+{
+    portENTER_CRITICAL(&mb->lock);
+
+    uint32_t s = mb->seq;
+
+    // Odd sequence first, so readers discard a copy that overlaps the write.
+    __atomic_store_n(&mb->seq, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(mb->slot, value, mb->size);
+
+    __atomic_store_n(&mb->seq, s + 2, __ATOMIC_RELEASE);
+
+    portEXIT_CRITICAL(&mb->lock);
+
+    mailbox_notify(mb);
+
+    return (s + 2) >> 1;
+}
+
+uint32_t mailbox_seq(const mailbox_t *mb)
+{
+    // A write in progress still reports the previous value's number.
+    return __atomic_load_n(&mb->seq, __ATOMIC_ACQUIRE) >> 1;
+}
+
+bool mailbox_read(const mailbox_t *mb, void *out, uint32_t *out_seq)
+{
+    uint32_t s1, s2 = 0;
+
+    do {
+        s1 = __atomic_load_n(&mb->seq, __ATOMIC_ACQUIRE);
+        if (s1 == 0) {
+            return false;
+        }
+        if (s1 & 1u) {
+            continue;   // writer is mid-copy on the other core
+        }
+
+        memcpy(out, mb->slot, mb->size);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&mb->seq, __ATOMIC_RELAXED);
+    } while ((s1 & 1u) || s1 != s2);
+
+    if (out_seq != NULL) {
+        *out_seq = s1 >> 1;
+    }
+    return true;
+}
+
+bool mailbox_wait(const mailbox_t *mb, void *out, uint32_t *io_seq,
+                  TickType_t timeout)
+{
+    const TickType_t start = xTaskGetTickCount();
+
+    while (1) {
+        if (mailbox_seq(mb) != *io_seq) {
+            return mailbox_read(mb, out, io_seq);
+        }
+
+        TickType_t remaining = portMAX_DELAY;
+        if (timeout != portMAX_DELAY) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= timeout) {
+                return false;
+            }
+            remaining = timeout - elapsed;
+        }
+
+        // Notifications are a count of publishes; clear them all, the
+        // slot only holds the newest value anyway.
+        ulTaskNotifyTake(pdTRUE, remaining);
+    }
+}
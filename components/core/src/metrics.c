@@ -0,0 +1,378 @@
+#include "core/metrics.h"
+#include "core/numfmt.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define METRICS_MAX_CELLS   64      // per core; checked by metrics_init()
+
+typedef struct {
+    const char     *name;
+    const char     *help;
+    metric_type_t   type;
+    const uint32_t *bounds;         // histograms only
+    uint8_t         nbounds;
+} metric_desc_t;
+
+static const uint32_t s_bounds_control_us[] = { 50, 100, 200, 500, 1000, 2000, 5000, 10000 };
+static const uint32_t s_bounds_sensor_ms[]  = { 100, 110, 125, 150, 200, 300, 500, 1000 };
+
+#define HIST(b)  METRIC_TYPE_HISTOGRAM, (b), (uint8_t)(sizeof(b) / sizeof((b)[0]))
+
+static const metric_desc_t s_desc[METRIC_COUNT] = {
+    [METRIC_CONTROL_CYCLES]   = { "thermostat_control_cycles_total",    "Control decisions made",               METRIC_TYPE_COUNTER },
+    [METRIC_CONTROL_LOOP_US]  = { "thermostat_control_loop_us",         "Control cycle duration (us)",          HIST(s_bounds_control_us) },
+    [METRIC_RELAY_SWITCHES]   = { "thermostat_relay_switches_total",    "Relay output changes",                 METRIC_TYPE_COUNTER },
+    [METRIC_SENSOR_SAMPLES]   = { "thermostat_sensor_samples_total",    "Sensor samples published",             METRIC_TYPE_COUNTER },
+    [METRIC_SENSOR_FAILURES]  = { "thermostat_sensor_failures_total",   "Sensor reads failed after retries",    METRIC_TYPE_COUNTER },
+    [METRIC_SENSOR_READ_MS]   = { "thermostat_sensor_read_ms",          "Sensor read duration (ms)",            HIST(s_bounds_sensor_ms) },
+    [METRIC_SENSOR_PERIOD_MS] = { "thermostat_sensor_period_ms",        "Current sampling period (ms)",         METRIC_TYPE_GAUGE },
+    [METRIC_I2C_ERRORS]       = { "thermostat_i2c_errors_total",        "Failed AHT20 transfer attempts",       METRIC_TYPE_COUNTER },
+    [METRIC_I2C_RETRIES]      = { "thermostat_i2c_retries_total",       "AHT20 read retries",                   METRIC_TYPE_COUNTER },
+    [METRIC_I2C_RECOVERIES]   = { "thermostat_i2c_recoveries_total",    "I2C bus clear + sensor re-init",       METRIC_TYPE_COUNTER },
+    [METRIC_LOG_POSTED]       = { "thermostat_log_posted_total",        "Log records posted",                   METRIC_TYPE_COUNTER },
+    [METRIC_LOG_DROPPED]      = { "thermostat_log_dropped_total",       "Log records dropped (queue full)",     METRIC_TYPE_COUNTER },
+    [METRIC_LOG_QUEUE_DEPTH]  = { "thermostat_log_queue_depth",         "Log records waiting",                  METRIC_TYPE_GAUGE },
+    [METRIC_WIFI_CONNECTED]   = { "thermostat_wifi_connected",          "Station has an IP address",            METRIC_TYPE_GAUGE },
+    [METRIC_WIFI_DISCONNECTS] = { "thermostat_wifi_disconnects_total",  "Wi-Fi disconnect events",              METRIC_TYPE_COUNTER },
+};
+
+// One row of cells per core; a row spans whole cache lines.
+static uint32_t s_cells[portNUM_PROCESSORS][METRICS_MAX_CELLS] __attribute__((aligned(32)));
+static int32_t  s_gauges[METRIC_COUNT];
+static uint8_t  s_cell_off[METRIC_COUNT];
+static bool     s_ready = false;
+
+/* ---------------- Setup ---------------- */
+
+app_error_t metrics_init(void)
+{
+    unsigned off = 0;
+
+    for (int id = 0; id < METRIC_COUNT; id++) {
+        const metric_desc_t *d = &s_desc[id];
+
+        if (d->name == NULL || d->nbounds > METRICS_HIST_MAX_BOUNDS) {
+            return ERR_GENERIC;
+        }
+
+        s_cell_off[id] = (uint8_t)off;
+        switch (d->type) {
+        case METRIC_TYPE_COUNTER:   off += 1u;                   break;
+        case METRIC_TYPE_HISTOGRAM: off += d->nbounds + 1u + 1u; break;  // buckets + sum
+        default:                                                 break;
+        }
+    }
+
+    if (off > METRICS_MAX_CELLS) {
+        return ERR_GENERIC;
+    }
+
+    __atomic_store_n(&s_ready, true, __ATOMIC_RELEASE);
+    return ERR_OK;
+}
+
+/* ---------------- Updates ---------------- */
+
+static inline uint32_t *my_row(void)
+{
+    return s_cells[xPortGetCoreID()];
+}
+
+void metrics_add(metric_id_t id, uint32_t n)
+{
+    if (!s_ready || (unsigned)id >= METRIC_COUNT ||
+        s_desc[id].type != METRIC_TYPE_COUNTER) {
+        return;
+    }
+    __atomic_fetch_add(&my_row()[s_cell_off[id]], n, __ATOMIC_RELAXED);
+}
+
+void metrics_gauge_set(metric_id_t id, int32_t value)
+{
+    if ((unsigned)id >= METRIC_COUNT || s_desc[id].type != METRIC_TYPE_GAUGE) {
+        return;
+    }
+    __atomic_store_n(&s_gauges[id], value, __ATOMIC_RELAXED);
+}
+
+void metrics_observe(metric_id_t id, uint32_t value)
+{
+    if (!s_ready || (unsigned)id >= METRIC_COUNT ||
+        s_desc[id].type != METRIC_TYPE_HISTOGRAM) {
+        return;
+    }
+
+    const metric_desc_t *d = &s_desc[id];
+
+    uint8_t b = 0;
+    while (b < d->nbounds && value > d->bounds[b]) {
+        b++;
+    }
+
+    uint32_t *cells = &my_row()[s_cell_off[id]];
+    __atomic_fetch_add(&cells[b], 1u, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&cells[d->nbounds + 1u], value, __ATOMIC_RELAXED);
+}
+
+/* ---------------- Reads ---------------- */
+
+static uint32_t cell_sum(unsigned off)
+{
+    uint32_t v = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        v += __atomic_load_n(&s_cells[core][off], __ATOMIC_RELAXED);
+    }
+    return v;
+}
+
+metric_type_t metrics_type(metric_id_t id)
+{
+    return s_desc[id].type;
+}
+
+const char *metrics_name(metric_id_t id)
+{
+    return s_desc[id].name;
+}
+
+uint32_t metrics_counter(metric_id_t id)
+{
+    if ((unsigned)id >= METRIC_COUNT || s_desc[id].type != METRIC_TYPE_COUNTER) {
+        return 0;
+    }
+    return cell_sum(s_cell_off[id]);
+}
+
+int32_t metrics_gauge(metric_id_t id)
+{
+    if ((unsigned)id >= METRIC_COUNT || s_desc[id].type != METRIC_TYPE_GAUGE) {
+        return 0;
+    }
+    return __atomic_load_n(&s_gauges[id], __ATOMIC_RELAXED);
+}
+
+void metrics_histogram(metric_id_t id, metrics_hist_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if ((unsigned)id >= METRIC_COUNT || s_desc[id].type != METRIC_TYPE_HISTOGRAM) {
+        return;
+    }
+
+    const metric_desc_t *d   = &s_desc[id];
+    const unsigned       off = s_cell_off[id];
+
+    out->nbounds = d->nbounds;
+    for (uint8_t b = 0; b < d->nbounds; b++) {
+        out->bounds[b] = d->bounds[b];
+    }
+    // Buckets are read one by one while writers keep going; the count is
+    // derived from them so count and buckets always agree.
+    for (uint8_t b = 0; b <= d->nbounds; b++) {
+        out->buckets[b] = cell_sum(off + b);
+        out->count     += out->buckets[b];
+    }
+    out->sum = cell_sum(off + d->nbounds + 1u);
+}
+
+/* ---------------- Prometheus text ---------------- */
+
+typedef struct {
+    char          *buf;
+    size_t         cap;
+    size_t         len;
+    metrics_sink_t sink;
+    void          *ctx;
+    bool           error;
+} text_out_t;
+
+static void out_flush(text_out_t *o)
+{
+    if (o->len > 0 && !o->error) {
+        o->error = (o->sink(o->ctx, o->buf, o->len) != 0);
+    }
+    o->len = 0;
+}
+
+static void out_put(text_out_t *o, const char *s, size_t n)
+{
+    while (n > 0 && !o->error) {
+        if (o->len == o->cap) {
+            out_flush(o);
+            continue;
+        }
+        size_t k = o->cap - o->len;
+        if (k > n) {
+            k = n;
+        }
+        memcpy(o->buf + o->len, s, k);
+        o->len += k;
+        s      += k;
+        n      -= k;
+    }
+}
+
+static void out_str(text_out_t *o, const char *s)
+{
+    out_put(o, s, strlen(s));
+}
+
+static void out_u32(text_out_t *o, uint32_t v)
+{
+    char tmp[12];
+    out_put(o, tmp, (size_t)(numfmt_u32(tmp, tmp + sizeof(tmp), v, 0) - tmp));
+}
+
+static void out_i32(text_out_t *o, int32_t v)
+{
+    char tmp[12];
+    out_put(o, tmp, (size_t)(numfmt_i32(tmp, tmp + sizeof(tmp), v, 0) - tmp));
+}
+
+static void out_sample(text_out_t *o, const char *name, const char *suffix, uint32_t v)
+{
+    out_str(o, name);
+    out_str(o, suffix);
+    out_put(o, " ", 1);
+    out_u32(o, v);
+    out_put(o, "\n", 1);
+}
+
+app_error_t metrics_export_prometheus(char *buf, size_t cap,
+                                      metrics_sink_t sink, void *ctx)
+{
+    static const char *const type_names[] = { "counter", "gauge", "histogram" };
+
+    if (buf == NULL || cap == 0 || sink == NULL) {
+        return ERR_GENERIC;
+    }
+
+    text_out_t o = { .buf = buf, .cap = cap, .sink = sink, .ctx = ctx };
+
+    for (int id = 0; id < METRIC_COUNT && !o.error; id++) {
+        const metric_desc_t *d = &s_desc[id];
+
+        out_str(&o, "# HELP ");
+        out_str(&o, d->name);
+        out_put(&o, " ", 1);
+        out_str(&o, d->help);
+        out_str(&o, "\n# TYPE ");
+        out_str(&o, d->name);
+        out_put(&o, " ", 1);
+        out_str(&o, type_names[d->type]);
+        out_put(&o, "\n", 1);
+
+        switch (d->type) {
+        case METRIC_TYPE_COUNTER:
+            out_sample(&o, d->name, "", metrics_counter((metric_id_t)id));
+            break;
+
+        case METRIC_TYPE_GAUGE:
+            out_str(&o, d->name);
+            out_put(&o, " ", 1);
+            out_i32(&o, metrics_gauge((metric_id_t)id));
+            out_put(&o, "\n", 1);
+            break;
+
+        case METRIC_TYPE_HISTOGRAM: {
+            metrics_hist_t h;
+            metrics_histogram((metric_id_t)id, &h);
+
+            uint32_t cum = 0;
+            for (uint8_t b = 0; b <= h.nbounds; b++) {
+                cum += h.buckets[b];
+                out_str(&o, d->name);
+                out_str(&o, "_bucket{le=\"");
+                if (b < h.nbounds) {
+                    out_u32(&o, h.bounds[b]);
+                } else {
+                    out_str(&o, "+Inf");
+                }
+                out_str(&o, "\"} ");
+                out_u32(&o, cum);
+                out_put(&o, "\n", 1);
+            }
+            out_sample(&o, d->name, "_sum",   h.sum);
+            out_sample(&o, d->name, "_count", h.count);
+            break;
+        }
+        }
+    }
+
+    out_flush(&o);
+    return o.error ? ERR_GENERIC : ERR_OK;
+}
+
+/* ---------------- Binary ---------------- */
+
+typedef struct {
+    uint8_t *p;
+    uint8_t *end;
+    bool     overflow;
+} bin_out_t;
+
+static void bin_u8(bin_out_t *o, uint8_t v)
+{
+    if (o->p >= o->end) {
+        o->overflow = true;
+        return;
+    }
+    *o->p++ = v;
+}
+
+static void bin_varint(bin_out_t *o, uint32_t v)
+{
+    do {
+        uint8_t b = (uint8_t)(v & 0x7Fu);
+        v >>= 7;
+        bin_u8(o, (v != 0) ? (uint8_t)(b | 0x80u) : b);
+    } while (v != 0 && !o->overflow);
+}
+
+size_t metrics_export_binary(uint8_t *buf, size_t cap)
+{
+    bin_out_t o = { .p = buf, .end = buf + cap, .overflow = (buf == NULL) };
+
+    bin_u8(&o, 'M');
+    bin_u8(&o, 'T');
+    bin_u8(&o, 1);
+    bin_varint(&o, METRIC_COUNT);
+
+    for (int id = 0; id < METRIC_COUNT && !o.overflow; id++) {
+        const metric_type_t type = s_desc[id].type;
+
+        bin_varint(&o, (uint32_t)id);
+        bin_u8(&o, (uint8_t)type);
+
+        switch (type) {
+        case METRIC_TYPE_COUNTER:
+            bin_varint(&o, metrics_counter((metric_id_t)id));
+            break;
+
+        case METRIC_TYPE_GAUGE: {
+            int32_t g = metrics_gauge((metric_id_t)id);
+            bin_varint(&o, ((uint32_t)g << 1) ^ (uint32_t)(g >> 31));
+            break;
+        }
+
+        case METRIC_TYPE_HISTOGRAM: {
+            metrics_hist_t h;
+            metrics_histogram((metric_id_t)id, &h);
+            bin_varint(&o, h.nbounds);
+            for (uint8_t b = 0; b < h.nbounds; b++) {
+                bin_varint(&o, h.bounds[b]);
+            }
+            for (uint8_t b = 0; b <= h.nbounds; b++) {
+                bin_varint(&o, h.buckets[b]);
+            }
+            bin_varint(&o, h.sum);
+            break;
+        }
+        }
+    }
+
+    return o.overflow ? 0 : (size_t)(o.p - buf);
+}
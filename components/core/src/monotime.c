@@ -0,0 +1,23 @@
+#include "core/monotime.h"
+
+#ifdef ESP_PLATFORM
+
+#include "esp_timer.h"
+
+mono_us_t monotime_now_us(void)
+{
+    return (mono_us_t)esp_timer_get_time();
+}
+
+#else  // host build
+
+#include <time.h>
+
+mono_us_t monotime_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (mono_us_t)ts.tv_sec * 1000000u + (mono_us_t)ts.tv_nsec / 1000u;
+}
+
+#endif
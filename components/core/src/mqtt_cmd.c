@@ -0,0 +1,86 @@
+#include "core/mqtt_cmd.h"
+#include "core/config.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool name_is(const char *name, size_t len, const char *lit)
+{
+    return strlen(lit) == len && memcmp(name, lit, len) == 0;
+}
+
+/**
+ * @brief Copy a payload into @p buf, trimmed and lower-cased.
+ */
+static bool payload_to_str(const char *p, size_t len, char *buf, size_t cap)
+{
+    while (len > 0 && isspace((unsigned char)p[0])) {
+        p++;
+        len--;
+    }
+    while (len > 0 && isspace((unsigned char)p[len - 1])) {
+        len--;
+    }
+    if (len == 0 || len >= cap) {
+        return false;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (char)tolower((unsigned char)p[i]);
+    }
+    buf[len] = '\0';
+    return true;
+}
+
+static bool parse_mode(const char *s, thermostat_mode_t *out)
+{
+    if (strcmp(s, "off") == 0)  { *out = THERMOSTAT_MODE_OFF;  return true; }
+    if (strcmp(s, "heat") == 0) { *out = THERMOSTAT_MODE_HEAT; return true; }
+    if (strcmp(s, "cool") == 0) { *out = THERMOSTAT_MODE_COOL; return true; }
+    if (strcmp(s, "auto") == 0) { *out = THERMOSTAT_MODE_AUTO; return true; }
+    return false;
+}
+
+static bool parse_celsius(const char *s, float min_c, float max_c, float *out)
+{
+    char *end = NULL;
+    float v   = strtof(s, &end);
+
+    if (end == s || *end != '\0' || !isfinite(v) || v < min_c || v > max_c) {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+app_error_t mqtt_cmd_parse(const char *name, size_t name_len,
+                           const char *payload, size_t payload_len,
+                           mqtt_cmd_t *out)
+{
+    char value[16];
+
+    if (name == NULL || payload == NULL || out == NULL ||
+        !payload_to_str(payload, payload_len, value, sizeof(value))) {
+        return ERR_GENERIC;
+    }
+
+    if (name_is(name, name_len, "mode")) {
+        out->type = MQTT_CMD_MODE;
+        return parse_mode(value, &out->mode) ? ERR_OK : ERR_GENERIC;
+    }
+    if (name_is(name, name_len, "setpoint")) {
+        out->type = MQTT_CMD_SETPOINT;
+        return parse_celsius(value, THERMOSTAT_SP_MIN_C, THERMOSTAT_SP_MAX_C,
+                             &out->value_c) ? ERR_OK : ERR_GENERIC;
+    }
+    if (name_is(name, name_len, "hysteresis")) {
+        out->type = MQTT_CMD_HYSTERESIS;
+        return parse_celsius(value, THERMOSTAT_HYST_MIN_C, THERMOSTAT_HYST_MAX_C,
+                             &out->value_c) ? ERR_OK : ERR_GENERIC;
+    }
+
+    return ERR_GENERIC;
+}
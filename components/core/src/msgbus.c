@@ -0,0 +1,271 @@
+#include "core/msgbus.h"
+#include "core/logging.h"
+
+#include <string.h>
+
+static const char *TAG = "MSGBUS";
+
+/*
+ * Sequence numbers start at 1; a slot header of 0 means "being written".
+ * Message n lives in slot (n - 1) % depth, so a reader can tell from the
+ * header alone whether the slot still holds the message it expects.
+ */
+
+typedef struct {
+    uint8_t           *ring;
+    size_t             msg_size;
+    size_t             stride;
+    uint16_t           depth;
+    volatile uint32_t  head;       // last committed sequence number
+    msgbus_sub_t      *subs;       // prepend-only list
+    uint32_t           nsubs;
+    portMUX_TYPE       lock;       // subscriber list updates
+} msgbus_topic_ctx_t;
+
+static msgbus_topic_ctx_t s_topics[MSGBUS_TOPIC_COUNT];
+
+static inline msgbus_topic_ctx_t *topic_ctx(msgbus_topic_t topic)
+{
+    if ((unsigned)topic >= MSGBUS_TOPIC_COUNT || s_topics[topic].ring == NULL) {
+        return NULL;
+    }
+    return &s_topics[topic];
+}
+
+static inline uint8_t *slot_of(const msgbus_topic_ctx_t *t, uint32_t seq)
+{
+    return t->ring + (size_t)((seq - 1u) % t->depth) * t->stride;
+}
+
+static inline uint32_t slot_seq(const uint8_t *slot)
+{
+    return __atomic_load_n((const uint32_t *)slot, __ATOMIC_ACQUIRE);
+}
+
+/* ---------------- Topics / producers ---------------- */
+
+void msgbus_topic_init(msgbus_topic_t topic, void *storage,
+                       size_t msg_size, uint16_t depth)
+{
+    if ((unsigned)topic >= MSGBUS_TOPIC_COUNT || storage == NULL || depth == 0) {
+        return;
+    }
+
+    msgbus_topic_ctx_t *t = &s_topics[topic];
+
+    memset(storage, 0, MSGBUS_RING_BYTES(msg_size, depth));
+    t->msg_size = msg_size;
+    t->stride   = MSGBUS_SLOT_STRIDE(msg_size);
+    t->depth    = depth;
+    t->head     = 0;
+    t->subs     = NULL;
+    t->nsubs    = 0;
+    portMUX_INITIALIZE(&t->lock);
+    t->ring     = storage;
+}
+
+void *msgbus_claim(msgbus_topic_t topic)
+{
+    msgbus_topic_ctx_t *t = topic_ctx(topic);
+    if (t == NULL) {
+        return NULL;
+    }
+
+    uint8_t *slot = slot_of(t, t->head + 1u);
+
+    // Invalidate first so readers still holding the old message notice.
+    __atomic_store_n((uint32_t *)slot, 0u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    return slot + MSGBUS_SLOT_HDR;
+}
+
+uint32_t msgbus_commit(msgbus_topic_t topic)
+{
+    msgbus_topic_ctx_t *t = topic_ctx(topic);
+    if (t == NULL) {
+        return 0;
+    }
+
+    uint32_t seq = t->head + 1u;
+
+    __atomic_store_n((uint32_t *)slot_of(t, seq), seq, __ATOMIC_RELEASE);
+    __atomic_store_n(&t->head, seq, __ATOMIC_RELEASE);
+
+    // One notification per subscriber; the message itself is never copied.
+    msgbus_sub_t *s = __atomic_load_n(&t->subs, __ATOMIC_ACQUIRE);
+    for (; s != NULL; s = s->link) {
+        xTaskNotifyGive(s->task);
+    }
+
+    return seq;
+}
+
+uint32_t msgbus_publish(msgbus_topic_t topic, const void *msg)
+{
+    void *slot = msgbus_claim(topic);
+    if (slot == NULL) {
+        return 0;
+    }
+
+    memcpy(slot, msg, s_topics[topic].msg_size);
+    return msgbus_commit(topic);
+}
+
+bool msgbus_read_latest(msgbus_topic_t topic, void *out, uint32_t *out_seq)
+{
+    const msgbus_topic_ctx_t *t = topic_ctx(topic);
+    if (t == NULL) {
+        return false;
+    }
+
+    while (1) {
+        uint32_t head = __atomic_load_n(&t->head, __ATOMIC_ACQUIRE);
+        if (head == 0) {
+            return false;
+        }
+
+        const uint8_t *slot = slot_of(t, head);
+        if (slot_seq(slot) != head) {
+            continue;   // recycled under us; retry with the new head
+        }
+
+        memcpy(out, slot + MSGBUS_SLOT_HDR, t->msg_size);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n((const uint32_t *)slot, __ATOMIC_RELAXED) == head) {
+            if (out_seq != NULL) {
+                *out_seq = head;
+            }
+            return true;
+        }
+    }
+}
+
+/* ---------------- Subscribers ---------------- */
+
+void msgbus_subscribe(msgbus_sub_t *sub, msgbus_topic_t topic,
+                      const char *name, bool replay_latest)
+{
+    msgbus_topic_ctx_t *t = topic_ctx(topic);
+    if (t == NULL || sub == NULL) {
+        log_post(LOG_LEVEL_ERROR, TAG, "subscribe(%s): topic %d not set up",
+                 name ? name : "?", (int)topic);
+        return;
+    }
+
+    memset(sub, 0, sizeof(*sub));
+    sub->name  = name;
+    sub->topic = topic;
+    sub->task  = xTaskGetCurrentTaskHandle();
+
+    uint32_t head = __atomic_load_n(&t->head, __ATOMIC_ACQUIRE);
+    sub->next = (replay_latest && head != 0) ? head : head + 1u;
+
+    // Publishers walk the list without the lock, so link before publishing.
+    portENTER_CRITICAL(&t->lock);
+    sub->link = t->subs;
+    __atomic_store_n(&t->subs, sub, __ATOMIC_RELEASE);
+    t->nsubs++;
+    portEXIT_CRITICAL(&t->lock);
+
+    log_post(LOG_LEVEL_INFO, TAG, "%s subscribed to topic %d (depth=%u)",
+             name ? name : "?", (int)topic, (unsigned)t->depth);
+}
+
+bool msgbus_peek(msgbus_sub_t *sub, const void **out_msg, TickType_t timeout)
+{
+    const msgbus_topic_ctx_t *t = topic_ctx(sub->topic);
+    if (t == NULL) {
+        return false;
+    }
+
+    const TickType_t start = xTaskGetTickCount();
+
+    while (1) {
+        uint32_t head = __atomic_load_n(&t->head, __ATOMIC_ACQUIRE);
+
+        if ((int32_t)(head - sub->next) < 0) {
+            // Nothing new: sleep until a publish (or timeout).
+            TickType_t remaining = portMAX_DELAY;
+            if (timeout != portMAX_DELAY) {
+                TickType_t elapsed = xTaskGetTickCount() - start;
+                if (elapsed >= timeout) {
+                    return false;
+                }
+                remaining = timeout - elapsed;
+            }
+            ulTaskNotifyTake(pdTRUE, remaining);
+            continue;
+        }
+
+        uint32_t lag = head - sub->next + 1u;
+        if (lag > sub->max_lag) {
+            sub->max_lag = lag;
+        }
+        if (lag > t->depth) {
+            // Overrun: the oldest messages are gone.
+            sub->dropped += lag - t->depth;
+            sub->next     = head - t->depth + 1u;
+        }
+
+        const uint8_t *slot = slot_of(t, sub->next);
+        if (slot_seq(slot) != sub->next) {
+            // Producer is recycling this slot right now.
+            sub->dropped++;
+            sub->next++;
+            continue;
+        }
+
+        *out_msg = slot + MSGBUS_SLOT_HDR;
+        return true;
+    }
+}
+
+bool msgbus_release(msgbus_sub_t *sub)
+{
+    const msgbus_topic_ctx_t *t = topic_ctx(sub->topic);
+    if (t == NULL) {
+        return false;
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    bool intact = (__atomic_load_n((const uint32_t *)slot_of(t, sub->next),
+                                   __ATOMIC_RELAXED) == sub->next);
+    if (intact) {
+        sub->delivered++;
+    } else {
+        sub->dropped++;
+    }
+    sub->next++;
+
+    return intact;
+}
+
+/* ---------------- Diagnostics ---------------- */
+
+void msgbus_get_topic_stats(msgbus_topic_t topic, msgbus_topic_stats_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+
+    const msgbus_topic_ctx_t *t = topic_ctx(topic);
+    out->published   = (t != NULL) ? t->head  : 0;
+    out->subscribers = (t != NULL) ? t->nsubs : 0;
+}
+
+void msgbus_get_sub_stats(const msgbus_sub_t *sub, msgbus_sub_stats_t *out)
+{
+    if (sub == NULL || out == NULL) {
+        return;
+    }
+
+    const msgbus_topic_ctx_t *t = topic_ctx(sub->topic);
+    uint32_t head = (t != NULL) ? t->head : 0;
+
+    out->delivered = sub->delivered;
+    out->dropped   = sub->dropped;
+    out->lag       = ((int32_t)(head - sub->next) >= 0) ? head - sub->next + 1u : 0;
+    out->max_lag   = sub->max_lag;
+}
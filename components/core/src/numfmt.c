@@ -0,0 +1,155 @@
+#include "core/numfmt.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Longest text we ever build: "-2147483648" / "-214748364.8".
+#define NUMFMT_TMP_LEN  24
+
+/**
+ * @brief Emit the digits in tmp[0..n) (stored in reverse) with padding.
+ */
+static char *emit_reversed(char *p, char *end,
+                           const char *tmp, int n, int width)
+{
+    for (int pad = width - n; pad > 0 && p < end; pad--) {
+        *p++ = ' ';
+    }
+    while (n > 0 && p < end) {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+char *numfmt_u32(char *p, char *end, uint32_t value, int width)
+{
+    char tmp[NUMFMT_TMP_LEN];
+    int  n = 0;
+
+    do {
+        tmp[n++] = (char)('0' + (value % 10u));
+        value /= 10u;
+    } while (value != 0u);
+
+    return emit_reversed(p, end, tmp, n, width);
+}
+
+char *numfmt_u64(char *p, char *end, uint64_t value, int width)
+{
+    char tmp[NUMFMT_TMP_LEN];
+    int  n = 0;
+
+    do {
+        tmp[n++] = (char)('0' + (value % 10u));
+        value /= 10u;
+    } while (value != 0u);
+
+    return emit_reversed(p, end, tmp, n, width);
+}
+
+char *numfmt_i32(char *p, char *end, int32_t value, int width)
+{
+    char     tmp[NUMFMT_TMP_LEN];
+    int      n   = 0;
+    bool     neg = value < 0;
+    uint32_t mag = neg ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+
+    do {
+        tmp[n++] = (char)('0' + (mag % 10u));
+        mag /= 10u;
+    } while (mag != 0u);
+
+    if (neg) {
+        tmp[n++] = '-';
+    }
+
+    return emit_reversed(p, end, tmp, n, width);
+}
+
+uint32_t numfmt_round_scaled(float value, uint32_t scale)
+{
+    union { float f; uint32_t u; } bits = { .f = value };
+    const uint32_t exp  = (bits.u >> 23) & 0xFFu;
+    uint64_t       mant = bits.u & 0x7FFFFFu;
+
+    if (exp == 0xFFu) {
+        return (mant != 0u) ? 0u : UINT32_MAX;      // NaN / Inf
+    }
+    if (exp != 0u) {
+        mant |= 0x800000u;
+    }
+
+    // |value| == mant * 2^shift exactly, so mant * scale (< 2^56) is the
+    // exact scaled value before the binary point moves.
+    const int32_t  shift = (int32_t)(exp == 0u ? 1u : exp) - 150;
+    const uint64_t prod  = mant * scale;
+
+    if (shift >= 0) {
+        if (shift >= 32 || prod > ((uint64_t)UINT32_MAX >> shift)) {
+            return UINT32_MAX;
+        }
+        return (uint32_t)(prod << shift);
+    }
+    if (shift <= -64) {
+        return 0u;
+    }
+
+    // Round to nearest, ties to even -- what printf does with the exact
+    // binary value, so "%.0f" of 22.5 stays "22".
+    const uint32_t n    = (uint32_t)-shift;
+    const uint64_t half = 1ull << (n - 1u);
+    const uint64_t rem  = prod & ((half << 1) - 1u);
+    uint64_t       q    = prod >> n;
+
+    if (rem > half || (rem == half && (q & 1u))) {
+        q++;
+    }
+    return (q > UINT32_MAX) ? UINT32_MAX : (uint32_t)q;
+}
+
+int16_t numfmt_centi(float value)
+{
+    if (value != value) {
+        return INT16_MIN;                               // NaN
+    }
+
+    const uint32_t c = numfmt_round_scaled(value, 100u);
+    if (value < 0.0f) {
+        return (c >= 32768u) ? INT16_MIN : (int16_t)-(int32_t)c;
+    }
+    return (c > 32767u) ? INT16_MAX : (int16_t)c;
+}
+
+char *numfmt_fixed1(char *p, char *end, float value, int width)
+{
+    char tmp[NUMFMT_TMP_LEN];
+    int  n = 0;
+
+    // Round to tenths like "%.1f", then work on integers only.
+    bool     neg    = value < 0.0f;
+    uint32_t tenths = numfmt_round_scaled(value, 10u);
+
+    tmp[n++] = (char)('0' + (tenths % 10u));
+    tmp[n++] = '.';
+    tenths /= 10u;
+
+    do {
+        tmp[n++] = (char)('0' + (tenths % 10u));
+        tenths /= 10u;
+    } while (tenths != 0u);
+
+    // Avoid printing "-0.0" for tiny negatives.
+    if (neg && !(n == 3 && tmp[0] == '0' && tmp[2] == '0')) {
+        tmp[n++] = '-';
+    }
+
+    return emit_reversed(p, end, tmp, n, width);
+}
+
+char *numfmt_str(char *p, char *end, const char *s)
+{
+    while (s != NULL && *s != '\0' && p < end) {
+        *p++ = *s++;
+    }
+    return p;
+}
@@ -0,0 +1,80 @@
+#include "core/rtos_alloc.h"
+#include "core/logging.h"
+
+static const char *TAG = "RTOS";
+
+app_error_t rtos_task_create(TaskFunction_t fn, const char *name, void *arg,
+                             UBaseType_t prio, BaseType_t core,
+                             rtos_task_mem_t *mem, TaskHandle_t *out)
+{
+    TaskHandle_t task = NULL;
+
+#if APP_STATIC_ALLOC
+    task = xTaskCreateStaticPinnedToCore(fn, name, mem->stack_size, arg, prio,
+                                         mem->stack, mem->tcb, core);
+#else
+    if (xTaskCreatePinnedToCore(fn, name, mem->stack_size, arg, prio,
+                                &task, core) != pdPASS) {
+        task = NULL;
+    }
+#endif
+
+    if (out != NULL) {
+        *out = task;
+    }
+    if (task == NULL) {
+        log_post(LOG_LEVEL_ERROR, TAG, "Failed to create task %s (%u B stack)",
+                 name, (unsigned)mem->stack_size);
+        return ERR_TASK_CREATE_FAILED;
+    }
+    return ERR_OK;
+}
+
+QueueHandle_t rtos_queue_create(rtos_queue_mem_t *mem)
+{
+#if APP_STATIC_ALLOC
+    QueueHandle_t q = xQueueCreateStatic(mem->length, mem->item_size,
+                                         mem->buf, mem->queue);
+#else
+    QueueHandle_t q = xQueueCreate(mem->length, mem->item_size);
+#endif
+
+    if (q == NULL) {
+        log_post(LOG_LEVEL_ERROR, TAG, "Failed to create queue (%u x %u B)",
+                 (unsigned)mem->length, (unsigned)mem->item_size);
+    }
+    return q;
+}
+
+SemaphoreHandle_t rtos_mutex_create(rtos_mutex_mem_t *mem)
+{
+#if APP_STATIC_ALLOC
+    SemaphoreHandle_t m = xSemaphoreCreateMutexStatic(mem->sem);
+#else
+    (void)mem;
+    SemaphoreHandle_t m = xSemaphoreCreateMutex();
+#endif
+
+    if (m == NULL) {
+        log_post(LOG_LEVEL_ERROR, TAG, "Failed to create mutex");
+    }
+    return m;
+}
+
+TimerHandle_t rtos_timer_create(rtos_timer_mem_t *mem, const char *name,
+                                TickType_t period, UBaseType_t auto_reload,
+                                void *id, TimerCallbackFunction_t cb)
+{
+#if APP_STATIC_ALLOC
+    TimerHandle_t t = xTimerCreateStatic(name, period, auto_reload, id, cb,
+                                         mem->timer);
+#else
+    (void)mem;
+    TimerHandle_t t = xTimerCreate(name, period, auto_reload, id, cb);
+#endif
+
+    if (t == NULL) {
+        log_post(LOG_LEVEL_ERROR, TAG, "Failed to create timer %s", name);
+    }
+    return t;
+}
@@ -0,0 +1,124 @@
+#include "core/sample_scheduler.h"
+#include "core/config.h"
+
+#include <math.h>
+#include <stddef.h>
+
+// Slopes below this are treated as "steady" (0.06 C per minute).
+#define SLOPE_EPSILON_C_PER_S   0.001f
+
+// Weight of the newest slope estimate in the moving average.
+#define SLOPE_EMA_ALPHA         0.3f
+
+static uint32_t clamp_period(const sample_scheduler_t *s, uint32_t p)
+{
+    if (p < s->min_period_ms) {
+        return s->min_period_ms;
+    }
+    if (p > s->max_period_ms) {
+        return s->max_period_ms;
+    }
+    return p;
+}
+
+void sample_scheduler_init(sample_scheduler_t *s,
+                           uint32_t min_ms,
+                           uint32_t max_ms)
+{
+    if (s == NULL) {
+        return;
+    }
+
+    if (max_ms < min_ms) {
+        max_ms = min_ms;
+    }
+
+    s->min_period_ms = min_ms;
+    s->max_period_ms = max_ms;
+    s->period_ms     = min_ms;
+    s->slope_c_per_s = 0.0f;
+    s->prev_tin_c    = 0.0f;
+    s->prev_ts_us    = 0u;
+    s->have_prev     = false;
+}
+
+uint32_t sample_scheduler_next_period(sample_scheduler_t    *s,
+                                      const sensor_sample_t *sample,
+                                      float                  setpoint_c,
+                                      float                  hysteresis_c)
+{
+    if (s == NULL) {
+        return PERIOD_SENSORS_MS;
+    }
+    if (sample == NULL) {
+        return s->period_ms;
+    }
+
+    const float tin = sample->temp_inside_c;
+
+    // --- Update smoothed slope ------------------------------------------
+    if (s->have_prev) {
+        uint64_t dt_us = sample->timestamp_us - s->prev_ts_us;
+        if (dt_us > 0u) {
+            float inst = (tin - s->prev_tin_c) * 1e6f / (float)dt_us;
+            s->slope_c_per_s += SLOPE_EMA_ALPHA * (inst - s->slope_c_per_s);
+        }
+    }
+    s->prev_tin_c = tin;
+    s->prev_ts_us = sample->timestamp_us;
+    s->have_prev  = true;
+
+    const float lo = setpoint_c - hysteresis_c;
+    const float hi = setpoint_c + hysteresis_c;
+
+    // --- Distance term ----------------------------------------------------
+    // Distance to the nearest switching threshold. Both edges matter:
+    // inside the band we may cross either one, outside we are about to
+    // cross back once the output acts.
+    float dist = fminf(fabsf(tin - lo), fabsf(tin - hi));
+
+    uint32_t span = s->max_period_ms - s->min_period_ms;
+    uint32_t p_dist;
+    if (dist >= SENSORS_ADAPT_FAR_C) {
+        p_dist = s->max_period_ms;
+    } else {
+        p_dist = s->min_period_ms +
+                 (uint32_t)((float)span * (dist / SENSORS_ADAPT_FAR_C));
+    }
+
+    // --- Slope term -------------------------------------------------------
+    // Estimate time until we reach the threshold we are heading for and
+    // make sure at least SENSORS_ADAPT_SAMPLES_TO_EDGE samples land before it.
+    uint32_t p_slope = s->max_period_ms;
+    const float slope = s->slope_c_per_s;
+
+    if (fabsf(slope) > SLOPE_EPSILON_C_PER_S) {
+        float target = (slope > 0.0f) ? hi : lo;
+
+        // If we are already past the edge in the direction of travel,
+        // look at the other edge (the one we would come back through).
+        if ((slope > 0.0f && tin >= hi) || (slope < 0.0f && tin <= lo)) {
+            target = (slope > 0.0f) ? lo : hi;
+        }
+
+        float t_edge_s = (target - tin) / slope;
+        if (t_edge_s > 0.0f) {
+            float p = t_edge_s * 1000.0f / (float)SENSORS_ADAPT_SAMPLES_TO_EDGE;
+            if (p < (float)s->max_period_ms) {
+                p_slope = (uint32_t)p;
+            }
+        }
+    }
+
+    uint32_t next = (p_dist < p_slope) ? p_dist : p_slope;
+
+    // Speed up immediately, slow down gradually (at most 2x per step) so a
+    // single quiet sample after a burst of activity does not stretch the
+    // interval all the way to max.
+    if (next > s->period_ms * 2u) {
+        next = s->period_ms * 2u;
+    }
+
+    s->period_ms = clamp_period(s, next);
+    return s->period_ms;
+}
@@ -0,0 +1,340 @@
+#include "core/spool.h"
+#include "core/logging.h"
+
+#include <string.h>
+
+static const char *TAG = "SPOOL";
+
+#define SPOOL_MAGIC     0x5350u        // "SP"; erased flash reads 0xFFFF
+#define SPOOL_HDR_LEN   12u
+
+typedef struct {
+    uint16_t magic;
+    uint16_t len;
+    uint32_t seq;
+    uint32_t crc;
+} spool_hdr_t;
+
+typedef enum {
+    REC_OK = 0,
+    REC_EMPTY,      // erased space: end of the sector's records
+    REC_BAD         // torn or corrupt frame
+} rec_status_t;
+
+static inline size_t frame_len(size_t payload_len)
+{
+    return SPOOL_HDR_LEN + ((payload_len + 3u) & ~(size_t)3u);
+}
+
+static inline size_t sector_of(const spool_t *sp, size_t off)
+{
+    return off - (off % sp->flash->sector_size);
+}
+
+static inline size_t next_sector(const spool_t *sp, size_t off)
+{
+    size_t n = sector_of(sp, off) + sp->flash->sector_size;
+    return (n >= sp->flash->size) ? 0 : n;
+}
+
+/**
+ * @brief CRC-32 (IEEE, reflected). Bitwise: records are small.
+ */
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t record_crc(const spool_hdr_t *h, const void *payload)
+{
+    uint32_t crc = crc32_update(0, h, offsetof(spool_hdr_t, crc));
+    return crc32_update(crc, payload, h->len);
+}
+
+/**
+ * @brief Read and validate the record at @p off.
+ *
+ * @param[out] payload Optional payload destination (SPOOL_MAX_PAYLOAD bytes)
+ */
+static rec_status_t read_record(spool_t *sp, size_t off,
+                                spool_hdr_t *h, uint8_t *payload)
+{
+    uint8_t scratch[SPOOL_MAX_PAYLOAD];
+    uint8_t *buf = (payload != NULL) ? payload : scratch;
+
+    // Room for a header before the end of the sector?
+    if (off + SPOOL_HDR_LEN > sector_of(sp, off) + sp->flash->sector_size) {
+        return REC_EMPTY;
+    }
+
+    if (sp->flash->read(sp->flash->ctx, off, h, sizeof(*h)) != 0) {
+        sp->stats.io_errors++;
+        return REC_BAD;
+    }
+    if (h->magic == 0xFFFFu && h->len == 0xFFFFu) {
+        return REC_EMPTY;
+    }
+    if (h->magic != SPOOL_MAGIC || h->len > SPOOL_MAX_PAYLOAD ||
+        off + frame_len(h->len) > sector_of(sp, off) + sp->flash->sector_size) {
+        return REC_BAD;
+    }
+
+    if (sp->flash->read(sp->flash->ctx, off + SPOOL_HDR_LEN, buf, h->len) != 0) {
+        sp->stats.io_errors++;
+        return REC_BAD;
+    }
+
+    return (record_crc(h, buf) == h->crc) ? REC_OK : REC_BAD;
+}
+
+/* ---------------- Open / recovery ---------------- */
+
+app_error_t spool_open(spool_t *sp, const spool_flash_t *flash, uint32_t ack_seq)
+{
+    if (sp == NULL || flash == NULL || flash->sector_size == 0 ||
+        flash->size < 2 * flash->sector_size ||
+        (flash->size % flash->sector_size) != 0) {
+        return ERR_GENERIC;
+    }
+
+    memset(sp, 0, sizeof(*sp));
+    sp->flash   = flash;
+    sp->ack_seq = ack_seq;
+
+    uint32_t max_seq   = 0;       // newest record
+    size_t   max_end   = 0;       // position after it
+    bool     max_dirty = false;   // its sector has a torn record after it
+
+    uint32_t first_seq = 0;       // oldest record newer than ack_seq
+    size_t   first_off = 0;
+
+    for (size_t sec = 0; sec < flash->size; sec += flash->sector_size) {
+        size_t off   = sec;
+        bool   dirty = false;
+        bool   has_max = false;
+
+        while (1) {
+            spool_hdr_t  h;
+            rec_status_t st = read_record(sp, off, &h, NULL);
+            if (st == REC_EMPTY) {
+                break;
+            }
+            if (st == REC_BAD) {
+                sp->stats.crc_errors++;
+                dirty = true;
+                break;
+            }
+
+            if (h.seq > max_seq) {
+                max_seq = h.seq;
+                max_end = off + frame_len(h.len);
+                has_max = true;
+            }
+            if (h.seq > ack_seq && (first_seq == 0 || h.seq < first_seq)) {
+                first_seq = h.seq;
+                first_off = off;
+            }
+            off += frame_len(h.len);
+        }
+
+        if (has_max) {
+            max_dirty = dirty;
+        }
+    }
+
+    if (max_seq == 0) {
+        // Empty region.
+        sp->write_off = 0;
+    } else if (max_dirty) {
+        // Never write behind a torn frame; continue in a fresh sector.
+        sp->write_off = next_sector(sp, max_end);
+    } else {
+        sp->write_off = max_end;
+    }
+
+    sp->next_seq = ((max_seq > ack_seq) ? max_seq : ack_seq) + 1u;
+
+    if (first_seq != 0) {
+        sp->read_off = first_off;
+        sp->read_seq = first_seq;
+        if (first_seq > ack_seq + 1u) {
+            // Unacknowledged records were overwritten before the reset.
+            sp->stats.lost += first_seq - ack_seq - 1u;
+        }
+    } else {
+        sp->read_off = sp->write_off;
+        sp->read_seq = sp->next_seq;
+    }
+
+    log_post(LOG_LEVEL_INFO, TAG,
+             "Spool open: %lu pending (seq %lu..%lu), ack=%lu, crc_errors=%lu",
+             (unsigned long)spool_pending(sp),
+             (unsigned long)sp->read_seq,
+             (unsigned long)(sp->next_seq - 1u),
+             (unsigned long)ack_seq,
+             (unsigned long)sp->stats.crc_errors);
+
+    return ERR_OK;
+}
+
+/* ---------------- Append ---------------- */
+
+/**
+ * @brief Erase the sector at write_off, moving the replay position past it
+ *        if it still held unacknowledged records.
+ */
+static app_error_t erase_for_write(spool_t *sp)
+{
+    const size_t sec = sp->write_off;
+
+    if (spool_pending(sp) > 0 && sector_of(sp, sp->read_off) == sec) {
+        // Count what is about to be lost.
+        size_t off = sec;
+        while (1) {
+            spool_hdr_t h;
+            if (read_record(sp, off, &h, NULL) != REC_OK) {
+                break;
+            }
+            if (h.seq >= sp->read_seq) {
+                sp->stats.lost++;
+            }
+            off += frame_len(h.len);
+        }
+
+        // The oldest surviving records start in the following sector.
+        spool_hdr_t h;
+        size_t nxt = next_sector(sp, sec);
+        if (read_record(sp, nxt, &h, NULL) == REC_OK && h.seq >= sp->read_seq) {
+            sp->read_off = nxt;
+            sp->read_seq = h.seq;
+        } else {
+            sp->read_off = sec;
+            sp->read_seq = sp->next_seq;
+        }
+        log_post(LOG_LEVEL_WARN, TAG, "Spool full, dropped oldest sector (lost=%lu)",
+                 (unsigned long)sp->stats.lost);
+    }
+
+    if (sp->flash->erase_sector(sp->flash->ctx, sec) != 0) {
+        sp->stats.io_errors++;
+        return ERR_GENERIC;
+    }
+    return ERR_OK;
+}
+
+app_error_t spool_append(spool_t *sp, const void *payload, size_t len)
+{
+    if (sp == NULL || sp->flash == NULL || payload == NULL || len > SPOOL_MAX_PAYLOAD) {
+        return ERR_GENERIC;
+    }
+
+    const size_t flen = frame_len(len);
+
+    if (sp->write_off + flen > sector_of(sp, sp->write_off) + sp->flash->sector_size) {
+        sp->write_off = next_sector(sp, sp->write_off);
+    }
+
+    if ((sp->write_off % sp->flash->sector_size) == 0) {
+        if (erase_for_write(sp) != ERR_OK) {
+            return ERR_GENERIC;
+        }
+    }
+
+    // Build the whole frame so it goes out in a single write.
+    uint8_t frame[SPOOL_HDR_LEN + SPOOL_MAX_PAYLOAD];
+    spool_hdr_t h = {
+        .magic = SPOOL_MAGIC,
+        .len   = (uint16_t)len,
+        .seq   = sp->next_seq,
+    };
+    h.crc = record_crc(&h, payload);
+
+    memset(frame, 0xFF, flen);
+    memcpy(frame, &h, sizeof(h));
+    memcpy(frame + SPOOL_HDR_LEN, payload, len);
+
+    if (sp->flash->write(sp->flash->ctx, sp->write_off, frame, flen) != 0) {
+        // Whatever landed is garbage now; start over in the next sector.
+        sp->stats.io_errors++;
+        sp->write_off = next_sector(sp, sp->write_off);
+        return ERR_GENERIC;
+    }
+
+    if (spool_pending(sp) == 0) {
+        sp->read_off = sp->write_off;
+        sp->read_seq = sp->next_seq;
+    }
+
+    sp->write_off += flen;
+    sp->next_seq++;
+    sp->stats.appended++;
+
+    return ERR_OK;
+}
+
+/* ---------------- Replay ---------------- */
+
+uint32_t spool_pending(const spool_t *sp)
+{
+    return sp->next_seq - sp->read_seq;
+}
+
+void spool_iter_begin(const spool_t *sp, spool_iter_t *it)
+{
+    it->off      = sp->read_off;
+    it->last_seq = sp->read_seq - 1u;
+}
+
+bool spool_read_next(spool_t *sp, spool_iter_t *it, void *buf, size_t *out_len)
+{
+    const size_t nsectors = sp->flash->size / sp->flash->sector_size;
+    size_t hops = 0;
+
+    while (it->last_seq + 1u < sp->next_seq) {
+        spool_hdr_t  h;
+        rec_status_t st = read_record(sp, it->off, &h, buf);
+
+        if (st == REC_OK) {
+            if (h.seq <= it->last_seq) {
+                return false;   // wrapped into older data
+            }
+            it->off      = it->off + frame_len(h.len);
+            it->last_seq = h.seq;
+            *out_len     = h.len;
+            return true;
+        }
+
+        if (st == REC_BAD) {
+            sp->stats.crc_errors++;
+        }
+
+        // End of this sector's records: continue with the next sector.
+        it->off = next_sector(sp, it->off);
+        if (++hops > nsectors) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+void spool_ack(spool_t *sp, const spool_iter_t *it)
+{
+    if ((int32_t)(it->last_seq - sp->ack_seq) <= 0) {
+        return;
+    }
+
+    sp->stats.replayed += it->last_seq + 1u - sp->read_seq;
+    sp->ack_seq  = it->last_seq;
+    sp->read_off = it->off;
+    sp->read_seq = it->last_seq + 1u;
+}
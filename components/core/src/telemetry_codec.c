@@ -0,0 +1,245 @@
+#include "core/telemetry_codec.h"
+#include "core/numfmt.h"
+#include "core/timeutil.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ---------------- Records ---------------- */
+
+void telemetry_record_from_state(const thermostat_state_t *st, time_t now_epoch,
+                                 uint64_t now_us, telemetry_record_t *rec)
+{
+    const uint64_t age_us = (now_us > st->timestamp_us) ? now_us - st->timestamp_us : 0u;
+    rec->epoch_s      = (uint32_t)(now_epoch - (time_t)(age_us / 1000000u));
+    rec->mode         = (uint8_t)st->mode;
+    rec->output       = (uint8_t)st->output;
+    rec->flags        = 0;
+    rec->boot_id      = 0;
+    rec->setpoint_c   = st->setpoint_c;
+    rec->hysteresis_c = st->hysteresis_c;
+    rec->tin_c        = st->tin_c;
+    rec->tout_c       = st->tout_c;
+}
+
+/* ---------------- Protobuf wire primitives ---------------- */
+
+#define PB_WT_VARINT   0u
+#define PB_WT_LEN      2u
+
+typedef struct {
+    uint8_t *p;
+    uint8_t *end;
+    bool     overflow;
+} pb_writer_t;
+
+static void pb_put_varint(pb_writer_t *w, uint32_t v)
+{
+    do {
+        if (w->p >= w->end) {
+            w->overflow = true;
+            return;
+        }
+        uint8_t b = (uint8_t)(v & 0x7Fu);
+        v >>= 7;
+        *w->p++ = (v != 0) ? (uint8_t)(b | 0x80u) : b;
+    } while (v != 0);
+}
+
+static inline uint32_t pb_zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline void pb_put_tag(pb_writer_t *w, uint32_t field, uint32_t wire_type)
+{
+    pb_put_varint(w, (field << 3) | wire_type);
+}
+
+// proto3: default (zero) values are not emitted.
+static void pb_put_uint(pb_writer_t *w, uint32_t field, uint32_t v)
+{
+    if (v != 0) {
+        pb_put_tag(w, field, PB_WT_VARINT);
+        pb_put_varint(w, v);
+    }
+}
+
+static void pb_put_sint(pb_writer_t *w, uint32_t field, int32_t v)
+{
+    if (v != 0) {
+        pb_put_tag(w, field, PB_WT_VARINT);
+        pb_put_varint(w, pb_zigzag(v));
+    }
+}
+
+static void pb_put_bytes(pb_writer_t *w, uint32_t field, const void *data, size_t len)
+{
+    pb_put_tag(w, field, PB_WT_LEN);
+    pb_put_varint(w, (uint32_t)len);
+    if ((size_t)(w->end - w->p) < len) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->p, data, len);
+    w->p += len;
+}
+
+/* ---------------- Protobuf batch ---------------- */
+
+// Field numbers from proto/telemetry.proto
+enum {
+    BATCH_DEVICE_ID = 1,
+    BATCH_BASE_EPOCH,
+    BATCH_BASE_TIN,
+    BATCH_BASE_TOUT,
+    BATCH_BASE_SETPOINT,
+    BATCH_BASE_HYST,
+    BATCH_SAMPLES
+};
+
+enum {
+    SAMPLE_DT = 1,
+    SAMPLE_D_TIN,
+    SAMPLE_D_TOUT,
+    SAMPLE_D_SETPOINT,
+    SAMPLE_D_HYST,
+    SAMPLE_MODE_OUTPUT
+};
+
+typedef struct {
+    uint32_t epoch_s;
+    int32_t  tin, tout, sp, hyst;
+} pb_prev_t;
+
+size_t telemetry_encode_pb(const char *device_id,
+                           const telemetry_record_t *recs, size_t n,
+                           uint8_t *buf, size_t cap)
+{
+    pb_writer_t w = { .p = buf, .end = buf + cap, .overflow = false };
+
+    pb_put_bytes(&w, BATCH_DEVICE_ID, device_id, strlen(device_id));
+
+    pb_prev_t prev = {0};
+    if (n > 0) {
+        prev.epoch_s = recs[0].epoch_s;
+        prev.tin     = numfmt_centi(recs[0].tin_c);
+        prev.tout    = numfmt_centi(recs[0].tout_c);
+        prev.sp      = numfmt_centi(recs[0].setpoint_c);
+        prev.hyst    = numfmt_centi(recs[0].hysteresis_c);
+
+        pb_put_uint(&w, BATCH_BASE_EPOCH,    prev.epoch_s);
+        pb_put_sint(&w, BATCH_BASE_TIN,      prev.tin);
+        pb_put_sint(&w, BATCH_BASE_TOUT,     prev.tout);
+        pb_put_sint(&w, BATCH_BASE_SETPOINT, prev.sp);
+        pb_put_sint(&w, BATCH_BASE_HYST,     prev.hyst);
+    }
+
+    for (size_t i = 0; i < n && !w.overflow; i++) {
+        const telemetry_record_t *r = &recs[i];
+
+        int32_t tin  = numfmt_centi(r->tin_c);
+        int32_t tout = numfmt_centi(r->tout_c);
+        int32_t sp   = numfmt_centi(r->setpoint_c);
+        int32_t hyst = numfmt_centi(r->hysteresis_c);
+
+        // A sample is at most 6 fields of <= 5-byte varints; encode it
+        // into scratch first to learn its length prefix.
+        uint8_t     tmp[40];
+        pb_writer_t s = { .p = tmp, .end = tmp + sizeof(tmp), .overflow = false };
+
+        // Signed: the clock may step back (SNTP correction, replayed
+        // records from before a reboot).
+        pb_put_sint(&s, SAMPLE_DT,          (int32_t)(r->epoch_s - prev.epoch_s));
+        pb_put_sint(&s, SAMPLE_D_TIN,       tin  - prev.tin);
+        pb_put_sint(&s, SAMPLE_D_TOUT,      tout - prev.tout);
+        pb_put_sint(&s, SAMPLE_D_SETPOINT,  sp   - prev.sp);
+        pb_put_sint(&s, SAMPLE_D_HYST,      hyst - prev.hyst);
+        pb_put_uint(&s, SAMPLE_MODE_OUTPUT, (uint32_t)r->mode | ((uint32_t)r->output << 4));
+
+        pb_put_bytes(&w, BATCH_SAMPLES, tmp, (size_t)(s.p - tmp));
+
+        prev.epoch_s = r->epoch_s;
+        prev.tin     = tin;
+        prev.tout    = tout;
+        prev.sp      = sp;
+        prev.hyst    = hyst;
+    }
+
+    return w.overflow ? 0 : (size_t)(w.p - buf);
+}
+
+/* ---------------- JSON batch ---------------- */
+
+size_t telemetry_encode_json(const char *device_id,
+                             const telemetry_record_t *recs, size_t n,
+                             char *buf, size_t cap)
+{
+    int len = snprintf(buf, cap,
+                       "{\"device_id\":\"%s\",\"samples\":[",
+                       device_id);
+    if (len <= 0 || (size_t)len >= cap) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const telemetry_record_t *r = &recs[i];
+
+        char iso[32];
+        if (!timeutil_format_iso8601((time_t)r->epoch_s, iso, sizeof(iso))) {
+            iso[0] = '\0';
+        }
+
+        int w = snprintf(buf + len, cap - (size_t)len,
+            "%s{"
+              "\"mode\":\"%s\","
+              "\"temp_inside_c\":%.2f,"
+              "\"temp_outside_c\":%.2f,"
+              "\"setpoint_c\":%.2f,"
+              "\"hysteresis_c\":%.2f,"
+              "\"output\":\"%s\","
+              "\"timestamp\":\"%s\""
+            "}",
+            (i == 0) ? "" : ",",
+            thermostat_mode_to_str((thermostat_mode_t)r->mode),
+            r->tin_c,
+            r->tout_c,
+            r->setpoint_c,
+            r->hysteresis_c,
+            thermostat_output_to_str((thermostat_output_t)r->output),
+            iso);
+
+        if (w <= 0 || (size_t)w >= cap - (size_t)len) {
+            return 0;
+        }
+        len += w;
+    }
+
+    if ((size_t)len + 3 > cap) {
+        return 0;
+    }
+    memcpy(buf + len, "]}", 3);
+    return (size_t)len + 2;
+}
+
+size_t telemetry_encode_state_json(const thermostat_state_t *st,
+                                   char *buf, size_t cap)
+{
+    int len = snprintf(buf, cap,
+        "{"
+          "\"mode\":\"%s\","
+          "\"output\":\"%s\","
+          "\"setpoint_c\":%.2f,"
+          "\"hysteresis_c\":%.2f"
+        "}",
+        thermostat_mode_to_str(st->mode),
+        thermostat_output_to_str(st->output),
+        st->setpoint_c,
+        st->hysteresis_c);
+
+    if (len <= 0 || (size_t)len >= cap) {
+        return 0;
+    }
+    return (size_t)len;
+}
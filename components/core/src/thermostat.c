@@ -11,6 +11,11 @@ static const char *TAG = "TH_CORE";
 static thermostat_state_t s_state;
 static bool s_initialized = false;
 
+// Requested mode. Written only by thermostat_set_mode() (any task), read
+// once per cycle by the core; s_state.mode is just the snapshot of the
+// mode the last decision used, so a cycle never writes a stale mode back.
+static volatile thermostat_mode_t s_mode = THERMOSTAT_MODE_HEAT;
+
 /**
  * @brief Initialize thermostat core and underlying configuration.
  */
@@ -42,7 +47,7 @@ app_error_t thermostat_core_init(void)
     s_state.hysteresis_c = cfg.hysteresis_c;
     s_state.tin_c        = 0.0f;
     s_state.tout_c       = 0.0f;
-    s_state.timestamp_ms = 0u;
+    s_state.timestamp_us = 0u;
 
     s_initialized = true;
 
@@ -89,7 +94,7 @@ app_error_t thermostat_core_process_sample(
 
     // Start from previous output to preserve hysteresis behavior.
     thermostat_output_t output = s_state.output;
-    thermostat_mode_t mode = s_state.mode;
+    const thermostat_mode_t mode = __atomic_load_n(&s_mode, __ATOMIC_ACQUIRE);
 
     switch (mode) {
 
@@ -151,7 +156,7 @@ app_error_t thermostat_core_process_sample(
     s_state.hysteresis_c = hyst;
     s_state.tin_c        = tin;
     s_state.tout_c       = tout;
-    s_state.timestamp_ms = sample->timestamp_ms;
+    s_state.timestamp_us = sample->timestamp_us;
     s_state.output       = output;
     s_state.mode         = mode;
 
@@ -186,13 +191,9 @@ app_error_t thermostat_set_mode(thermostat_mode_t mode)
     case THERMOSTAT_MODE_HEAT:
     case THERMOSTAT_MODE_COOL:
     case THERMOSTAT_MODE_AUTO:
-        // valid modes
-        s_state.mode = mode;
-
-        // In OFF mode, force outputs OFF immediately
-        if (mode == THERMOSTAT_MODE_OFF) {
-            s_state.output = THERMOSTAT_OUTPUT_OFF;
-        }
+        // valid modes; the next decision (callers kick CONTROL) applies
+        // it, OFF included. The core owns s_state, so nothing else here.
+        __atomic_store_n(&s_mode, mode, __ATOMIC_RELEASE);
 
         log_post(LOG_LEVEL_INFO, TAG, "Mode set to %d", (int)mode);
         return ERR_OK;
@@ -219,7 +220,7 @@ app_error_t thermostat_get_mode(thermostat_mode_t *out_mode)
         return ERR_GENERIC;
     }
 
-    *out_mode = s_state.mode;
+    *out_mode = __atomic_load_n(&s_mode, __ATOMIC_ACQUIRE);
     return ERR_OK;
 }
 
@@ -229,7 +230,7 @@ app_error_t thermostat_get_mode(thermostat_mode_t *out_mode)
  * Thread-safe in the sense that s_state is only updated inside the core
  * and this function returns a simple struct copy.
  */
-app_error_t thermostat_get_state_snapshot(thermostat_state_t *out_state)
+app_error_t thermostat_get_state(thermostat_state_t *out_state)
 {
     if (!out_state) {
         return ERR_GENERIC;
@@ -241,3 +242,23 @@ app_error_t thermostat_get_state_snapshot(thermostat_state_t *out_state)
     *out_state = s_state;
     return ERR_OK;
 }
+
+const char *thermostat_mode_to_str(thermostat_mode_t mode)
+{
+    switch (mode) {
+    case THERMOSTAT_MODE_OFF:  return "OFF";
+    case THERMOSTAT_MODE_HEAT: return "HEAT";
+    case THERMOSTAT_MODE_COOL: return "COOL";
+    case THERMOSTAT_MODE_AUTO: return "AUTO";
+    default:                   return "UNKNOWN";
+    }
+}
+
+const char *thermostat_output_to_str(thermostat_output_t output)
+{
+    switch (output) {
+    case THERMOSTAT_OUTPUT_HEAT_ON: return "HEAT_ON";
+    case THERMOSTAT_OUTPUT_COOL_ON: return "COOL_ON";
+    default:                        return "OFF";
+    }
+}
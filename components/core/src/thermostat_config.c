@@ -1,9 +1,13 @@
 #include "core/thermostat_config.h"
 #include "core/config.h"
 #include "core/logging.h"
+#include "core/rtos_alloc.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/timers.h"
+
+#include <math.h>
 
 static const char *TAG = "TH_CFG";
 
@@ -12,13 +16,80 @@ static thermostat_config_t s_cfg;
 
 // Mutex to protect s_cfg from concurrent access.
 static SemaphoreHandle_t s_cfg_mutex = NULL;
+RTOS_MUTEX_MEM(s_cfg_mutex_mem);
+
+// Deferred change notification (coalesces bursts of updates).
+static TimerHandle_t s_notify_timer = NULL;
+RTOS_TIMER_MEM(s_notify_timer_mem);
+static bool          s_dirty = false;          // protected by s_cfg_mutex
+
+static thermostat_config_listener_t s_listener     = NULL;
+static void                        *s_listener_ctx = NULL;
+
+static void clamp_config(thermostat_config_t *cfg)
+{
+    if (cfg->setpoint_c < THERMOSTAT_SP_MIN_C) {
+        cfg->setpoint_c = THERMOSTAT_SP_MIN_C;
+    } else if (cfg->setpoint_c > THERMOSTAT_SP_MAX_C) {
+        cfg->setpoint_c = THERMOSTAT_SP_MAX_C;
+    }
+
+    if (cfg->hysteresis_c < THERMOSTAT_HYST_MIN_C) {
+        cfg->hysteresis_c = THERMOSTAT_HYST_MIN_C;
+    } else if (cfg->hysteresis_c > THERMOSTAT_HYST_MAX_C) {
+        cfg->hysteresis_c = THERMOSTAT_HYST_MAX_C;
+    }
+}
+
+/**
+ * @brief Timer service callback: report the settled config once.
+ *
+ * Timer callbacks must not block: if an update holds the mutex right
+ * now, try again one coalescing window later (that update is part of the
+ * same burst anyway). log_post() and the listener never block either.
+ * The record and the float formatting are what
+ * CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH is sized for.
+ */
+static void notify_timer_cb(TimerHandle_t t)
+{
+    thermostat_config_t snap;
+
+    if (xSemaphoreTake(s_cfg_mutex, 0) != pdTRUE) {
+        xTimerStart(t, 0);
+        return;
+    }
+    snap = s_cfg;
+    const bool dirty = s_dirty;
+    s_dirty = false;
+    xSemaphoreGive(s_cfg_mutex);
+
+    if (!dirty) {
+        return;
+    }
+
+    log_post(LOG_LEVEL_INFO, TAG,
+             "Update setpoint=%.2fC hysteresis=%.2fC",
+             snap.setpoint_c, snap.hysteresis_c);
+
+    thermostat_config_listener_t fn = s_listener;
+    if (fn != NULL) {
+        fn(&snap, s_listener_ctx);
+    }
+}
 
 app_error_t thermostat_config_init(void)
 {
     // Create mutex once.
-    s_cfg_mutex = xSemaphoreCreateMutex();
+    s_cfg_mutex = rtos_mutex_create(&s_cfg_mutex_mem);
     if (s_cfg_mutex == NULL) {
-        log_post(LOG_LEVEL_ERROR, TAG, "Failed to create config mutex");
+        return ERR_GENERIC;
+    }
+
+    // One-shot; started by the first update of a burst.
+    s_notify_timer = rtos_timer_create(&s_notify_timer_mem, "cfg_notify",
+                                       pdMS_TO_TICKS(THERMOSTAT_CONFIG_COALESCE_MS),
+                                       pdFALSE, NULL, notify_timer_cb);
+    if (s_notify_timer == NULL) {
         return ERR_GENERIC;
     }
 
@@ -53,27 +124,78 @@ app_error_t thermostat_config_get(thermostat_config_t *out_cfg)
     return ERR_GENERIC;
 }
 
+static void replace_config(thermostat_config_t *cfg, void *ctx)
+{
+    *cfg = *(const thermostat_config_t *)ctx;
+}
+
 app_error_t thermostat_config_set(const thermostat_config_t *new_cfg)
 {
     if (new_cfg == NULL) {
         return ERR_GENERIC;
     }
 
-    if (s_cfg_mutex == NULL) {
+    return thermostat_config_update(replace_config, (void *)new_cfg, NULL);
+}
+
+app_error_t thermostat_config_update(thermostat_config_mutator_t fn, void *ctx,
+                                     thermostat_config_t *out_cfg)
+{
+    if (fn == NULL) {
         return ERR_GENERIC;
     }
 
-    if (xSemaphoreTake(s_cfg_mutex, portMAX_DELAY) == pdTRUE) {
+    if (s_cfg_mutex == NULL) {
+        return ERR_GENERIC;
+    }
 
-        s_cfg = *new_cfg;  // struct copy
+    if (xSemaphoreTake(s_cfg_mutex, portMAX_DELAY) != pdTRUE) {
+        return ERR_GENERIC;
+    }
 
-        log_post(LOG_LEVEL_INFO, TAG,
-                 "Update setpoint=%.2fC hysteresis=%.2fC",
-                 s_cfg.setpoint_c, s_cfg.hysteresis_c);
+    thermostat_config_t next = s_cfg;
+    fn(&next, ctx);
 
+    // NaN would slip through the clamps and stop the controller from
+    // ever switching; refuse the update and keep the current config.
+    if (!isfinite(next.setpoint_c) || !isfinite(next.hysteresis_c)) {
         xSemaphoreGive(s_cfg_mutex);
-        return ERR_OK;
+        log_post(LOG_LEVEL_WARN, TAG, "Rejected non-finite config update");
+        return ERR_GENERIC;
     }
+    clamp_config(&next);
 
-    return ERR_GENERIC;
+    bool changed = (next.setpoint_c   != s_cfg.setpoint_c) ||
+                   (next.hysteresis_c != s_cfg.hysteresis_c);
+
+    s_cfg = next;  // publish
+    if (changed) {
+        s_dirty = true;
+    }
+    if (out_cfg != NULL) {
+        *out_cfg = next;
+    }
+
+    xSemaphoreGive(s_cfg_mutex);
+
+    // Arm but never push back a pending notification, so a long
+    // auto-repeat sweep still reports at most every COALESCE_MS.
+    if (changed && xTimerIsTimerActive(s_notify_timer) == pdFALSE) {
+        xTimerStart(s_notify_timer, 0);
+    }
+
+    return ERR_OK;
+}
+
+bool thermostat_config_held_by(void *task)
+{
+    return s_cfg_mutex != NULL && task != NULL &&
+           xSemaphoreGetMutexHolder(s_cfg_mutex) == (TaskHandle_t)task;
+}
+
+void thermostat_config_set_listener(thermostat_config_listener_t fn, void *ctx)
+{
+    // Expected to be called once during start-up, before updates begin.
+    s_listener_ctx = ctx;
+    s_listener     = fn;
 }
@@ -0,0 +1,202 @@
+#include "core/timefmt.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include <string.h>
+
+// Shortest DST (or standard) period we assume when searching for the
+// edges of the current UTC offset; real zones are months long.
+#define TZ_PROBE_STEP_S     (7 * 86400)
+#define TZ_PROBE_MAX_S      (400 * 86400)
+
+// Everything below is guarded by s_lock.
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Local UTC offset, valid for epoch seconds in [s_tz_lo, s_tz_hi).
+static int32_t s_tz_offset_s = 0;
+static int64_t s_tz_lo       = 0;
+static int64_t s_tz_hi       = 0;     // lo == hi: empty
+
+// Last string produced by timefmt_iso8601().
+static int64_t s_iso_t = -1;
+static char    s_iso[32];
+
+/* ---------------- Civil calendar (proleptic Gregorian, UTC) ---------------- */
+
+// Days since 1970-01-01 -> y/m/d. Era-based, exact for any int64 day.
+void timefmt_civil_from_days(int64_t z, int32_t *y, uint32_t *m, uint32_t *d)
+{
+    z += 719468;
+    const int64_t  era = (z >= 0 ? z : z - 146096) / 146097;
+    const uint32_t doe = (uint32_t)(z - era * 146097);
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp  = (5 * doy + 2) / 153;
+
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = (mp < 10) ? mp + 3 : mp - 9;
+    *y = (int32_t)(yoe + era * 400 + (*m <= 2));
+}
+
+int64_t timefmt_days_from_civil(int32_t y, uint32_t m, uint32_t d)
+{
+    y -= (m <= 2);
+    const int64_t  era = (y >= 0 ? y : y - 399) / 400;
+    const uint32_t yoe = (uint32_t)(y - era * 400);
+    const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+/* ---------------- Time zone offset cache ---------------- */
+
+// The only libc TZ evaluation left: local - UTC for one instant.
+static int32_t tz_offset_at(int64_t t)
+{
+    time_t    tt = (time_t)t;
+    struct tm lt;
+    localtime_r(&tt, &lt);
+
+    const int64_t local = timefmt_days_from_civil(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday) * 86400 +
+                          lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec;
+    return (int32_t)(local - t);
+}
+
+// Edge of the period with offset @p off around @p t, searching in
+// direction @p dir (+1: first second with a different offset; -1: first
+// second of the period).
+static int64_t tz_find_edge(int64_t t, int32_t off, int dir)
+{
+    int64_t same = t;
+    int64_t diff = t;
+    bool    found = false;
+
+    for (int64_t step = TZ_PROBE_STEP_S; step <= TZ_PROBE_MAX_S; step += TZ_PROBE_STEP_S) {
+        diff = t + dir * step;
+        if (tz_offset_at(diff) != off) {
+            found = true;
+            break;
+        }
+        same = diff;
+    }
+    if (!found) {
+        return same;     // no DST (or beyond the probe window)
+    }
+
+    // Offset changes somewhere in (same, diff]: bisect to the second.
+    while ((dir > 0) ? (diff - same > 1) : (same - diff > 1)) {
+        const int64_t mid = same + (diff - same) / 2;
+        if (tz_offset_at(mid) == off) {
+            same = mid;
+        } else {
+            diff = mid;
+        }
+    }
+    return (dir > 0) ? diff : same;
+}
+
+// Call with s_lock NOT held: the search runs localtime_r many times.
+static int32_t tz_offset_cached(int64_t t)
+{
+    taskENTER_CRITICAL(&s_lock);
+    if (t >= s_tz_lo && t < s_tz_hi) {
+        const int32_t off = s_tz_offset_s;
+        taskEXIT_CRITICAL(&s_lock);
+        return off;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    // Miss: only at a DST boundary, a clock jump or a far back-dated
+    // sample. Find the whole period so both live and replayed times hit.
+    const int32_t off = tz_offset_at(t);
+    const int64_t lo  = tz_find_edge(t, off, -1);
+    const int64_t hi  = tz_find_edge(t, off, +1);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_tz_offset_s = off;
+    s_tz_lo       = lo;
+    s_tz_hi       = (hi > t) ? hi : t + 1;
+    s_iso_t       = -1;
+    taskEXIT_CRITICAL(&s_lock);
+    return off;
+}
+
+/* ---------------- ISO8601 formatting ---------------- */
+
+static inline void put2(char *p, uint32_t v)
+{
+    p[0] = (char)('0' + v / 10);
+    p[1] = (char)('0' + v % 10);
+}
+
+// "YYYY-MM-DDTHH:MM:SS+hhmm" (strftime "%Y-%m-%dT%H:%M:%S%z"), 24 chars.
+static void format_full(char *out, int64_t t, int32_t off)
+{
+    const int64_t local = t + off;
+    int64_t       days  = local / 86400;
+    int64_t       sod   = local % 86400;
+    if (sod < 0) {
+        sod  += 86400;
+        days -= 1;
+    }
+
+    int32_t  y;
+    uint32_t m, d;
+    timefmt_civil_from_days(days, &y, &m, &d);
+
+    const uint32_t yy = (uint32_t)((y < 0) ? 0 : (y > 9999 ? 9999 : y));
+    put2(out + 0, yy / 100);
+    put2(out + 2, yy % 100);
+    out[4] = '-';
+    put2(out + 5, m);
+    out[7] = '-';
+    put2(out + 8, d);
+    out[10] = 'T';
+    put2(out + 11, (uint32_t)(sod / 3600));
+    out[13] = ':';
+    put2(out + 14, (uint32_t)(sod / 60 % 60));
+    out[16] = ':';
+    put2(out + 17, (uint32_t)(sod % 60));
+
+    const uint32_t aoff = (uint32_t)((off < 0) ? -off : off);
+    out[19] = (off < 0) ? '-' : '+';
+    put2(out + 20, aoff / 3600);
+    put2(out + 22, aoff / 60 % 60);
+    out[24] = '\0';
+}
+
+/* ---------------- Public API ---------------- */
+
+void timefmt_tz_changed(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_tz_lo = s_tz_hi = 0;
+    s_iso_t = -1;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+bool timefmt_iso8601(time_t t, char *buf, size_t buf_len)
+{
+    if (buf_len < 32) {
+        return false;
+    }
+
+    const int32_t off = tz_offset_cached((int64_t)t);
+
+    taskENTER_CRITICAL(&s_lock);
+    if (s_iso_t >= 0 && t >= 0 && (int64_t)t / 60 == s_iso_t / 60 && (off % 60) == 0 &&
+        off == s_tz_offset_s && (int64_t)t >= s_tz_lo && (int64_t)t < s_tz_hi) {
+        // Same minute as last time: only the seconds digits move.
+        if ((int64_t)t != s_iso_t) {
+            put2(s_iso + 17, (uint32_t)((int64_t)t % 60));
+            s_iso_t = t;
+        }
+    } else {
+        format_full(s_iso, (int64_t)t, off);
+        s_iso_t = t;
+    }
+    memcpy(buf, s_iso, 25);
+    taskEXIT_CRITICAL(&s_lock);
+
+    return true;
+}
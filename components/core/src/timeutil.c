@@ -1,23 +1,66 @@
 #include "core/timeutil.h"
+#include "core/timefmt.h"
+#include "core/monotime.h"
+#include "core/boot.h"
 
 #include "esp_sntp.h"
 #include "esp_netif_sntp.h"
 #include "esp_log.h"
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
 #include <time.h>
 #include <sys/time.h>
 
 static const char *TAG = "TIMEUTIL";
 
-static bool s_time_set = false;
+#define TIME_SET_BIT   (1u << 0)
+
+static StaticEventGroup_t s_events_buf;
+static EventGroupHandle_t s_events = NULL;
+static portMUX_TYPE       s_events_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Guards s_epoch_offset_us.
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// UTC (us since epoch) = monotime_now_us() + s_epoch_offset_us.
+static int64_t s_epoch_offset_us = 0;
+
+// Created on first use: waiters may start before SNTP is initialized.
+static EventGroupHandle_t time_events(void)
+{
+    EventGroupHandle_t eg = __atomic_load_n(&s_events, __ATOMIC_ACQUIRE);
+    if (eg != NULL) {
+        return eg;
+    }
+
+    taskENTER_CRITICAL(&s_events_lock);
+    if (s_events == NULL) {
+        __atomic_store_n(&s_events, xEventGroupCreateStatic(&s_events_buf),
+                         __ATOMIC_RELEASE);
+    }
+    eg = s_events;
+    taskEXIT_CRITICAL(&s_events_lock);
+    return eg;
+}
 
 static void time_sync_cb(struct timeval *tv)
 {
-    (void)tv;
-    s_time_set = true;
+    const int64_t utc_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+    const int64_t mono   = (int64_t)monotime_now_us();
+
+    taskENTER_CRITICAL(&s_lock);
+    s_epoch_offset_us = utc_us - mono;
+    taskEXIT_CRITICAL(&s_lock);
+
+    xEventGroupSetBits(time_events(), TIME_SET_BIT);
+    boot_mark(BOOT_STAGE_TIME_SET);
     ESP_LOGI(TAG, "Time synchronized via SNTP");
 }
 
+/* ---------------- Public API ---------------- */
+
 void timeutil_init_sntp(void)
 {
     ESP_LOGI(TAG, "Initializing SNTP...");
@@ -26,6 +69,9 @@ void timeutil_init_sntp(void)
     setenv("TZ", "PST8PDT", 1);
     tzset();
 
+    // New TZ rules: drop the cached offset.
+    timefmt_tz_changed();
+
     // New style config
     esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG("pool.ntp.org");
     config.sync_cb = time_sync_cb;
@@ -39,24 +85,53 @@ void timeutil_init_sntp(void)
 
 bool timeutil_is_time_set(void)
 {
-    return s_time_set;
+    return (xEventGroupGetBits(time_events()) & TIME_SET_BIT) != 0;
+}
+
+bool timeutil_wait_time_set(uint32_t timeout_ms)
+{
+    const TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY
+                                                        : pdMS_TO_TICKS(timeout_ms);
+    EventBits_t bits = xEventGroupWaitBits(time_events(), TIME_SET_BIT,
+                                           pdFALSE, pdTRUE, ticks);
+    return (bits & TIME_SET_BIT) != 0;
+}
+
+int64_t timeutil_now_us(void)
+{
+    if (!timeutil_is_time_set()) {
+        return 0;
+    }
+
+    const int64_t mono = (int64_t)monotime_now_us();
+
+    taskENTER_CRITICAL(&s_lock);
+    const int64_t off = s_epoch_offset_us;
+    taskEXIT_CRITICAL(&s_lock);
+
+    return mono + off;
+}
+
+time_t timeutil_now(void)
+{
+    return (time_t)(timeutil_now_us() / 1000000);
 }
 
 bool timeutil_get_iso8601(char *buf, size_t buf_len)
 {
-    if (!s_time_set || buf_len < 32) {
+    if (!timeutil_is_time_set() || buf_len < 32) {
         return false;
     }
 
-    time_t now_sec;
-    time(&now_sec);
+    time_t now_sec = timeutil_now();
     if (now_sec == 0) {
         return false;
     }
 
-    struct tm local_tm;
-    localtime_r(&now_sec, &local_tm);
+    return timeutil_format_iso8601(now_sec, buf, buf_len);
+}
 
-    int n = strftime(buf, buf_len, "%Y-%m-%dT%H:%M:%S%z", &local_tm);
-    return (n > 0 && (size_t)n < buf_len);
+bool timeutil_format_iso8601(time_t t, char *buf, size_t buf_len)
+{
+    return timefmt_iso8601(t, buf, buf_len);
 }
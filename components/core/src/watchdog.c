@@ -1,18 +1,328 @@
 #include "core/watchdog.h"
+#include "core/config.h"
 #include "core/logging.h"
+#include "core/monotime.h"
+#include "core/rtos_alloc.h"
 
-esp_err_t watchdog_init(void){
-    log_post(LOG_LEVEL_INFO, "WDT", "Watchdog init stub");
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_task_wdt.h"
+#include "sdkconfig.h"
+
+#include <string.h>
+
+static const char *TAG = "WDT";
+
+typedef struct {
+    const watchdog_cfg_t *cfg;
+    TaskHandle_t          task;         // NULL while being restarted
+    mono_us_t             last_feed_us;
+    mono_us_t             begin_us;     // watchdog_loop_begin(), 0 if none
+    uint64_t              interval_sum_us;
+    uint32_t              interval_max_us;
+    uint64_t              work_sum_us;
+    uint32_t              work_max_us;
+    uint32_t              work_loops;
+    uint32_t              feeds;
+    uint32_t              misses;
+    uint32_t              restarts;
+    uint8_t               level;
+} wdt_slot_t;
+
+static wdt_slot_t   s_slots[WATCHDOG_MAX_TASKS];
+static size_t       s_count = 0;
+static portMUX_TYPE s_lock  = portMUX_INITIALIZER_UNLOCKED;
+
+RTOS_TASK_MEM(s_task_mem, TASK_STACK_WATCHDOG);
+
+/* ---------------- Hardware task watchdog ---------------- */
+
+static esp_err_t hw_wdt_init(void)
+{
+    uint32_t idle_mask = 0;
+#if CONFIG_ESP_TASK_WDT_CHECK_IDLE_TASK_CPU0
+    idle_mask |= 1u << 0;
+#endif
+#if CONFIG_ESP_TASK_WDT_CHECK_IDLE_TASK_CPU1
+    idle_mask |= 1u << 1;
+#endif
+
+    const esp_task_wdt_config_t cfg = {
+        .timeout_ms     = WATCHDOG_HW_TIMEOUT_MS,
+        .idle_core_mask = idle_mask,
+        .trigger_panic  = true,
+    };
+
+    // Already running when CONFIG_ESP_TASK_WDT_INIT is set.
+    esp_err_t err = esp_task_wdt_reconfigure(&cfg);
+    if (err == ESP_ERR_INVALID_STATE) {
+        err = esp_task_wdt_init(&cfg);
+    }
+    return err;
+}
+
+/* ---------------- Supervisor ---------------- */
+
+static wdt_slot_t *find_current(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < s_count; i++) {
+        if (s_slots[i].task == self) {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void __attribute__((noreturn)) wdt_reset(const char *name)
+{
+    // The LOGGER task may be the one that is stuck: write directly.
+    ESP_LOGE(TAG, "Task %s unrecoverable, resetting", name);
+    esp_restart();
+}
+
+static void wdt_restart(wdt_slot_t *slot, TaskHandle_t task)
+{
+    // Freeze it first, so what detach checks (locks held) and drops
+    // (handles published to other tasks) cannot change under it.
+    vTaskSuspend(task);
+    if (slot->cfg->detach != NULL && !slot->cfg->detach(task)) {
+        wdt_reset(slot->cfg->name);
+    }
+
+    log_post(LOG_LEVEL_ERROR, TAG, "Task %s stuck, restarting (%u)",
+             slot->cfg->name, (unsigned)(slot->restarts + 1u));
+
+    taskENTER_CRITICAL(&s_lock);
+    slot->task = NULL;
+    slot->restarts++;
+    slot->level        = 0;
+    slot->begin_us     = 0;
+    slot->last_feed_us = monotime_now_us();   // grace period for the new task
+    taskEXIT_CRITICAL(&s_lock);
+
+    vTaskDelete(task);
+#if APP_STATIC_ALLOC
+    // The restart reuses the task's static stack and TCB. If it was
+    // running on the other core it is only reaped by that core's idle
+    // task; give it time before handing the storage out again.
+    vTaskDelay(pdMS_TO_TICKS(WATCHDOG_CHECK_MS));
+#endif
+    slot->cfg->restart(slot->cfg);
+}
+
+static void wdt_check(void)
+{
+    const mono_us_t now = monotime_now_us();
+
+    for (size_t i = 0; i < s_count; i++) {
+        wdt_slot_t *slot = &s_slots[i];
+
+        taskENTER_CRITICAL(&s_lock);
+        const TaskHandle_t task  = slot->task;
+        const mono_us_t    last  = slot->last_feed_us;
+        const uint8_t      level = slot->level;
+        taskEXIT_CRITICAL(&s_lock);
+
+        const uint64_t late_us  = (now > last) ? now - last : 0u;
+        const uint64_t limit_us = (uint64_t)slot->cfg->deadline_ms * 1000u;
+
+        if (task == NULL) {
+            // Restarted but never registered again.
+            if (late_us >= 2u * limit_us) {
+                wdt_reset(slot->cfg->name);
+            }
+            continue;
+        }
+
+        if (level == 0 && late_us >= limit_us) {
+            taskENTER_CRITICAL(&s_lock);
+            slot->level = 1;
+            slot->misses++;
+            taskEXIT_CRITICAL(&s_lock);
+
+            log_post(LOG_LEVEL_WARN, TAG, "Task %s missed its %u ms deadline",
+                     slot->cfg->name, (unsigned)slot->cfg->deadline_ms);
+            if (slot->cfg->on_miss != NULL) {
+                slot->cfg->on_miss();
+            }
+        } else if (level == 1 && late_us >= 2u * limit_us && !slot->cfg->report_only) {
+            if (slot->cfg->restart == NULL || slot->restarts >= WATCHDOG_MAX_RESTARTS) {
+                wdt_reset(slot->cfg->name);
+            }
+            wdt_restart(slot, task);
+        }
+    }
+}
+
+static void task_watchdog(void *arg)
+{
+    (void)arg;
+
+    ESP_ERROR_CHECK(esp_task_wdt_add(NULL));
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1) {
+        wdt_check();
+        esp_task_wdt_reset();
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(WATCHDOG_CHECK_MS));
+    }
+}
+
+/* ---------------- Public API ---------------- */
+
+esp_err_t watchdog_init(void)
+{
+    esp_err_t err = hw_wdt_init();
+    if (err != ESP_OK) {
+        log_post(LOG_LEVEL_ERROR, TAG, "TWDT init failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    if (rtos_task_create(task_watchdog, "task_watchdog", NULL, TASK_PRIO_WATCHDOG,
+                         tskNO_AFFINITY, &s_task_mem, NULL) != ERR_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    log_post(LOG_LEVEL_INFO, TAG, "Supervisor started (check %u ms, TWDT %u ms)",
+             (unsigned)WATCHDOG_CHECK_MS, (unsigned)WATCHDOG_HW_TIMEOUT_MS);
     return ESP_OK;
 }
 
-esp_err_t watchdog_register_current(const char *task_name) {
-    log_post(LOG_LEVEL_INFO, "WDT", "Register task: %s", task_name);
+esp_err_t watchdog_register(void *task, const watchdog_cfg_t *cfg)
+{
+    if (task == NULL || cfg == NULL || cfg->name == NULL || cfg->deadline_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const mono_us_t now  = monotime_now_us();
+    wdt_slot_t     *slot = NULL;
+
+    taskENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < s_count; i++) {
+        if (strcmp(s_slots[i].cfg->name, cfg->name) == 0) {
+            slot = &s_slots[i];
+            break;
+        }
+    }
+    if (slot == NULL && s_count < WATCHDOG_MAX_TASKS) {
+        slot = &s_slots[s_count++];
+        memset(slot, 0, sizeof(*slot));
+    }
+    if (slot != NULL) {
+        slot->cfg          = cfg;
+        slot->task         = task;
+        slot->last_feed_us = now;
+        slot->begin_us     = 0;
+        slot->level        = 0;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (slot == NULL) {
+        log_post(LOG_LEVEL_ERROR, TAG, "No slot for task %s", cfg->name);
+        return ESP_ERR_NO_MEM;
+    }
+
+    log_post(LOG_LEVEL_INFO, TAG, "Register task: %s (period %u ms, deadline %u ms)",
+             cfg->name, (unsigned)cfg->period_ms, (unsigned)cfg->deadline_ms);
     return ESP_OK;
 }
 
+esp_err_t watchdog_register_current(const watchdog_cfg_t *cfg)
+{
+    return watchdog_register(xTaskGetCurrentTaskHandle(), cfg);
+}
+
+void watchdog_loop_begin(void)
+{
+    const mono_us_t now = monotime_now_us();
 
-esp_err_t watchdog_feed(void) {
-    // In a real implementation, call esp_task_wdt_reset() here.
+    taskENTER_CRITICAL(&s_lock);
+    wdt_slot_t *slot = find_current();
+    if (slot != NULL) {
+        slot->begin_us = now;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static inline uint32_t sat32(uint64_t v)
+{
+    return (v > UINT32_MAX) ? UINT32_MAX : (uint32_t)v;
+}
+
+esp_err_t watchdog_feed(void)
+{
+    const mono_us_t now = monotime_now_us();
+
+    taskENTER_CRITICAL(&s_lock);
+    wdt_slot_t *slot = find_current();
+    if (slot == NULL) {
+        taskEXIT_CRITICAL(&s_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const uint32_t dt32 = sat32((now > slot->last_feed_us) ? now - slot->last_feed_us : 0u);
+    slot->last_feed_us     = now;
+    slot->interval_sum_us += dt32;
+    slot->feeds++;
+    if (dt32 > slot->interval_max_us) {
+        slot->interval_max_us = dt32;
+    }
+
+    if (slot->begin_us != 0) {
+        const uint32_t work = sat32((now > slot->begin_us) ? now - slot->begin_us : 0u);
+        slot->begin_us     = 0;
+        slot->work_sum_us += work;
+        slot->work_loops++;
+        if (work > slot->work_max_us) {
+            slot->work_max_us = work;
+        }
+    }
+    const bool recovered = (slot->level != 0);
+    slot->level = 0;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (recovered) {
+        log_post(LOG_LEVEL_WARN, TAG, "Task %s recovered after %u ms",
+                 slot->cfg->name, (unsigned)(dt32 / 1000u));
+    }
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+size_t watchdog_get_stats(watchdog_task_stats_t *out, size_t max)
+{
+    if (out == NULL) {
+        return 0;
+    }
+
+    const mono_us_t now = monotime_now_us();
+    size_t          n   = 0;
+
+    taskENTER_CRITICAL(&s_lock);
+    for (; n < s_count && n < max; n++) {
+        const wdt_slot_t      *slot = &s_slots[n];
+        watchdog_task_stats_t *st   = &out[n];
+
+        strncpy(st->name, slot->cfg->name, sizeof(st->name) - 1);
+        st->name[sizeof(st->name) - 1] = '\0';
+        st->task          = slot->task;
+        st->period_ms     = slot->cfg->period_ms;
+        st->deadline_ms   = slot->cfg->deadline_ms;
+        st->feeds         = slot->feeds;
+        st->feed_interval_avg_us = slot->feeds ? (uint32_t)(slot->interval_sum_us / slot->feeds) : 0u;
+        st->feed_interval_max_us = slot->interval_max_us;
+        st->work_avg_us   = slot->work_loops ? (uint32_t)(slot->work_sum_us / slot->work_loops) : 0u;
+        st->work_max_us   = slot->work_max_us;
+        st->since_feed_ms = (now > slot->last_feed_us)
+                                ? (uint32_t)((now - slot->last_feed_us) / 1000u) : 0u;
+        st->misses        = slot->misses;
+        st->restarts      = slot->restarts;
+        st->level         = slot->level;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    return n;
+}
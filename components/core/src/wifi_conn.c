@@ -0,0 +1,108 @@
+#include "core/wifi_conn.h"
+
+#define WIFI_CONN_MAX_SHIFT   16u
+
+static uint32_t next_rand(wifi_conn_t *c)
+{
+    uint32_t x = c->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    c->rng = x;
+    return x;
+}
+
+static uint32_t backoff_ms(wifi_conn_t *c)
+{
+    uint32_t shift   = (c->attempt < WIFI_CONN_MAX_SHIFT) ? c->attempt : WIFI_CONN_MAX_SHIFT;
+    uint64_t ceiling = (uint64_t)c->base_ms << shift;
+    if (ceiling > c->max_ms) {
+        ceiling = c->max_ms;
+    }
+
+    const uint32_t half = (uint32_t)ceiling / 2u;
+    return half + next_rand(c) % ((uint32_t)ceiling - half + 1u);
+}
+
+static void enter_backoff(wifi_conn_t *c, uint32_t now_ms)
+{
+    c->retry_at_ms = now_ms + backoff_ms(c);
+    if (c->attempt < UINT32_MAX) {
+        c->attempt++;
+    }
+    c->state = WIFI_CONN_BACKOFF;
+}
+
+void wifi_conn_init(wifi_conn_t *c, uint32_t base_ms, uint32_t max_ms,
+                    uint32_t seed)
+{
+    c->state       = WIFI_CONN_IDLE;
+    c->attempt     = 0;
+    c->retry_at_ms = 0;
+    c->base_ms     = (base_ms > 0) ? base_ms : 1u;
+    c->max_ms      = (max_ms >= c->base_ms) ? max_ms : c->base_ms;
+    c->rng         = (seed != 0) ? seed : 0x9E3779B9u;
+}
+
+bool wifi_conn_on_event(wifi_conn_t *c, wifi_conn_event_t ev, uint32_t now_ms)
+{
+    switch (ev) {
+    case WIFI_CONN_EV_START:
+        c->attempt = 0;
+        c->state   = WIFI_CONN_CONNECTING;
+        return true;
+
+    case WIFI_CONN_EV_DISCONNECTED:
+        // The driver repeats DISCONNECTED while idle or already backing
+        // off; only the first one of an attempt counts.
+        if (c->state == WIFI_CONN_CONNECTING || c->state == WIFI_CONN_CONNECTED) {
+            enter_backoff(c, now_ms);
+        }
+        return false;
+
+    case WIFI_CONN_EV_GOT_IP:
+        c->attempt = 0;
+        c->state   = WIFI_CONN_CONNECTED;
+        return false;
+
+    case WIFI_CONN_EV_LOST_IP:
+        if (c->state == WIFI_CONN_CONNECTED) {
+            c->state = WIFI_CONN_CONNECTING;
+        }
+        return false;
+    }
+    return false;
+}
+
+bool wifi_conn_poll(wifi_conn_t *c, uint32_t now_ms)
+{
+    if (c->state != WIFI_CONN_BACKOFF || (int32_t)(now_ms - c->retry_at_ms) < 0) {
+        return false;
+    }
+    c->state = WIFI_CONN_CONNECTING;
+    return true;
+}
+
+uint32_t wifi_conn_wait_ms(const wifi_conn_t *c, uint32_t now_ms,
+                           uint32_t cap_ms)
+{
+    if (c->state != WIFI_CONN_BACKOFF) {
+        return cap_ms;
+    }
+    int32_t left = (int32_t)(c->retry_at_ms - now_ms);
+    if (left <= 0) {
+        return 0;
+    }
+    return ((uint32_t)left < cap_ms) ? (uint32_t)left : cap_ms;
+}
+
+const char *wifi_conn_state_to_str(wifi_conn_state_t s)
+{
+    switch (s) {
+    case WIFI_CONN_IDLE:       return "IDLE";
+    case WIFI_CONN_CONNECTING: return "CONNECTING";
+    case WIFI_CONN_CONNECTED:  return "CONNECTED";
+    case WIFI_CONN_BACKOFF:    return "BACKOFF";
+    }
+    return "?";
+}
@@ -1,31 +1,62 @@
 #ifndef DRV_BUTTONS_H
 #define DRV_BUTTONS_H
 
+#include <stdint.h>
+
 #include "core/app_types.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "core/error.h"
 
 /**
- * @brief Logical button events produced by the driver.
+ * @brief Physical buttons handled by the driver.
  */
 typedef enum {
-    BUTTON_EVENT_UP = 0,
-    BUTTON_EVENT_DOWN,
-    BUTTON_EVENT_MODE
-} button_event_t;
+    BUTTON_ID_UP = 0,
+    BUTTON_ID_DOWN,
+    BUTTON_ID_MODE,
+    BUTTON_ID_COUNT
+} button_id_t;
 
+/**
+ * @brief Debounced actions reported for a button.
+ */
+typedef enum {
+    BUTTON_ACTION_PRESS = 0,    // contact closed and stable
+    BUTTON_ACTION_RELEASE,      // contact opened and stable
+    BUTTON_ACTION_LONG_PRESS,   // held for BUTTON_LONG_PRESS_MS (once per press)
+    BUTTON_ACTION_REPEAT        // auto-repeat while held, accelerating
+} button_action_t;
 
+#define BUTTON_ACTION_BIT(a)   (1u << (a))
 
 /**
- * @brief Initialize GPIOs and ISR for buttons, create event queue.
+ * @brief Logical button event produced by the driver.
  *
- * @param[out] out_queue Queue handle that will receive button_event_t
- * 
- * 
+ * Events are generated after debouncing, so each physical press yields a
+ * single PRESS (plus REPEAT/LONG_PRESS while held, if enabled).
  */
+typedef struct {
+    uint8_t  button;        // button_id_t
+    uint8_t  action;        // button_action_t
+    uint16_t repeat_count;  // 1.. for BUTTON_ACTION_REPEAT, 0 otherwise
+} button_event_t;
 
- app_error_t drv_buttons_init(void);
+/**
+ * @brief Driver counters (for diagnostics).
+ */
+typedef struct {
+    uint32_t edges;         // raw GPIO edges seen by the ISR (incl. bounce)
+    uint32_t events;        // events queued
+    uint32_t dropped;       // events lost because the queue was full
+} drv_buttons_stats_t;
+
+/**
+ * @brief Initialize GPIOs, ISR and debounce timers for buttons, create event queue.
+ *
+ * By default UP/DOWN report PRESS and REPEAT, MODE reports PRESS only.
+ */
+app_error_t drv_buttons_init(void);
 
 /**
  * @brief Get handle to the internal button event queue.
@@ -34,4 +65,17 @@ typedef enum {
  */
 QueueHandle_t drv_buttons_get_queue(void);
 
+/**
+ * @brief Select which actions are queued for a button.
+ *
+ * @param button Button to configure
+ * @param mask   OR of BUTTON_ACTION_BIT(action) values
+ */
+void drv_buttons_set_action_mask(button_id_t button, uint32_t mask);
+
+/**
+ * @brief Get a snapshot of the driver counters.
+ */
+void drv_buttons_get_stats(drv_buttons_stats_t *out);
+
 #endif  // DRV_BUTTONS_H
@@ -19,11 +19,36 @@ extern "C" {
  *   - clear the screen
  *   - write one logical line at a time (always 16 chars, padded)
  *   - render a high level thermostat_state_t snapshot
+ *
+ * The driver keeps a shadow copy of the display contents and only sends
+ * the cells that changed, so redrawing an unchanged frame costs no bus
+ * traffic.
  */
 
 #define LCD_ROWS 2
 #define LCD_COLS 16
 
+/**
+ * @brief One full screen of text, one NUL-terminated string per row.
+ *
+ * Rows shorter than LCD_COLS are padded with spaces when shown.
+ */
+typedef struct {
+    char line[LCD_ROWS][LCD_COLS + 1];
+} drv_display_frame_t;
+
+/**
+ * @brief Bus operation counters (monotonic since boot).
+ *
+ * Each command or data byte costs two nibble transfers on the bus.
+ */
+typedef struct {
+    uint32_t frames;            // frames shown (show_frame / show_state)
+    uint32_t frames_unchanged;  // frames that needed no bus traffic
+    uint32_t cmd_bytes;         // command bytes sent (incl. cursor moves)
+    uint32_t data_bytes;        // character bytes sent
+} drv_display_stats_t;
+
 /**
  * @brief Initialize the LCD hardware and put it in 4 bit, 2 line mode.
  *
@@ -42,7 +67,7 @@ app_error_t drv_display_clear(void);
  * This function:
  *   - truncates the input string to LCD_COLS characters if it is longer
  *   - pads with spaces up to LCD_COLS characters if it is shorter
- *   - always writes exactly LCD_COLS characters to the given row
+ *   - only sends the cells that differ from what the row shows now
  *
  * @param row  Zero based row index (0 or 1 on a 16x2 display).
  * @param text Null terminated C string to render.
@@ -50,12 +75,29 @@ app_error_t drv_display_clear(void);
 app_error_t drv_display_write_line(uint8_t row, const char *text);
 
 /**
- * @brief High level helper to render a thermostat_state_t snapshot.
+ * @brief Build the frame for a thermostat_state_t snapshot (no I/O).
  *
- * Typical layout:
- *   Line 0: indoor and outdoor temperatures
- *   Line 1: setpoint, hysteresis, and heater output state
+ * Uses integer-only formatting. Callers can compare the result with the
+ * previous frame and skip drv_display_show_frame() when nothing changed.
  *
+ * Layout:
+ *   Line 0: "In:21.3 Out:10.0"   indoor and outdoor temperatures
+ *   Line 1: "Sp:22 H:0.5 AHOn"   setpoint, hysteresis, mode + output
+ */
+void drv_display_format_state(const thermostat_state_t *state,
+                              drv_display_frame_t      *out);
+
+/**
+ * @brief Show a prepared frame (only changed cells are transferred).
+ *
+ * @param frame Frame to show. Must not be NULL.
+ */
+app_error_t drv_display_show_frame(const drv_display_frame_t *frame);
+
+/**
+ * @brief High level helper to render a thermostat_state_t snapshot.
+ *
+ * Equivalent to drv_display_format_state() + drv_display_show_frame().
  * The exact formatting lives in the driver and can evolve without
  * touching the tasks that call it.
  *
@@ -63,6 +105,14 @@ app_error_t drv_display_write_line(uint8_t row, const char *text);
  */
 app_error_t drv_display_show_state(const thermostat_state_t *state);
 
+/**
+ * @brief Copy the bus operation counters.
+ *
+ * @param[out] out_stats Caller-allocated struct.
+ * @return ERR_OK on success, ERR_GENERIC if out_stats is NULL.
+ */
+app_error_t drv_display_get_stats(drv_display_stats_t *out_stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,47 @@
+#ifndef DRV_GPIO_PORT_H
+#define DRV_GPIO_PORT_H
+
+#include <stdint.h>
+
+/**
+ * @file drv_gpio_port.h
+ * @brief Port-level (whole register) GPIO output writes.
+ *
+ * gpio_set_level() touches one pin per call. When several pins must change
+ * together (LCD data nibble, heat / cool relays) the masks for every
+ * possible output pattern can be computed once and applied later with the
+ * W1TC / W1TS (write-1-to-clear / write-1-to-set) registers:
+ *   - all pins of one bank change in a single register write each
+ *   - clears are always written before sets, so two outputs are never
+ *     both driven high in between (break-before-make)
+ *
+ * Pins must already be configured as outputs (gpio_config()).
+ */
+
+typedef struct {
+    uint32_t set_lo;   // GPIO 0..31 to drive high
+    uint32_t clr_lo;   // GPIO 0..31 to drive low
+    uint32_t set_hi;   // GPIO 32..39 to drive high
+    uint32_t clr_hi;   // GPIO 32..39 to drive low
+} drv_gpio_port_masks_t;
+
+/**
+ * @brief Precompute the masks for one output pattern.
+ *
+ * @param[out] out    Masks to fill.
+ * @param      pins   Bit mask of pins this pattern controls (1ULL << gpio).
+ * @param      levels Bit mask of pins (subset of @p pins) to drive high;
+ *                    every other pin in @p pins is driven low.
+ */
+void drv_gpio_port_build(drv_gpio_port_masks_t *out,
+                         uint64_t               pins,
+                         uint64_t               levels);
+
+/**
+ * @brief Apply a precomputed pattern (clear first, then set).
+ *
+ * ISR / timer-callback safe: plain register writes, no locking.
+ */
+void drv_gpio_port_apply(const drv_gpio_port_masks_t *masks);
+
+#endif  // DRV_GPIO_PORT_H
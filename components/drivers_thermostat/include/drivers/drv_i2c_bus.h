@@ -0,0 +1,54 @@
+#ifndef DRV_I2C_BUS_H
+#define DRV_I2C_BUS_H
+
+#include "core/error.h"
+
+/**
+ * @file drv_i2c_bus.h
+ * @brief Shared I2C master bus used by the on-board I2C devices.
+ *
+ * Owns the I2C controller configuration (pins / speed from config.h) and
+ * the recovery sequence used when a slave holds SDA low after a glitch:
+ *   - release the controller
+ *   - clock SCL until the slave lets go of SDA (bus clear)
+ *   - issue a STOP condition
+ *   - reinstall the controller
+ *
+ * Several devices share the bus (AHT20, optional PCF8574 LCD backpack).
+ * Each transaction is wrapped in drv_i2c_bus_lock() / drv_i2c_bus_unlock()
+ * so a recovery never pulls the driver out from under another device.
+ */
+
+/**
+ * @brief Configure and install the I2C master driver.
+ *
+ * Safe to call more than once; later calls are no-ops.
+ *
+ * @return ERR_OK on success, ERR_GENERIC on driver errors.
+ */
+app_error_t drv_i2c_bus_init(void);
+
+/**
+ * @brief Recover a stuck bus and reinstall the I2C master driver.
+ *
+ * Devices on the bus keep their state, but any transaction in flight is
+ * lost, so callers should re-initialize their device afterwards.
+ *
+ * @return ERR_OK if the bus is idle again, ERR_GENERIC otherwise.
+ */
+app_error_t drv_i2c_bus_recover(void);
+
+/**
+ * @brief Take exclusive use of the bus for one transaction.
+ *
+ * Blocks until the bus is free. Do not hold across long waits (e.g. a
+ * sensor conversion), only around i2c_master_* calls.
+ */
+void drv_i2c_bus_lock(void);
+
+/**
+ * @brief Release the bus taken with drv_i2c_bus_lock().
+ */
+void drv_i2c_bus_unlock(void);
+
+#endif  // DRV_I2C_BUS_H
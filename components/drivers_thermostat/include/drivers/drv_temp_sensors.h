@@ -1,11 +1,39 @@
 #ifndef DRV_TEMP_SENSORS_H
 #define DRV_TEMP_SENSORS_H
 
+#include <stdint.h>
+
 #include "core/app_types.h"
 #include "core/error.h"
 
+/**
+ * @brief I2C error accounting for the AHT20.
+ *
+ * Counters are monotonic since boot and are meant for telemetry /
+ * diagnostics. A read that succeeds after retries counts once in
+ * reads_ok and once per failed attempt in the matching error counter.
+ */
+typedef struct {
+    uint32_t reads_ok;       // samples delivered to the caller
+    uint32_t reads_failed;   // samples lost after all retries
+    uint32_t retries;        // extra attempts made
+    uint32_t nacks;          // device did not ACK (ESP_FAIL)
+    uint32_t timeouts;       // bus / transaction timeout
+    uint32_t crc_errors;     // payload CRC mismatch
+    uint32_t busy;           // conversion not finished when read
+    uint32_t recoveries;     // bus clear + sensor re-init sequences
+} drv_temp_stats_t;
+
 app_error_t drv_temp_sensors_init(void);
 
 app_error_t drv_temp_read(sensor_sample_t *out_sample);
 
+/**
+ * @brief Copy the current AHT20 error counters.
+ *
+ * @param[out] out_stats Caller-allocated struct.
+ * @return ERR_OK on success, ERR_GENERIC if out_stats is NULL.
+ */
+app_error_t drv_temp_get_stats(drv_temp_stats_t *out_stats);
+
 #endif
@@ -2,61 +2,241 @@
 #include "core/config.h"
 #include "core/logging.h"
 #include "core/error.h"
+#include "core/rtos_alloc.h"
+
+#include <stdbool.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 
 #include "driver/gpio.h"
+#include "esp_timer.h"
 
 static const char *TAG = "DRV_BTN";
 
-// Queue used to send button events from ISR to task context.
+#define BTN_DEBOUNCE_US   ((uint32_t)BUTTON_DEBOUNCE_MS * 1000u)
+
+/*
+ * Debounce scheme
+ * ---------------
+ * The ISR fires on both edges. It only records the edge time and (re)starts
+ * the button's one-shot timer for BUTTON_DEBOUNCE_MS, so a burst of contact
+ * bounce costs a few timer restarts and nothing reaches the queue.
+ *
+ * The timer callback (esp_timer task) samples the pin once the line has
+ * been quiet for the debounce time and runs a small state machine:
+ * PRESS/RELEASE on a stable level change, then LONG_PRESS and accelerating
+ * REPEAT while the button stays down. While held, the timer re-arms itself
+ * for the next hold deadline, so no task polls the buttons.
+ *
+ * Timestamps are the low 32 bits of esp_timer_get_time() (us). Only
+ * differences are used, so the ~71 min wrap is harmless, and 32-bit
+ * stores keep the ISR/timer hand-off atomic.
+ */
+
+typedef struct {
+    gpio_num_t          gpio;
+    button_id_t         id;
+    uint32_t            action_mask;
+    esp_timer_handle_t  timer;
+
+    volatile uint32_t   edge_us;        // last raw edge (written by ISR)
+
+    // Owned by the timer callback
+    bool                pressed;
+    bool                long_sent;
+    uint32_t            pressed_at_us;
+    uint32_t            next_repeat_us;
+    uint32_t            repeat_ms;
+    uint16_t            repeat_count;
+} btn_state_t;
+
+// Queue used to send button events from timer to task context.
 static QueueHandle_t s_btn_queue = NULL;
+RTOS_QUEUE_MEM(s_btn_queue_mem, BUTTON_EVENT_QUEUE_LEN, sizeof(button_event_t));
+
+static btn_state_t s_buttons[BUTTON_ID_COUNT] = {
+    [BUTTON_ID_UP] = {
+        .gpio        = GPIO_BTN_UP,
+        .id          = BUTTON_ID_UP,
+        .action_mask = BUTTON_ACTION_BIT(BUTTON_ACTION_PRESS) |
+                       BUTTON_ACTION_BIT(BUTTON_ACTION_REPEAT),
+    },
+    [BUTTON_ID_DOWN] = {
+        .gpio        = GPIO_BTN_DOWN,
+        .id          = BUTTON_ID_DOWN,
+        .action_mask = BUTTON_ACTION_BIT(BUTTON_ACTION_PRESS) |
+                       BUTTON_ACTION_BIT(BUTTON_ACTION_REPEAT),
+    },
+    [BUTTON_ID_MODE] = {
+        .gpio        = GPIO_BTN_MODE,
+        .id          = BUTTON_ID_MODE,
+        .action_mask = BUTTON_ACTION_BIT(BUTTON_ACTION_PRESS),
+    },
+};
 
-// Simple mapping from GPIO to event
-static button_event_t gpio_to_event(gpio_num_t gpio)
+static volatile drv_buttons_stats_t s_stats;
+
+static inline uint32_t now_us(void)
 {
-    if (gpio == GPIO_BTN_UP) {
-        return BUTTON_EVENT_UP;
-    } else if (gpio == GPIO_BTN_DOWN) {
-        return BUTTON_EVENT_DOWN;
-    } else if (gpio == GPIO_BTN_MODE) {
-        return BUTTON_EVENT_MODE;
-    } else {
-        // Fallback: treat as DOWN (should not happen if wiring is correct).
-        return BUTTON_EVENT_DOWN;
-    }
+    return (uint32_t)esp_timer_get_time();
 }
 
+/* ---------------- ISR ---------------- */
+
 /**
  * @brief ISR for button GPIOs.
  *
- * Kept very small. It only pushes an event into the queue.
+ * Kept very small. It only timestamps the edge and restarts the debounce timer.
  */
 static void IRAM_ATTR button_isr_handler(void *arg)
 {
-    gpio_num_t gpio = (gpio_num_t)(intptr_t)arg;
-    button_event_t evt = gpio_to_event(gpio);
+    btn_state_t *b = (btn_state_t *)arg;
+
+    b->edge_us = now_us();
+    s_stats.edges++;
+
+    esp_timer_stop(b->timer);
+    esp_timer_start_once(b->timer, BTN_DEBOUNCE_US);
+}
+
+/* ---------------- Timer context ---------------- */
+
+static void btn_post(btn_state_t *b, button_action_t action)
+{
+    if ((b->action_mask & BUTTON_ACTION_BIT(action)) == 0) {
+        return;
+    }
+
+    button_event_t evt = {
+        .button       = (uint8_t)b->id,
+        .action       = (uint8_t)action,
+        .repeat_count = (action == BUTTON_ACTION_REPEAT) ? b->repeat_count : 0,
+    };
+
+    if (xQueueSend(s_btn_queue, &evt, 0) == pdTRUE) {
+        s_stats.events++;
+    } else {
+        s_stats.dropped++;
+    }
+}
+
+static void btn_arm(btn_state_t *b, uint32_t delay_us)
+{
+    // INVALID_STATE means the ISR re-armed it meanwhile; its deadline wins.
+    esp_err_t err = esp_timer_start_once(b->timer, delay_us);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        log_post(LOG_LEVEL_WARN, TAG, "timer arm failed, err=%d", (int)err);
+    }
+}
+
+static void btn_on_press(btn_state_t *b, uint32_t now)
+{
+    b->pressed_at_us  = now;
+    b->long_sent      = false;
+    b->repeat_count   = 0;
+    b->repeat_ms      = BUTTON_REPEAT_START_MS;
+    b->next_repeat_us = now + (uint32_t)BUTTON_REPEAT_DELAY_MS * 1000u;
+    btn_post(b, BUTTON_ACTION_PRESS);
+}
+
+/**
+ * @brief Emit LONG_PRESS / REPEAT whose deadline has passed and return the
+ *        delay until the next hold deadline (us).
+ */
+static uint32_t btn_on_hold(btn_state_t *b, uint32_t now)
+{
+    const uint32_t long_us = (uint32_t)BUTTON_LONG_PRESS_MS * 1000u;
+    uint32_t held = now - b->pressed_at_us;
 
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    if (s_btn_queue != NULL) {
-        xQueueSendFromISR(s_btn_queue, &evt, &xHigherPriorityTaskWoken);
+    if (!b->long_sent && held >= long_us) {
+        b->long_sent = true;
+        btn_post(b, BUTTON_ACTION_LONG_PRESS);
     }
-    if (xHigherPriorityTaskWoken == pdTRUE) {
-        portYIELD_FROM_ISR();
+
+    if ((int32_t)(now - b->next_repeat_us) >= 0) {
+        b->repeat_count++;
+        btn_post(b, BUTTON_ACTION_REPEAT);
+
+        // Schedule from now so a late callback doesn't trigger a burst.
+        b->next_repeat_us = now + b->repeat_ms * 1000u;
+
+        uint32_t next_ms = (b->repeat_ms * BUTTON_REPEAT_ACCEL_PCT) / 100u;
+        b->repeat_ms = (next_ms < BUTTON_REPEAT_MIN_MS) ? BUTTON_REPEAT_MIN_MS : next_ms;
+    }
+
+    uint32_t wake = (uint32_t)BUTTON_HOLD_POLL_MS * 1000u;
+
+    if (b->action_mask & BUTTON_ACTION_BIT(BUTTON_ACTION_REPEAT)) {
+        uint32_t until_repeat = b->next_repeat_us - now;
+        if (until_repeat < wake) {
+            wake = until_repeat;
+        }
+    }
+    if (!b->long_sent && (b->action_mask & BUTTON_ACTION_BIT(BUTTON_ACTION_LONG_PRESS))) {
+        uint32_t until_long = long_us - held;
+        if (until_long < wake) {
+            wake = until_long;
+        }
+    }
+
+    return wake;
+}
+
+static void btn_timer_cb(void *arg)
+{
+    btn_state_t *b = (btn_state_t *)arg;
+    uint32_t now   = now_us();
+    uint32_t quiet = now - b->edge_us;
+
+    // Still bouncing: wait until the line has been quiet long enough.
+    if (quiet < BTN_DEBOUNCE_US) {
+        btn_arm(b, BTN_DEBOUNCE_US - quiet);
+        return;
+    }
+
+    bool pressed = (gpio_get_level(b->gpio) == 0);   // active low
+
+    if (pressed != b->pressed) {
+        b->pressed = pressed;
+        if (pressed) {
+            btn_on_press(b, now);
+        } else {
+            btn_post(b, BUTTON_ACTION_RELEASE);
+        }
+    }
+
+    if (b->pressed) {
+        btn_arm(b, btn_on_hold(b, now));
     }
 }
 
+/* ---------------- Public API ---------------- */
+
 app_error_t drv_buttons_init(void)
 {
     // Create event queue once
-    s_btn_queue = xQueueCreate(BUTTON_EVENT_QUEUE_LEN, sizeof(button_event_t));
+    s_btn_queue = rtos_queue_create(&s_btn_queue_mem);
     if (s_btn_queue == NULL) {
-        log_post(LOG_LEVEL_ERROR, TAG, "Failed to create button queue");
         return ERR_GENERIC;
     }
 
-    // Configure both pins as inputs with pull-ups and falling-edge interrupts
+    // One debounce / hold timer per button
+    for (int i = 0; i < BUTTON_ID_COUNT; i++) {
+        const esp_timer_create_args_t targs = {
+            .callback        = btn_timer_cb,
+            .arg             = &s_buttons[i],
+            .dispatch_method = ESP_TIMER_TASK,
+            .name            = "btn",
+        };
+        if (esp_timer_create(&targs, &s_buttons[i].timer) != ESP_OK) {
+            log_post(LOG_LEVEL_ERROR, TAG, "esp_timer_create failed (button %d)", i);
+            return ERR_GENERIC;
+        }
+    }
+
+    // Configure the pins as inputs with pull-ups; both edges so releases
+    // are debounced too. The classic ESP32 has no GPIO glitch filter.
     gpio_config_t io_conf = {
         .pin_bit_mask =
             (1ULL << GPIO_BTN_UP)   |
@@ -65,7 +245,7 @@ app_error_t drv_buttons_init(void)
         .mode         = GPIO_MODE_INPUT,
         .pull_up_en   = GPIO_PULLUP_ENABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type    = GPIO_INTR_NEGEDGE   // pressed -> line goes low
+        .intr_type    = GPIO_INTR_ANYEDGE
     };
 
     esp_err_t err = gpio_config(&io_conf);
@@ -83,38 +263,24 @@ app_error_t drv_buttons_init(void)
     }
 
     // Attach ISR handlers for each button
-    err = gpio_isr_handler_add(GPIO_BTN_UP,
-                               button_isr_handler,
-                               (void *)(intptr_t)GPIO_BTN_UP);
-    if (err != ESP_OK) {
-        log_post(LOG_LEVEL_ERROR, TAG,
-                 "gpio_isr_handler_add(UP) failed, err=%d", (int)err);
-        return ERR_GENERIC;
-    }
-
-    err = gpio_isr_handler_add(GPIO_BTN_DOWN,
-                               button_isr_handler,
-                               (void *)(intptr_t)GPIO_BTN_DOWN);
-    if (err != ESP_OK) {
-        log_post(LOG_LEVEL_ERROR, TAG,
-                 "gpio_isr_handler_add(DOWN) failed, err=%d", (int)err);
-        return ERR_GENERIC;
-    }
-
-    err = gpio_isr_handler_add(GPIO_BTN_MODE,
-                               button_isr_handler,
-                               (void *)(intptr_t)GPIO_BTN_MODE);
-    if (err != ESP_OK) {
-        log_post(LOG_LEVEL_ERROR, TAG,
-                 "gpio_isr_handler_add(MODE) failed, err=%d", (int)err);
-        return ERR_GENERIC;
+    for (int i = 0; i < BUTTON_ID_COUNT; i++) {
+        err = gpio_isr_handler_add(s_buttons[i].gpio,
+                                   button_isr_handler,
+                                   &s_buttons[i]);
+        if (err != ESP_OK) {
+            log_post(LOG_LEVEL_ERROR, TAG,
+                     "gpio_isr_handler_add(%d) failed, err=%d",
+                     (int)s_buttons[i].gpio, (int)err);
+            return ERR_GENERIC;
+        }
     }
 
     log_post(LOG_LEVEL_INFO, TAG,
-             "Buttons initialized (UP=%d, DOWN=%d, MODE=%d)",
+             "Buttons initialized (UP=%d, DOWN=%d, MODE=%d, debounce=%d ms)",
              (int)GPIO_BTN_UP,
              (int)GPIO_BTN_DOWN,
-             (int)GPIO_BTN_MODE);
+             (int)GPIO_BTN_MODE,
+             BUTTON_DEBOUNCE_MS);
 
     return ERR_OK;
 }
@@ -123,3 +289,21 @@ QueueHandle_t drv_buttons_get_queue(void)
 {
     return s_btn_queue;
 }
+
+void drv_buttons_set_action_mask(button_id_t button, uint32_t mask)
+{
+    if ((unsigned)button >= BUTTON_ID_COUNT) {
+        return;
+    }
+    s_buttons[button].action_mask = mask;
+}
+
+void drv_buttons_get_stats(drv_buttons_stats_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+    out->edges   = s_stats.edges;
+    out->events  = s_stats.events;
+    out->dropped = s_stats.dropped;
+}
@@ -1,101 +1,57 @@
 #include "drivers/drv_display.h"
 
-#include "core/config.h"    // LCD_PIN_RS, LCD_PIN_EN, LCD_PIN_D4..D7, LCD_ROWS, LCD_COLS
+#include "core/config.h"
 #include "core/logging.h"   // log_post
 #include "core/error.h"     // app_error_t, ERR_OK, ERR_GENERIC
 #include "core/thermostat.h"
 
-#include "driver/gpio.h"
-#include "esp_rom_sys.h"
+#include "lcd_bus.h"        // queued, non-blocking transport to the LCD
+
+#include "core/numfmt.h"   // integer-only formatting for frame text
 
 #include <string.h>
-#include <stdio.h>
 
 static const char *TAG = "LCD";
 
 static bool s_lcd_initialized = false;
 
-/* ---------------- Low-Level GPIO Helpers ---------------- */
+// Shadow copy of the visible DDRAM cells, i.e. what the LCD shows now.
+static char s_shadow[LCD_ROWS][LCD_COLS];
 
-static void lcd_gpio_init(void)
-{
-    uint64_t mask =
-        (1ULL << LCD_PIN_RS) |
-        (1ULL << LCD_PIN_EN) |
-        (1ULL << LCD_PIN_D4) |
-        (1ULL << LCD_PIN_D5) |
-        (1ULL << LCD_PIN_D6) |
-        (1ULL << LCD_PIN_D7);
-
-    gpio_config_t cfg = {
-        .pin_bit_mask = mask,
-        .mode         = GPIO_MODE_OUTPUT,
-        .pull_up_en   = 0,
-        .pull_down_en = 0,
-        .intr_type    = GPIO_INTR_DISABLE
-    };
-    gpio_config(&cfg);
-
-    // Known idle state: EN low, RS low. Data lines will be driven as needed.
-    gpio_set_level(LCD_PIN_EN, 0);
-    gpio_set_level(LCD_PIN_RS, 0);
-}
+// Where the LCD address counter points (it auto-increments after each
+// data write). s_cursor_col may equal LCD_COLS after the last column.
+// s_cursor_row < 0 means "unknown", forcing an explicit cursor move.
+static int s_cursor_row = -1;
+static int s_cursor_col = 0;
 
-static inline void lcd_pulse(void)
-{
-    // Short enable pulse using ROM microsecond delay
-    gpio_set_level(LCD_PIN_EN, 1);
-    esp_rom_delay_us(1);
-    gpio_set_level(LCD_PIN_EN, 0);
-    esp_rom_delay_us(40);   // command settle time
-}
+// Bus operation accounting, see drv_display_get_stats().
+static drv_display_stats_t s_stats;
 
-static inline void lcd_write_nibble(uint8_t nib)
-{
-    gpio_set_level(LCD_PIN_D4, (nib >> 0) & 1);
-    gpio_set_level(LCD_PIN_D5, (nib >> 1) & 1);
-    gpio_set_level(LCD_PIN_D6, (nib >> 2) & 1);
-    gpio_set_level(LCD_PIN_D7, (nib >> 3) & 1);
+// A cursor move is one command byte, the same bus cost as one data byte.
+// Rewriting up to this many unchanged cells is no more expensive than
+// jumping over them.
+#define LCD_CURSOR_MOVE_COST  1
 
-    lcd_pulse();
-}
-
-static void lcd_send(uint8_t val, bool rs)
-{
-    gpio_set_level(LCD_PIN_RS, rs ? 1 : 0);
+/* ---------------- Bus helpers ---------------- */
 
-    // High nibble then low nibble
-    lcd_write_nibble((val >> 4) & 0x0F);
-    lcd_write_nibble(val & 0x0F);
-
-    // Clear (0x01) and home (0x02) need a longer delay
-    if (val == 0x01 || val == 0x02) {
-        esp_rom_delay_us(2000);
-    } else {
-        esp_rom_delay_us(50);
-    }
-}
-
-static inline void lcd_cmd(uint8_t cmd)  { lcd_send(cmd, false); }
-static inline void lcd_data(uint8_t ch)  { lcd_send(ch, true); }
+// All transfers go through lcd_bus (see lcd_bus.h): these only queue work.
+static inline void lcd_cmd(uint8_t cmd)  { s_stats.cmd_bytes++;  lcd_bus_send(cmd, false); }
+static inline void lcd_data(uint8_t ch)  { s_stats.data_bytes++; lcd_bus_send(ch, true); }
 
 /* ---------------- LCD Init Sequence ---------------- */
 
 static void lcd_init_sequence(void)
 {
     // Wait for power to stabilize
-    esp_rom_delay_us(50000);   // 50 ms
-
-    gpio_set_level(LCD_PIN_RS, 0);
+    lcd_bus_delay_us(50000);   // 50 ms
 
     // Force 8-bit mode (3 times)
-    lcd_write_nibble(0x03); esp_rom_delay_us(4500);
-    lcd_write_nibble(0x03); esp_rom_delay_us(4500);
-    lcd_write_nibble(0x03); esp_rom_delay_us(150);
+    lcd_bus_nibble(0x03, 4500);
+    lcd_bus_nibble(0x03, 4500);
+    lcd_bus_nibble(0x03, 150);
 
     // Switch to 4-bit
-    lcd_write_nibble(0x02);
-    esp_rom_delay_us(150);
+    lcd_bus_nibble(0x02, 150);
 
     // Function set: 4-bit, 2-line, 5x8
     lcd_cmd(0x28);
@@ -123,6 +79,82 @@ static void lcd_set_cursor(uint8_t row, uint8_t col)
         row = 0;  // fallback
     }
     lcd_cmd(0x80 | (row_addr[row] + col));
+
+    s_cursor_row = row;
+    s_cursor_col = col;
+}
+
+/* ---------------- Shadow framebuffer ---------------- */
+
+static void lcd_shadow_reset(void)
+{
+    memset(s_shadow, ' ', sizeof(s_shadow));
+    s_cursor_row = 0;
+    s_cursor_col = 0;
+}
+
+/**
+ * @brief Bring one LCD row in line with @p target, sending only changes.
+ *
+ * Walks the row and, for every cell that differs from the shadow, either
+ * moves the cursor there or - if only a few unchanged cells lie between
+ * the cursor and the dirty cell - rewrites those cells instead, whichever
+ * costs fewer bus operations.
+ *
+ * @return Number of cells written (0 if the row was already up to date).
+ */
+static size_t lcd_sync_row(uint8_t row, const char target[LCD_COLS])
+{
+    size_t written = 0;
+
+    for (int col = 0; col < LCD_COLS; col++) {
+        if (s_shadow[row][col] == target[col]) {
+            continue;
+        }
+
+        int gap = col - s_cursor_col;
+        if (s_cursor_row != row || gap < 0 || gap > LCD_CURSOR_MOVE_COST) {
+            lcd_set_cursor(row, (uint8_t)col);
+        } else {
+            // Cheaper to rewrite the few unchanged cells in between.
+            while (s_cursor_col < col) {
+                lcd_data((uint8_t)s_shadow[row][s_cursor_col]);
+                s_cursor_col++;
+                written++;
+            }
+        }
+
+        lcd_data((uint8_t)target[col]);
+        s_shadow[row][col] = target[col];
+        s_cursor_col++;
+        written++;
+    }
+
+    return written;
+}
+
+/**
+ * @brief Queue the changes needed to show @p text on @p row.
+ *
+ * Truncates / pads @p text to LCD_COLS. Does not flush.
+ *
+ * @return Number of cells queued.
+ */
+static size_t lcd_write_row(uint8_t row, const char *text)
+{
+    char target[LCD_COLS];
+    size_t i = 0;
+
+    while (i < LCD_COLS && text && text[i] != '\0') {
+        target[i] = text[i];
+        i++;
+    }
+    while (i < LCD_COLS) {
+        target[i] = ' ';
+        i++;
+    }
+
+    return lcd_sync_row(row, target);
 }
 
 /* ---------------- Public API ---------------- */
@@ -133,11 +165,20 @@ app_error_t drv_display_init(void)
         return ERR_OK;
     }
 
-    lcd_gpio_init();
+    if (lcd_bus_init() != ERR_OK) {
+        return ERR_GENERIC;
+    }
+
+    // Queue the power-up sequence; it runs in the background while the
+    // caller carries on. Later writes queue up behind it.
     lcd_init_sequence();
+    lcd_bus_flush();
+
+    // The init sequence clears the display: DDRAM is all spaces.
+    lcd_shadow_reset();
 
     s_lcd_initialized = true;
-    log_post(LOG_LEVEL_INFO, TAG, "LCD initialized (ROM-delay driver)");
+    log_post(LOG_LEVEL_INFO, TAG, "LCD initialized (timer-driven transfers)");
 
     return ERR_OK;
 }
@@ -148,9 +189,11 @@ app_error_t drv_display_clear(void)
         return ERR_GENERIC;
     }
 
+    // The bus applies the long settle time for 0x01 itself.
     lcd_cmd(0x01);
-    // lcd_send already includes the long delay for 0x01, but we keep code explicit
-    esp_rom_delay_us(2000);
+    lcd_bus_flush();
+
+    lcd_shadow_reset();
     return ERR_OK;
 }
 
@@ -164,50 +207,41 @@ app_error_t drv_display_write_line(uint8_t row, const char *text)
         return ERR_GENERIC;
     }
 
-    // Move cursor to start of the row
-    lcd_set_cursor(row, 0);
-
-    // Write up to LCD_COLS chars, then pad with spaces
-    size_t i = 0;
-
-    while (i < LCD_COLS && text && text[i] != '\0') {
-        lcd_data((uint8_t)text[i]);
-        i++;
+    if (lcd_write_row(row, text) > 0) {
+        lcd_bus_flush();
     }
-    while (i < LCD_COLS) {
-        lcd_data(' ');
-        i++;
-    }
-
     return ERR_OK;
 }
 
-app_error_t drv_display_show_state(const thermostat_state_t *state)
+void drv_display_format_state(const thermostat_state_t *state,
+                              drv_display_frame_t      *out)
 {
-    if (!s_lcd_initialized || state == NULL) {
-        return ERR_GENERIC;
+    if (state == NULL || out == NULL) {
+        return;
     }
 
-    char line0[LCD_COLS + 1];
-    char line1[LCD_COLS + 1];
+    // Zero-fill so frames can be compared with memcmp().
+    memset(out, 0, sizeof(*out));
 
     // Line 0: indoor and outdoor temps
-    snprintf(line0, sizeof(line0),
-             "In:%2.1f Out:%2.1f",
-             state->tin_c,
-             state->tout_c);
-
-           
+    // Example: "In:21.3 Out:10.0"
+    char *p   = out->line[0];
+    char *end = out->line[0] + LCD_COLS;
+    p = numfmt_str(p, end, "In:");
+    p = numfmt_fixed1(p, end, state->tin_c, 2);
+    p = numfmt_str(p, end, " Out:");
+    p = numfmt_fixed1(p, end, state->tout_c, 2);
+    *p = '\0';
 
     // Map mode to short 1-letter label.
-    char mode_char = 'O';  // Off
+    char mode_char[2] = "O";  // Off
     switch (state->mode) {
-    case THERMOSTAT_MODE_HEAT: mode_char = 'H'; break;
-    case THERMOSTAT_MODE_COOL: mode_char = 'C'; break;
-    case THERMOSTAT_MODE_AUTO: mode_char = 'A'; break;
+    case THERMOSTAT_MODE_HEAT: mode_char[0] = 'H'; break;
+    case THERMOSTAT_MODE_COOL: mode_char[0] = 'C'; break;
+    case THERMOSTAT_MODE_AUTO: mode_char[0] = 'A'; break;
     case THERMOSTAT_MODE_OFF:
     default:
-        mode_char = 'O';
+        mode_char[0] = 'O';
         break;
     }
 
@@ -218,26 +252,71 @@ app_error_t drv_display_show_state(const thermostat_state_t *state)
     } else if (state->output == THERMOSTAT_OUTPUT_COOL_ON) {
         out_str = "COn";
     }
-    
-
 
     // Line 1: setpoint, hysteresis, mode / output
-    // Example: "Sp:22 H:0.5 HOn"
-    snprintf(line1, sizeof(line1),
-             "Sp:%2.0f H:%1.1f %c%s",
-             state->setpoint_c,
-             state->hysteresis_c,
-             mode_char,
-             out_str);
-
-    // Log exactly what we intend to show on LCD (truncated to LCD_COLS for safety).
-    log_post(LOG_LEVEL_INFO, TAG,
-             "LCD lines -> \"%.*s\" | \"%.*s\"",
-             LCD_COLS, line0,
-             LCD_COLS, line1);
-
-    drv_display_write_line(0, line0);
-    drv_display_write_line(1, line1);
+    // Example: "Sp:22 H:0.5 AHOn"
+    // Same rounding as the old "%2.0f": 22.5 -> "22", 23.5 -> "24".
+    int32_t sp_whole = (int32_t)numfmt_round_scaled(state->setpoint_c, 1u);
+    if (state->setpoint_c < 0.0f) {
+        sp_whole = -sp_whole;
+    }
+
+    p   = out->line[1];
+    end = out->line[1] + LCD_COLS;
+    p = numfmt_str(p, end, "Sp:");
+    p = numfmt_i32(p, end, sp_whole, 2);
+    p = numfmt_str(p, end, " H:");
+    p = numfmt_fixed1(p, end, state->hysteresis_c, 1);
+    p = numfmt_str(p, end, " ");
+    p = numfmt_str(p, end, mode_char);
+    p = numfmt_str(p, end, out_str);
+    *p = '\0';
+}
+
+app_error_t drv_display_show_frame(const drv_display_frame_t *frame)
+{
+    if (!s_lcd_initialized || frame == NULL) {
+        return ERR_GENERIC;
+    }
+
+    uint32_t ops_before = s_stats.cmd_bytes + s_stats.data_bytes;
+
+    // Queue every changed cell of the frame, then transfer it in one go
+    // (a single I2C burst on the PCF8574 backend).
+    size_t written = 0;
+    for (uint8_t row = 0; row < LCD_ROWS; row++) {
+        written += lcd_write_row(row, frame->line[row]);
+    }
+    if (written > 0) {
+        lcd_bus_flush();
+    }
+
+    s_stats.frames++;
+    if (s_stats.cmd_bytes + s_stats.data_bytes == ops_before) {
+        s_stats.frames_unchanged++;
+    }
+
+    return ERR_OK;
+}
+
+app_error_t drv_display_show_state(const thermostat_state_t *state)
+{
+    if (!s_lcd_initialized || state == NULL) {
+        return ERR_GENERIC;
+    }
+
+    drv_display_frame_t frame;
+    drv_display_format_state(state, &frame);
+
+    return drv_display_show_frame(&frame);
+}
+
+app_error_t drv_display_get_stats(drv_display_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return ERR_GENERIC;
+    }
 
+    *out_stats = s_stats;
     return ERR_OK;
 }
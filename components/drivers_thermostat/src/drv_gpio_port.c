@@ -0,0 +1,44 @@
+#include "drivers/drv_gpio_port.h"
+
+#include "soc/soc_caps.h"
+#include "soc/gpio_struct.h"
+#include "esp_attr.h"
+
+void drv_gpio_port_build(drv_gpio_port_masks_t *out,
+                         uint64_t               pins,
+                         uint64_t               levels)
+{
+    if (out == NULL) {
+        return;
+    }
+
+    uint64_t high = pins & levels;
+    uint64_t low  = pins & ~levels;
+
+    out->set_lo = (uint32_t)(high & 0xFFFFFFFFULL);
+    out->clr_lo = (uint32_t)(low  & 0xFFFFFFFFULL);
+    out->set_hi = (uint32_t)(high >> 32);
+    out->clr_hi = (uint32_t)(low  >> 32);
+}
+
+void IRAM_ATTR drv_gpio_port_apply(const drv_gpio_port_masks_t *masks)
+{
+    // Clears first (both banks), then sets: break-before-make.
+    if (masks->clr_lo) {
+        GPIO.out_w1tc = masks->clr_lo;
+    }
+#if SOC_GPIO_PIN_COUNT > 32
+    if (masks->clr_hi) {
+        GPIO.out1_w1tc.val = masks->clr_hi;
+    }
+#endif
+
+    if (masks->set_lo) {
+        GPIO.out_w1ts = masks->set_lo;
+    }
+#if SOC_GPIO_PIN_COUNT > 32
+    if (masks->set_hi) {
+        GPIO.out1_w1ts.val = masks->set_hi;
+    }
+#endif
+}
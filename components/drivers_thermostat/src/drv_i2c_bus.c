@@ -0,0 +1,188 @@
+#include "drivers/drv_i2c_bus.h"
+#include "core/config.h"
+#include "core/logging.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "driver/i2c.h"
+#include "driver/gpio.h"
+#include "esp_rom_sys.h"
+
+static const char *TAG = "I2C_BUS";
+
+static bool s_installed = false;
+
+// Serializes transactions against recovery (which uninstalls the driver).
+// Created on first use from whichever task gets there first: a CAS on
+// s_bus_mutex_state picks the one task that creates it, outside any
+// critical section, and the others wait for it to be ready.
+enum { BUS_MUTEX_NONE = 0, BUS_MUTEX_CREATING, BUS_MUTEX_READY };
+
+static SemaphoreHandle_t  s_bus_mutex = NULL;
+static StaticSemaphore_t  s_bus_mutex_buf;
+static uint32_t           s_bus_mutex_state = BUS_MUTEX_NONE;
+
+// Half of one SCL period for the manual bus clear (~100 kHz).
+#define BUS_CLEAR_HALF_PERIOD_US   5
+
+// A slave can be at most 8 data bits + ACK into a byte when it stalls.
+#define BUS_CLEAR_MAX_PULSES       9
+
+/**
+ * @brief Configure and install the I2C master peripheral.
+ *
+ * Uses parameters defined in config.h (I2C_MASTER_PORT, I2C_MASTER_SDA_IO,
+ * I2C_MASTER_SCL_IO, I2C_MASTER_FREQ_HZ).
+ */
+static esp_err_t i2c_master_install(void)
+{
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ   // Only clk_speed here in this IDF version
+    };
+
+    esp_err_t err = i2c_param_config(I2C_MASTER_PORT, &conf);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Install I2C driver with no RX/TX buffers for master mode
+    return i2c_driver_install(I2C_MASTER_PORT, conf.mode, 0, 0, 0);
+}
+
+/**
+ * @brief Bit-bang SCL until SDA is released, then generate a STOP.
+ *
+ * Must be called with the I2C driver uninstalled so the pins are plain
+ * GPIOs. Both lines are driven open-drain, relying on the pull-ups.
+ *
+ * @return true if SDA reads high afterwards (bus idle).
+ */
+static bool i2c_bus_clear(void)
+{
+    gpio_config_t io = {
+        .pin_bit_mask = (1ULL << I2C_MASTER_SCL_IO) | (1ULL << I2C_MASTER_SDA_IO),
+        .mode         = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pull_up_en   = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type    = GPIO_INTR_DISABLE
+    };
+    gpio_config(&io);
+
+    gpio_set_level(I2C_MASTER_SDA_IO, 1);
+    gpio_set_level(I2C_MASTER_SCL_IO, 1);
+    esp_rom_delay_us(BUS_CLEAR_HALF_PERIOD_US);
+
+    // Clock out whatever byte the slave thinks it is still sending.
+    for (int i = 0; i < BUS_CLEAR_MAX_PULSES; i++) {
+        if (gpio_get_level(I2C_MASTER_SDA_IO) == 1) {
+            break;
+        }
+        gpio_set_level(I2C_MASTER_SCL_IO, 0);
+        esp_rom_delay_us(BUS_CLEAR_HALF_PERIOD_US);
+        gpio_set_level(I2C_MASTER_SCL_IO, 1);
+        esp_rom_delay_us(BUS_CLEAR_HALF_PERIOD_US);
+    }
+
+    // STOP: SDA low -> high while SCL is high.
+    gpio_set_level(I2C_MASTER_SCL_IO, 0);
+    esp_rom_delay_us(BUS_CLEAR_HALF_PERIOD_US);
+    gpio_set_level(I2C_MASTER_SDA_IO, 0);
+    esp_rom_delay_us(BUS_CLEAR_HALF_PERIOD_US);
+    gpio_set_level(I2C_MASTER_SCL_IO, 1);
+    esp_rom_delay_us(BUS_CLEAR_HALF_PERIOD_US);
+    gpio_set_level(I2C_MASTER_SDA_IO, 1);
+    esp_rom_delay_us(BUS_CLEAR_HALF_PERIOD_US);
+
+    return gpio_get_level(I2C_MASTER_SDA_IO) == 1;
+}
+
+static void bus_mutex_create_once(void)
+{
+    uint32_t expected = BUS_MUTEX_NONE;
+    if (__atomic_compare_exchange_n(&s_bus_mutex_state, &expected, BUS_MUTEX_CREATING,
+                                    false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        s_bus_mutex = xSemaphoreCreateMutexStatic(&s_bus_mutex_buf);
+        __atomic_store_n(&s_bus_mutex_state, BUS_MUTEX_READY, __ATOMIC_RELEASE);
+        return;
+    }
+
+    // Lost the race: sleep rather than spin, so a lower-priority winner
+    // can finish creating it.
+    while (__atomic_load_n(&s_bus_mutex_state, __ATOMIC_ACQUIRE) != BUS_MUTEX_READY) {
+        vTaskDelay(1);
+    }
+}
+
+app_error_t drv_i2c_bus_init(void)
+{
+    bus_mutex_create_once();
+
+    drv_i2c_bus_lock();
+
+    if (s_installed) {
+        drv_i2c_bus_unlock();
+        return ERR_OK;
+    }
+
+    esp_err_t err = i2c_master_install();
+    if (err != ESP_OK) {
+        drv_i2c_bus_unlock();
+        log_post(LOG_LEVEL_ERROR, TAG, "I2C install failed, err=%d", (int)err);
+        return ERR_GENERIC;
+    }
+
+    s_installed = true;
+    drv_i2c_bus_unlock();
+    return ERR_OK;
+}
+
+void drv_i2c_bus_lock(void)
+{
+    if (s_bus_mutex != NULL) {
+        xSemaphoreTake(s_bus_mutex, portMAX_DELAY);
+    }
+}
+
+void drv_i2c_bus_unlock(void)
+{
+    if (s_bus_mutex != NULL) {
+        xSemaphoreGive(s_bus_mutex);
+    }
+}
+
+app_error_t drv_i2c_bus_recover(void)
+{
+    bus_mutex_create_once();
+
+    drv_i2c_bus_lock();
+
+    if (s_installed) {
+        i2c_driver_delete(I2C_MASTER_PORT);
+        s_installed = false;
+    }
+
+    bool idle = i2c_bus_clear();
+    if (!idle) {
+        log_post(LOG_LEVEL_WARN, TAG, "Bus clear: SDA still held low");
+    }
+
+    esp_err_t err = i2c_master_install();
+    s_installed = (err == ESP_OK);
+
+    drv_i2c_bus_unlock();
+
+    if (err != ESP_OK) {
+        log_post(LOG_LEVEL_ERROR, TAG,
+                 "I2C reinstall after recovery failed, err=%d", (int)err);
+        return ERR_GENERIC;
+    }
+
+    return idle ? ERR_OK : ERR_GENERIC;
+}
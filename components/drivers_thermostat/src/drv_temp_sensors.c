@@ -12,59 +12,43 @@
  *   - Convert raw measurement bytes into Celsius
  *   - Populate sensor_sample_t used by the SENSORS task
  *
+ *   - Retry failed transactions and recover a stuck bus (see drv_temp_read)
+ *   - Keep I2C error counters for diagnostics / telemetry
+ *
  * Future extensions:
  *   - Add a second physical sensor for true indoor/outdoor readings
  *   - Add humidity reporting
- *   - Error counters and self-diagnostics
  */
 
 #include "drivers/drv_temp_sensors.h"
 #include "core/logging.h"
 #include "core/config.h"
 #include "core/error.h"
+#include "core/metrics.h"
+#include "core/monotime.h"
+#include "drivers/drv_i2c_bus.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "driver/i2c.h"
-#include "driver/gpio.h"   // For GPIO_PULLUP_ENABLE, pin types
 
 static const char *TAG = "DRV_TS";
 
+// Tracks whether drv_temp_sensors_init() has been called.
+static bool g_init_called = false;
+
 // Tracks whether the AHT20 has been successfully initialized.
 static bool g_aht20_initialized = false;
 
+// Error accounting, read by drv_temp_get_stats().
+static drv_temp_stats_t g_stats;
 
-/**
- * @brief Configure and initialize the I2C master peripheral.
- *
- * Uses parameters defined in config.h (I2C_MASTER_PORT, I2C_MASTER_SDA_IO,
- * I2C_MASTER_SCL_IO, I2C_MASTER_FREQ_HZ).
- *
- * @return ESP_OK on success, ESP_FAIL / ESP_ERR_* on error.
- */
-static esp_err_t i2c_master_init(void)
-{
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = I2C_MASTER_SDA_IO,
-        .scl_io_num = I2C_MASTER_SCL_IO,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = I2C_MASTER_FREQ_HZ   // Only clk_speed here in this IDF version
-    };
+// AHT20 status byte bits
+#define AHT20_STATUS_BUSY        0x80
 
-    esp_err_t err = i2c_param_config(I2C_MASTER_PORT, &conf);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-     // Install I2C driver with no RX/TX buffers for master mode
-    err = i2c_driver_install(I2C_MASTER_PORT, conf.mode, 0, 0, 0);
-    
-
-    return err;
-}
+// AHT20 frame: status + 5 data bytes + CRC
+#define AHT20_FRAME_LEN          7
 
 
 /**
@@ -89,11 +73,13 @@ static esp_err_t aht20_write_cmd(const uint8_t *data, size_t len)
     i2c_master_write(cmd, (uint8_t *)data, len, true);
     i2c_master_stop(cmd);
 
+    drv_i2c_bus_lock();
     esp_err_t err = i2c_master_cmd_begin(
         I2C_MASTER_PORT,
         cmd,
         pdMS_TO_TICKS(100)   // Command timeout
     );
+    drv_i2c_bus_unlock();
 
     i2c_cmd_link_delete(cmd);
     return err;
@@ -132,11 +118,13 @@ static esp_err_t aht20_read_bytes(uint8_t *data, size_t len)
 
     i2c_master_stop(cmd);
 
+    drv_i2c_bus_lock();
     esp_err_t err = i2c_master_cmd_begin(
         I2C_MASTER_PORT,
         cmd,
         pdMS_TO_TICKS(100)
     );
+    drv_i2c_bus_unlock();
 
     i2c_cmd_link_delete(cmd);
     return err;
@@ -172,22 +160,42 @@ static esp_err_t aht20_init(void)
 }
 
 
+/**
+ * @brief CRC-8 used by the AHT20 (poly 0x31, init 0xFF, no reflection).
+ */
+static uint8_t aht20_crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0xFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+
 /**
  * @brief Trigger a measurement on the AHT20 and read raw bytes.
  *
  * This function:
  *   - Sends the measurement command
  *   - Waits for the conversion time
- *   - Reads 6 bytes from the sensor (status + 5 data bytes)
+ *   - Reads 7 bytes from the sensor (status + 5 data bytes + CRC)
+ *   - Checks the busy flag and the CRC
  *
- * @param[out] buf Buffer to hold at least 6 bytes of raw data.
- * @param[in]  len Buffer length in bytes (must be >= 6).
+ * @param[out] buf Buffer to hold at least AHT20_FRAME_LEN bytes of raw data.
+ * @param[in]  len Buffer length in bytes (must be >= AHT20_FRAME_LEN).
  *
- * @return ESP_OK on success, ESP_ERR_INVALID_SIZE or ESP_ERR_* on error.
+ * @return ESP_OK on success, ESP_ERR_NOT_FINISHED if the sensor is still
+ *         busy, ESP_ERR_INVALID_CRC on CRC mismatch, ESP_ERR_* on I2C errors.
  */
 static esp_err_t aht20_measure_raw(uint8_t *buf, size_t len)
 {
-    if (buf == NULL || len < 6) {
+    if (buf == NULL || len < AHT20_FRAME_LEN) {
         return ESP_ERR_INVALID_SIZE;
     }
 
@@ -207,12 +215,20 @@ static esp_err_t aht20_measure_raw(uint8_t *buf, size_t len)
     // Wait for sensor to complete the measurement.
     vTaskDelay(pdMS_TO_TICKS(AHT20_MEASURE_DELAY_MS));
 
-    // Read 6 bytes: [0] status, [1..5] humidity + temperature bits
-    err = aht20_read_bytes(buf, 6);
+    // Read 7 bytes: [0] status, [1..5] humidity + temperature bits, [6] CRC
+    err = aht20_read_bytes(buf, AHT20_FRAME_LEN);
     if (err != ESP_OK) {
         return err;
     }
 
+    if (buf[0] & AHT20_STATUS_BUSY) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    if (aht20_crc8(buf, AHT20_FRAME_LEN - 1) != buf[AHT20_FRAME_LEN - 1]) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
     return ESP_OK;
 }
 
@@ -266,14 +282,14 @@ static esp_err_t aht20_raw_to_temp_c(const uint8_t *buf, float *out_temp_c)
  */
 app_error_t drv_temp_sensors_init(void)
 {
-    esp_err_t err = i2c_master_init();
-    if (err != ESP_OK) {
-        log_post(LOG_LEVEL_ERROR, TAG,
-                 "I2C init failed, err=%d", (int)err);
+    g_init_called = true;
+
+    if (drv_i2c_bus_init() != ERR_OK) {
+        log_post(LOG_LEVEL_ERROR, TAG, "I2C init failed");
         return ERR_GENERIC;
     }
 
-    err = aht20_init();
+    esp_err_t err = aht20_init();
     if (err != ESP_OK) {
         log_post(LOG_LEVEL_ERROR, TAG,
                  "AHT20 init failed, err=%d", (int)err);
@@ -289,6 +305,48 @@ app_error_t drv_temp_sensors_init(void)
 }
 
 
+/**
+ * @brief Account one failed AHT20 attempt in the matching counter.
+ */
+static void aht20_count_error(esp_err_t err)
+{
+    metrics_inc(METRIC_I2C_ERRORS);
+
+    switch (err) {
+    case ESP_FAIL:             g_stats.nacks++;      break;  // no ACK from slave
+    case ESP_ERR_TIMEOUT:      g_stats.timeouts++;   break;
+    case ESP_ERR_INVALID_CRC:  g_stats.crc_errors++; break;
+    case ESP_ERR_NOT_FINISHED: g_stats.busy++;       break;
+    default:                   g_stats.timeouts++;   break;  // bus / driver state
+    }
+}
+
+
+/**
+ * @brief Clear the bus and bring the AHT20 back to a known state.
+ *
+ * Used when retries alone do not help: a slave stuck mid-byte keeps SDA
+ * low and every further transaction times out until SCL is clocked out.
+ */
+static void aht20_recover(void)
+{
+    g_stats.recoveries++;
+    metrics_inc(METRIC_I2C_RECOVERIES);
+
+    if (drv_i2c_bus_recover() != ERR_OK) {
+        log_post(LOG_LEVEL_WARN, TAG, "I2C bus recovery incomplete");
+    }
+
+    esp_err_t err = aht20_init();
+    g_aht20_initialized = (err == ESP_OK);
+
+    log_post(LOG_LEVEL_WARN, TAG,
+             "AHT20 recovery #%lu: re-init %s",
+             (unsigned long)g_stats.recoveries,
+             g_aht20_initialized ? "ok" : "failed");
+}
+
+
 /**
  * @brief Read indoor and outdoor temperatures from hardware.
  *
@@ -296,6 +354,11 @@ app_error_t drv_temp_sensors_init(void)
  *   - Reads indoor temperature from AHT20 (Tin)
  *   - Sets outdoor temperature (Tout) equal to Tin as a placeholder
  *
+ * Transient I2C errors are retried up to AHT20_MAX_ATTEMPTS times with
+ * exponentially growing spacing (AHT20_RETRY_BASE_MS, x2 per attempt).
+ * From AHT20_RECOVER_AFTER_ATTEMPTS failed attempts on, each retry is
+ * preceded by a bus clear and sensor re-initialization.
+ *
  * In the future, this function can:
  *   - Use a second sensor for Tout
  *   - Fuse multiple sensors or apply filtering
@@ -310,19 +373,52 @@ app_error_t drv_temp_read(sensor_sample_t *out_sample)
         return ERR_GENERIC;
     }
 
-    if (!g_aht20_initialized) {
+    if (!g_init_called) {
         // Driver was not initialized; this indicates a programming or startup order bug.
         log_post(LOG_LEVEL_ERROR, TAG,
                  "drv_temp_read called before drv_temp_sensors_init");
         return ERR_GENERIC;
     }
 
-    uint8_t buf[6] = {0};
+    uint8_t buf[AHT20_FRAME_LEN] = {0};
+    esp_err_t err = ESP_FAIL;
+    uint32_t backoff_ms = AHT20_RETRY_BASE_MS;
+
+    for (int attempt = 0; attempt < AHT20_MAX_ATTEMPTS; attempt++) {
+
+        if (attempt > 0) {
+            g_stats.retries++;
+            metrics_inc(METRIC_I2C_RETRIES);
+            vTaskDelay(pdMS_TO_TICKS(backoff_ms));
+            backoff_ms *= 2u;
+        }
+
+        // Sensor lost (failed init or earlier recovery): re-init before use.
+        if (!g_aht20_initialized || attempt >= AHT20_RECOVER_AFTER_ATTEMPTS) {
+            aht20_recover();
+            if (!g_aht20_initialized) {
+                err = ESP_ERR_INVALID_STATE;
+                aht20_count_error(err);
+                continue;
+            }
+        }
+
+        err = aht20_measure_raw(buf, sizeof(buf));
+        if (err == ESP_OK) {
+            break;
+        }
+
+        aht20_count_error(err);
+        log_post(LOG_LEVEL_WARN, TAG,
+                 "AHT20 measure attempt %d/%d failed, err=%d",
+                 attempt + 1, AHT20_MAX_ATTEMPTS, (int)err);
+    }
 
-    esp_err_t err = aht20_measure_raw(buf, sizeof(buf));
     if (err != ESP_OK) {
+        g_stats.reads_failed++;
         log_post(LOG_LEVEL_ERROR, TAG,
-                 "AHT20 measure failed, err=%d", (int)err);
+                 "AHT20 measure failed after %d attempts, err=%d",
+                 AHT20_MAX_ATTEMPTS, (int)err);
         return ERR_GENERIC;
     }
 
@@ -338,8 +434,22 @@ app_error_t drv_temp_read(sensor_sample_t *out_sample)
     out_sample->temp_inside_c  = tin_c;
     out_sample->temp_outside_c = tin_c;  // Placeholder: single physical sensor for now
 
-    out_sample->timestamp_ms =
-        (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    out_sample->timestamp_us = monotime_now_us();
+
+    g_stats.reads_ok++;
+
+    return ERR_OK;
+}
+
+
+app_error_t drv_temp_get_stats(drv_temp_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return ERR_GENERIC;
+    }
 
+    // Counters are only written from the SENSORS task; a plain copy is
+    // good enough for diagnostics.
+    *out_stats = g_stats;
     return ERR_OK;
 }
@@ -0,0 +1,53 @@
+#ifndef LCD_BUS_H
+#define LCD_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/error.h"
+
+/**
+ * @file lcd_bus.h
+ * @brief Private transport interface between drv_display and the wiring
+ *        of the HD44780 (4-bit mode).
+ *
+ * drv_display decides *what* to send (commands, characters, the init
+ * sequence); the bus implementation decides *how* it reaches the LCD and
+ * takes care of the controller's settle times.
+ *
+ * All calls only queue work. Nothing is guaranteed to reach the LCD until
+ * lcd_bus_flush() is called, and lcd_bus_flush() itself does not wait for
+ * the transfer to finish.
+ *
+ * Called from the DISPLAY task only (single producer).
+ */
+
+/**
+ * @brief Configure the pins / peripherals used to talk to the LCD.
+ */
+app_error_t lcd_bus_init(void);
+
+/**
+ * @brief Queue one byte (two nibbles), RS low for commands, high for data.
+ *
+ * Clear (0x01) and home (0x02) commands get the long settle time.
+ */
+void lcd_bus_send(uint8_t val, bool rs);
+
+/**
+ * @brief Queue a single high-nibble write with RS low (init sequence only),
+ *        followed by @p settle_us of idle time.
+ */
+void lcd_bus_nibble(uint8_t nib, uint32_t settle_us);
+
+/**
+ * @brief Queue an idle period of @p us microseconds.
+ */
+void lcd_bus_delay_us(uint32_t us);
+
+/**
+ * @brief Start transferring everything queued so far. Returns immediately.
+ */
+void lcd_bus_flush(void);
+
+#endif  // LCD_BUS_H
@@ -0,0 +1,281 @@
+/**
+ * @file lcd_bus_gpio.c
+ * @brief Timer-driven HD44780 transfer engine over six GPIOs.
+ *
+ * Operations are queued in a small ring by the DISPLAY task and clocked
+ * out from a one-shot esp_timer dispatched from the timer ISR
+ * (ESP_TIMER_ISR). Each callback sends one byte (~4 us of register
+ * writes and enable pulses) and re-arms the timer for the controller's
+ * settle time, so nothing ever waits in place: no busy-wait between
+ * bytes, and no wake-up of the esp_timer task, which would preempt the
+ * network stack on core 0.
+ *
+ * lcd_bus_flush() only arms the timer. The one synchronous step left in
+ * the caller is a full ring: lcd_enqueue() then yields a tick at a time
+ * until the engine has drained a slot.
+ */
+
+#include "lcd_bus.h"
+
+#include "core/config.h"    // LCD_PIN_RS, LCD_PIN_EN, LCD_PIN_D4..D7
+#include "core/logging.h"
+
+#if LCD_BACKEND == LCD_BACKEND_GPIO
+
+#include "drivers/drv_gpio_port.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#if !CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+#error "LCD GPIO backend needs CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD"
+#endif
+
+static const char *TAG = "LCD_BUS";
+
+// Settle times after a byte (datasheet: 37 us typical, 1.52 ms for clear/home)
+#define LCD_SETTLE_US        50
+#define LCD_SETTLE_LONG_US   2000
+
+typedef enum {
+    LCD_OP_CMD = 0,     // byte, RS low
+    LCD_OP_DATA,        // byte, RS high
+    LCD_OP_NIBBLE,      // single nibble, RS low
+    LCD_OP_DELAY        // idle only
+} lcd_op_kind_t;
+
+typedef struct {
+    uint8_t  kind;      // lcd_op_kind_t
+    uint8_t  value;
+    uint16_t settle_us; // idle time after this op
+} lcd_op_t;
+
+// Ring of pending operations (one slot kept free to tell full from empty).
+static lcd_op_t          s_ring[LCD_XFER_QUEUE_LEN];
+static volatile uint16_t s_head = 0;   // written by producer
+static volatile uint16_t s_tail = 0;   // written by timer callback
+static volatile bool     s_running = false;
+
+static portMUX_TYPE       s_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_timer = NULL;
+
+// Precomputed port writes: one per data nibble value, plus EN and RS.
+static drv_gpio_port_masks_t s_nibble_masks[16];
+static drv_gpio_port_masks_t s_en_high, s_en_low;
+static drv_gpio_port_masks_t s_rs_cmd, s_rs_data;
+
+/* ---------------- Pin level helpers ---------------- */
+
+static void lcd_build_masks(void)
+{
+    const uint64_t data_pins =
+        (1ULL << LCD_PIN_D4) |
+        (1ULL << LCD_PIN_D5) |
+        (1ULL << LCD_PIN_D6) |
+        (1ULL << LCD_PIN_D7);
+
+    for (uint8_t nib = 0; nib < 16; nib++) {
+        uint64_t levels =
+            ((nib & 0x1) ? (1ULL << LCD_PIN_D4) : 0) |
+            ((nib & 0x2) ? (1ULL << LCD_PIN_D5) : 0) |
+            ((nib & 0x4) ? (1ULL << LCD_PIN_D6) : 0) |
+            ((nib & 0x8) ? (1ULL << LCD_PIN_D7) : 0);
+        drv_gpio_port_build(&s_nibble_masks[nib], data_pins, levels);
+    }
+
+    drv_gpio_port_build(&s_en_high, 1ULL << LCD_PIN_EN, 1ULL << LCD_PIN_EN);
+    drv_gpio_port_build(&s_en_low,  1ULL << LCD_PIN_EN, 0);
+    drv_gpio_port_build(&s_rs_data, 1ULL << LCD_PIN_RS, 1ULL << LCD_PIN_RS);
+    drv_gpio_port_build(&s_rs_cmd,  1ULL << LCD_PIN_RS, 0);
+}
+
+static inline void IRAM_ATTR lcd_pulse(void)
+{
+    // Enable pulse width >= 450 ns, cycle time >= 1 us.
+    drv_gpio_port_apply(&s_en_high);
+    esp_rom_delay_us(1);
+    drv_gpio_port_apply(&s_en_low);
+    esp_rom_delay_us(1);
+}
+
+static inline void IRAM_ATTR lcd_write_nibble(uint8_t nib)
+{
+    // D4..D7 change together in one clear + one set register write.
+    drv_gpio_port_apply(&s_nibble_masks[nib & 0x0F]);
+
+    lcd_pulse();
+}
+
+static void IRAM_ATTR lcd_exec(const lcd_op_t *op)
+{
+    switch (op->kind) {
+    case LCD_OP_CMD:
+    case LCD_OP_DATA:
+        drv_gpio_port_apply(op->kind == LCD_OP_DATA ? &s_rs_data : &s_rs_cmd);
+        lcd_write_nibble((op->value >> 4) & 0x0F);
+        lcd_write_nibble(op->value & 0x0F);
+        break;
+
+    case LCD_OP_NIBBLE:
+        drv_gpio_port_apply(&s_rs_cmd);
+        lcd_write_nibble(op->value & 0x0F);
+        break;
+
+    case LCD_OP_DELAY:
+    default:
+        break;
+    }
+}
+
+/* ---------------- Engine ---------------- */
+
+/**
+ * @brief Execute the next queued operation.
+ *
+ * Runs in the esp_timer ISR. Operations without a settle time run back to
+ * back; the first one that needs one re-arms the timer for it. Only one
+ * chain is ever active, guarded by s_running.
+ */
+static void IRAM_ATTR lcd_xfer_step(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        lcd_op_t op;
+
+        taskENTER_CRITICAL_ISR(&s_lock);
+        if (s_tail == s_head) {
+            s_running = false;
+            taskEXIT_CRITICAL_ISR(&s_lock);
+            return;
+        }
+        op = s_ring[s_tail];
+        s_tail = (uint16_t)((s_tail + 1u) % LCD_XFER_QUEUE_LEN);
+        taskEXIT_CRITICAL_ISR(&s_lock);
+
+        lcd_exec(&op);
+
+        if (op.settle_us > 0) {
+            esp_timer_start_once(s_timer, op.settle_us);
+            return;
+        }
+    }
+}
+
+static void lcd_enqueue(lcd_op_kind_t kind, uint8_t value, uint32_t settle_us)
+{
+    lcd_op_t op = {
+        .kind      = (uint8_t)kind,
+        .value     = value,
+        .settle_us = (uint16_t)(settle_us > UINT16_MAX ? UINT16_MAX : settle_us)
+    };
+
+    while (1) {
+        taskENTER_CRITICAL(&s_lock);
+        uint16_t next = (uint16_t)((s_head + 1u) % LCD_XFER_QUEUE_LEN);
+        if (next != s_tail) {
+            s_ring[s_head] = op;
+            s_head = next;
+            taskEXIT_CRITICAL(&s_lock);
+            return;
+        }
+        taskEXIT_CRITICAL(&s_lock);
+
+        // Ring full: make sure it drains, then yield instead of spinning.
+        lcd_bus_flush();
+        vTaskDelay(1);
+    }
+}
+
+/* ---------------- lcd_bus API ---------------- */
+
+app_error_t lcd_bus_init(void)
+{
+    uint64_t mask =
+        (1ULL << LCD_PIN_RS) |
+        (1ULL << LCD_PIN_EN) |
+        (1ULL << LCD_PIN_D4) |
+        (1ULL << LCD_PIN_D5) |
+        (1ULL << LCD_PIN_D6) |
+        (1ULL << LCD_PIN_D7);
+
+    gpio_config_t cfg = {
+        .pin_bit_mask = mask,
+        .mode         = GPIO_MODE_OUTPUT,
+        .pull_up_en   = 0,
+        .pull_down_en = 0,
+        .intr_type    = GPIO_INTR_DISABLE
+    };
+    gpio_config(&cfg);
+
+    lcd_build_masks();
+
+    // Known idle state: EN low, RS low. Data lines will be driven as needed.
+    drv_gpio_port_apply(&s_en_low);
+    drv_gpio_port_apply(&s_rs_cmd);
+
+    const esp_timer_create_args_t targs = {
+        .callback        = lcd_xfer_step,
+        .arg             = NULL,
+        .dispatch_method = ESP_TIMER_ISR,
+        .name            = "lcd_xfer"
+    };
+
+    esp_err_t err = esp_timer_create(&targs, &s_timer);
+    if (err != ESP_OK) {
+        log_post(LOG_LEVEL_ERROR, TAG, "esp_timer_create failed, err=%d", (int)err);
+        return ERR_GENERIC;
+    }
+
+    return ERR_OK;
+}
+
+void lcd_bus_send(uint8_t val, bool rs)
+{
+    // Clear (0x01) and home (0x02) need a longer delay
+    uint32_t settle = (!rs && (val == 0x01 || val == 0x02))
+                      ? LCD_SETTLE_LONG_US
+                      : LCD_SETTLE_US;
+
+    lcd_enqueue(rs ? LCD_OP_DATA : LCD_OP_CMD, val, settle);
+}
+
+void lcd_bus_nibble(uint8_t nib, uint32_t settle_us)
+{
+    lcd_enqueue(LCD_OP_NIBBLE, nib, settle_us);
+}
+
+void lcd_bus_delay_us(uint32_t us)
+{
+    // Split long waits so they fit the 16-bit per-op settle field.
+    while (us > 0) {
+        uint32_t chunk = (us > UINT16_MAX) ? UINT16_MAX : us;
+        lcd_enqueue(LCD_OP_DELAY, 0, chunk);
+        us -= chunk;
+    }
+}
+
+void lcd_bus_flush(void)
+{
+    bool start = false;
+
+    taskENTER_CRITICAL(&s_lock);
+    if (!s_running && s_tail != s_head) {
+        s_running = true;
+        start = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    // The transfer itself runs in the timer ISR, never here.
+    if (start) {
+        esp_timer_start_once(s_timer, 0);
+    }
+}
+
+#endif  // LCD_BACKEND == LCD_BACKEND_GPIO
@@ -0,0 +1,93 @@
+/**
+ * @file lcd_bus_pcf8574.c
+ * @brief HD44780 over a PCF8574 I2C backpack, one burst per frame.
+ *
+ * Commands and characters are encoded into a burst buffer as they are
+ * queued (lcd_pcf8574_enc.c) and sent as a single I2C write on
+ * lcd_bus_flush(), instead of one bit-banged sequence per nibble. The
+ * 50 ms power-up wait is a task delay.
+ */
+
+#include "lcd_bus.h"
+
+#include "core/config.h"
+#include "core/logging.h"
+
+#if LCD_BACKEND == LCD_BACKEND_PCF8574
+
+#include "lcd_pcf8574_enc.h"
+
+#include "drivers/drv_i2c_bus.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "driver/i2c.h"
+
+static const char *TAG = "LCD_I2C";
+
+static pcf_enc_t s_enc;
+
+/* ---------------- Transport ---------------- */
+
+static void pcf_write(void *ctx, const uint8_t *bytes, size_t len)
+{
+    drv_i2c_bus_lock();
+    esp_err_t err = i2c_master_write_to_device(I2C_MASTER_PORT,
+                                               LCD_PCF8574_ADDR,
+                                               bytes,
+                                               len,
+                                               pdMS_TO_TICKS(100));
+    drv_i2c_bus_unlock();
+
+    if (err != ESP_OK) {
+        log_post(LOG_LEVEL_WARN, TAG,
+                 "Burst of %u bytes failed, err=%d",
+                 (unsigned)len, (int)err);
+    }
+}
+
+static void pcf_sleep_us(void *ctx, uint32_t us)
+{
+    vTaskDelay(pdMS_TO_TICKS((us + 999u) / 1000u) + 1);
+}
+
+static const pcf_enc_ops_t s_ops = {
+    .write    = pcf_write,
+    .sleep_us = pcf_sleep_us,
+};
+
+/* ---------------- lcd_bus API ---------------- */
+
+app_error_t lcd_bus_init(void)
+{
+    if (drv_i2c_bus_init() != ERR_OK) {
+        log_post(LOG_LEVEL_ERROR, TAG, "I2C bus init failed");
+        return ERR_GENERIC;
+    }
+
+    pcf_enc_init(&s_enc, &s_ops, NULL);
+    return ERR_OK;
+}
+
+void lcd_bus_send(uint8_t val, bool rs)
+{
+    pcf_enc_send(&s_enc, val, rs);
+}
+
+void lcd_bus_nibble(uint8_t nib, uint32_t settle_us)
+{
+    pcf_enc_nibble(&s_enc, nib, settle_us);
+}
+
+void lcd_bus_delay_us(uint32_t us)
+{
+    pcf_enc_delay_us(&s_enc, us);
+}
+
+void lcd_bus_flush(void)
+{
+    pcf_enc_flush(&s_enc);
+}
+
+#endif  // LCD_BACKEND == LCD_BACKEND_PCF8574
@@ -0,0 +1,101 @@
+/**
+ * @file lcd_pcf8574_enc.c
+ * @brief PCF8574 byte-stream encoder (see lcd_pcf8574_enc.h).
+ *
+ * The PCF8574 sets all eight lines with every byte written to it, so one
+ * HD44780 nibble transfer is two expander bytes: data + EN high, then
+ * data + EN low. At 100 kHz one expander byte takes ~90 us on the wire,
+ * which already covers the enable pulse width and the 37 us command
+ * settle time; longer settle times are padded with idle bytes.
+ */
+
+#include "lcd_pcf8574_enc.h"
+
+// HD44780 settle times
+#define LCD_SETTLE_US        50
+#define LCD_SETTLE_LONG_US   2000
+
+void pcf_enc_init(pcf_enc_t *e, const pcf_enc_ops_t *ops, void *ctx)
+{
+    e->ops = ops;
+    e->ctx = ctx;
+    e->len = 0;
+}
+
+void pcf_enc_flush(pcf_enc_t *e)
+{
+    if (e->len == 0) {
+        return;
+    }
+    e->ops->write(e->ctx, e->buf, e->len);
+    e->len = 0;
+}
+
+static void enc_put(pcf_enc_t *e, const uint8_t *bytes, size_t n)
+{
+    if (e->len + n > sizeof(e->buf)) {
+        pcf_enc_flush(e);
+    }
+    for (size_t i = 0; i < n; i++) {
+        e->buf[e->len++] = bytes[i];
+    }
+}
+
+/**
+ * @brief Encode one 4-bit transfer as two expander bytes.
+ *
+ * @param[out] out  Two bytes: EN high, then EN low (data latched on fall).
+ * @param      nib  Nibble in the low 4 bits.
+ * @param      rs   Register select (false = command, true = data).
+ */
+static void enc_nibble(uint8_t out[2], uint8_t nib, bool rs)
+{
+    uint8_t v = (uint8_t)(((nib & 0x0F) << 4) | PCF_BACKLIGHT | (rs ? PCF_RS : 0));
+
+    out[0] = v | PCF_EN;
+    out[1] = v;
+}
+
+void pcf_enc_delay_us(pcf_enc_t *e, uint32_t us)
+{
+    if (us <= PCF_BYTE_US) {
+        return;  // the next byte on the wire is late enough already
+    }
+
+    if (us > PCF_MAX_PAD_US) {
+        pcf_enc_flush(e);
+        e->ops->sleep_us(e->ctx, us);
+        return;
+    }
+
+    uint8_t idle = PCF_BACKLIGHT;
+    if (e->len > 0) {
+        idle = e->buf[e->len - 1] & (uint8_t)~PCF_EN;
+    }
+
+    for (uint32_t t = PCF_BYTE_US; t < us; t += PCF_BYTE_US) {
+        enc_put(e, &idle, 1);
+    }
+}
+
+void pcf_enc_send(pcf_enc_t *e, uint8_t val, bool rs)
+{
+    uint8_t bytes[4];
+
+    enc_nibble(&bytes[0], (val >> 4) & 0x0F, rs);
+    enc_nibble(&bytes[2], val & 0x0F, rs);
+    enc_put(e, bytes, sizeof(bytes));
+
+    pcf_enc_delay_us(e, (!rs && (val == 0x01 || val == 0x02))
+                        ? LCD_SETTLE_LONG_US
+                        : LCD_SETTLE_US);
+}
+
+void pcf_enc_nibble(pcf_enc_t *e, uint8_t nib, uint32_t settle_us)
+{
+    uint8_t bytes[2];
+
+    enc_nibble(bytes, nib, false);
+    enc_put(e, bytes, sizeof(bytes));
+    pcf_enc_delay_us(e, settle_us);
+}
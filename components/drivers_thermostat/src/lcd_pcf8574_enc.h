@@ -0,0 +1,78 @@
+#ifndef LCD_PCF8574_ENC_H
+#define LCD_PCF8574_ENC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "core/config.h"
+
+/**
+ * @file lcd_pcf8574_enc.h
+ * @brief Byte-stream encoder for an HD44780 behind a PCF8574 backpack.
+ *
+ * Turns lcd_bus operations into the expander bytes that go on the wire
+ * and hands them to a write callback in bursts. Pure code: the I2C
+ * transfer and the task sleep live in lcd_bus_pcf8574.c, so the encoding
+ * can be checked on the host.
+ *
+ * Backpack wiring (common PCF8574 modules):
+ *   P0 = RS, P1 = RW, P2 = EN, P3 = backlight, P4..P7 = D4..D7
+ */
+
+#define PCF_RS          0x01
+#define PCF_RW          0x02
+#define PCF_EN          0x04
+#define PCF_BACKLIGHT   0x08
+
+// Wire time of one expander byte at I2C_MASTER_FREQ_HZ (9 clocks), rounded up.
+#define PCF_BYTE_US     ((9u * 1000000u + I2C_MASTER_FREQ_HZ - 1u) / I2C_MASTER_FREQ_HZ)
+
+// Delays longer than this end the burst and sleep instead of padding.
+#define PCF_MAX_PAD_US  5000u
+
+/**
+ * @brief Transport callbacks used by the encoder.
+ */
+typedef struct {
+    /** Send @p len expander bytes as one I2C write. */
+    void (*write)(void *ctx, const uint8_t *bytes, size_t len);
+    /** Sleep at least @p us (called right after a write of the pending burst). */
+    void (*sleep_us)(void *ctx, uint32_t us);
+} pcf_enc_ops_t;
+
+typedef struct {
+    const pcf_enc_ops_t *ops;
+    void                *ctx;
+    size_t               len;
+    uint8_t              buf[LCD_PCF8574_BURST_LEN];
+} pcf_enc_t;
+
+void pcf_enc_init(pcf_enc_t *e, const pcf_enc_ops_t *ops, void *ctx);
+
+/**
+ * @brief Encode one byte (two nibbles) plus its HD44780 settle time.
+ *
+ * Clear (0x01) and home (0x02) commands get the long settle time.
+ */
+void pcf_enc_send(pcf_enc_t *e, uint8_t val, bool rs);
+
+/**
+ * @brief Encode a single high-nibble write with RS low, then @p settle_us.
+ */
+void pcf_enc_nibble(pcf_enc_t *e, uint8_t nib, uint32_t settle_us);
+
+/**
+ * @brief Wait @p us after the last encoded byte.
+ *
+ * Short waits become idle bytes (EN low, lines unchanged) inside the
+ * burst; waits over PCF_MAX_PAD_US write the burst and sleep.
+ */
+void pcf_enc_delay_us(pcf_enc_t *e, uint32_t us);
+
+/**
+ * @brief Write whatever is pending as one burst.
+ */
+void pcf_enc_flush(pcf_enc_t *e);
+
+#endif  // LCD_PCF8574_ENC_H
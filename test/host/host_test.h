@@ -0,0 +1,76 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+/**
+ * @file host_test.h
+ * @brief Minimal check macros for the host tests.
+ *
+ * A failed CHECK prints file:line and the expression and counts the
+ * failure; the test carries on so one run reports every failure.
+ * HOST_TEST_RESULT() is the exit code for main().
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+static int s_host_test_failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                    \
+                    __FILE__, __LINE__, #cond);                             \
+            s_host_test_failures++;                                         \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ_INT(a, b)                                                  \
+    do {                                                                    \
+        const long long a_ = (long long)(a), b_ = (long long)(b);           \
+        if (a_ != b_) {                                                     \
+            fprintf(stderr, "%s:%d: %s == %s failed (%lld != %lld)\n",      \
+                    __FILE__, __LINE__, #a, #b, a_, b_);                    \
+            s_host_test_failures++;                                         \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ_STR(a, b)                                                  \
+    do {                                                                    \
+        const char *a_ = (a), *b_ = (b);                                    \
+        if (strcmp(a_, b_) != 0) {                                          \
+            fprintf(stderr, "%s:%d: %s == %s failed (\"%s\" != \"%s\")\n",  \
+                    __FILE__, __LINE__, #a, #b, a_, b_);                    \
+            s_host_test_failures++;                                         \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ_MEM(a, b, n)                                               \
+    do {                                                                    \
+        if (memcmp((a), (b), (n)) != 0) {                                   \
+            fprintf(stderr, "%s:%d: %s == %s failed (%zu bytes)\n",         \
+                    __FILE__, __LINE__, #a, #b, (size_t)(n));               \
+            s_host_test_failures++;                                         \
+        }                                                                   \
+    } while (0)
+
+#define RUN_TEST(fn)                                                        \
+    do {                                                                    \
+        const int before_ = s_host_test_failures;                           \
+        fn();                                                               \
+        printf("%-40s %s\n", #fn,                                           \
+               (s_host_test_failures == before_) ? "ok" : "FAILED");        \
+    } while (0)
+
+#define HOST_TEST_RESULT()   (s_host_test_failures == 0 ? 0 : 1)
+
+/** @brief Wall-clock nanoseconds, for the benchmark printouts. */
+static inline uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#endif  // HOST_TEST_H
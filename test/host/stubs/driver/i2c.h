@@ -0,0 +1,33 @@
+#ifndef HOST_STUB_DRIVER_I2C_H
+#define HOST_STUB_DRIVER_I2C_H
+
+// Host shim: the legacy I2C master API as used by the drivers. Tests
+// implement it with a device model (see test_aht20_retry.c).
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef int   i2c_port_t;
+typedef void *i2c_cmd_handle_t;
+
+typedef enum { I2C_MASTER_ACK = 0, I2C_MASTER_NACK = 1, I2C_MASTER_LAST_NACK = 2 } i2c_ack_type_t;
+
+#define I2C_NUM_0          0
+#define I2C_MASTER_WRITE   0
+#define I2C_MASTER_READ    1
+
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void      i2c_cmd_link_delete(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data, size_t len, bool ack_en);
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t *data, i2c_ack_type_t ack);
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data, size_t len, i2c_ack_type_t ack);
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks);
+
+#endif
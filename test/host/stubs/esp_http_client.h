@@ -0,0 +1,46 @@
+#ifndef HOST_STUB_ESP_HTTP_CLIENT_H
+#define HOST_STUB_ESP_HTTP_CLIENT_H
+
+// Host shim: the esp_http_client subset the telemetry uploader uses,
+// implemented over a POSIX socket by host_http_client.c.
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+typedef enum {
+    HTTP_METHOD_GET = 0,
+    HTTP_METHOD_POST,
+} esp_http_client_method_t;
+
+typedef enum {
+    HTTP_TRANSPORT_UNKNOWN = 0,
+    HTTP_TRANSPORT_OVER_TCP,
+    HTTP_TRANSPORT_OVER_SSL,
+} esp_http_client_transport_t;
+
+typedef struct {
+    const char                 *url;
+    esp_http_client_method_t    method;
+    esp_http_client_transport_t transport_type;
+    int                         timeout_ms;
+    bool                        keep_alive_enable;
+    int                         buffer_size_tx;
+} esp_http_client_config_t;
+
+typedef struct host_http_client *esp_http_client_handle_t;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *cfg);
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t c, const char *key,
+                                     const char *value);
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t c,
+                                         const char *data, int len);
+esp_err_t esp_http_client_perform(esp_http_client_handle_t c);
+int       esp_http_client_get_status_code(esp_http_client_handle_t c);
+esp_err_t esp_http_client_close(esp_http_client_handle_t c);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t c);
+
+// Host only: connect to 127.0.0.1:@p port whatever the URL says.
+void host_http_client_redirect(int port);
+
+#endif
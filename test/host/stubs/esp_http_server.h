@@ -0,0 +1,74 @@
+#ifndef HOST_STUB_ESP_HTTP_SERVER_H
+#define HOST_STUB_ESP_HTTP_SERVER_H
+
+// Host shim: the esp_http_server subset the local API uses, implemented
+// over a POSIX socket by host_httpd.c.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "esp_err.h"
+
+#define ESP_ERR_HTTPD_BASE          0xb000
+#define ESP_ERR_HTTPD_RESULT_TRUNC  (ESP_ERR_HTTPD_BASE + 7)
+
+#define HTTPD_RESP_USE_STRLEN       -1
+
+typedef void *httpd_handle_t;
+
+typedef enum {
+    HTTP_GET = 1,
+} httpd_method_t;
+
+typedef struct httpd_req {
+    const char *uri;            // path and query, as received
+    void       *user_ctx;
+
+    // Host shim state for the response in progress.
+    int         fd;
+    bool        head_sent;
+    bool        failed;
+    const char *type;
+    const char *status;
+    char        hdr[256];
+} httpd_req_t;
+
+typedef struct {
+    const char     *uri;
+    httpd_method_t  method;
+    esp_err_t     (*handler)(httpd_req_t *req);
+    void           *user_ctx;
+} httpd_uri_t;
+
+typedef struct {
+    uint16_t server_port;
+    uint16_t max_uri_handlers;
+    uint32_t stack_size;
+    unsigned task_priority;
+    int      core_id;
+    bool     lru_purge_enable;
+    uint16_t max_open_sockets;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() { .server_port = 80, .max_uri_handlers = 8, \
+                                 .max_open_sockets = 7 }
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *cfg);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri);
+
+esp_err_t httpd_resp_set_status(httpd_req_t *req, const char *status);
+esp_err_t httpd_resp_set_type(httpd_req_t *req, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *req, const char *field, const char *value);
+esp_err_t httpd_resp_send(httpd_req_t *req, const char *buf, ssize_t len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *req, const char *buf, ssize_t len);
+esp_err_t httpd_resp_send_500(httpd_req_t *req);
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *req, char *buf, size_t len);
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t len);
+
+// Host only: the port the server listens on (127.0.0.1, chosen by the
+// kernel whatever server_port says); 0 until httpd_start() has run.
+int host_httpd_port(void);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_STUB_ESP_SYSTEM_H
+#define HOST_STUB_ESP_SYSTEM_H
+
+// Host shim: heap figures reported by the diagnostics endpoints; the
+// test that needs them defines them.
+
+#include <stdint.h>
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef HOST_STUB_FREERTOS_H
+#define HOST_STUB_FREERTOS_H
+
+// Host shim: FreeRTOS types and macros only. A test either defines the
+// few kernel functions it calls itself, or links stubs/host_rtos.c (a
+// pthread-backed implementation) when it needs real threads.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef uint32_t      TickType_t;
+typedef long          BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint8_t       StackType_t;
+
+#define pdFALSE          ((BaseType_t)0)
+#define pdTRUE           ((BaseType_t)1)
+#define pdPASS           pdTRUE
+#define pdFAIL           pdFALSE
+#define portMAX_DELAY    ((TickType_t)0xffffffffu)
+#define portTICK_PERIOD_MS 1u
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMAX_PRIORITIES 25
+#define portNUM_PROCESSORS   2
+#define tskNO_AFFINITY       ((BaseType_t)0x7fffffff)
+
+// Critical sections: one process-wide lock is enough on the host.
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+#define portMUX_INITIALIZE(mux)        ((void)(mux))
+
+void host_critical_enter(portMUX_TYPE *mux);
+void host_critical_exit(portMUX_TYPE *mux);
+
+#define taskENTER_CRITICAL(mux)        host_critical_enter(mux)
+#define taskEXIT_CRITICAL(mux)         host_critical_exit(mux)
+#define taskENTER_CRITICAL_ISR(mux)    host_critical_enter(mux)
+#define taskEXIT_CRITICAL_ISR(mux)     host_critical_exit(mux)
+#define portENTER_CRITICAL(mux)        host_critical_enter(mux)
+#define portEXIT_CRITICAL(mux)         host_critical_exit(mux)
+
+#endif
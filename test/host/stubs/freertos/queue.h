@@ -0,0 +1,18 @@
+#ifndef HOST_STUB_QUEUE_H
+#define HOST_STUB_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_queue *QueueHandle_t;
+typedef struct { uint8_t unused; } StaticQueue_t;
+
+// Implemented by stubs/host_rtos.c (mutex + condvar, copy in / copy out).
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void          vQueueDelete(QueueHandle_t q);
+BaseType_t    xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks);
+BaseType_t    xQueueOverwrite(QueueHandle_t q, const void *item);
+BaseType_t    xQueueReceive(QueueHandle_t q, void *out, TickType_t ticks);
+BaseType_t    xQueuePeek(QueueHandle_t q, void *out, TickType_t ticks);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t q);
+
+#endif
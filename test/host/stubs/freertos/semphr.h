@@ -0,0 +1,11 @@
+#ifndef HOST_STUB_SEMPHR_H
+#define HOST_STUB_SEMPHR_H
+
+// Host shim: semaphore types only, for headers that name them.
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+typedef struct { uint8_t unused; } StaticSemaphore_t;
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef HOST_STUB_TASK_H
+#define HOST_STUB_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+typedef struct { uint8_t unused; } StaticTask_t;
+
+void         vTaskDelay(TickType_t ticks);
+void         vTaskDelete(TaskHandle_t task);
+TickType_t   xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t   ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_STUB_TIMERS_H
+#define HOST_STUB_TIMERS_H
+
+// Host shim: software timer types only, for headers that name them.
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_timer *TimerHandle_t;
+typedef struct { uint8_t unused; } StaticTimer_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+#endif
@@ -0,0 +1,250 @@
+#define _GNU_SOURCE
+/**
+ * esp_http_client over a POSIX TCP socket, enough for the telemetry
+ * uploader: POST with persistent headers, keep-alive reuse of one
+ * connection, Content-Length responses, and the same error behaviour on
+ * timeouts (ESP_ERR_HTTP_* collapsed to ESP_FAIL / ESP_ERR_TIMEOUT).
+ */
+
+#include "esp_http_client.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define HOST_HTTP_MAX_HEADERS   8
+
+struct host_http_client {
+    char        path[128];
+    int         timeout_ms;
+    bool        keep_alive;
+    int         fd;
+    int         status;
+    const char *body;
+    int         body_len;
+    struct {
+        char key[32];
+        char value[64];
+    } hdr[HOST_HTTP_MAX_HEADERS];
+    int         nhdr;
+};
+
+static int s_port = 80;
+
+void host_http_client_redirect(int port)
+{
+    s_port = port;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *cfg)
+{
+    struct host_http_client *c = calloc(1, sizeof(*c));
+    if (c == NULL) {
+        return NULL;
+    }
+
+    // Keep only the path: the host part is replaced by the redirect port.
+    const char *p = strstr(cfg->url, "://");
+    p = (p != NULL) ? strchr(p + 3, '/') : NULL;
+    snprintf(c->path, sizeof(c->path), "%s", (p != NULL) ? p : "/");
+
+    c->timeout_ms = cfg->timeout_ms;
+    c->keep_alive = cfg->keep_alive_enable;
+    c->fd         = -1;
+    return c;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t c, const char *key,
+                                     const char *value)
+{
+    int i = 0;
+    while (i < c->nhdr && strcasecmp(c->hdr[i].key, key) != 0) {
+        i++;
+    }
+    if (i == HOST_HTTP_MAX_HEADERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (i == c->nhdr) {
+        c->nhdr++;
+    }
+    snprintf(c->hdr[i].key, sizeof(c->hdr[i].key), "%s", key);
+    snprintf(c->hdr[i].value, sizeof(c->hdr[i].value), "%s", value);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t c,
+                                         const char *data, int len)
+{
+    c->body     = data;
+    c->body_len = len;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t c)
+{
+    if (c->fd >= 0) {
+        close(c->fd);
+        c->fd = -1;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t c)
+{
+    esp_http_client_close(c);
+    free(c);
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t c)
+{
+    return c->status;
+}
+
+static bool client_connect(esp_http_client_handle_t c)
+{
+    const struct timeval tv = {
+        .tv_sec  = c->timeout_ms / 1000,
+        .tv_usec = (c->timeout_ms % 1000) * 1000,
+    };
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port   = htons((uint16_t)s_port),
+    };
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    c->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c->fd < 0) {
+        return false;
+    }
+    setsockopt(c->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(c->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    // Header and body go out in two writes; don't let Nagle + delayed
+    // ACK add 40 ms to every POST.
+    const int one = 1;
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        esp_http_client_close(c);
+        return false;
+    }
+    return true;
+}
+
+static bool send_all(int fd, const char *p, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        p   += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool send_request(esp_http_client_handle_t c)
+{
+    char head[512];
+    int  n = snprintf(head, sizeof(head),
+                      "POST %s HTTP/1.1\r\nHost: collector\r\n"
+                      "Content-Length: %d\r\n%s",
+                      c->path, c->body_len,
+                      c->keep_alive ? "" : "Connection: close\r\n");
+    for (int i = 0; i < c->nhdr; i++) {
+        n += snprintf(head + n, sizeof(head) - (size_t)n, "%s: %s\r\n",
+                      c->hdr[i].key, c->hdr[i].value);
+    }
+    n += snprintf(head + n, sizeof(head) - (size_t)n, "\r\n");
+
+    return send_all(c->fd, head, (size_t)n) &&
+           send_all(c->fd, c->body, (size_t)c->body_len);
+}
+
+/**
+ * @brief Read one response; -1 on error, 0 on timeout, 1 on success.
+ */
+static int read_response(esp_http_client_handle_t c, bool *server_close)
+{
+    char   buf[1024];
+    size_t len = 0;
+    char  *end = NULL;
+
+    while (end == NULL) {
+        if (len == sizeof(buf) - 1) {
+            return -1;
+        }
+        ssize_t n = recv(c->fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        if (n == 0) {
+            return -1;
+        }
+        len += (size_t)n;
+        buf[len] = '\0';
+        end = strstr(buf, "\r\n\r\n");
+    }
+
+    if (sscanf(buf, "HTTP/1.%*d %d", &c->status) != 1) {
+        return -1;
+    }
+
+    int   content_len = 0;
+    char *cl          = strcasestr(buf, "\r\nContent-Length:");
+    if (cl != NULL) {
+        content_len = atoi(cl + 17);
+    }
+    *server_close = strcasestr(buf, "\r\nConnection: close") != NULL;
+
+    // Discard the body.
+    size_t have = len - (size_t)(end + 4 - buf);
+    while ((int)have < content_len) {
+        ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) ? 0 : -1;
+        }
+        have += (size_t)n;
+    }
+    return 1;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t c)
+{
+    c->status = 0;
+
+    // A reused connection may have been closed by the server meanwhile:
+    // like the real client, reconnect once before giving up.
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const bool reused = (c->fd >= 0);
+        if (!reused && !client_connect(c)) {
+            return ESP_FAIL;
+        }
+
+        bool server_close = false;
+        int  r            = send_request(c) ? read_response(c, &server_close) : -1;
+
+        if (r == 1) {
+            if (server_close || !c->keep_alive) {
+                esp_http_client_close(c);
+            }
+            return ESP_OK;
+        }
+        esp_http_client_close(c);
+        if (r == 0) {
+            return ESP_ERR_TIMEOUT;
+        }
+        if (!reused) {
+            return ESP_FAIL;
+        }
+    }
+    return ESP_FAIL;
+}
@@ -0,0 +1,286 @@
+#define _GNU_SOURCE
+/**
+ * esp_http_server over a POSIX TCP socket, enough for the local API:
+ * GET with a query string, keep-alive, handlers matched on the exact
+ * path, responses with Content-Length (httpd_resp_send) or chunked
+ * transfer encoding (httpd_resp_send_chunk), 404 for unknown paths.
+ *
+ * Like the IDF server, one thread serves every connection and a handler
+ * returning an error closes its connection. Unlike it, connections are
+ * served one at a time, and each chunk goes out in one send() instead of
+ * three.
+ */
+
+#include "esp_http_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define HOST_HTTPD_MAX_URIS     16
+#define HOST_HTTPD_REQ_BYTES    2048
+
+static struct {
+    int         listen_fd;
+    volatile int port;
+    int         nuris;
+    httpd_uri_t uris[HOST_HTTPD_MAX_URIS];
+} s_srv;
+
+int host_httpd_port(void)
+{
+    return __atomic_load_n(&s_srv.port, __ATOMIC_ACQUIRE);
+}
+
+/* ---------------- Responses ---------------- */
+
+static bool send_all(int fd, const char *p, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        p   += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static esp_err_t send_head(httpd_req_t *req, long content_len)
+{
+    char   head[512];
+    int    n = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\n%s",
+                        req->status, req->type, req->hdr);
+    if (content_len >= 0) {
+        n += snprintf(head + n, sizeof(head) - (size_t)n,
+                      "Content-Length: %ld\r\n\r\n", content_len);
+    } else {
+        n += snprintf(head + n, sizeof(head) - (size_t)n,
+                      "Transfer-Encoding: chunked\r\n\r\n");
+    }
+    req->head_sent = true;
+    if (!send_all(req->fd, head, (size_t)n)) {
+        req->failed = true;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *req, const char *status)
+{
+    req->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *req, const char *type)
+{
+    req->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *req, const char *field, const char *value)
+{
+    const size_t used = strlen(req->hdr);
+    const int    n    = snprintf(req->hdr + used, sizeof(req->hdr) - used,
+                                 "%s: %s\r\n", field, value);
+    return (n > 0 && (size_t)n < sizeof(req->hdr) - used) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *req, const char *buf, ssize_t len)
+{
+    if (len == HTTPD_RESP_USE_STRLEN) {
+        len = (buf != NULL) ? (ssize_t)strlen(buf) : 0;
+    }
+    if (req->head_sent || send_head(req, (long)len) != ESP_OK ||
+        !send_all(req->fd, buf, (size_t)len)) {
+        req->failed = true;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *req, const char *buf, ssize_t len)
+{
+    if (len == HTTPD_RESP_USE_STRLEN) {
+        len = (buf != NULL) ? (ssize_t)strlen(buf) : 0;
+    }
+    if (req->failed || (!req->head_sent && send_head(req, -1) != ESP_OK)) {
+        return ESP_FAIL;
+    }
+
+    // NULL / 0 ends the response.
+    static char chunk[16 + 4096];
+    size_t      n;
+    if (buf == NULL || len == 0) {
+        n = (size_t)snprintf(chunk, sizeof(chunk), "0\r\n\r\n");
+    } else if ((size_t)len <= sizeof(chunk) - 16) {
+        n = (size_t)snprintf(chunk, sizeof(chunk), "%zx\r\n", (size_t)len);
+        memcpy(chunk + n, buf, (size_t)len);
+        n += (size_t)len;
+        chunk[n++] = '\r';
+        chunk[n++] = '\n';
+    } else {
+        req->failed = true;
+        return ESP_FAIL;
+    }
+    if (!send_all(req->fd, chunk, n)) {
+        req->failed = true;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_500(httpd_req_t *req)
+{
+    req->status = "500 Internal Server Error";
+    req->type   = "text/html";
+    return httpd_resp_send(req, "Internal Server Error", HTTPD_RESP_USE_STRLEN);
+}
+
+/* ---------------- Query strings ---------------- */
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *req, char *buf, size_t len)
+{
+    const char *q = strchr(req->uri, '?');
+    if (q == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const int n = snprintf(buf, len, "%s", q + 1);
+    return ((size_t)n < len) ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t len)
+{
+    const size_t klen = strlen(key);
+
+    for (const char *p = qry; p != NULL && *p != '\0'; ) {
+        const char *end = strchr(p, '&');
+        const size_t plen = (end != NULL) ? (size_t)(end - p) : strlen(p);
+
+        if (plen > klen && strncmp(p, key, klen) == 0 && p[klen] == '=') {
+            const size_t vlen = plen - klen - 1;
+            snprintf(val, len, "%.*s", (int)vlen, p + klen + 1);
+            return (vlen < len) ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+        }
+        p = (end != NULL) ? end + 1 : NULL;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/* ---------------- Server ---------------- */
+
+/** Serve one request from @p head; false closes the connection. */
+static bool serve(int fd, char *head)
+{
+    char *uri = strchr(head, ' ');
+    char *end = (uri != NULL) ? strchr(uri + 1, ' ') : NULL;
+    if (strncmp(head, "GET ", 4) != 0 || end == NULL) {
+        return false;
+    }
+    *end = '\0';
+    uri++;
+
+    const size_t path_len = strcspn(uri, "?");
+    for (int i = 0; i < s_srv.nuris; i++) {
+        const httpd_uri_t *u = &s_srv.uris[i];
+        if (strlen(u->uri) != path_len || strncmp(u->uri, uri, path_len) != 0) {
+            continue;
+        }
+        httpd_req_t req = {
+            .uri      = uri,
+            .user_ctx = u->user_ctx,
+            .fd       = fd,
+            .type     = "text/html",
+            .status   = "200 OK",
+        };
+        return u->handler(&req) == ESP_OK && !req.failed;
+    }
+
+    static const char nf[] = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+    return send_all(fd, nf, sizeof(nf) - 1);
+}
+
+static void serve_connection(int fd)
+{
+    static char buf[HOST_HTTPD_REQ_BYTES];
+    size_t      len = 0;
+
+    while (1) {
+        char *end;
+        while ((end = memmem(buf, len, "\r\n\r\n", 4)) == NULL) {
+            if (len == sizeof(buf) - 1) {
+                return;
+            }
+            ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+            if (n <= 0) {
+                return;
+            }
+            len += (size_t)n;
+        }
+
+        // GET has no body: the next request starts after the blank line.
+        const size_t used = (size_t)(end + 4 - buf);
+        *end = '\0';
+        if (!serve(fd, buf)) {
+            return;
+        }
+        memmove(buf, buf + used, len - used);
+        len -= used;
+    }
+}
+
+static void *server_thread(void *arg)
+{
+    while (1) {
+        const int fd = accept(s_srv.listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        serve_connection(fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *cfg)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    socklen_t          alen = sizeof(addr);
+
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    s_srv.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s_srv.listen_fd < 0 ||
+        bind(s_srv.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(s_srv.listen_fd, 8) != 0) {
+        return ESP_FAIL;
+    }
+    getsockname(s_srv.listen_fd, (struct sockaddr *)&addr, &alen);
+
+    pthread_t t;
+    if (pthread_create(&t, NULL, server_thread, NULL) != 0) {
+        return ESP_FAIL;
+    }
+    pthread_detach(t);
+
+    *handle = &s_srv;
+    __atomic_store_n(&s_srv.port, ntohs(addr.sin_port), __ATOMIC_RELEASE);
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri)
+{
+    if (s_srv.nuris == HOST_HTTPD_MAX_URIS) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_srv.uris[s_srv.nuris++] = *uri;
+    return ESP_OK;
+}
@@ -0,0 +1,436 @@
+#define _GNU_SOURCE
+/**
+ * esp-mqtt client over a POSIX TCP socket, enough for task_mqtt.c:
+ * MQTT 3.1.1 CONNECT with a last will, SUBSCRIBE, PUBLISH QoS 0/1 out,
+ * PUBLISH in as MQTT_EVENT_DATA, PINGREQ at half the keepalive, and
+ * reconnect after a dropped session.
+ *
+ * Like esp-mqtt, a client thread owns the socket and delivers events, and
+ * enqueue only appends to an outbox under the API lock; the client
+ * thread holds that lock while it writes the outbox out. Differences: the
+ * reconnect delay defaults to HOST_MQTT_RECONNECT_MS instead of 10 s,
+ * nothing is retried (QoS 1 is sent, its PUBACK ignored), and enqueue
+ * while disconnected fails instead of storing the message.
+ */
+
+#include "mqtt_client.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define HOST_MQTT_OUTBOX_BYTES  16384
+#define HOST_MQTT_RX_BYTES      4096
+#define HOST_MQTT_RECONNECT_MS  100
+
+struct host_mqtt_client {
+    char                client_id[64];
+    char                will_topic[128];
+    char                will_msg[64];
+    int                 will_qos;
+    int                 will_retain;
+    int                 keepalive_s;
+    int                 timeout_ms;
+    int                 reconnect_ms;
+
+    esp_event_handler_t handler;
+    void               *handler_arg;
+
+    pthread_mutex_t     lock;           // API lock: outbox, connected, next_id
+    bool                connected;
+    uint16_t            next_id;
+    size_t              out_len;
+    uint8_t             outbox[HOST_MQTT_OUTBOX_BYTES];
+    int                 wake[2];        // pipe: enqueue -> client thread
+};
+
+static int s_port = 1883;
+
+void host_mqtt_client_redirect(int port)
+{
+    s_port = port;
+}
+
+/* ---------------- Encoding ---------------- */
+
+static size_t put_remaining_len(uint8_t *p, size_t len)
+{
+    size_t n = 0;
+    do {
+        uint8_t b = len & 0x7f;
+        len >>= 7;
+        p[n++] = b | (len > 0 ? 0x80 : 0);
+    } while (len > 0);
+    return n;
+}
+
+static size_t put_str(uint8_t *p, const char *s, size_t len)
+{
+    p[0] = (uint8_t)(len >> 8);
+    p[1] = (uint8_t)len;
+    memcpy(p + 2, s, len);
+    return 2 + len;
+}
+
+/** Append one packet (@p type byte + @p body) to the outbox; lock held. */
+static bool outbox_put(struct host_mqtt_client *c, uint8_t type,
+                       const uint8_t *body, size_t body_len)
+{
+    if (c->out_len + 5 + body_len > sizeof(c->outbox)) {
+        return false;
+    }
+    uint8_t *p = c->outbox + c->out_len;
+    p[0] = type;
+    size_t n = 1 + put_remaining_len(p + 1, body_len);
+    memcpy(p + n, body, body_len);
+    c->out_len += n + body_len;
+
+    const char one = 1;
+    (void)!write(c->wake[1], &one, 1);
+    return true;
+}
+
+static uint16_t take_id(struct host_mqtt_client *c)
+{
+    if (++c->next_id == 0) {
+        c->next_id = 1;
+    }
+    return c->next_id;
+}
+
+/* ---------------- Socket ---------------- */
+
+static bool send_all(int fd, const uint8_t *p, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        p   += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool recv_all(int fd, uint8_t *p, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        p   += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/** Read one packet; returns the type byte, or -1 on error / EOF / overlong. */
+static int read_packet(int fd, uint8_t *body, size_t cap, size_t *body_len)
+{
+    uint8_t type;
+    if (!recv_all(fd, &type, 1)) {
+        return -1;
+    }
+
+    size_t len = 0;
+    for (int shift = 0; shift < 28; shift += 7) {
+        uint8_t b;
+        if (!recv_all(fd, &b, 1)) {
+            return -1;
+        }
+        len |= (size_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+    }
+    if (len > cap || !recv_all(fd, body, len)) {
+        return -1;
+    }
+    *body_len = len;
+    return type;
+}
+
+static int connect_broker(const struct host_mqtt_client *c)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(s_port) };
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    const int       one = 1;
+    struct timeval  tv  = { .tv_sec = c->timeout_ms / 1000,
+                            .tv_usec = (c->timeout_ms % 1000) * 1000 };
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+/** CONNECT / CONNACK; false if the broker refused or went away. */
+static bool handshake(struct host_mqtt_client *c, int fd)
+{
+    uint8_t body[512];
+    size_t  n = put_str(body, "MQTT", 4);
+
+    uint8_t flags = 0x02;                           // clean session
+    if (c->will_topic[0] != '\0') {
+        flags |= 0x04 | (uint8_t)(c->will_qos << 3) | (c->will_retain ? 0x20 : 0);
+    }
+    body[n++] = 4;                                  // protocol level 3.1.1
+    body[n++] = flags;
+    body[n++] = (uint8_t)(c->keepalive_s >> 8);
+    body[n++] = (uint8_t)c->keepalive_s;
+    n += put_str(body + n, c->client_id, strlen(c->client_id));
+    if (c->will_topic[0] != '\0') {
+        n += put_str(body + n, c->will_topic, strlen(c->will_topic));
+        n += put_str(body + n, c->will_msg, strlen(c->will_msg));
+    }
+
+    uint8_t pkt[520];
+    pkt[0] = 0x10;
+    size_t h = 1 + put_remaining_len(pkt + 1, n);
+    memcpy(pkt + h, body, n);
+    if (!send_all(fd, pkt, h + n)) {
+        return false;
+    }
+
+    size_t len;
+    int    type = read_packet(fd, body, sizeof(body), &len);
+    return type == 0x20 && len == 2 && body[1] == 0;
+}
+
+/* ---------------- Client thread ---------------- */
+
+static void dispatch(struct host_mqtt_client *c, esp_mqtt_event_t *ev)
+{
+    ev->client = c;
+    if (c->handler != NULL) {
+        c->handler(c->handler_arg, "MQTT_EVENTS", ev->event_id, ev);
+    }
+}
+
+/** Handle one inbound PUBLISH: PUBACK if QoS 1, then MQTT_EVENT_DATA. */
+static void on_publish(struct host_mqtt_client *c, uint8_t type,
+                       uint8_t *body, size_t len)
+{
+    if (len < 2) {
+        return;
+    }
+    const size_t topic_len = ((size_t)body[0] << 8) | body[1];
+    size_t       off       = 2 + topic_len;
+    const int    qos       = (type >> 1) & 3;
+
+    if (off > len) {
+        return;
+    }
+    if (qos > 0) {
+        if (off + 2 > len) {
+            return;
+        }
+        pthread_mutex_lock(&c->lock);
+        outbox_put(c, 0x40, body + off, 2);
+        pthread_mutex_unlock(&c->lock);
+        off += 2;
+    }
+
+    esp_mqtt_event_t ev = {
+        .event_id            = MQTT_EVENT_DATA,
+        .topic               = (char *)body + 2,
+        .topic_len           = (int)topic_len,
+        .data                = (char *)body + off,
+        .data_len            = (int)(len - off),
+        .total_data_len      = (int)(len - off),
+        .current_data_offset = 0,
+    };
+    dispatch(c, &ev);
+}
+
+/** Run one session until the socket fails. */
+static void session(struct host_mqtt_client *c, int fd)
+{
+    static uint8_t rx[HOST_MQTT_RX_BYTES];
+    const int      ping_ms = c->keepalive_s * 500;
+
+    while (1) {
+        pthread_mutex_lock(&c->lock);
+        const bool ok = send_all(fd, c->outbox, c->out_len);
+        c->out_len = 0;
+        pthread_mutex_unlock(&c->lock);
+        if (!ok) {
+            return;
+        }
+
+        struct pollfd pfd[2] = {
+            { .fd = fd,         .events = POLLIN },
+            { .fd = c->wake[0], .events = POLLIN },
+        };
+        const int n = poll(pfd, 2, ping_ms);
+        if (n == 0) {
+            pthread_mutex_lock(&c->lock);
+            outbox_put(c, 0xc0, NULL, 0);
+            pthread_mutex_unlock(&c->lock);
+            continue;
+        }
+        if (pfd[1].revents & POLLIN) {
+            char drain[64];
+            (void)!read(c->wake[0], drain, sizeof(drain));
+        }
+        if (pfd[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            size_t len;
+            const int type = read_packet(fd, rx, sizeof(rx), &len);
+            if (type < 0) {
+                return;
+            }
+            if ((type & 0xf0) == 0x30) {
+                on_publish(c, (uint8_t)type, rx, len);
+            }
+        }
+    }
+}
+
+static void *client_thread(void *arg)
+{
+    struct host_mqtt_client *c = arg;
+
+    while (1) {
+        const int fd = connect_broker(c);
+        if (fd >= 0 && handshake(c, fd)) {
+            pthread_mutex_lock(&c->lock);
+            c->connected = true;
+            c->out_len   = 0;
+            pthread_mutex_unlock(&c->lock);
+
+            esp_mqtt_event_t ev = { .event_id = MQTT_EVENT_CONNECTED };
+            dispatch(c, &ev);
+
+            session(c, fd);
+
+            pthread_mutex_lock(&c->lock);
+            c->connected = false;
+            c->out_len   = 0;
+            pthread_mutex_unlock(&c->lock);
+
+            ev = (esp_mqtt_event_t){ .event_id = MQTT_EVENT_DISCONNECTED };
+            dispatch(c, &ev);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        usleep((useconds_t)c->reconnect_ms * 1000u);
+    }
+    return NULL;
+}
+
+/* ---------------- API ---------------- */
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *cfg)
+{
+    struct host_mqtt_client *c = calloc(1, sizeof(*c));
+    if (c == NULL) {
+        return NULL;
+    }
+    if (pipe(c->wake) != 0) {
+        free(c);
+        return NULL;
+    }
+
+    snprintf(c->client_id, sizeof(c->client_id), "%s",
+             cfg->credentials.client_id ? cfg->credentials.client_id : "");
+    if (cfg->session.last_will.topic != NULL) {
+        snprintf(c->will_topic, sizeof(c->will_topic), "%s", cfg->session.last_will.topic);
+        snprintf(c->will_msg, sizeof(c->will_msg), "%s", cfg->session.last_will.msg);
+        c->will_qos    = cfg->session.last_will.qos;
+        c->will_retain = cfg->session.last_will.retain;
+    }
+    c->keepalive_s  = cfg->session.keepalive > 0 ? cfg->session.keepalive : 120;
+    c->timeout_ms   = cfg->network.timeout_ms > 0 ? cfg->network.timeout_ms : 10000;
+    c->reconnect_ms = cfg->network.reconnect_timeout_ms > 0
+                          ? cfg->network.reconnect_timeout_ms : HOST_MQTT_RECONNECT_MS;
+    pthread_mutex_init(&c->lock, NULL);
+    return c;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t c,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler, void *arg)
+{
+    c->handler     = handler;
+    c->handler_arg = arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t c)
+{
+    pthread_t t;
+    if (pthread_create(&t, NULL, client_thread, c) != 0) {
+        return ESP_FAIL;
+    }
+    pthread_detach(t);
+    return ESP_OK;
+}
+
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t c, const char *topic, int qos)
+{
+    const size_t len = strlen(topic);
+    uint8_t      body[256];
+
+    if (len + 5 > sizeof(body)) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&c->lock);
+    const uint16_t id = take_id(c);
+    body[0] = (uint8_t)(id >> 8);
+    body[1] = (uint8_t)id;
+    size_t n = 2 + put_str(body + 2, topic, len);
+    body[n++] = (uint8_t)qos;
+    const bool ok = c->connected && outbox_put(c, 0x82, body, n);
+    pthread_mutex_unlock(&c->lock);
+    return ok ? id : -1;
+}
+
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t c, const char *topic,
+                            const char *data, int len, int qos, int retain, bool store)
+{
+    static uint8_t body[HOST_MQTT_OUTBOX_BYTES];
+    const size_t   topic_len = strlen(topic);
+
+    if (len == 0 && data != NULL) {
+        len = (int)strlen(data);
+    }
+    if (topic_len + 4 + (size_t)len > sizeof(body)) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&c->lock);
+    int    id = 0;
+    size_t n  = put_str(body, topic, topic_len);
+    if (qos > 0) {
+        id = take_id(c);
+        body[n++] = (uint8_t)(id >> 8);
+        body[n++] = (uint8_t)id;
+    }
+    memcpy(body + n, data, (size_t)len);
+    n += (size_t)len;
+
+    const uint8_t type = 0x30 | (uint8_t)(qos << 1) | (retain ? 1 : 0);
+    const bool    ok   = c->connected && outbox_put(c, type, body, n);
+    pthread_mutex_unlock(&c->lock);
+    return ok ? id : -1;
+}
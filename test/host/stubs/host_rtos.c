@@ -0,0 +1,264 @@
+/**
+ * pthread-backed stand-ins for the FreeRTOS calls used by the core
+ * modules: task notifications, tick count, critical sections and queues.
+ *
+ * Behaviour, not timing, is what matters here: a "task" is whichever
+ * pthread calls in, critical sections share one process-wide mutex, and
+ * queues are a mutex + condvar ring with the same copy-in / copy-out
+ * semantics as the kernel's.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ---------------------------------------------------------------------------
+// Time
+// ---------------------------------------------------------------------------
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)now_ms();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec  = ticks / 1000u,
+        .tv_nsec = (long)(ticks % 1000u) * 1000000L,
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+/** Absolute CLOCK_MONOTONIC deadline @p ticks (ms) from now. */
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec  += ticks / 1000u;
+    ts.tv_nsec += (long)(ticks % 1000u) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+static void cond_init_monotonic(pthread_cond_t *c)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(c, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/** One wait on @p c, bounded by @p ticks / @p dl; false on timeout. */
+static bool cond_wait_until(pthread_cond_t *c, pthread_mutex_t *m,
+                            TickType_t ticks, const struct timespec *dl)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(c, m);
+        return true;
+    }
+    return pthread_cond_timedwait(c, m, dl) != ETIMEDOUT;
+}
+
+// ---------------------------------------------------------------------------
+// Critical sections
+// ---------------------------------------------------------------------------
+
+static pthread_mutex_t s_critical = PTHREAD_MUTEX_INITIALIZER;
+
+void host_critical_enter(portMUX_TYPE *mux)
+{
+    pthread_mutex_lock(&s_critical);
+}
+
+void host_critical_exit(portMUX_TYPE *mux)
+{
+    pthread_mutex_unlock(&s_critical);
+}
+
+// ---------------------------------------------------------------------------
+// Tasks and notifications
+// ---------------------------------------------------------------------------
+
+struct host_task {
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    uint32_t        notify;
+};
+
+static __thread struct host_task *t_self;
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Only self-deletion: the calling pthread ends.
+    if (task == NULL || task == t_self) {
+        pthread_exit(NULL);
+    }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (t_self == NULL) {
+        t_self = calloc(1, sizeof(*t_self));
+        pthread_mutex_init(&t_self->m, NULL);
+        cond_init_monotonic(&t_self->c);
+    }
+    return t_self;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->m);
+    task->notify++;
+    pthread_cond_signal(&task->c);
+    pthread_mutex_unlock(&task->m);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct host_task     *self = xTaskGetCurrentTaskHandle();
+    const struct timespec dl   = deadline_after(ticks);
+
+    pthread_mutex_lock(&self->m);
+    while (self->notify == 0) {
+        if (!cond_wait_until(&self->c, &self->m, ticks, &dl)) {
+            break;
+        }
+    }
+    const uint32_t v = self->notify;
+    if (v != 0) {
+        self->notify = clear_on_exit ? 0 : v - 1;
+    }
+    pthread_mutex_unlock(&self->m);
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+// Queues
+// ---------------------------------------------------------------------------
+
+struct host_queue {
+    pthread_mutex_t m;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+    UBaseType_t     length;
+    UBaseType_t     item_size;
+    UBaseType_t     count;
+    UBaseType_t     head;       // index of the oldest item
+    uint8_t        *buf;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *q = calloc(1, sizeof(*q));
+    pthread_mutex_init(&q->m, NULL);
+    cond_init_monotonic(&q->not_empty);
+    cond_init_monotonic(&q->not_full);
+    q->length    = length;
+    q->item_size = item_size;
+    q->buf       = calloc(length, item_size);
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    free(q->buf);
+    free(q);
+}
+
+static uint8_t *item_at(QueueHandle_t q, UBaseType_t i)
+{
+    return q->buf + ((q->head + i) % q->length) * q->item_size;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    const struct timespec dl = deadline_after(ticks);
+
+    pthread_mutex_lock(&q->m);
+    while (q->count == q->length) {
+        if (!cond_wait_until(&q->not_full, &q->m, ticks, &dl)) {
+            pthread_mutex_unlock(&q->m);
+            return pdFAIL;
+        }
+    }
+    memcpy(item_at(q, q->count), item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->m);
+    return pdPASS;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void *item)
+{
+    // Length-1 queues only, as in the kernel.
+    pthread_mutex_lock(&q->m);
+    memcpy(q->buf, item, q->item_size);
+    q->head  = 0;
+    q->count = 1;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->m);
+    return pdPASS;
+}
+
+static BaseType_t queue_take(QueueHandle_t q, void *out, TickType_t ticks,
+                             bool remove)
+{
+    const struct timespec dl = deadline_after(ticks);
+
+    pthread_mutex_lock(&q->m);
+    while (q->count == 0) {
+        if (!cond_wait_until(&q->not_empty, &q->m, ticks, &dl)) {
+            pthread_mutex_unlock(&q->m);
+            return pdFAIL;
+        }
+    }
+    memcpy(out, item_at(q, 0), q->item_size);
+    if (remove) {
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->m);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *out, TickType_t ticks)
+{
+    return queue_take(q, out, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void *out, TickType_t ticks)
+{
+    return queue_take(q, out, ticks, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->m);
+    const UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->m);
+    return n;
+}
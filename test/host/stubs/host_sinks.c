@@ -0,0 +1,65 @@
+/**
+ * Host sinks for the firmware's logging and metrics calls: log records
+ * go to stderr when HOST_TEST_LOG is set, metric updates are counted
+ * per id so tests can check them.
+ */
+
+#include "core/logging.h"
+#include "core/metrics.h"
+#include "host_sinks.h"
+
+#include "esp_err.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+QueueHandle_t g_log_queue = NULL;
+
+uint32_t host_metric_counts[METRIC_COUNT];
+
+void log_post(log_level_t level, const char *tag, const char *fmt, ...)
+{
+    static int verbose = -1;
+    if (verbose < 0) {
+        verbose = (getenv("HOST_TEST_LOG") != NULL);
+    }
+    if (!verbose) {
+        return;
+    }
+
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "[%d %s] ", (int)level, tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+const char *esp_err_to_name(esp_err_t err)
+{
+    static char buf[16];
+    snprintf(buf, sizeof(buf), "err 0x%x", (unsigned)err);
+    return buf;
+}
+
+void metrics_add(metric_id_t id, uint32_t n)
+{
+    if ((unsigned)id < METRIC_COUNT) {
+        host_metric_counts[id] += n;
+    }
+}
+
+void metrics_gauge_set(metric_id_t id, int32_t value)
+{
+    if ((unsigned)id < METRIC_COUNT) {
+        host_metric_counts[id] = (uint32_t)value;
+    }
+}
+
+void metrics_observe(metric_id_t id, uint32_t value)
+{
+    (void)value;
+    if ((unsigned)id < METRIC_COUNT) {
+        host_metric_counts[id]++;
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef HOST_SINKS_H
+#define HOST_SINKS_H
+
+#include "core/metrics.h"
+
+// Per-metric update counts recorded by host_sinks.c.
+extern uint32_t host_metric_counts[METRIC_COUNT];
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef HOST_STUB_MQTT_CLIENT_H
+#define HOST_STUB_MQTT_CLIENT_H
+
+// Host shim: the esp-mqtt subset task_mqtt.c uses, implemented as an
+// MQTT 3.1.1 client over a POSIX socket by host_mqtt_client.c.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t base,
+                                    int32_t event_id, void *event_data);
+
+typedef struct host_mqtt_client *esp_mqtt_client_handle_t;
+
+typedef enum {
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+} esp_mqtt_event_id_t;
+
+typedef struct {
+    esp_mqtt_event_id_t      event_id;
+    esp_mqtt_client_handle_t client;
+    char                    *data;
+    int                      data_len;
+    int                      total_data_len;
+    int                      current_data_offset;
+    char                    *topic;
+    int                      topic_len;
+    int                      msg_id;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
+
+typedef struct {
+    struct {
+        struct {
+            const char *uri;
+        } address;
+    } broker;
+    struct {
+        const char *client_id;
+    } credentials;
+    struct {
+        struct {
+            const char *topic;
+            const char *msg;
+            int         msg_len;
+            int         qos;
+            int         retain;
+        } last_will;
+        int keepalive;
+    } session;
+    struct {
+        int timeout_ms;
+        int reconnect_timeout_ms;
+    } network;
+} esp_mqtt_client_config_t;
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *cfg);
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
+                                         esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler, void *arg);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos);
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain, bool store);
+
+/** @brief Connect to 127.0.0.1:@p port instead of the configured broker. */
+void host_mqtt_client_redirect(int port);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef HOST_STUB_NVS_H
+#define HOST_STUB_NVS_H
+
+// Host shim: the NVS calls the firmware makes. Tests provide them.
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+#define ESP_ERR_NVS_NOT_FOUND   0x1102
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out);
+esp_err_t nvs_get_u32(nvs_handle_t h, const char *key, uint32_t *out);
+esp_err_t nvs_set_u32(nvs_handle_t h, const char *key, uint32_t value);
+esp_err_t nvs_commit(nvs_handle_t h);
+void      nvs_close(nvs_handle_t h);
+
+#endif
@@ -0,0 +1,423 @@
+/**
+ * Host test for the AHT20 retry / recovery engine in drv_temp_sensors.c.
+ *
+ * The real driver source is compiled against an I2C master shim backed
+ * by an AHT20 model with an injectable fault per transaction (NACK,
+ * timeout, CRC error, busy, stuck SDA) or a random fault rate. The test
+ * checks the retry count, backoff spacing, bus recovery and the
+ * per-device counters, and how many samples a noisy bus loses with and
+ * without the retry engine.
+ */
+
+#include "host_test.h"
+#include "host_sinks.h"
+
+#include "core/config.h"
+#include "drivers/drv_i2c_bus.h"
+#include "drivers/drv_temp_sensors.h"
+
+#include "driver/i2c.h"
+#include "freertos/task.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// ---------------------------------------------------------------------------
+// AHT20 model
+// ---------------------------------------------------------------------------
+
+typedef enum {
+    FAULT_NONE = 0,
+    FAULT_NACK,         // address not acknowledged -> ESP_FAIL
+    FAULT_TIMEOUT,      // transaction timeout
+    FAULT_CRC,          // read frame with a corrupted CRC byte
+    FAULT_BUSY,         // read frame with the busy bit still set
+    FAULT_STUCK,        // slave holds SDA: every transfer times out until a bus clear
+} fault_t;
+
+#define SCRIPT_MAX   32
+#define DELAYS_MAX   64
+
+static struct {
+    fault_t  script[SCRIPT_MAX];    // one entry per transaction, then FAULT_NONE
+    size_t   script_len;
+    size_t   script_pos;
+    uint32_t noise_pct;             // random NACK / timeout rate per transaction
+    uint32_t rng;
+    bool     stuck;
+    float    temp_c;                // what the sensor measures
+    uint32_t transactions;
+    uint32_t bus_clears;
+    uint32_t delays[DELAYS_MAX];
+    size_t   n_delays;
+} s_dev;
+
+typedef enum { OP_WRITE_BYTE, OP_WRITE, OP_READ } op_kind_t;
+
+typedef struct {
+    op_kind_t kind;
+    uint8_t  *data;
+    size_t    len;
+    uint8_t   byte;
+} op_t;
+
+typedef struct {
+    op_t   ops[8];
+    size_t n;
+} cmd_t;
+
+static void dev_reset(float temp_c)
+{
+    memset(&s_dev, 0, sizeof(s_dev));
+    s_dev.temp_c = temp_c;
+    s_dev.rng    = 12345u;
+}
+
+static void dev_script(const fault_t *faults, size_t n)
+{
+    memcpy(s_dev.script, faults, n * sizeof(faults[0]));
+    s_dev.script_len = n;
+}
+
+static uint32_t dev_rand(void)
+{
+    s_dev.rng = s_dev.rng * 1103515245u + 12345u;
+    return (s_dev.rng >> 16) & 0x7fffu;
+}
+
+static uint8_t crc8(const uint8_t *d, size_t n)
+{
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= d[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void dev_frame(uint8_t f[7], fault_t fault)
+{
+    const uint32_t adc_t = (uint32_t)lroundf((s_dev.temp_c + 50.0f) * 1048576.0f / 200.0f);
+
+    f[0] = (fault == FAULT_BUSY) ? 0x80 : 0x18;
+    f[1] = 0x80;                    // humidity, unused
+    f[2] = 0x00;
+    f[3] = (uint8_t)(0x50 | ((adc_t >> 16) & 0x0F));
+    f[4] = (uint8_t)(adc_t >> 8);
+    f[5] = (uint8_t)adc_t;
+    f[6] = crc8(f, 6);
+    if (fault == FAULT_CRC) {
+        f[6] ^= 0x5A;
+    }
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+    return calloc(1, sizeof(cmd_t));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd)
+{
+    free(cmd);
+}
+
+static void cmd_push(i2c_cmd_handle_t h, op_t op)
+{
+    cmd_t *c = h;
+    if (c->n < sizeof(c->ops) / sizeof(c->ops[0])) {
+        c->ops[c->n++] = op;
+    }
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) { (void)cmd; return ESP_OK; }
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd)  { (void)cmd; return ESP_OK; }
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en)
+{
+    cmd_push(cmd, (op_t){ .kind = OP_WRITE_BYTE, .byte = data });
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data, size_t len, bool ack_en)
+{
+    cmd_push(cmd, (op_t){ .kind = OP_WRITE, .data = (uint8_t *)data, .len = len });
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data, size_t len, i2c_ack_type_t ack)
+{
+    cmd_push(cmd, (op_t){ .kind = OP_READ, .data = data, .len = len });
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t *data, i2c_ack_type_t ack)
+{
+    return i2c_master_read(cmd, data, 1, ack);
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t h, TickType_t ticks)
+{
+    cmd_t *c = h;
+    s_dev.transactions++;
+
+    fault_t fault = FAULT_NONE;
+    if (s_dev.script_pos < s_dev.script_len) {
+        fault = s_dev.script[s_dev.script_pos++];
+    } else if (s_dev.noise_pct > 0 && dev_rand() % 100u < s_dev.noise_pct) {
+        fault = (dev_rand() & 1u) ? FAULT_NACK : FAULT_TIMEOUT;
+    }
+
+    if (fault == FAULT_STUCK) {
+        s_dev.stuck = true;
+    }
+    if (s_dev.stuck) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (fault == FAULT_NACK) {
+        return ESP_FAIL;
+    }
+    if (fault == FAULT_TIMEOUT) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    CHECK(c->n >= 1 && c->ops[0].kind == OP_WRITE_BYTE);
+    CHECK_EQ_INT(c->ops[0].byte >> 1, AHT20_I2C_ADDRESS);
+
+    if (c->ops[0].byte & I2C_MASTER_READ) {
+        // Read: the driver asks for len-1 bytes + 1 final byte.
+        uint8_t frame[7];
+        dev_frame(frame, fault);
+        size_t off = 0;
+        for (size_t i = 1; i < c->n; i++) {
+            if (c->ops[i].kind == OP_READ) {
+                for (size_t k = 0; k < c->ops[i].len && off < sizeof(frame); k++) {
+                    c->ops[i].data[k] = frame[off++];
+                }
+            }
+        }
+        CHECK_EQ_INT(off, sizeof(frame));
+    }
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Bus and RTOS shims
+// ---------------------------------------------------------------------------
+
+app_error_t drv_i2c_bus_init(void)    { return ERR_OK; }
+void        drv_i2c_bus_lock(void)    { }
+void        drv_i2c_bus_unlock(void)  { }
+
+app_error_t drv_i2c_bus_recover(void)
+{
+    s_dev.bus_clears++;
+    s_dev.stuck = false;
+    return ERR_OK;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (s_dev.n_delays < DELAYS_MAX) {
+        s_dev.delays[s_dev.n_delays++] = ticks;
+    }
+}
+
+// Sleeps other than the conversion wait. Scenarios using this never
+// re-init successfully, so there is no 40 ms init wait either.
+static size_t backoff_delays(uint32_t *out, size_t cap)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < s_dev.n_delays && n < cap; i++) {
+        if (s_dev.delays[i] != AHT20_MEASURE_DELAY_MS) {
+            out[n++] = s_dev.delays[i];
+        }
+    }
+    return n;
+}
+
+static drv_temp_stats_t stats_delta(const drv_temp_stats_t *before)
+{
+    drv_temp_stats_t now;
+    drv_temp_get_stats(&now);
+
+    drv_temp_stats_t d;
+    d.reads_ok     = now.reads_ok     - before->reads_ok;
+    d.reads_failed = now.reads_failed - before->reads_failed;
+    d.retries      = now.retries      - before->retries;
+    d.nacks        = now.nacks        - before->nacks;
+    d.timeouts     = now.timeouts     - before->timeouts;
+    d.crc_errors   = now.crc_errors   - before->crc_errors;
+    d.busy         = now.busy         - before->busy;
+    d.recoveries   = now.recoveries   - before->recoveries;
+    return d;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_clean_read(void)
+{
+    dev_reset(21.5f);
+    CHECK_EQ_INT(drv_temp_sensors_init(), ERR_OK);
+
+    drv_temp_stats_t before;
+    drv_temp_get_stats(&before);
+
+    sensor_sample_t s;
+    CHECK_EQ_INT(drv_temp_read(&s), ERR_OK);
+    CHECK(fabsf(s.temp_inside_c - 21.5f) < 0.01f);
+
+    const drv_temp_stats_t d = stats_delta(&before);
+    CHECK_EQ_INT(d.reads_ok, 1);
+    CHECK_EQ_INT(d.retries, 0);
+    CHECK_EQ_INT(d.recoveries, 0);
+    CHECK_EQ_INT(s_dev.transactions, 3);    // init, measure cmd, read
+}
+
+static void test_transient_nack(void)
+{
+    dev_reset(19.0f);
+    const fault_t f[] = { FAULT_NACK };     // first measure command
+    dev_script(f, 1);
+
+    drv_temp_stats_t before;
+    drv_temp_get_stats(&before);
+
+    sensor_sample_t s;
+    CHECK_EQ_INT(drv_temp_read(&s), ERR_OK);
+    CHECK(fabsf(s.temp_inside_c - 19.0f) < 0.01f);
+
+    const drv_temp_stats_t d = stats_delta(&before);
+    CHECK_EQ_INT(d.reads_ok, 1);
+    CHECK_EQ_INT(d.retries, 1);
+    CHECK_EQ_INT(d.nacks, 1);
+    CHECK_EQ_INT(d.recoveries, 0);
+
+    uint32_t bo[8];
+    CHECK_EQ_INT(backoff_delays(bo, 8), 1);
+    CHECK_EQ_INT(bo[0], AHT20_RETRY_BASE_MS);
+}
+
+static void test_crc_and_busy_then_recovery(void)
+{
+    dev_reset(23.0f);
+    // attempt 1: write ok, read CRC error; attempt 2: write ok, read busy;
+    // attempt 3 recovers (init) and then succeeds.
+    const fault_t f[] = { FAULT_NONE, FAULT_CRC, FAULT_NONE, FAULT_BUSY };
+    dev_script(f, 4);
+
+    drv_temp_stats_t before;
+    drv_temp_get_stats(&before);
+
+    sensor_sample_t s;
+    CHECK_EQ_INT(drv_temp_read(&s), ERR_OK);
+
+    const drv_temp_stats_t d = stats_delta(&before);
+    CHECK_EQ_INT(d.reads_ok, 1);
+    CHECK_EQ_INT(d.crc_errors, 1);
+    CHECK_EQ_INT(d.busy, 1);
+    CHECK_EQ_INT(d.retries, 2);
+    CHECK_EQ_INT(d.recoveries, 1);
+    CHECK_EQ_INT(s_dev.bus_clears, 1);
+}
+
+static void test_stuck_sda_cleared(void)
+{
+    dev_reset(20.0f);
+    const fault_t f[] = { FAULT_STUCK };
+    dev_script(f, 1);
+
+    drv_temp_stats_t before;
+    drv_temp_get_stats(&before);
+
+    sensor_sample_t s;
+    CHECK_EQ_INT(drv_temp_read(&s), ERR_OK);
+
+    // Two timed-out attempts, then bus clear + re-init on the third.
+    const drv_temp_stats_t d = stats_delta(&before);
+    CHECK_EQ_INT(d.timeouts, AHT20_RECOVER_AFTER_ATTEMPTS);
+    CHECK_EQ_INT(d.recoveries, 1);
+    CHECK_EQ_INT(d.reads_ok, 1);
+    CHECK_EQ_INT(s_dev.bus_clears, 1);
+    CHECK(!s_dev.stuck);
+}
+
+static void test_permanent_failure(void)
+{
+    dev_reset(20.0f);
+    fault_t f[SCRIPT_MAX];
+    for (size_t i = 0; i < SCRIPT_MAX; i++) {
+        f[i] = FAULT_NACK;
+    }
+    dev_script(f, SCRIPT_MAX);
+
+    drv_temp_stats_t before;
+    drv_temp_get_stats(&before);
+
+    sensor_sample_t s;
+    CHECK_EQ_INT(drv_temp_read(&s), ERR_GENERIC);
+
+    const drv_temp_stats_t d = stats_delta(&before);
+    CHECK_EQ_INT(d.reads_failed, 1);
+    CHECK_EQ_INT(d.retries, AHT20_MAX_ATTEMPTS - 1);
+    CHECK_EQ_INT(d.recoveries, AHT20_MAX_ATTEMPTS - AHT20_RECOVER_AFTER_ATTEMPTS);
+
+    // Bounded, exponentially spaced retries.
+    uint32_t bo[8];
+    const size_t n = backoff_delays(bo, 8);
+    CHECK_EQ_INT(n, AHT20_MAX_ATTEMPTS - 1);
+    for (size_t i = 0; i < n; i++) {
+        CHECK_EQ_INT(bo[i], AHT20_RETRY_BASE_MS << i);
+    }
+
+    // Recovered on the next read once the fault is gone.
+    dev_reset(20.0f);
+    CHECK_EQ_INT(drv_temp_read(&s), ERR_OK);
+}
+
+static void test_noisy_bus_loss(void)
+{
+    const uint32_t reads = 2000;
+    const uint32_t pct   = 20;
+
+    dev_reset(21.0f);
+    s_dev.noise_pct = pct;
+
+    drv_temp_stats_t before;
+    drv_temp_get_stats(&before);
+
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < reads; i++) {
+        sensor_sample_t s;
+        if (drv_temp_read(&s) != ERR_OK) {
+            lost++;
+        }
+    }
+    const drv_temp_stats_t d = stats_delta(&before);
+
+    // Without retries a read needs two clean transactions.
+    const double single = 100.0 * (1.0 - (1.0 - pct / 100.0) * (1.0 - pct / 100.0));
+    printf("  %u%% transaction faults: %.1f%% samples lost without retries, "
+           "%.2f%% with (%u retries, %u recoveries)\n",
+           (unsigned)pct, single, 100.0 * lost / reads,
+           (unsigned)d.retries, (unsigned)d.recoveries);
+
+    CHECK_EQ_INT(d.reads_ok + d.reads_failed, reads);
+    CHECK_EQ_INT(d.reads_failed, lost);
+    CHECK(lost * 100u < reads * 5u);        // < 5 % vs ~36 % without retries
+    CHECK(host_metric_counts[METRIC_I2C_ERRORS] > 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_clean_read);
+    RUN_TEST(test_transient_nack);
+    RUN_TEST(test_crc_and_busy_then_recovery);
+    RUN_TEST(test_stuck_sda_cleared);
+    RUN_TEST(test_permanent_failure);
+    RUN_TEST(test_noisy_bus_loss);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,701 @@
+/**
+ * Host test for the local HTTP API (task_httpd.c) over a loopback socket.
+ *
+ * The real bootstrap task starts the server and registers the real
+ * handlers; esp_http_server is the socket shim in stubs/host_httpd.c.
+ * Handlers read the real message bus and history ring; the counters they
+ * report (telemetry, MQTT, drivers, watchdog, boot) are stubs in this
+ * file. A client here sends GETs on a keep-alive connection, decodes the
+ * chunked bodies and checks that each one is well-formed JSON, then
+ * measures requests per second per endpoint.
+ */
+
+#define _GNU_SOURCE
+
+#include "host_test.h"
+
+#include "core/boot.h"
+#include "core/config.h"
+#include "core/history.h"
+#include "core/metrics.h"
+#include "core/monotime.h"
+#include "core/msgbus.h"
+#include "core/thermostat.h"
+#include "core/thermostat_config.h"
+#include "core/timeutil.h"
+#include "core/watchdog.h"
+
+#include "drivers/drv_buttons.h"
+#include "drivers/drv_display.h"
+#include "drivers/drv_temp_sensors.h"
+
+#include "app/app_tasks.h"
+#include "app/task_common.h"
+#include "app/task_httpd.h"
+#include "app/task_mqtt.h"
+#include "app/task_net.h"
+#include "app/task_telemetry.h"
+
+#include "esp_http_server.h"
+#include "esp_system.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// Firmware dependencies
+// ---------------------------------------------------------------------------
+
+uint32_t esp_get_free_heap_size(void) { return 151234; }
+uint32_t esp_get_minimum_free_heap_size(void) { return 140321; }
+
+bool       task_net_is_connected(void) { return true; }
+BaseType_t app_tasks_core(BaseType_t core) { return core; }
+
+// thermostat.c is linked for the mode / output names only.
+app_error_t thermostat_config_init(void) { return ERR_OK; }
+app_error_t thermostat_config_get(thermostat_config_t *out) { return ERR_GENERIC; }
+
+bool timeutil_get_iso8601(char *buf, size_t buf_len)
+{
+    const time_t t = time(NULL);
+    struct tm    tm;
+    gmtime_r(&t, &tm);
+    return strftime(buf, buf_len, "%Y-%m-%dT%H:%M:%SZ", &tm) != 0;
+}
+
+void task_telemetry_get_stats(telemetry_stats_t *out)
+{
+    *out = (telemetry_stats_t){ .samples = 4321, .samples_sent = 4300, .batches_sent = 215,
+                                .bytes_sent = 123456, .post_failures = 2, .dropped = 1 };
+}
+
+void task_mqtt_get_stats(mqtt_stats_t *out)
+{
+    *out = (mqtt_stats_t){ .connects = 3, .commands = 12, .states_published = 40,
+                           .batches_published = 430, .samples_published = 4300 };
+}
+
+app_error_t drv_temp_get_stats(drv_temp_stats_t *out)
+{
+    *out = (drv_temp_stats_t){ .reads_ok = 9000, .reads_failed = 3, .retries = 7 };
+    return ERR_OK;
+}
+
+app_error_t drv_display_get_stats(drv_display_stats_t *out)
+{
+    *out = (drv_display_stats_t){ .frames = 800, .frames_unchanged = 600 };
+    return ERR_OK;
+}
+
+void drv_buttons_get_stats(drv_buttons_stats_t *out)
+{
+    *out = (drv_buttons_stats_t){ .edges = 40, .events = 20 };
+}
+
+size_t watchdog_get_stats(watchdog_task_stats_t *out, size_t max)
+{
+    static const char *const names[] = { "SENSORS", "CONTROL", "DISPLAY", "TELEMETRY",
+                                         "MQTT", "BUTTONS", "HEARTBEAT" };
+    size_t n = 0;
+    for (; n < sizeof(names) / sizeof(names[0]) && n < max; n++) {
+        out[n] = (watchdog_task_stats_t){
+            .period_ms = 1000, .deadline_ms = WATCHDOG_DEADLINE_MS, .feeds = 5000 + (uint32_t)n,
+            .feed_interval_avg_us = 1000000, .feed_interval_max_us = 1004000,
+            .work_avg_us = 120, .work_max_us = 900,
+        };
+        snprintf(out[n].name, sizeof(out[n].name), "%s", names[n]);
+    }
+    return n;
+}
+
+uint64_t boot_stage_us(boot_stage_t stage)
+{
+    return (stage < BOOT_STAGE_COUNT / 2) ? 100000u * (stage + 1) : 0;
+}
+
+const char *boot_stage_name(boot_stage_t stage)
+{
+    static char names[BOOT_STAGE_COUNT][12];
+    snprintf(names[stage], sizeof(names[stage]), "stage%d", (int)stage);
+    return names[stage];
+}
+
+// The Prometheus / binary exports are not under test here.
+app_error_t metrics_export_prometheus(char *buf, size_t cap, metrics_sink_t sink, void *ctx)
+{
+    return ERR_GENERIC;
+}
+size_t metrics_export_binary(uint8_t *buf, size_t cap) { return 0; }
+
+history_t g_history;
+
+static history_slot_t s_history_slots[HISTORY_DEPTH];
+
+// ---------------------------------------------------------------------------
+// Client
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int    status;
+    bool   chunked;
+    int    chunks;
+    char   type[64];
+    size_t head_len;
+    size_t body_len;
+    char   body[32768];
+} resp_t;
+
+// Receive buffer shared by the response reader; one client at a time.
+static struct {
+    char   buf[65536];
+    size_t len;
+    size_t off;
+} s_rx;
+
+static int client_connect(void)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(host_httpd_port()) };
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    s_rx.len = 0;
+    s_rx.off = 0;
+
+    const int fd  = socket(AF_INET, SOCK_STREAM, 0);
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool rx_fill(int fd)
+{
+    if (s_rx.off > 0) {
+        memmove(s_rx.buf, s_rx.buf + s_rx.off, s_rx.len - s_rx.off);
+        s_rx.len -= s_rx.off;
+        s_rx.off  = 0;
+    }
+    ssize_t n = recv(fd, s_rx.buf + s_rx.len, sizeof(s_rx.buf) - s_rx.len, 0);
+    if (n <= 0) {
+        return false;
+    }
+    s_rx.len += (size_t)n;
+    return true;
+}
+
+/** Pointer to the next CRLF-terminated line (CRLF stripped), reading as needed. */
+static char *rx_line(int fd)
+{
+    char *eol;
+    while ((eol = memmem(s_rx.buf + s_rx.off, s_rx.len - s_rx.off, "\r\n", 2)) == NULL) {
+        if (!rx_fill(fd)) {
+            return NULL;
+        }
+    }
+    char *line = s_rx.buf + s_rx.off;
+    *eol = '\0';
+    s_rx.off = (size_t)(eol + 2 - s_rx.buf);
+    return line;
+}
+
+static bool rx_bytes(int fd, char *out, size_t n)
+{
+    while (s_rx.len - s_rx.off < n) {
+        if (!rx_fill(fd)) {
+            return false;
+        }
+    }
+    memcpy(out, s_rx.buf + s_rx.off, n);
+    s_rx.off += n;
+    return true;
+}
+
+/** GET @p path on @p fd and read the whole response; false on a broken response. */
+static bool http_get(int fd, const char *path, resp_t *r)
+{
+    char req[256];
+    int  n = snprintf(req, sizeof(req),
+                      "GET %s HTTP/1.1\r\nHost: thermostat\r\nConnection: keep-alive\r\n\r\n",
+                      path);
+    if (send(fd, req, (size_t)n, MSG_NOSIGNAL) != n) {
+        return false;
+    }
+
+    memset(r, 0, offsetof(resp_t, body));
+    long  content_len = -1;
+    char *line        = rx_line(fd);
+    if (line == NULL || sscanf(line, "HTTP/1.1 %d", &r->status) != 1) {
+        return false;
+    }
+    r->head_len = strlen(line) + 2;
+    while ((line = rx_line(fd)) != NULL && line[0] != '\0') {
+        r->head_len += strlen(line) + 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_len = atol(line + 15);
+        } else if (strncasecmp(line, "Transfer-Encoding: chunked", 26) == 0) {
+            r->chunked = true;
+        } else if (strncasecmp(line, "Content-Type: ", 14) == 0) {
+            snprintf(r->type, sizeof(r->type), "%s", line + 14);
+        }
+    }
+    if (line == NULL) {
+        return false;
+    }
+    r->head_len += 2;
+
+    if (!r->chunked) {
+        if (content_len < 0 || (size_t)content_len >= sizeof(r->body) ||
+            !rx_bytes(fd, r->body, (size_t)content_len)) {
+            return false;
+        }
+        r->body_len = (size_t)content_len;
+        r->body[r->body_len] = '\0';
+        return true;
+    }
+
+    while (1) {
+        line = rx_line(fd);
+        if (line == NULL) {
+            return false;
+        }
+        char         *end;
+        const size_t  size = strtoul(line, &end, 16);
+        if (end == line || r->body_len + size >= sizeof(r->body)) {
+            return false;
+        }
+        if (size == 0) {
+            line = rx_line(fd);                 // blank line after the last chunk
+            r->body[r->body_len] = '\0';
+            return line != NULL && line[0] == '\0';
+        }
+        char crlf[2];
+        if (!rx_bytes(fd, r->body + r->body_len, size) || !rx_bytes(fd, crlf, 2) ||
+            crlf[0] != '\r' || crlf[1] != '\n') {
+            return false;
+        }
+        r->body_len += size;
+        r->chunks++;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// JSON checker (RFC 8259 grammar, no semantics)
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const char *p;
+    const char *end;
+    int         depth;
+} js_t;
+
+static bool js_value(js_t *j);
+
+static void js_ws(js_t *j)
+{
+    while (j->p < j->end && (*j->p == ' ' || *j->p == '\t' || *j->p == '\n' || *j->p == '\r')) {
+        j->p++;
+    }
+}
+
+static bool js_lit(js_t *j, const char *lit)
+{
+    const size_t n = strlen(lit);
+    if ((size_t)(j->end - j->p) < n || memcmp(j->p, lit, n) != 0) {
+        return false;
+    }
+    j->p += n;
+    return true;
+}
+
+static bool js_string(js_t *j)
+{
+    if (j->p >= j->end || *j->p++ != '"') {
+        return false;
+    }
+    while (j->p < j->end) {
+        const unsigned char c = (unsigned char)*j->p++;
+        if (c == '"') {
+            return true;
+        }
+        if (c < 0x20) {
+            return false;
+        }
+        if (c == '\\') {
+            if (j->p >= j->end) {
+                return false;
+            }
+            const char e = *j->p++;
+            if (e == 'u') {
+                for (int i = 0; i < 4; i++) {
+                    if (j->p >= j->end || strchr("0123456789abcdefABCDEF", *j->p++) == NULL) {
+                        return false;
+                    }
+                }
+            } else if (strchr("\"\\/bfnrt", e) == NULL) {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+static bool js_digits(js_t *j)
+{
+    const char *start = j->p;
+    while (j->p < j->end && *j->p >= '0' && *j->p <= '9') {
+        j->p++;
+    }
+    return j->p > start;
+}
+
+static bool js_number(js_t *j)
+{
+    if (j->p < j->end && *j->p == '-') {
+        j->p++;
+    }
+    if (j->p < j->end && *j->p == '0') {
+        j->p++;
+    } else if (!js_digits(j)) {
+        return false;
+    }
+    if (j->p < j->end && *j->p == '.') {
+        j->p++;
+        if (!js_digits(j)) {
+            return false;
+        }
+    }
+    if (j->p < j->end && (*j->p == 'e' || *j->p == 'E')) {
+        j->p++;
+        if (j->p < j->end && (*j->p == '+' || *j->p == '-')) {
+            j->p++;
+        }
+        if (!js_digits(j)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool js_container(js_t *j, char close, bool object)
+{
+    if (++j->depth > 32) {
+        return false;
+    }
+    j->p++;
+    js_ws(j);
+    if (j->p < j->end && *j->p == close) {
+        j->p++;
+        j->depth--;
+        return true;
+    }
+    while (1) {
+        js_ws(j);
+        if (object) {
+            if (!js_string(j)) {
+                return false;
+            }
+            js_ws(j);
+            if (j->p >= j->end || *j->p++ != ':') {
+                return false;
+            }
+        }
+        if (!js_value(j)) {
+            return false;
+        }
+        js_ws(j);
+        if (j->p >= j->end) {
+            return false;
+        }
+        const char c = *j->p++;
+        if (c == close) {
+            j->depth--;
+            return true;
+        }
+        if (c != ',') {
+            return false;
+        }
+    }
+}
+
+static bool js_value(js_t *j)
+{
+    js_ws(j);
+    if (j->p >= j->end) {
+        return false;
+    }
+    switch (*j->p) {
+    case '{': return js_container(j, '}', true);
+    case '[': return js_container(j, ']', false);
+    case '"': return js_string(j);
+    case 't': return js_lit(j, "true");
+    case 'f': return js_lit(j, "false");
+    case 'n': return js_lit(j, "null");
+    default:  return js_number(j);
+    }
+}
+
+/** True if @p s is exactly one JSON value (surrounding whitespace allowed). */
+static bool json_valid(const char *s, size_t len)
+{
+    js_t j = { s, s + len, 0 };
+    if (!js_value(&j)) {
+        return false;
+    }
+    js_ws(&j);
+    return j.p == j.end;
+}
+
+static int count_of(const char *s, const char *needle)
+{
+    int n = 0;
+    for (const char *p = strstr(s, needle); p != NULL; p = strstr(p + 1, needle)) {
+        n++;
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static uint8_t s_ring_sensor[MSGBUS_RING_BYTES(sizeof(sensor_sample_t), 4)]
+    __attribute__((aligned(8)));
+static uint8_t s_ring_state[MSGBUS_RING_BYTES(sizeof(thermostat_state_t), 4)]
+    __attribute__((aligned(8)));
+static uint8_t s_ring_config[MSGBUS_RING_BYTES(sizeof(thermostat_config_t), 2)]
+    __attribute__((aligned(8)));
+static uint8_t s_ring_button[MSGBUS_RING_BYTES(sizeof(button_event_t), 8)]
+    __attribute__((aligned(8)));
+
+static thermostat_state_t make_state(uint64_t t_us, float tin_c)
+{
+    return (thermostat_state_t){
+        .mode         = THERMOSTAT_MODE_HEAT,
+        .output       = (tin_c < 21.0f) ? THERMOSTAT_OUTPUT_HEAT_ON : THERMOSTAT_OUTPUT_OFF,
+        .setpoint_c   = 21.5f,
+        .hysteresis_c = 0.5f,
+        .tin_c        = tin_c,
+        .tout_c       = -3.25f,
+        .timestamp_us = t_us,
+    };
+}
+
+/** Record @p n history entries one interval apart, continuing the timeline. */
+static void fill_history(int n)
+{
+    static uint64_t t_us = 1000000u;
+    for (int i = 0; i < n; i++) {
+        const thermostat_state_t st = make_state(t_us, 19.0f + (float)(i % 50) * 0.1f);
+        history_record(&g_history, &st);
+        t_us += (uint64_t)HISTORY_INTERVAL_MS * 1000u;
+    }
+}
+
+static resp_t s_resp;
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_state_before_first_sample(void)
+{
+    const int fd = client_connect();
+
+    CHECK(http_get(fd, "/state", &s_resp));
+    CHECK_EQ_INT(s_resp.status, 503);
+    CHECK(!s_resp.chunked);
+    CHECK(json_valid(s_resp.body, s_resp.body_len));
+
+    // Unknown paths do not break the connection.
+    CHECK(http_get(fd, "/nope", &s_resp));
+    CHECK_EQ_INT(s_resp.status, 404);
+    close(fd);
+}
+
+static void test_state_config_json(void)
+{
+    const int                fd = client_connect();
+    const thermostat_state_t st = make_state(monotime_now_us(), 20.37f);
+    msgbus_publish(MSGBUS_TOPIC_THERMOSTAT_STATE, &st);
+
+    CHECK(http_get(fd, "/state", &s_resp));
+    CHECK_EQ_INT(s_resp.status, 200);
+    CHECK(s_resp.chunked);
+    CHECK_EQ_STR(s_resp.type, "application/json");
+    CHECK(json_valid(s_resp.body, s_resp.body_len));
+    CHECK(strstr(s_resp.body, "\"mode\":\"HEAT\"") != NULL);
+    CHECK(strstr(s_resp.body, "\"temp_inside_c\":20.37") != NULL);
+    CHECK(strstr(s_resp.body, "\"temp_outside_c\":-3.25") != NULL);
+    CHECK(strstr(s_resp.body, "\"time\":\"") != NULL);
+
+    // No settled change yet: the setpoint CONTROL last used.
+    CHECK(http_get(fd, "/config", &s_resp));
+    CHECK_EQ_INT(s_resp.status, 200);
+    CHECK(json_valid(s_resp.body, s_resp.body_len));
+    CHECK(strstr(s_resp.body, "\"setpoint_c\":21.50") != NULL);
+
+    const thermostat_config_t cfg = { .setpoint_c = 22.0f, .hysteresis_c = 0.75f };
+    msgbus_publish(MSGBUS_TOPIC_CONFIG, &cfg);
+    CHECK(http_get(fd, "/config", &s_resp));
+    CHECK(json_valid(s_resp.body, s_resp.body_len));
+    CHECK(strstr(s_resp.body, "\"setpoint_c\":22.00") != NULL);
+    CHECK(strstr(s_resp.body, "\"hysteresis_c\":0.75") != NULL);
+    close(fd);
+}
+
+static void test_history_json(void)
+{
+    const int fd = client_connect();
+
+    fill_history(HISTORY_DEPTH + 7);
+
+    CHECK(http_get(fd, "/history", &s_resp));
+    CHECK_EQ_INT(s_resp.status, 200);
+    CHECK(s_resp.chunked);
+    CHECK(json_valid(s_resp.body, s_resp.body_len));
+    CHECK_EQ_INT(count_of(s_resp.body, "\"age_s\":"), HISTORY_DEPTH);
+    CHECK(s_resp.chunks > 1);
+    CHECK(s_resp.body_len > (size_t)s_resp.chunks * (HTTPD_CHUNK_LEN / 2));
+    printf("  /history: %zu bytes in %d chunks (buffer %d bytes)\n",
+           s_resp.body_len, s_resp.chunks, HTTPD_CHUNK_LEN);
+
+    CHECK(http_get(fd, "/history?limit=5", &s_resp));
+    CHECK(json_valid(s_resp.body, s_resp.body_len));
+    CHECK_EQ_INT(count_of(s_resp.body, "\"age_s\":"), 5);
+
+    CHECK(http_get(fd, "/history?limit=0", &s_resp));
+    CHECK_EQ_INT(count_of(s_resp.body, "\"age_s\":"), HISTORY_DEPTH);
+    close(fd);
+}
+
+static void test_metrics_json(void)
+{
+    const int fd = client_connect();
+
+    CHECK(http_get(fd, "/metrics", &s_resp));
+    CHECK_EQ_INT(s_resp.status, 200);
+    CHECK(json_valid(s_resp.body, s_resp.body_len));
+    CHECK(strstr(s_resp.body, "\"heap_free\":151234") != NULL);
+    CHECK(strstr(s_resp.body, "\"samples_sent\":4300") != NULL);
+    CHECK(strstr(s_resp.body, "\"thermostat_state\":{\"published\":") != NULL);
+    CHECK_EQ_INT(count_of(s_resp.body, "\"feed_interval_max_us\":"), 7);
+    CHECK(strstr(s_resp.body, "\"stage0\":100000") != NULL);
+    CHECK(strstr(s_resp.body, "null") != NULL);
+    close(fd);
+}
+
+/** Streams /history while a writer recycles the ring underneath it. */
+static volatile bool s_writer_run;
+
+static void *history_writer(void *arg)
+{
+    while (s_writer_run) {
+        fill_history(3);
+        vTaskDelay(1);
+    }
+    return NULL;
+}
+
+static void test_history_while_recording(void)
+{
+    const int fd = client_connect();
+    pthread_t w;
+
+    s_writer_run = true;
+    pthread_create(&w, NULL, history_writer, NULL);
+
+    int bad = 0;
+    for (int i = 0; i < 300; i++) {
+        if (!http_get(fd, "/history", &s_resp) || s_resp.status != 200 ||
+            !json_valid(s_resp.body, s_resp.body_len)) {
+            bad++;
+        }
+    }
+    s_writer_run = false;
+    pthread_join(w, NULL);
+    close(fd);
+
+    CHECK_EQ_INT(bad, 0);
+}
+
+static void test_throughput(void)
+{
+    static const struct {
+        const char *path;
+        int         n;
+    } cases[] = {
+        { "/state",   5000 },
+        { "/config",  5000 },
+        { "/history", 1000 },
+        { "/metrics", 2000 },
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const int fd = client_connect();
+        int       bad = 0;
+
+        const uint64_t t0 = host_now_ns();
+        for (int i = 0; i < cases[c].n; i++) {
+            bad += !http_get(fd, cases[c].path, &s_resp) || s_resp.status != 200;
+        }
+        const double s = (host_now_ns() - t0) / 1e9;
+        close(fd);
+
+        CHECK_EQ_INT(bad, 0);
+        CHECK(json_valid(s_resp.body, s_resp.body_len));
+        printf("  %-9s %7.0f req/s  %5zu body bytes, %2d chunks, %3zu header bytes\n",
+               cases[c].path, cases[c].n / s, s_resp.body_len, s_resp.chunks,
+               s_resp.head_len);
+    }
+
+    // One connection per request, as a browser without keep-alive would.
+    const uint64_t t0  = host_now_ns();
+    int            bad = 0;
+    for (int i = 0; i < 1000; i++) {
+        const int fd = client_connect();
+        bad += !http_get(fd, "/state", &s_resp) || s_resp.status != 200;
+        close(fd);
+    }
+    const double s = (host_now_ns() - t0) / 1e9;
+    CHECK_EQ_INT(bad, 0);
+    printf("  /state, new connection each: %.0f req/s\n", 1000 / s);
+}
+
+static void *httpd_thread(void *arg)
+{
+    task_httpd(arg);
+    return NULL;
+}
+
+int main(void)
+{
+    msgbus_topic_init(MSGBUS_TOPIC_SENSOR_SAMPLE, s_ring_sensor, sizeof(sensor_sample_t), 4);
+    msgbus_topic_init(MSGBUS_TOPIC_THERMOSTAT_STATE, s_ring_state, sizeof(thermostat_state_t), 4);
+    msgbus_topic_init(MSGBUS_TOPIC_CONFIG, s_ring_config, sizeof(thermostat_config_t), 2);
+    msgbus_topic_init(MSGBUS_TOPIC_BUTTON, s_ring_button, sizeof(button_event_t), 8);
+    history_init(&g_history, s_history_slots, HISTORY_DEPTH, HISTORY_INTERVAL_MS);
+
+    // The bootstrap task registers the handlers and deletes itself.
+    pthread_t boot;
+    pthread_create(&boot, NULL, httpd_thread, NULL);
+    pthread_join(boot, NULL);
+    CHECK(host_httpd_port() != 0);
+
+    RUN_TEST(test_state_before_first_sample);
+    RUN_TEST(test_state_config_json);
+    RUN_TEST(test_history_json);
+    RUN_TEST(test_metrics_json);
+    RUN_TEST(test_history_while_recording);
+    RUN_TEST(test_throughput);
+
+    return HOST_TEST_RESULT();
+}
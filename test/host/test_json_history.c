@@ -0,0 +1,354 @@
+/**
+ * Host test and benchmark for the streaming JSON writer (json_writer.c)
+ * and the lock-free history ring (history.c) behind GET /history.
+ *
+ * The writer must produce the same document whatever its buffer size, so
+ * every document is rebuilt with buffers from 1 byte up and compared with
+ * a single-flush run. The ring is hammered by a writer thread while a
+ * reader checks that every entry it accepts is internally consistent.
+ * The benchmark streams a full /history body through the same 512-byte
+ * buffer the HTTP task uses.
+ */
+
+#include "host_test.h"
+
+#include "core/config.h"
+#include "core/history.h"
+#include "core/json_writer.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+// ---------------------------------------------------------------------------
+// Sinks
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    char     out[16384];
+    size_t   len;
+    uint32_t calls;
+    uint32_t fail_after;    // fail the call after this many (0: never)
+} sink_buf_t;
+
+static int sink_append(void *ctx, const char *data, size_t len)
+{
+    sink_buf_t *s = (sink_buf_t *)ctx;
+
+    if (s->fail_after != 0 && s->calls >= s->fail_after) {
+        return -1;
+    }
+    s->calls++;
+    if (s->len + len >= sizeof(s->out)) {
+        return -1;
+    }
+    memcpy(s->out + s->len, data, len);
+    s->len += len;
+    s->out[s->len] = '\0';
+    return 0;
+}
+
+static int sink_count(void *ctx, const char *data, size_t len)
+{
+    *(size_t *)ctx += len;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// JSON writer
+// ---------------------------------------------------------------------------
+
+static void build_doc(json_writer_t *w)
+{
+    json_begin_object(w);
+    json_kv_string(w, "name", "say \"hi\"\\\n\x01");
+    json_kv_uint(w, "u", 4294967295u);
+    json_kv_uint64(w, "u64", 18446744073709551615ull);
+    json_kv_int(w, "i", -2147483647 - 1);
+    json_kv_bool(w, "b", true);
+    json_kv_fixed(w, "f", -3.05f, 2);
+    json_kv_fixed(w, "nan", NAN, 1);
+    json_key(w, "a");
+    json_begin_array(w);
+    json_null(w);
+    json_begin_object(w);
+    json_end_object(w);
+    json_begin_array(w);
+    json_int(w, 1);
+    json_int(w, 2);
+    json_end_array(w);
+    json_string(w, "");
+    json_end_array(w);
+    json_end_object(w);
+}
+
+static void test_json_any_buffer_size(void)
+{
+    static const char want[] =
+        "{\"name\":\"say \\\"hi\\\"\\\\\\u000a\\u0001\","
+        "\"u\":4294967295,\"u64\":18446744073709551615,\"i\":-2147483648,"
+        "\"b\":true,\"f\":-3.05,\"nan\":null,"
+        "\"a\":[null,{},[1,2],\"\"]}";
+    static sink_buf_t s;
+    char              buf[256];
+    json_writer_t     w;
+
+    for (size_t cap = 1; cap <= sizeof(buf); cap++) {
+        memset(&s, 0, sizeof(s));
+        json_writer_init(&w, buf, cap, sink_append, &s);
+        build_doc(&w);
+        CHECK_EQ_INT(json_writer_finish(&w), ERR_OK);
+        if (strcmp(s.out, want) != 0) {
+            CHECK_EQ_STR(s.out, want);
+            break;
+        }
+        CHECK_EQ_INT(w.bytes, strlen(want));
+        CHECK_EQ_INT(s.calls, (strlen(want) + cap - 1) / cap);
+    }
+}
+
+static void test_json_errors(void)
+{
+    static sink_buf_t s;
+    char              buf[16];
+    json_writer_t     w;
+
+    // Unbalanced close.
+    memset(&s, 0, sizeof(s));
+    json_writer_init(&w, buf, sizeof(buf), sink_append, &s);
+    json_begin_array(&w);
+    json_end_object(&w);
+    json_end_array(&w);
+    json_end_array(&w);
+    CHECK_EQ_INT(json_writer_finish(&w), ERR_GENERIC);
+
+    // Key without a value, and a container left open.
+    json_writer_init(&w, buf, sizeof(buf), sink_append, &s);
+    json_begin_object(&w);
+    json_key(&w, "k");
+    CHECK_EQ_INT(json_writer_finish(&w), ERR_GENERIC);
+
+    json_writer_init(&w, buf, sizeof(buf), sink_append, &s);
+    json_begin_array(&w);
+    CHECK_EQ_INT(json_writer_finish(&w), ERR_GENERIC);
+
+    // Too deep.
+    json_writer_init(&w, buf, sizeof(buf), sink_append, &s);
+    for (int i = 0; i < JSON_WRITER_MAX_DEPTH; i++) {
+        json_begin_array(&w);
+    }
+    for (int i = 0; i < JSON_WRITER_MAX_DEPTH; i++) {
+        json_end_array(&w);
+    }
+    CHECK_EQ_INT(json_writer_finish(&w), ERR_GENERIC);
+
+    // A failing sink (client went away) stops all further output.
+    memset(&s, 0, sizeof(s));
+    s.fail_after = 2;
+    json_writer_init(&w, buf, 4, sink_append, &s);
+    build_doc(&w);
+    CHECK_EQ_INT(json_writer_finish(&w), ERR_GENERIC);
+    CHECK_EQ_INT(s.calls, 2);
+    CHECK_EQ_INT(w.bytes, 8);
+
+    // No buffer or no sink.
+    json_writer_init(&w, NULL, 16, sink_append, &s);
+    json_null(&w);
+    CHECK_EQ_INT(json_writer_finish(&w), ERR_GENERIC);
+    json_writer_init(&w, buf, sizeof(buf), NULL, &s);
+    json_null(&w);
+    CHECK_EQ_INT(json_writer_finish(&w), ERR_GENERIC);
+}
+
+// ---------------------------------------------------------------------------
+// History ring
+// ---------------------------------------------------------------------------
+
+/** State whose fields all encode @p n, so a torn copy is detectable. */
+static thermostat_state_t state_for(uint32_t n, uint64_t t_us)
+{
+    return (thermostat_state_t){
+        .mode         = (thermostat_mode_t)(n % 4u),
+        .output       = (thermostat_output_t)(n % 2u),
+        .setpoint_c   = (float)(n % 1000u) / 10.0f,
+        .tin_c        = (float)(n % 3000u) / 100.0f,
+        .tout_c       = -(float)(n % 2000u) / 100.0f,
+        .timestamp_us = t_us,
+    };
+}
+
+static bool entry_consistent(const history_entry_t *e, uint32_t n)
+{
+    return e->tin_cc      == (int16_t)(n % 3000u) &&
+           e->tout_cc     == -(int16_t)(n % 2000u) &&
+           e->setpoint_cc == (int16_t)((n % 1000u) * 10u) &&
+           e->mode        == n % 4u &&
+           e->output      == n % 2u;
+}
+
+static void test_history_interval_and_overwrite(void)
+{
+    history_slot_t  slots[4];
+    history_t       h;
+    history_entry_t e;
+
+    history_init(&h, slots, 4, HISTORY_INTERVAL_MS);
+    CHECK_EQ_INT(history_head(&h), 0);
+    CHECK(!history_read(&h, 0, &e));
+    CHECK(!history_read(&h, 1, &e));
+
+    // One entry per interval; the first sample is always taken.
+    const uint64_t iv = (uint64_t)HISTORY_INTERVAL_MS * 1000u;
+    CHECK(history_record(&h, &(thermostat_state_t){ .timestamp_us = 5 }));
+    thermostat_state_t st = state_for(1, 5 + iv - 1);
+    CHECK(!history_record(&h, &st));
+    st.timestamp_us = 5 + iv;
+    CHECK(history_record(&h, &st));
+    CHECK_EQ_INT(history_head(&h), 2);
+    CHECK(history_read(&h, 2, &e));
+    CHECK(entry_consistent(&e, 1));
+    CHECK_EQ_INT(e.uptime_s, (5 + iv) / 1000000u);
+
+    // Ten entries in a four-slot ring: only the newest four remain.
+    for (uint32_t n = 3; n <= 10; n++) {
+        st = state_for(n, n * iv);
+        CHECK(history_record(&h, &st));
+    }
+    CHECK_EQ_INT(history_head(&h), 10);
+    for (uint32_t seq = 1; seq <= 11; seq++) {
+        const bool ok = history_read(&h, seq, &e);
+        CHECK_EQ_INT(ok, seq >= 7 && seq <= 10);
+        if (ok) {
+            CHECK(entry_consistent(&e, seq));
+        }
+    }
+}
+
+static struct {
+    history_slot_t slots[HISTORY_DEPTH];
+    history_t      h;
+    volatile bool  stop;
+    uint32_t       written;
+} s_ring;
+
+static void *history_writer(void *arg)
+{
+    uint32_t n = 0;
+    while (!s_ring.stop) {
+        n++;
+        const thermostat_state_t st = state_for(n, (uint64_t)n * 1000000u);
+        history_record(&s_ring.h, &st);
+    }
+    s_ring.written = n;
+    return NULL;
+}
+
+static void test_history_reader_never_sees_torn_entry(void)
+{
+    pthread_t t;
+    uint32_t  reads = 0, hits = 0, torn = 0;
+
+    history_init(&s_ring.h, s_ring.slots, HISTORY_DEPTH, 0);
+    s_ring.stop = false;
+    pthread_create(&t, NULL, history_writer, NULL);
+
+    const uint64_t end = host_now_ns() + 300000000u;
+    while (host_now_ns() < end) {
+        // Walk the ring oldest first, as handle_history() does.
+        const uint32_t head  = history_head(&s_ring.h);
+        const uint32_t first = (head > HISTORY_DEPTH) ? head - HISTORY_DEPTH + 1u : 1u;
+        for (uint32_t seq = first; seq != 0 && seq <= head; seq++) {
+            history_entry_t e;
+            reads++;
+            if (!history_read(&s_ring.h, seq, &e)) {
+                continue;
+            }
+            hits++;
+            if (!entry_consistent(&e, seq) || e.uptime_s != seq) {
+                torn++;
+            }
+        }
+    }
+    s_ring.stop = true;
+    pthread_join(t, NULL);
+
+    printf("  %u entries written, %u reads (%u accepted, %u skipped as recycled), "
+           "%u torn\n", (unsigned)s_ring.written, (unsigned)reads, (unsigned)hits,
+           (unsigned)(reads - hits), (unsigned)torn);
+    CHECK(hits > 0);
+    CHECK_EQ_INT(torn, 0);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+/** The body of GET /history, as built by task_httpd.c. */
+static size_t history_body(const history_t *h, char *buf, size_t cap)
+{
+    static const char *modes[]   = { "off", "heat", "cool", "auto" };
+    static const char *outputs[] = { "off", "heat_on" };
+    size_t             total     = 0;
+    json_writer_t      w;
+
+    json_writer_init(&w, buf, cap, sink_count, &total);
+    json_begin_object(&w);
+    json_kv_uint(&w, "interval_ms", HISTORY_INTERVAL_MS);
+    json_key(&w, "entries");
+    json_begin_array(&w);
+    const uint32_t head = history_head(h);
+    for (uint32_t seq = (head > HISTORY_DEPTH) ? head - HISTORY_DEPTH + 1u : 1u;
+         seq <= head; seq++) {
+        history_entry_t e;
+        if (!history_read(h, seq, &e)) {
+            continue;
+        }
+        json_begin_object(&w);
+        json_kv_uint  (&w, "age_s",      head - e.uptime_s);
+        json_kv_fixed (&w, "tin_c",      e.tin_cc / 100.0f, 2);
+        json_kv_fixed (&w, "tout_c",     e.tout_cc / 100.0f, 2);
+        json_kv_fixed (&w, "setpoint_c", e.setpoint_cc / 100.0f, 2);
+        json_kv_string(&w, "mode",       modes[e.mode & 3u]);
+        json_kv_string(&w, "output",     outputs[e.output & 1u]);
+        json_end_object(&w);
+    }
+    json_end_array(&w);
+    json_end_object(&w);
+    return (json_writer_finish(&w) == ERR_OK) ? total : 0;
+}
+
+static void test_bench_history_body(void)
+{
+    enum { DOCS = 2000 };
+    static history_slot_t slots[HISTORY_DEPTH];
+    history_t             h;
+    char                  buf[HTTPD_CHUNK_LEN];
+    size_t                bytes = 0;
+
+    history_init(&h, slots, HISTORY_DEPTH, 0);
+    for (uint32_t n = 1; n <= HISTORY_DEPTH; n++) {
+        const thermostat_state_t st = state_for(n * 7u, (uint64_t)n * 60000000u);
+        history_record(&h, &st);
+    }
+
+    const uint64_t t0 = host_now_ns();
+    for (int i = 0; i < DOCS; i++) {
+        bytes += history_body(&h, buf, sizeof(buf));
+    }
+    const uint64_t ns = host_now_ns() - t0;
+
+    printf("  /history (%d entries, %u-byte buffer): %zu bytes, %.1f us/body, "
+           "%.0f MB/s\n", HISTORY_DEPTH, (unsigned)HTTPD_CHUNK_LEN, bytes / DOCS,
+           (double)ns / DOCS / 1000.0, (double)bytes * 1000.0 / (double)ns);
+    CHECK(bytes / DOCS > (size_t)HISTORY_DEPTH * 80u);
+}
+
+int main(void)
+{
+    RUN_TEST(test_json_any_buffer_size);
+    RUN_TEST(test_json_errors);
+    RUN_TEST(test_history_interval_and_overwrite);
+    RUN_TEST(test_history_reader_never_sees_torn_entry);
+    RUN_TEST(test_bench_history_body);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,215 @@
+/**
+ * Host test for the PCF8574 byte-stream encoder (lcd_pcf8574_enc.c).
+ *
+ * The recorded bursts are fed to an HD44780 model that latches D4..D7 on
+ * every EN falling edge, so the test checks both the exact expander bytes
+ * and that the stream decodes back to the commands and characters sent.
+ */
+
+#include "host_test.h"
+
+#include "lcd_pcf8574_enc.h"
+
+// ---------------------------------------------------------------------------
+// Recording transport + 4-bit HD44780 decoder
+// ---------------------------------------------------------------------------
+
+static struct {
+    uint8_t  wire[4096];    // every byte written, all bursts concatenated
+    size_t   wire_len;
+    uint32_t writes;
+    uint32_t max_burst;
+    uint32_t sleeps;
+    uint32_t slept_us;
+} s_rec;
+
+static void rec_write(void *ctx, const uint8_t *bytes, size_t len)
+{
+    memcpy(&s_rec.wire[s_rec.wire_len], bytes, len);
+    s_rec.wire_len += len;
+    s_rec.writes++;
+    if (len > s_rec.max_burst) {
+        s_rec.max_burst = (uint32_t)len;
+    }
+}
+
+static void rec_sleep_us(void *ctx, uint32_t us)
+{
+    s_rec.sleeps++;
+    s_rec.slept_us += us;
+}
+
+static const pcf_enc_ops_t s_ops = { rec_write, rec_sleep_us };
+
+static void rec_reset(pcf_enc_t *e)
+{
+    memset(&s_rec, 0, sizeof(s_rec));
+    pcf_enc_init(e, &s_ops, NULL);
+}
+
+typedef struct {
+    uint8_t val;
+    bool    rs;
+} decoded_t;
+
+/** Decode the wire into bytes (pairs of nibbles latched on EN fall). */
+static size_t decode(decoded_t *out, size_t max)
+{
+    size_t  n       = 0;
+    int     half    = 0;
+    uint8_t hi      = 0;
+    uint8_t prev    = PCF_BACKLIGHT;
+
+    for (size_t i = 0; i < s_rec.wire_len; i++) {
+        const uint8_t b = s_rec.wire[i];
+        CHECK(b & PCF_BACKLIGHT);
+        CHECK(!(b & PCF_RW));
+        if ((prev & PCF_EN) && !(b & PCF_EN)) {
+            // Data must be stable across the falling edge.
+            CHECK_EQ_INT(prev & 0xF1, b & 0xF1);
+            if (half == 0) {
+                hi   = b >> 4;
+                half = 1;
+            } else if (n < max) {
+                out[n].val = (uint8_t)((hi << 4) | (b >> 4));
+                out[n].rs  = (b & PCF_RS) != 0;
+                n++;
+                half = 0;
+            }
+        }
+        prev = b;
+    }
+    CHECK_EQ_INT(half, 0);
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_char_byte_stream(void)
+{
+    pcf_enc_t e;
+    rec_reset(&e);
+
+    pcf_enc_send(&e, 'A', true);        // 0x41, RS high
+    CHECK_EQ_INT(s_rec.writes, 0);      // nothing until flush
+    pcf_enc_flush(&e);
+
+    // EN high / EN low per nibble; 50 us settle is under one byte time.
+    const uint8_t want[] = {
+        0x4D, 0x49,     // high nibble 4: D=0x40 | BL | EN | RS, then EN low
+        0x1D, 0x19,     // low nibble 1
+    };
+    CHECK_EQ_INT(s_rec.writes, 1);
+    CHECK_EQ_INT(s_rec.wire_len, sizeof(want));
+    CHECK_EQ_MEM(s_rec.wire, want, sizeof(want));
+
+    pcf_enc_flush(&e);                  // empty flush is a no-op
+    CHECK_EQ_INT(s_rec.writes, 1);
+}
+
+static void test_clear_is_padded(void)
+{
+    pcf_enc_t e;
+    rec_reset(&e);
+
+    pcf_enc_send(&e, 0x01, false);
+    pcf_enc_flush(&e);
+
+    // 4 transfer bytes + idle bytes covering the 2 ms clear time.
+    const size_t pad = s_rec.wire_len - 4;
+    CHECK((pad + 1) * PCF_BYTE_US >= 2000u);
+    CHECK(pad * PCF_BYTE_US < 2000u + PCF_BYTE_US);
+    for (size_t i = 4; i < s_rec.wire_len; i++) {
+        CHECK_EQ_INT(s_rec.wire[i], 0x18);  // lines held at low nibble 1, EN low
+    }
+    CHECK_EQ_INT(s_rec.wire[0], 0x0C);
+    CHECK_EQ_INT(s_rec.wire[3], 0x18);
+
+    decoded_t d[4];
+    CHECK_EQ_INT(decode(d, 4), 1);
+    CHECK_EQ_INT(d[0].val, 0x01);
+    CHECK(!d[0].rs);
+}
+
+static void test_power_up_sleeps(void)
+{
+    pcf_enc_t e;
+    rec_reset(&e);
+
+    pcf_enc_delay_us(&e, 50000u);       // power-up wait: no padding bytes
+    CHECK_EQ_INT(s_rec.wire_len, 0);
+    CHECK_EQ_INT(s_rec.sleeps, 1);
+    CHECK_EQ_INT(s_rec.slept_us, 50000u);
+
+    // Init nibbles: the 4.1 ms wait is padded, not slept.
+    pcf_enc_nibble(&e, 0x03, 4100u);
+    CHECK_EQ_INT(s_rec.sleeps, 1);
+    pcf_enc_nibble(&e, 0x03, 100u);
+    pcf_enc_flush(&e);
+    CHECK_EQ_INT(s_rec.wire[0], 0x3C);
+    CHECK_EQ_INT(s_rec.wire[1], 0x38);
+
+    // A pending burst goes out before the sleep.
+    pcf_enc_send(&e, 'x', true);
+    const uint32_t before = s_rec.writes;
+    pcf_enc_delay_us(&e, 6000u);
+    CHECK_EQ_INT(s_rec.writes, before + 1);
+    CHECK_EQ_INT(s_rec.sleeps, 2);
+}
+
+static void test_frame_splits_at_burst_len(void)
+{
+    pcf_enc_t e;
+    rec_reset(&e);
+
+    // Full 16x2 redraw: cursor move + 16 chars per row = 34 LCD bytes.
+    const char *rows[2] = { "In:21.3 Out:10.0", "Sp:22 H:0.5 AHOn" };
+    for (int r = 0; r < 2; r++) {
+        pcf_enc_send(&e, (uint8_t)(0x80 | (r ? 0x40 : 0x00)), false);
+        for (int c = 0; c < 16; c++) {
+            pcf_enc_send(&e, (uint8_t)rows[r][c], true);
+        }
+    }
+    pcf_enc_flush(&e);
+
+    printf("  full redraw: %u expander bytes in %u burst(s)\n",
+           (unsigned)s_rec.wire_len, (unsigned)s_rec.writes);
+    CHECK_EQ_INT(s_rec.wire_len, 34 * 4);
+    CHECK_EQ_INT(s_rec.writes, 1);      // fits LCD_PCF8574_BURST_LEN
+    CHECK(s_rec.max_burst <= LCD_PCF8574_BURST_LEN);
+
+    decoded_t d[40];
+    CHECK_EQ_INT(decode(d, 40), 34);
+    CHECK_EQ_INT(d[0].val, 0x80);
+    CHECK(!d[0].rs);
+    CHECK_EQ_INT(d[17].val, 0xC0);
+    for (int c = 0; c < 16; c++) {
+        CHECK_EQ_INT(d[1 + c].val, (uint8_t)rows[0][c]);
+        CHECK(d[1 + c].rs);
+        CHECK_EQ_INT(d[18 + c].val, (uint8_t)rows[1][c]);
+    }
+
+    // Two clears back to back overflow the buffer: split on a byte
+    // boundary, never mid-transfer, and still decode.
+    rec_reset(&e);
+    for (int i = 0; i < 8; i++) {
+        pcf_enc_send(&e, 0x01, false);
+        pcf_enc_send(&e, (uint8_t)('0' + i), true);
+    }
+    pcf_enc_flush(&e);
+    CHECK(s_rec.writes > 1);
+    CHECK(s_rec.max_burst <= LCD_PCF8574_BURST_LEN);
+    CHECK_EQ_INT(decode(d, 40), 16);
+    CHECK_EQ_INT(d[15].val, '7');
+}
+
+int main(void)
+{
+    RUN_TEST(test_char_byte_stream);
+    RUN_TEST(test_clear_is_padded);
+    RUN_TEST(test_power_up_sleeps);
+    RUN_TEST(test_frame_splits_at_burst_len);
+    return HOST_TEST_RESULT();
+}
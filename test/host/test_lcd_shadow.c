@@ -0,0 +1,246 @@
+/**
+ * Host test for the LCD shadow framebuffer in drv_display.c.
+ *
+ * drv_display.c is compiled against a recording lcd_bus (lcd_bus.h)
+ * that feeds an HD44780 DDRAM model: commands move the address counter,
+ * data bytes write the cell under it and advance. The test counts bus
+ * operations per frame and checks that the model always ends up
+ * showing the requested frame.
+ */
+
+#include "host_test.h"
+
+#include "drivers/drv_display.h"
+#include "lcd_bus.h"
+
+#include <stdlib.h>
+
+// ---------------------------------------------------------------------------
+// Recording bus + HD44780 DDRAM model
+// ---------------------------------------------------------------------------
+
+static struct {
+    char     ddram[2][40];
+    int      row;           // address counter (row, col)
+    int      col;
+    uint32_t cmds;          // command bytes, including cursor moves
+    uint32_t data;          // character bytes
+    uint32_t flushes;
+} s_lcd;
+
+app_error_t lcd_bus_init(void)
+{
+    memset(&s_lcd, 0, sizeof(s_lcd));
+    return ERR_OK;
+}
+
+void lcd_bus_send(uint8_t val, bool rs)
+{
+    if (rs) {
+        s_lcd.data++;
+        s_lcd.ddram[s_lcd.row][s_lcd.col] = (char)val;
+        s_lcd.col = (s_lcd.col + 1) % 40;
+        return;
+    }
+
+    s_lcd.cmds++;
+    if (val == 0x01) {                  // clear + home
+        memset(s_lcd.ddram, ' ', sizeof(s_lcd.ddram));
+        s_lcd.row = s_lcd.col = 0;
+    } else if (val & 0x80) {            // set DDRAM address
+        const uint8_t addr = val & 0x7F;
+        s_lcd.row = (addr >= 0x40) ? 1 : 0;
+        s_lcd.col = addr - (s_lcd.row ? 0x40 : 0x00);
+    }
+}
+
+void lcd_bus_nibble(uint8_t nib, uint32_t settle_us) { }
+void lcd_bus_delay_us(uint32_t us) { }
+void lcd_bus_flush(void) { s_lcd.flushes++; }
+
+static void counters_reset(void)
+{
+    s_lcd.cmds = s_lcd.data = s_lcd.flushes = 0;
+}
+
+static bool model_shows(const drv_display_frame_t *f)
+{
+    for (int r = 0; r < LCD_ROWS; r++) {
+        const size_t n = strlen(f->line[r]);
+        for (int c = 0; c < LCD_COLS; c++) {
+            const char want = (c < (int)n) ? f->line[r][c] : ' ';
+            if (s_lcd.ddram[r][c] != want) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void frame_set(drv_display_frame_t *f, const char *l0, const char *l1)
+{
+    memset(f, 0, sizeof(*f));
+    strncpy(f->line[0], l0, LCD_COLS);
+    strncpy(f->line[1], l1, LCD_COLS);
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_identical_frame_is_free(void)
+{
+    CHECK_EQ_INT(drv_display_init(), ERR_OK);
+
+    drv_display_frame_t f;
+    frame_set(&f, "In:21.3 Out:10.0", "Sp:22 H:0.5 AHOn");
+
+    counters_reset();
+    CHECK_EQ_INT(drv_display_show_frame(&f), ERR_OK);
+    CHECK(model_shows(&f));
+    const uint32_t first = s_lcd.cmds + s_lcd.data;
+    printf("  first frame: %u cmd + %u data bytes, %u flush\n",
+           (unsigned)s_lcd.cmds, (unsigned)s_lcd.data, (unsigned)s_lcd.flushes);
+    CHECK(first <= 2u * (LCD_COLS + 1u));       // never worse than a full rewrite
+    CHECK_EQ_INT(s_lcd.flushes, 1);
+
+    counters_reset();
+    CHECK_EQ_INT(drv_display_show_frame(&f), ERR_OK);
+    CHECK_EQ_INT(s_lcd.cmds + s_lcd.data, 0);
+    CHECK_EQ_INT(s_lcd.flushes, 0);
+
+    drv_display_stats_t st;
+    drv_display_get_stats(&st);
+    CHECK(st.frames_unchanged >= 1);
+}
+
+static void test_single_digit_change(void)
+{
+    drv_display_frame_t f;
+    frame_set(&f, "In:21.4 Out:10.0", "Sp:22 H:0.5 AHOn");
+
+    counters_reset();
+    drv_display_show_frame(&f);
+    CHECK(model_shows(&f));
+    // One cursor move + one character, against 2 x 17 bytes for a full redraw.
+    CHECK_EQ_INT(s_lcd.cmds, 1);
+    CHECK_EQ_INT(s_lcd.data, 1);
+}
+
+static void test_gap_rewrite_vs_cursor_move(void)
+{
+    drv_display_frame_t f;
+
+    // Two changes far apart (cols 4 and 10): one cursor move each.
+    frame_set(&f, "In:21.4 Out:10.0", "Sp:23 H:0.6 AHOn");
+    counters_reset();
+    drv_display_show_frame(&f);
+    CHECK(model_shows(&f));
+    CHECK_EQ_INT(s_lcd.cmds, 2);
+    CHECK_EQ_INT(s_lcd.data, 2);
+
+    frame_set(&f, "In:21.4 Out:10.0", "Sp:24 H:0.7 AHOn");
+    counters_reset();
+    drv_display_show_frame(&f);
+    CHECK(model_shows(&f));
+
+    // Adjacent cells ("24" -> "35"): one move, then the counter
+    // auto-increments into the second cell.
+    frame_set(&f, "In:21.4 Out:10.0", "Sp:35 H:0.7 AHOn");
+    counters_reset();
+    drv_display_show_frame(&f);
+    CHECK(model_shows(&f));
+    CHECK_EQ_INT(s_lcd.cmds, 1);
+    CHECK_EQ_INT(s_lcd.data, 2);
+
+    // Cols 0 and 2 change: one move, then rewrite col 1 instead of moving.
+    frame_set(&f, "Xn.21.4 Out:10.0", "Sp:35 H:0.7 AHOn");
+    counters_reset();
+    drv_display_show_frame(&f);
+    CHECK(model_shows(&f));
+    CHECK_EQ_INT(s_lcd.cmds, 1);
+    CHECK_EQ_INT(s_lcd.data, 3);
+}
+
+static void test_random_frames_match_model(void)
+{
+    static const char alphabet[] = " 0123456789.:ACHOSInutp";
+    drv_display_frame_t f;
+    uint32_t rng = 7u;
+    uint32_t total = 0;
+    const int frames = 5000;
+
+    frame_set(&f, "", "");
+    drv_display_show_frame(&f);
+
+    counters_reset();
+    for (int i = 0; i < frames; i++) {
+        // Mutate a few cells per frame, like a live status screen.
+        for (int k = 0; k < 3; k++) {
+            rng = rng * 1103515245u + 12345u;
+            const int r = (rng >> 8) & 1;
+            const int c = (rng >> 9) % LCD_COLS;
+            const size_t len = strlen(f.line[r]);
+            for (size_t p = len; p < (size_t)c; p++) {
+                f.line[r][p] = ' ';
+            }
+            f.line[r][c] = alphabet[(rng >> 16) % (sizeof(alphabet) - 1)];
+        }
+        drv_display_show_frame(&f);
+        if (!model_shows(&f)) {
+            CHECK(model_shows(&f));
+            break;
+        }
+    }
+    total = s_lcd.cmds + s_lcd.data;
+    printf("  %d frames, <=3 cells changed each: %.2f bus bytes/frame "
+           "(full redraw: %d)\n", frames, (double)total / frames,
+           2 * (LCD_COLS + 1));
+    CHECK(total < (uint32_t)frames * 8u);
+}
+
+static void test_clear_resets_shadow(void)
+{
+    drv_display_frame_t f;
+    frame_set(&f, "hello", "world");
+    drv_display_show_frame(&f);
+
+    CHECK_EQ_INT(drv_display_clear(), ERR_OK);
+    counters_reset();
+    drv_display_show_frame(&f);
+    CHECK(model_shows(&f));
+    CHECK_EQ_INT(s_lcd.data, 10);
+}
+
+static void test_format_state_rounding(void)
+{
+    thermostat_state_t  st = {
+        .tin_c        = 21.25f,
+        .tout_c       = -3.05f,
+        .setpoint_c   = 22.5f,
+        .hysteresis_c = 0.5f,
+        .mode         = THERMOSTAT_MODE_AUTO,
+        .output       = THERMOSTAT_OUTPUT_HEAT_ON,
+    };
+    drv_display_frame_t f;
+
+    // Same digits as the old "In:%2.1f Out:%2.1f" / "Sp:%2.0f H:%1.1f".
+    drv_display_format_state(&st, &f);
+    CHECK_EQ_STR(f.line[0], "In:21.2 Out:-3.0");
+    CHECK_EQ_STR(f.line[1], "Sp:22 H:0.5 AHOn");
+
+    st.setpoint_c = 23.5f;
+    drv_display_format_state(&st, &f);
+    CHECK_EQ_STR(f.line[1], "Sp:24 H:0.5 AHOn");
+}
+
+int main(void)
+{
+    RUN_TEST(test_format_state_rounding);
+    RUN_TEST(test_identical_frame_is_free);
+    RUN_TEST(test_single_digit_change);
+    RUN_TEST(test_gap_rewrite_vs_cursor_move);
+    RUN_TEST(test_random_frames_match_model);
+    RUN_TEST(test_clear_resets_shadow);
+    return HOST_TEST_RESULT();
+}
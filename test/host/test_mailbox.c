@@ -0,0 +1,365 @@
+/**
+ * Host test and microbenchmark for the latest-value mailbox (mailbox.c).
+ *
+ * Runs on pthreads through stubs/host_rtos.c: a "task" is a thread, task
+ * notifications are a counter + condvar, and the length-1 queue used for
+ * comparison is a mutex + condvar ring with FreeRTOS copy semantics.
+ * Absolute numbers are host numbers; the comparison is what matters.
+ */
+
+#include "host_test.h"
+
+#include "core/app_types.h"
+#include "core/mailbox.h"
+
+#include "freertos/queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define TORN_WORDS      16
+#define STRESS_PUBLISH  1000000u
+#define HANDOFFS        100000u
+
+typedef struct {
+    uint32_t word[TORN_WORDS];  // all equal to the publish number
+} torn_probe_t;
+
+// ---------------------------------------------------------------------------
+// Functional
+// ---------------------------------------------------------------------------
+
+static void test_publish_read_wait(void)
+{
+    sensor_sample_t storage;
+    sensor_sample_t v   = { 21.5f, 4.0f, 1000u };
+    sensor_sample_t out = { 0 };
+    uint32_t        seq = 0;
+    mailbox_t       mb;
+
+    mailbox_init(&mb, &storage, sizeof(storage));
+    CHECK(!mailbox_read(&mb, &out, &seq));
+    CHECK_EQ_INT(mailbox_seq(&mb), 0);
+    CHECK(!mailbox_wait(&mb, &out, &seq, 0));
+
+    CHECK_EQ_INT(mailbox_publish(&mb, &v), 1);
+    v.temp_inside_c = 22.0f;
+    CHECK_EQ_INT(mailbox_publish(&mb, &v), 2);
+
+    // Newer value present: returns at once, with the newest value only.
+    CHECK(mailbox_wait(&mb, &out, &seq, portMAX_DELAY));
+    CHECK_EQ_INT(seq, 2);
+    CHECK(out.temp_inside_c == 22.0f);
+
+    // Non-consuming: any reader still sees it.
+    memset(&out, 0, sizeof(out));
+    uint32_t rseq = 0;
+    CHECK(mailbox_read(&mb, &out, &rseq));
+    CHECK_EQ_INT(rseq, 2);
+    CHECK(out.temp_inside_c == 22.0f);
+
+    // Nothing newer: times out.
+    const TickType_t t0 = xTaskGetTickCount();
+    CHECK(!mailbox_wait(&mb, &out, &seq, 30));
+    CHECK(xTaskGetTickCount() - t0 >= 30);
+    CHECK_EQ_INT(seq, 2);
+}
+
+// ---------------------------------------------------------------------------
+// Torn reads under a concurrent writer
+// ---------------------------------------------------------------------------
+
+static mailbox_t    s_stress_mb;
+static torn_probe_t s_stress_slot;
+static volatile int s_stress_done;
+
+static void *stress_writer(void *arg)
+{
+    torn_probe_t v;
+    for (uint32_t n = 1; n <= STRESS_PUBLISH; n++) {
+        for (int i = 0; i < TORN_WORDS; i++) {
+            v.word[i] = n;
+        }
+        mailbox_publish(&s_stress_mb, &v);
+    }
+    __atomic_store_n(&s_stress_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+typedef struct {
+    uint32_t reads;
+    uint32_t torn;
+    uint32_t backwards;
+    uint32_t wrong_seq;
+} stress_result_t;
+
+static void *stress_reader(void *arg)
+{
+    stress_result_t *r    = arg;
+    uint32_t         last = 0;
+    torn_probe_t     v;
+    uint32_t         seq;
+
+    while (!__atomic_load_n(&s_stress_done, __ATOMIC_ACQUIRE)) {
+        if (!mailbox_read(&s_stress_mb, &v, &seq)) {
+            continue;
+        }
+        r->reads++;
+        for (int i = 1; i < TORN_WORDS; i++) {
+            if (v.word[i] != v.word[0]) {
+                r->torn++;
+                break;
+            }
+        }
+        if (v.word[0] != seq) {
+            r->wrong_seq++;
+        }
+        if (seq < last) {
+            r->backwards++;
+        }
+        last = seq;
+    }
+    return NULL;
+}
+
+static void test_no_torn_reads(void)
+{
+    pthread_t       w, rd[2];
+    stress_result_t res[2] = { { 0 } };
+
+    mailbox_init(&s_stress_mb, &s_stress_slot, sizeof(s_stress_slot));
+    s_stress_done = 0;
+
+    for (int i = 0; i < 2; i++) {
+        pthread_create(&rd[i], NULL, stress_reader, &res[i]);
+    }
+    pthread_create(&w, NULL, stress_writer, NULL);
+    pthread_join(w, NULL);
+    for (int i = 0; i < 2; i++) {
+        pthread_join(rd[i], NULL);
+    }
+
+    printf("  %u publishes, %u + %u concurrent reads\n",
+           STRESS_PUBLISH, (unsigned)res[0].reads, (unsigned)res[1].reads);
+    for (int i = 0; i < 2; i++) {
+        CHECK(res[i].reads > 0);
+        CHECK_EQ_INT(res[i].torn, 0);
+        CHECK_EQ_INT(res[i].wrong_seq, 0);
+        CHECK_EQ_INT(res[i].backwards, 0);
+    }
+    CHECK_EQ_INT(mailbox_seq(&s_stress_mb), STRESS_PUBLISH);
+}
+
+// ---------------------------------------------------------------------------
+// Detach: no notification reaches a waiter after mailbox_attach(NULL)
+// ---------------------------------------------------------------------------
+
+#define DETACH_ROUNDS   2000u
+
+static mailbox_t       s_detach_mb;
+static sensor_sample_t s_detach_slot;
+static volatile int    s_detach_done;
+
+static void *detach_publisher(void *arg)
+{
+    sensor_sample_t v = { 20.0f, 5.0f, 0 };
+    const bool      kick = (arg != NULL);
+
+    while (!__atomic_load_n(&s_detach_done, __ATOMIC_ACQUIRE)) {
+        if (kick) {
+            mailbox_notify(&s_detach_mb);           // task_control_kick()
+        } else {
+            v.timestamp_us++;
+            mailbox_publish(&s_detach_mb, &v);      // SENSORS
+        }
+    }
+    return NULL;
+}
+
+static void test_detach_stops_notifications(void)
+{
+    pthread_t pub[2];
+    uint32_t  woken = 0, late = 0;
+
+    mailbox_init(&s_detach_mb, &s_detach_slot, sizeof(s_detach_slot));
+    s_detach_done = 0;
+    pthread_create(&pub[0], NULL, detach_publisher, NULL);
+    pthread_create(&pub[1], NULL, detach_publisher, &s_detach_mb);
+
+    // The watchdog's detach-then-delete of CONTROL, over and over: once
+    // mailbox_attach(NULL) returns, the old waiter must not be notified.
+    for (uint32_t r = 0; r < DETACH_ROUNDS; r++) {
+        mailbox_attach(&s_detach_mb, xTaskGetCurrentTaskHandle());
+        woken += (ulTaskNotifyTake(pdTRUE, 1) != 0);
+        mailbox_attach(&s_detach_mb, NULL);
+
+        ulTaskNotifyTake(pdTRUE, 0);
+        for (int i = 0; i < 3; i++) {
+            sched_yield();
+        }
+        late += (ulTaskNotifyTake(pdTRUE, 0) != 0);
+    }
+
+    __atomic_store_n(&s_detach_done, 1, __ATOMIC_RELEASE);
+    pthread_join(pub[0], NULL);
+    pthread_join(pub[1], NULL);
+
+    printf("  %u attach / detach rounds, %u woken, %u notified after detach\n",
+           DETACH_ROUNDS, (unsigned)woken, (unsigned)late);
+    CHECK(woken > 0);
+    CHECK_EQ_INT(late, 0);
+}
+
+// ---------------------------------------------------------------------------
+// Producer -> blocked consumer handoff: mailbox vs length-1 overwrite queue
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    mailbox_t       mb;
+    sensor_sample_t slot;
+    QueueHandle_t   q;
+    volatile int    ready;
+    uint32_t        received;
+    uint32_t        last_ts;
+    uint32_t        out_of_order;
+} handoff_t;
+
+static void *mailbox_consumer(void *arg)
+{
+    handoff_t      *h   = arg;
+    sensor_sample_t s;
+    uint32_t        seq = 0;
+
+    mailbox_attach(&h->mb, xTaskGetCurrentTaskHandle());
+    __atomic_store_n(&h->ready, 1, __ATOMIC_RELEASE);
+
+    while (h->last_ts < HANDOFFS) {
+        if (mailbox_wait(&h->mb, &s, &seq, portMAX_DELAY)) {
+            h->received++;
+            if ((uint32_t)s.timestamp_us <= h->last_ts) {
+                h->out_of_order++;
+            }
+            h->last_ts = (uint32_t)s.timestamp_us;
+        }
+    }
+    return NULL;
+}
+
+static void *queue_consumer(void *arg)
+{
+    handoff_t      *h = arg;
+    sensor_sample_t s;
+
+    __atomic_store_n(&h->ready, 1, __ATOMIC_RELEASE);
+    while (h->last_ts < HANDOFFS) {
+        if (xQueueReceive(h->q, &s, portMAX_DELAY) == pdTRUE) {
+            h->received++;
+            if ((uint32_t)s.timestamp_us <= h->last_ts) {
+                h->out_of_order++;
+            }
+            h->last_ts = (uint32_t)s.timestamp_us;
+        }
+    }
+    return NULL;
+}
+
+static double run_handoff(handoff_t *h, bool use_mailbox, double *publish_ns)
+{
+    pthread_t c;
+    sensor_sample_t s = { 21.0f, 5.0f, 0 };
+
+    pthread_create(&c, NULL, use_mailbox ? mailbox_consumer : queue_consumer, h);
+    while (!__atomic_load_n(&h->ready, __ATOMIC_ACQUIRE)) {
+    }
+
+    uint64_t pub_ns = 0;
+    const uint64_t t0 = host_now_ns();
+    for (uint32_t n = 1; n <= HANDOFFS; n++) {
+        s.timestamp_us = n;
+        const uint64_t p0 = host_now_ns();
+        if (use_mailbox) {
+            mailbox_publish(&h->mb, &s);
+        } else {
+            xQueueOverwrite(h->q, &s);
+        }
+        pub_ns += host_now_ns() - p0;
+    }
+    pthread_join(c, NULL);
+    const uint64_t t1 = host_now_ns();
+
+    *publish_ns = (double)pub_ns / HANDOFFS;
+    return (double)(t1 - t0) / HANDOFFS;
+}
+
+static void test_handoff_vs_queue(void)
+{
+    static handoff_t mb_h, q_h;
+    double mb_pub, q_pub;
+
+    mailbox_init(&mb_h.mb, &mb_h.slot, sizeof(mb_h.slot));
+    q_h.q = xQueueCreate(1, sizeof(sensor_sample_t));
+
+    const double mb_total = run_handoff(&mb_h, true, &mb_pub);
+    const double q_total  = run_handoff(&q_h, false, &q_pub);
+
+    printf("  mailbox: publish %6.1f ns, %6.1f ns/sample end to end, "
+           "consumer woke for %u of %u\n",
+           mb_pub, mb_total, (unsigned)mb_h.received, HANDOFFS);
+    printf("  queue  : publish %6.1f ns, %6.1f ns/sample end to end, "
+           "consumer woke for %u of %u\n",
+           q_pub, q_total, (unsigned)q_h.received, HANDOFFS);
+
+    // Both deliver the newest value last and never go backwards.
+    CHECK_EQ_INT(mb_h.last_ts, HANDOFFS);
+    CHECK_EQ_INT(q_h.last_ts, HANDOFFS);
+    CHECK_EQ_INT(mb_h.out_of_order, 0);
+    CHECK_EQ_INT(q_h.out_of_order, 0);
+
+    vQueueDelete(q_h.q);
+}
+
+// ---------------------------------------------------------------------------
+// Non-consuming reads: mailbox_read vs xQueuePeek (single thread)
+// ---------------------------------------------------------------------------
+
+static void test_read_cost(void)
+{
+    const uint32_t  iters = 2000000u;
+    sensor_sample_t storage, s = { 21.0f, 5.0f, 1u }, out;
+    mailbox_t       mb;
+    QueueHandle_t   q = xQueueCreate(1, sizeof(sensor_sample_t));
+    volatile float  sink = 0.0f;
+
+    mailbox_init(&mb, &storage, sizeof(storage));
+    mailbox_publish(&mb, &s);
+    xQueueOverwrite(q, &s);
+
+    uint64_t t0 = host_now_ns();
+    for (uint32_t i = 0; i < iters; i++) {
+        mailbox_read(&mb, &out, NULL);
+        sink += out.temp_inside_c;
+    }
+    const double mb_ns = (double)(host_now_ns() - t0) / iters;
+
+    t0 = host_now_ns();
+    for (uint32_t i = 0; i < iters; i++) {
+        xQueuePeek(q, &out, 0);
+        sink += out.temp_inside_c;
+    }
+    const double q_ns = (double)(host_now_ns() - t0) / iters;
+
+    printf("  read newest value: mailbox %.1f ns, queue peek %.1f ns\n",
+           mb_ns, q_ns);
+    CHECK(sink > 0.0f);
+    vQueueDelete(q);
+}
+
+int main(void)
+{
+    RUN_TEST(test_publish_read_wait);
+    RUN_TEST(test_no_torn_reads);
+    RUN_TEST(test_detach_stops_notifications);
+    RUN_TEST(test_handoff_vs_queue);
+    RUN_TEST(test_read_cost);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,174 @@
+/**
+ * Host test for the MQTT command parser (mqtt_cmd.c).
+ *
+ * Topic names and payloads come straight from the MQTT client, which
+ * hands over length-delimited buffers that are not NUL-terminated and
+ * may be followed by unrelated bytes. Every case here is parsed from a
+ * copy placed in front of a run of garbage, so reading past the given
+ * length shows up as a wrong result.
+ */
+
+#include "host_test.h"
+
+#include "core/config.h"
+#include "core/mqtt_cmd.h"
+
+#include <stdlib.h>
+
+static app_error_t parse(const char *name, const char *payload, mqtt_cmd_t *out)
+{
+    static char n_buf[64];
+    static char p_buf[64];
+    const size_t nl = strlen(name);
+    const size_t pl = strlen(payload);
+
+    memset(n_buf, 'x', sizeof(n_buf));
+    memset(p_buf, '7', sizeof(p_buf));
+    memcpy(n_buf, name, nl);
+    memcpy(p_buf, payload, pl);
+    return mqtt_cmd_parse(n_buf, nl, p_buf, pl, out);
+}
+
+static void test_mode(void)
+{
+    static const struct {
+        const char        *payload;
+        thermostat_mode_t  mode;
+    } ok[] = {
+        { "off",      THERMOSTAT_MODE_OFF  },
+        { "heat",     THERMOSTAT_MODE_HEAT },
+        { "cool",     THERMOSTAT_MODE_COOL },
+        { "auto",     THERMOSTAT_MODE_AUTO },
+        { "HEAT",     THERMOSTAT_MODE_HEAT },
+        { " Auto\r\n", THERMOSTAT_MODE_AUTO },
+    };
+    mqtt_cmd_t cmd;
+
+    for (size_t i = 0; i < sizeof(ok) / sizeof(ok[0]); i++) {
+        memset(&cmd, 0xA5, sizeof(cmd));
+        CHECK_EQ_INT(parse("mode", ok[i].payload, &cmd), ERR_OK);
+        CHECK_EQ_INT(cmd.type, MQTT_CMD_MODE);
+        CHECK_EQ_INT(cmd.mode, ok[i].mode);
+    }
+
+    CHECK_EQ_INT(parse("mode", "heating", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("mode", "he at", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("mode", "", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("mode", "   ", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("mode", "1", &cmd), ERR_GENERIC);
+}
+
+static void test_setpoint_and_hysteresis(void)
+{
+    mqtt_cmd_t cmd;
+
+    CHECK_EQ_INT(parse("setpoint", "21.5", &cmd), ERR_OK);
+    CHECK_EQ_INT(cmd.type, MQTT_CMD_SETPOINT);
+    CHECK(cmd.value_c == 21.5f);
+
+    CHECK_EQ_INT(parse("setpoint", " 22\n", &cmd), ERR_OK);
+    CHECK(cmd.value_c == 22.0f);
+
+    CHECK_EQ_INT(parse("hysteresis", "0.5", &cmd), ERR_OK);
+    CHECK_EQ_INT(cmd.type, MQTT_CMD_HYSTERESIS);
+    CHECK(cmd.value_c == 0.5f);
+
+    // Range limits are inclusive and come from config.h.
+    CHECK_EQ_INT(parse("setpoint", "15", &cmd), ERR_OK);
+    CHECK(cmd.value_c == THERMOSTAT_SP_MIN_C);
+    CHECK_EQ_INT(parse("setpoint", "28.0", &cmd), ERR_OK);
+    CHECK(cmd.value_c == THERMOSTAT_SP_MAX_C);
+    CHECK_EQ_INT(parse("setpoint", "14.99", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("setpoint", "28.01", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("hysteresis", "0.05", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("hysteresis", "3.5", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("hysteresis", "-0.5", &cmd), ERR_GENERIC);
+}
+
+static void test_bad_numbers(void)
+{
+    static const char *bad[] = {
+        "", "abc", "21.5C", "21,5", "21.5 22", "nan", "NaN", "inf",
+        "-inf", "1e999", "--21", "21.5.1",
+    };
+    mqtt_cmd_t cmd;
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (parse("setpoint", bad[i], &cmd) != ERR_GENERIC) {
+            fprintf(stderr, "  accepted setpoint \"%s\"\n", bad[i]);
+            CHECK(false);
+        }
+    }
+
+    // Longer than the parser's buffer, even if the number would fit.
+    CHECK_EQ_INT(parse("setpoint", "21.500000000000000", &cmd), ERR_GENERIC);
+}
+
+static void test_names(void)
+{
+    mqtt_cmd_t cmd;
+
+    CHECK_EQ_INT(parse("mod", "heat", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("modes", "heat", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("MODE", "heat", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("cmd/mode", "heat", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("", "heat", &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(parse("restart", "1", &cmd), ERR_GENERIC);
+
+    CHECK_EQ_INT(mqtt_cmd_parse(NULL, 0, "heat", 4, &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(mqtt_cmd_parse("mode", 4, NULL, 0, &cmd), ERR_GENERIC);
+    CHECK_EQ_INT(mqtt_cmd_parse("mode", 4, "heat", 4, NULL), ERR_GENERIC);
+}
+
+static void test_random_payloads_stay_in_range(void)
+{
+    static const char alphabet[] = "0123456789.-+eE xXnaifHEATOFCOLUheatofcolu\t\r\n";
+    static const char *names[]   = { "mode", "setpoint", "hysteresis" };
+    uint32_t rng = 99u;
+    uint32_t accepted = 0;
+
+    for (int i = 0; i < 200000; i++) {
+        char   payload[24];
+        size_t len;
+
+        rng = rng * 1103515245u + 12345u;
+        len = (rng >> 8) % sizeof(payload);
+        for (size_t k = 0; k < len; k++) {
+            rng = rng * 1103515245u + 12345u;
+            payload[k] = alphabet[(rng >> 16) % (sizeof(alphabet) - 1)];
+        }
+
+        const char *name = names[i % 3];
+        mqtt_cmd_t  cmd;
+        if (mqtt_cmd_parse(name, strlen(name), payload, len, &cmd) != ERR_OK) {
+            continue;
+        }
+        accepted++;
+        switch (cmd.type) {
+        case MQTT_CMD_MODE:
+            CHECK(cmd.mode <= THERMOSTAT_MODE_AUTO);
+            break;
+        case MQTT_CMD_SETPOINT:
+            CHECK(cmd.value_c >= THERMOSTAT_SP_MIN_C && cmd.value_c <= THERMOSTAT_SP_MAX_C);
+            break;
+        case MQTT_CMD_HYSTERESIS:
+            CHECK(cmd.value_c >= THERMOSTAT_HYST_MIN_C && cmd.value_c <= THERMOSTAT_HYST_MAX_C);
+            break;
+        default:
+            CHECK(false);
+            break;
+        }
+    }
+    printf("  200000 random payloads: %u accepted, all in range\n", (unsigned)accepted);
+    CHECK(accepted > 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_mode);
+    RUN_TEST(test_setpoint_and_hysteresis);
+    RUN_TEST(test_bad_numbers);
+    RUN_TEST(test_names);
+    RUN_TEST(test_random_payloads_stay_in_range);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,797 @@
+/**
+ * Host test for the MQTT task (task_mqtt.c) against a local stand-in
+ * broker.
+ *
+ * The real task runs on a pthread (stubs/host_rtos.c) and reads states
+ * from the real message bus; esp-mqtt is the socket shim in
+ * stubs/host_mqtt_client.c, pointed at a broker thread in this file. The
+ * broker speaks just enough MQTT 3.1.1 for one client: it records every
+ * PUBLISH with its arrival time, keeps retained messages, applies the
+ * last will when the connection drops, and can inject commands or drop
+ * the client. thermostat.c is the real core (remote mode changes go
+ * through it); the config store and task_control_kick() are stubs that
+ * record what the command path did.
+ */
+
+#define _GNU_SOURCE
+
+#include "host_test.h"
+
+#include "core/config.h"
+#include "core/monotime.h"
+#include "core/msgbus.h"
+#include "core/telemetry_codec.h"
+#include "core/thermostat.h"
+#include "core/thermostat_config.h"
+#include "core/timeutil.h"
+#include "core/watchdog.h"
+
+#include "app/task_common.h"
+#include "app/task_control.h"
+#include "app/task_mqtt.h"
+#include "app/task_net.h"
+
+#include "mqtt_client.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TOPIC_STATUS    MQTT_TOPIC_BASE "/status"
+#define TOPIC_STATE     MQTT_TOPIC_BASE "/state"
+#define TOPIC_SAMPLES   MQTT_TOPIC_BASE "/samples"
+#define TOPIC_CMD       MQTT_TOPIC_BASE "/cmd/"
+
+// ---------------------------------------------------------------------------
+// Firmware dependencies
+// ---------------------------------------------------------------------------
+
+bool task_net_wait_connected(TickType_t timeout) { return true; }
+
+time_t timeutil_now(void) { return time(NULL); }
+bool   timeutil_is_time_set(void) { return true; }
+
+bool timeutil_format_iso8601(time_t t, char *buf, size_t buf_len)
+{
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    return strftime(buf, buf_len, "%Y-%m-%dT%H:%M:%SZ", &tm) != 0;
+}
+
+void      watchdog_loop_begin(void) { }
+esp_err_t watchdog_feed(void) { return ESP_OK; }
+
+// Config store: the command path's only writer besides the mode.
+static pthread_mutex_t     s_cfg_m = PTHREAD_MUTEX_INITIALIZER;
+static thermostat_config_t s_cfg   = { THERMOSTAT_SETPOINT_C, THERMOSTAT_HYSTERESIS_C };
+
+app_error_t thermostat_config_init(void) { return ERR_OK; }
+
+app_error_t thermostat_config_get(thermostat_config_t *out)
+{
+    pthread_mutex_lock(&s_cfg_m);
+    *out = s_cfg;
+    pthread_mutex_unlock(&s_cfg_m);
+    return ERR_OK;
+}
+
+app_error_t thermostat_config_update(thermostat_config_mutator_t fn, void *ctx,
+                                     thermostat_config_t *out_cfg)
+{
+    pthread_mutex_lock(&s_cfg_m);
+    fn(&s_cfg, ctx);
+    if (out_cfg != NULL) {
+        *out_cfg = s_cfg;
+    }
+    pthread_mutex_unlock(&s_cfg_m);
+    return ERR_OK;
+}
+
+// CONTROL: record when it was kicked.
+static struct {
+    pthread_mutex_t m;
+    pthread_cond_t  cv;
+    uint32_t        count;
+    uint64_t        last_ns;
+} s_kick = { .m = PTHREAD_MUTEX_INITIALIZER, .cv = PTHREAD_COND_INITIALIZER };
+
+void task_control_kick(void)
+{
+    const uint64_t now = host_now_ns();
+
+    pthread_mutex_lock(&s_kick.m);
+    s_kick.count++;
+    s_kick.last_ns = now;
+    pthread_cond_broadcast(&s_kick.cv);
+    pthread_mutex_unlock(&s_kick.m);
+}
+
+// ---------------------------------------------------------------------------
+// Stand-in broker
+// ---------------------------------------------------------------------------
+
+#define BRK_MAX_MSG     512
+#define BRK_MAX_RETAIN  4
+#define BRK_BODY_MAX    1024
+
+typedef struct {
+    char     topic[96];
+    uint8_t  payload[BRK_BODY_MAX];
+    size_t   len;
+    int      qos;
+    bool     retain;
+    bool     will;          // published by the broker for a dropped client
+    uint64_t at_ns;
+} brk_msg_t;
+
+static struct {
+    pthread_mutex_t m;
+    pthread_cond_t  cv;
+    pthread_mutex_t tx;             // serialises writes to the client socket
+    int             listen_fd;
+    int             fd;             // current client, -1 between sessions
+    uint32_t        sessions;
+    char            client_id[64];
+    char            sub[96];
+    brk_msg_t       will;
+    uint32_t        nmsg;
+    brk_msg_t       msg[BRK_MAX_MSG];
+    brk_msg_t       retained[BRK_MAX_RETAIN];
+} s_brk = {
+    .m  = PTHREAD_MUTEX_INITIALIZER,
+    .cv = PTHREAD_COND_INITIALIZER,
+    .tx = PTHREAD_MUTEX_INITIALIZER,
+    .fd = -1,
+};
+
+static bool brk_recv_all(int fd, uint8_t *p, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        p   += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static void brk_send(int fd, uint8_t type, const uint8_t *body, size_t len)
+{
+    uint8_t pkt[8 + BRK_BODY_MAX + 128];
+    size_t  n = 0;
+
+    pkt[n++] = type;
+    size_t rem = len;
+    do {
+        uint8_t b = rem & 0x7f;
+        rem >>= 7;
+        pkt[n++] = b | (rem > 0 ? 0x80 : 0);
+    } while (rem > 0);
+    memcpy(pkt + n, body, len);
+
+    pthread_mutex_lock(&s_brk.tx);
+    send(fd, pkt, n + len, MSG_NOSIGNAL);
+    pthread_mutex_unlock(&s_brk.tx);
+}
+
+/** Read a length-prefixed string at @p *off; false if it runs past @p len. */
+static bool brk_str(const uint8_t *b, size_t len, size_t *off, char *out, size_t cap)
+{
+    if (*off + 2 > len) {
+        return false;
+    }
+    const size_t n = ((size_t)b[*off] << 8) | b[*off + 1];
+    if (*off + 2 + n > len || n >= cap) {
+        return false;
+    }
+    memcpy(out, b + *off + 2, n);
+    out[n] = '\0';
+    *off += 2 + n;
+    return true;
+}
+
+/** Log a message and update the retained table; s_brk.m held. */
+static void brk_store(const brk_msg_t *m)
+{
+    if (s_brk.nmsg < BRK_MAX_MSG) {
+        s_brk.msg[s_brk.nmsg++] = *m;
+    }
+    if (!m->retain) {
+        return;
+    }
+    int slot = -1;
+    for (int i = 0; i < BRK_MAX_RETAIN; i++) {
+        if (strcmp(s_brk.retained[i].topic, m->topic) == 0) {
+            slot = i;
+            break;
+        }
+        if (slot < 0 && s_brk.retained[i].topic[0] == '\0') {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        s_brk.retained[slot] = *m;
+    }
+}
+
+static void brk_on_connect(int fd, const uint8_t *b, size_t len)
+{
+    size_t  off = 0;
+    char    proto[8];
+    uint8_t ack[2] = { 0, 0 };
+
+    if (!brk_str(b, len, &off, proto, sizeof(proto)) || off + 4 > len) {
+        return;
+    }
+    const uint8_t flags = b[off + 1];
+    off += 4;
+
+    pthread_mutex_lock(&s_brk.m);
+    memset(&s_brk.will, 0, sizeof(s_brk.will));
+    brk_str(b, len, &off, s_brk.client_id, sizeof(s_brk.client_id));
+    if (flags & 0x04) {
+        brk_str(b, len, &off, s_brk.will.topic, sizeof(s_brk.will.topic));
+        char msg[64];
+        brk_str(b, len, &off, msg, sizeof(msg));
+        s_brk.will.len    = strlen(msg);
+        memcpy(s_brk.will.payload, msg, s_brk.will.len);
+        s_brk.will.qos    = (flags >> 3) & 3;
+        s_brk.will.retain = (flags & 0x20) != 0;
+        s_brk.will.will   = true;
+    }
+    s_brk.fd = fd;
+    s_brk.sessions++;
+    pthread_cond_broadcast(&s_brk.cv);
+    pthread_mutex_unlock(&s_brk.m);
+
+    brk_send(fd, 0x20, ack, sizeof(ack));
+}
+
+static void brk_on_publish(int fd, uint8_t type, const uint8_t *b, size_t len)
+{
+    brk_msg_t m = { .qos = (type >> 1) & 3, .retain = type & 1, .at_ns = host_now_ns() };
+    size_t    off = 0;
+
+    if (!brk_str(b, len, &off, m.topic, sizeof(m.topic))) {
+        return;
+    }
+    if (m.qos > 0) {
+        brk_send(fd, 0x40, b + off, 2);
+        off += 2;
+    }
+    m.len = len - off;
+    memcpy(m.payload, b + off, m.len);
+
+    pthread_mutex_lock(&s_brk.m);
+    brk_store(&m);
+    pthread_cond_broadcast(&s_brk.cv);
+    pthread_mutex_unlock(&s_brk.m);
+}
+
+static void brk_on_subscribe(int fd, const uint8_t *b, size_t len)
+{
+    size_t  off = 2;
+    uint8_t ack[3] = { b[0], b[1], 1 };
+
+    pthread_mutex_lock(&s_brk.m);
+    brk_str(b, len, &off, s_brk.sub, sizeof(s_brk.sub));
+    pthread_cond_broadcast(&s_brk.cv);
+    pthread_mutex_unlock(&s_brk.m);
+
+    brk_send(fd, 0x90, ack, sizeof(ack));
+}
+
+/** Serve one connection; true if the client said DISCONNECT. */
+static bool brk_session(int fd)
+{
+    static uint8_t b[BRK_BODY_MAX + 128];
+
+    while (1) {
+        uint8_t type, c;
+        size_t  len = 0;
+
+        if (!brk_recv_all(fd, &type, 1)) {
+            return false;
+        }
+        for (int shift = 0; shift < 28; shift += 7) {
+            if (!brk_recv_all(fd, &c, 1)) {
+                return false;
+            }
+            len |= (size_t)(c & 0x7f) << shift;
+            if ((c & 0x80) == 0) {
+                break;
+            }
+        }
+        if (len > sizeof(b) || !brk_recv_all(fd, b, len)) {
+            return false;
+        }
+
+        switch (type & 0xf0) {
+        case 0x10: brk_on_connect(fd, b, len);          break;
+        case 0x30: brk_on_publish(fd, type, b, len);    break;
+        case 0x80: brk_on_subscribe(fd, b, len);        break;
+        case 0xc0: brk_send(fd, 0xd0, NULL, 0);         break;
+        case 0xe0: return true;
+        default:                                        break;
+        }
+    }
+}
+
+static void *brk_thread(void *arg)
+{
+    while (1) {
+        const int fd = accept(s_brk.listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        const bool clean = brk_session(fd);
+
+        pthread_mutex_lock(&s_brk.m);
+        s_brk.fd = -1;
+        if (!clean && s_brk.will.will) {
+            s_brk.will.at_ns = host_now_ns();
+            brk_store(&s_brk.will);
+        }
+        pthread_cond_broadcast(&s_brk.cv);
+        pthread_mutex_unlock(&s_brk.m);
+        close(fd);
+    }
+    return NULL;
+}
+
+static int brk_start(void)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    socklen_t          alen = sizeof(addr);
+
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    s_brk.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    bind(s_brk.listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+    listen(s_brk.listen_fd, 4);
+    getsockname(s_brk.listen_fd, (struct sockaddr *)&addr, &alen);
+
+    pthread_t t;
+    pthread_create(&t, NULL, brk_thread, NULL);
+    pthread_detach(t);
+    return ntohs(addr.sin_port);
+}
+
+/** Deliver a command to the client as the broker would (QoS 1). */
+static void brk_inject(const char *name, const char *payload)
+{
+    static uint16_t id = 0;
+    uint8_t         b[256];
+    const size_t    tl = strlen(TOPIC_CMD) + strlen(name);
+    const size_t    pl = strlen(payload);
+    size_t          n  = 0;
+
+    b[n++] = (uint8_t)(tl >> 8);
+    b[n++] = (uint8_t)tl;
+    memcpy(b + n, TOPIC_CMD, strlen(TOPIC_CMD));
+    n += strlen(TOPIC_CMD);
+    memcpy(b + n, name, strlen(name));
+    n += strlen(name);
+    id++;
+    b[n++] = (uint8_t)(id >> 8);
+    b[n++] = (uint8_t)id;
+    memcpy(b + n, payload, pl);
+    n += pl;
+
+    pthread_mutex_lock(&s_brk.m);
+    const int fd = s_brk.fd;
+    pthread_mutex_unlock(&s_brk.m);
+    brk_send(fd, 0x32, b, n);
+}
+
+/** Drop the client as a network failure would; optionally lose retained state. */
+static void brk_drop(bool lose_state)
+{
+    pthread_mutex_lock(&s_brk.m);
+    if (lose_state) {
+        for (int i = 0; i < BRK_MAX_RETAIN; i++) {
+            if (strcmp(s_brk.retained[i].topic, TOPIC_STATE) == 0) {
+                memset(&s_brk.retained[i], 0, sizeof(s_brk.retained[i]));
+            }
+        }
+    }
+    const int fd = s_brk.fd;
+    pthread_mutex_unlock(&s_brk.m);
+    shutdown(fd, SHUT_RDWR);
+}
+
+/** Messages on @p topic from index @p from on; s_brk.m held. */
+static uint32_t brk_count(const char *topic, uint32_t from)
+{
+    uint32_t n = 0;
+    for (uint32_t i = from; i < s_brk.nmsg; i++) {
+        n += strcmp(s_brk.msg[i].topic, topic) == 0;
+    }
+    return n;
+}
+
+/** Index of the @p k-th message (0-based) on @p topic from @p from; s_brk.m held. */
+static const brk_msg_t *brk_nth(const char *topic, uint32_t from, uint32_t k)
+{
+    for (uint32_t i = from; i < s_brk.nmsg; i++) {
+        if (strcmp(s_brk.msg[i].topic, topic) == 0 && k-- == 0) {
+            return &s_brk.msg[i];
+        }
+    }
+    return NULL;
+}
+
+static const brk_msg_t *brk_retained(const char *topic)
+{
+    for (int i = 0; i < BRK_MAX_RETAIN; i++) {
+        if (strcmp(s_brk.retained[i].topic, topic) == 0) {
+            return &s_brk.retained[i];
+        }
+    }
+    return NULL;
+}
+
+/** Wait until @p topic has @p n messages from @p from on; false on timeout. */
+static bool brk_wait(const char *topic, uint32_t from, uint32_t n, uint32_t timeout_ms)
+{
+    struct timespec dl;
+    clock_gettime(CLOCK_REALTIME, &dl);
+    dl.tv_sec  += timeout_ms / 1000u;
+    dl.tv_nsec += (long)(timeout_ms % 1000u) * 1000000L;
+    if (dl.tv_nsec >= 1000000000L) {
+        dl.tv_sec++;
+        dl.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&s_brk.m);
+    int rc = 0;
+    while (brk_count(topic, from) < n && rc == 0) {
+        rc = pthread_cond_timedwait(&s_brk.cv, &s_brk.m, &dl);
+    }
+    const bool ok = brk_count(topic, from) >= n;
+    pthread_mutex_unlock(&s_brk.m);
+    return ok;
+}
+
+static uint32_t brk_mark(void)
+{
+    pthread_mutex_lock(&s_brk.m);
+    const uint32_t n = s_brk.nmsg;
+    pthread_mutex_unlock(&s_brk.m);
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+#define STATE_RING_DEPTH 64
+
+static uint8_t s_ring_state[MSGBUS_RING_BYTES(sizeof(thermostat_state_t), STATE_RING_DEPTH)]
+    __attribute__((aligned(8)));
+
+static thermostat_state_t s_last;
+
+static void publish_state(thermostat_output_t output, float setpoint_c)
+{
+    static float t = 20.0f;
+
+    s_last = (thermostat_state_t){
+        .mode         = THERMOSTAT_MODE_HEAT,
+        .output       = output,
+        .setpoint_c   = setpoint_c,
+        .hysteresis_c = 0.5f,
+        .tin_c        = t,
+        .tout_c       = 4.2f,
+        .timestamp_us = monotime_now_us(),
+    };
+    t += 0.01f;
+    msgbus_publish(MSGBUS_TOPIC_THERMOSTAT_STATE, &s_last);
+}
+
+static mqtt_stats_t stats(void)
+{
+    mqtt_stats_t st;
+    task_mqtt_get_stats(&st);
+    return st;
+}
+
+static bool payload_is_state(const brk_msg_t *m, const thermostat_state_t *st)
+{
+    char   json[128];
+    size_t len = telemetry_encode_state_json(st, json, sizeof(json));
+    return m != NULL && m->len == len && memcmp(m->payload, json, len) == 0;
+}
+
+static uint64_t varint(const uint8_t **p, const uint8_t *end)
+{
+    uint64_t v = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        const uint8_t b = *(*p)++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+    }
+    return v;
+}
+
+/** Samples (field 7) in a protobuf Batch; -1 if it does not parse. */
+static int pb_samples(const uint8_t *buf, size_t len)
+{
+    const uint8_t *p   = buf;
+    const uint8_t *end = buf + len;
+    int            n   = 0;
+
+    while (p < end) {
+        const uint64_t tag = varint(&p, end);
+        const uint64_t v   = varint(&p, end);
+        if ((tag & 7) == 2) {
+            if (v > (uint64_t)(end - p)) {
+                return -1;
+            }
+            n += (tag >> 3) == 7;
+            p += v;
+        }
+    }
+    return n;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_session_setup(void)
+{
+    pthread_mutex_lock(&s_brk.m);
+    CHECK_EQ_INT(s_brk.sessions, 1);
+    CHECK_EQ_STR(s_brk.client_id, TELEMETRY_DEVICE_ID);
+    CHECK_EQ_STR(s_brk.sub, TOPIC_CMD "+");
+    CHECK_EQ_STR(s_brk.will.topic, TOPIC_STATUS);
+    CHECK(s_brk.will.retain);
+    CHECK(s_brk.will.len == 7 && memcmp(s_brk.will.payload, "offline", 7) == 0);
+
+    const brk_msg_t *st = brk_retained(TOPIC_STATUS);
+    CHECK(st != NULL && st->len == 6 && memcmp(st->payload, "online", 6) == 0);
+    pthread_mutex_unlock(&s_brk.m);
+}
+
+static void test_samples_batched(void)
+{
+    const uint32_t     from = brk_mark();
+    const mqtt_stats_t s0   = stats();
+    const int          n    = 2 * MQTT_SAMPLE_BATCH + 5;
+
+    uint64_t tail_ns = 0;
+    for (int i = 0; i < n; i++) {
+        if (i == 2 * MQTT_SAMPLE_BATCH) {
+            tail_ns = host_now_ns();
+        }
+        publish_state(THERMOSTAT_OUTPUT_OFF, 21.5f);
+        vTaskDelay(1);
+    }
+
+    // Two full batches right away, the remainder after the flush interval.
+    CHECK(brk_wait(TOPIC_SAMPLES, from, 2, 2000));
+    CHECK_EQ_INT(brk_count(TOPIC_SAMPLES, from), 2);
+    CHECK(brk_wait(TOPIC_SAMPLES, from, 3, MQTT_SAMPLE_FLUSH_MS + 3000));
+
+    pthread_mutex_lock(&s_brk.m);
+    size_t bytes = 0;
+    for (uint32_t k = 0; k < 3; k++) {
+        const brk_msg_t *m = brk_nth(TOPIC_SAMPLES, from, k);
+        CHECK(m != NULL);
+        if (m == NULL) {
+            continue;
+        }
+        CHECK_EQ_INT(m->qos, 0);
+        CHECK(!m->retain);
+        CHECK_EQ_INT(pb_samples(m->payload, m->len), k < 2 ? MQTT_SAMPLE_BATCH : 5);
+        bytes += m->len;
+    }
+    const brk_msg_t *tail = brk_nth(TOPIC_SAMPLES, from, 2);
+    const uint64_t   wait_ms = (tail != NULL) ? (tail->at_ns - tail_ns) / 1000000u : 0;
+    pthread_mutex_unlock(&s_brk.m);
+
+    const mqtt_stats_t s1 = stats();
+    CHECK_EQ_INT(s1.batches_published - s0.batches_published, 3);
+    CHECK_EQ_INT(s1.samples_published - s0.samples_published, n);
+    CHECK_EQ_INT(s1.samples_dropped - s0.samples_dropped, 0);
+
+    // One message per sample would repeat the batch header every time.
+    telemetry_record_t rec;
+    uint8_t            one[128];
+    telemetry_record_from_state(&s_last, time(NULL), 0, &rec);
+    const size_t single = telemetry_encode_pb(TELEMETRY_DEVICE_ID, &rec, 1, one, sizeof(one));
+    const size_t topic  = 2 + strlen(TOPIC_SAMPLES) + 2;    // topic + fixed header
+
+    printf("  %d samples: 3 messages, %.1f bytes/sample (one message per sample: %zu); "
+           "partial batch after %u ms\n",
+           n, (double)(bytes + 3 * topic) / n, single + topic, (unsigned)wait_ms);
+    CHECK(wait_ms + 10 >= MQTT_SAMPLE_FLUSH_MS);
+    CHECK(wait_ms <= MQTT_SAMPLE_FLUSH_MS + 1500);
+}
+
+static void test_state_retained_and_deduped(void)
+{
+    uint32_t from = brk_mark();
+
+    // Temperatures alone never republish the retained state.
+    for (int i = 0; i < 30; i++) {
+        publish_state(THERMOSTAT_OUTPUT_OFF, 21.5f);
+        vTaskDelay(1);
+    }
+    vTaskDelay(2 * MQTT_STATE_MIN_INTERVAL_MS);
+    CHECK_EQ_INT(brk_count(TOPIC_STATE, from), 0);
+
+    // A burst of changes: the first goes out at once, then only the newest
+    // one, no earlier than the rate limit allows.
+    from = brk_mark();
+    const uint64_t t0 = host_now_ns();
+    publish_state(THERMOSTAT_OUTPUT_HEAT_ON, 21.5f);
+    thermostat_state_t first = s_last;
+    publish_state(THERMOSTAT_OUTPUT_OFF, 21.5f);
+    publish_state(THERMOSTAT_OUTPUT_HEAT_ON, 21.5f);
+    publish_state(THERMOSTAT_OUTPUT_OFF, 21.5f);
+    publish_state(THERMOSTAT_OUTPUT_OFF, 22.0f);
+
+    CHECK(brk_wait(TOPIC_STATE, from, 2, 2000));
+    vTaskDelay(2 * MQTT_STATE_MIN_INTERVAL_MS);
+
+    pthread_mutex_lock(&s_brk.m);
+    CHECK_EQ_INT(brk_count(TOPIC_STATE, from), 2);
+    const brk_msg_t *a = brk_nth(TOPIC_STATE, from, 0);
+    const brk_msg_t *b = brk_nth(TOPIC_STATE, from, 1);
+    CHECK(payload_is_state(a, &first));
+    CHECK(payload_is_state(b, &s_last));
+    CHECK(payload_is_state(brk_retained(TOPIC_STATE), &s_last));
+    uint64_t first_ms = 0, gap_ms = 0;
+    if (a != NULL && b != NULL) {
+        CHECK(a->retain && b->retain);
+        CHECK_EQ_INT(a->qos, 1);
+        first_ms = (a->at_ns - t0) / 1000000u;
+        gap_ms   = (b->at_ns - a->at_ns) / 1000000u;
+    }
+    pthread_mutex_unlock(&s_brk.m);
+
+    printf("  5 changes in a burst: 2 retained publishes, first after %u ms, "
+           "newest %u ms later (window %u ms)\n",
+           (unsigned)first_ms, (unsigned)gap_ms, (unsigned)MQTT_STATE_MIN_INTERVAL_MS);
+    CHECK(first_ms < 50);
+    CHECK(gap_ms + 2 >= MQTT_STATE_MIN_INTERVAL_MS);
+}
+
+static void test_command_kicks_control(void)
+{
+    enum { ROUNDS = 200 };
+    static uint64_t lat_ns[ROUNDS];
+    const mqtt_stats_t s0 = stats();
+
+    for (int i = 0; i < ROUNDS; i++) {
+        const char *sp = (i & 1) ? "22.5" : "20.5";
+
+        pthread_mutex_lock(&s_kick.m);
+        const uint32_t before = s_kick.count;
+        pthread_mutex_unlock(&s_kick.m);
+
+        const uint64_t t0 = host_now_ns();
+        brk_inject("setpoint", sp);
+
+        pthread_mutex_lock(&s_kick.m);
+        while (s_kick.count == before) {
+            pthread_cond_wait(&s_kick.cv, &s_kick.m);
+        }
+        lat_ns[i] = s_kick.last_ns - t0;
+        pthread_mutex_unlock(&s_kick.m);
+
+        thermostat_config_t cfg;
+        thermostat_config_get(&cfg);
+        CHECK(cfg.setpoint_c == strtof(sp, NULL));
+    }
+
+    // Rejected commands do not kick.
+    pthread_mutex_lock(&s_kick.m);
+    const uint32_t kicks = s_kick.count;
+    pthread_mutex_unlock(&s_kick.m);
+    brk_inject("setpoint", "warm");
+    brk_inject("fan", "on");
+    for (int t = 0; t < 1000 && stats().commands_rejected < s0.commands_rejected + 2; t += 5) {
+        vTaskDelay(5);
+    }
+    CHECK_EQ_INT(stats().commands_rejected - s0.commands_rejected, 2);
+    CHECK_EQ_INT(stats().commands - s0.commands, ROUNDS);
+    CHECK_EQ_INT(s_kick.count, kicks);
+
+    qsort(lat_ns, ROUNDS, sizeof(lat_ns[0]), cmp_u64);
+    const double p50 = lat_ns[ROUNDS / 2] / 1e6;
+    const double p99 = lat_ns[ROUNDS * 99 / 100] / 1e6;
+    const double max = lat_ns[ROUNDS - 1] / 1e6;
+    printf("  command -> task_control_kick: p50 %.3f ms, p99 %.3f ms, max %.3f ms "
+           "(next sensor sample: up to %u ms)\n",
+           p50, p99, max, (unsigned)PERIOD_SENSORS_MAX_MS);
+    CHECK(p50 < 5.0);
+    CHECK(max < PERIOD_SENSORS_MIN_MS);
+}
+
+static void test_reconnect_resyncs_state(void)
+{
+    const uint32_t from = brk_mark();
+
+    // The broker restarts without its retained state.
+    brk_drop(true);
+    CHECK(brk_wait(TOPIC_STATUS, from, 2, 3000));   // will, then "online"
+    CHECK(brk_wait(TOPIC_STATE, from, 1, 3000));
+
+    pthread_mutex_lock(&s_brk.m);
+    CHECK_EQ_INT(s_brk.sessions, 2);
+    const brk_msg_t *will   = brk_nth(TOPIC_STATUS, from, 0);
+    const brk_msg_t *online = brk_nth(TOPIC_STATUS, from, 1);
+    CHECK(will != NULL && will->will);
+    CHECK(online != NULL && !online->will && online->len == 6 &&
+          memcmp(online->payload, "online", 6) == 0);
+    CHECK(payload_is_state(brk_retained(TOPIC_STATE), &s_last));
+    pthread_mutex_unlock(&s_brk.m);
+    CHECK_EQ_INT(stats().connects, 2);
+
+    // The new session is subscribed: a mode command reaches the core.
+    pthread_mutex_lock(&s_kick.m);
+    const uint32_t before = s_kick.count;
+    pthread_mutex_unlock(&s_kick.m);
+    brk_inject("mode", "cool");
+    pthread_mutex_lock(&s_kick.m);
+    while (s_kick.count == before) {
+        pthread_cond_wait(&s_kick.cv, &s_kick.m);
+    }
+    pthread_mutex_unlock(&s_kick.m);
+
+    thermostat_mode_t mode;
+    CHECK(thermostat_get_mode(&mode) == ERR_OK);
+    CHECK_EQ_INT(mode, THERMOSTAT_MODE_COOL);
+}
+
+static void *mqtt_thread(void *arg)
+{
+    task_mqtt(arg);
+    return NULL;
+}
+
+int main(void)
+{
+    msgbus_topic_init(MSGBUS_TOPIC_THERMOSTAT_STATE, s_ring_state,
+                      sizeof(thermostat_state_t), STATE_RING_DEPTH);
+    thermostat_core_init();
+    host_mqtt_client_redirect(brk_start());
+
+    pthread_t task;
+    pthread_create(&task, NULL, mqtt_thread, NULL);
+
+    msgbus_topic_stats_t ts = { 0 };
+    while (ts.subscribers == 0) {
+        vTaskDelay(1);
+        msgbus_get_topic_stats(MSGBUS_TOPIC_THERMOSTAT_STATE, &ts);
+    }
+    brk_wait(TOPIC_STATUS, 0, 1, 3000);
+
+    RUN_TEST(test_session_setup);
+    RUN_TEST(test_samples_batched);
+    RUN_TEST(test_state_retained_and_deduped);
+    RUN_TEST(test_command_kicks_control);
+    RUN_TEST(test_reconnect_resyncs_state);
+
+    // The task never returns; exiting main ends it.
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,142 @@
+/**
+ * Host test for the integer-only formatters (numfmt.c, json_fixed()).
+ *
+ * The LCD frame and the JSON documents used to come from snprintf
+ * ("%2.1f", "%2.0f", "%.2f"); the replacements must print the same
+ * digits, including printf's ties-to-even on exact halves.
+ */
+
+#include "host_test.h"
+
+#include "core/json_writer.h"
+#include "core/numfmt.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+static void fixed1(char *buf, float v)
+{
+    char *p = numfmt_fixed1(buf, buf + 23, v, 0);
+    *p = '\0';
+}
+
+static int sink_append(void *ctx, const char *data, size_t len)
+{
+    strncat((char *)ctx, data, len);
+    return 0;
+}
+
+static void json_fixed_str(char *out, float v, uint8_t decimals)
+{
+    char          buf[32];
+    json_writer_t w;
+
+    out[0] = '\0';
+    json_writer_init(&w, buf, sizeof(buf), sink_append, out);
+    json_fixed(&w, v, decimals);
+    json_writer_finish(&w);
+}
+
+static void test_round_scaled_ties_to_even(void)
+{
+    CHECK_EQ_INT(numfmt_round_scaled(22.5f, 1u), 22);
+    CHECK_EQ_INT(numfmt_round_scaled(23.5f, 1u), 24);
+    CHECK_EQ_INT(numfmt_round_scaled(22.49f, 1u), 22);
+    CHECK_EQ_INT(numfmt_round_scaled(22.51f, 1u), 23);
+    CHECK_EQ_INT(numfmt_round_scaled(0.25f, 10u), 2);
+    CHECK_EQ_INT(numfmt_round_scaled(0.75f, 10u), 8);
+    CHECK_EQ_INT(numfmt_round_scaled(-0.75f, 10u), 8);
+    CHECK_EQ_INT(numfmt_round_scaled(0.0f, 10u), 0);
+    CHECK_EQ_INT(numfmt_round_scaled(1e-40f, 1000u), 0);
+    CHECK_EQ_INT(numfmt_round_scaled(NAN, 10u), 0);
+    CHECK_EQ_INT(numfmt_round_scaled(INFINITY, 10u), UINT32_MAX);
+    CHECK_EQ_INT(numfmt_round_scaled(1e12f, 10u), UINT32_MAX);
+    CHECK_EQ_INT(numfmt_round_scaled(16777216.0f, 100u), 1677721600u);
+}
+
+static void test_centi_saturates(void)
+{
+    CHECK_EQ_INT(numfmt_centi(21.25f), 2125);
+    CHECK_EQ_INT(numfmt_centi(-3.05f), -305);
+    CHECK_EQ_INT(numfmt_centi(0.004f), 0);
+    CHECK_EQ_INT(numfmt_centi(-0.004f), 0);
+    CHECK_EQ_INT(numfmt_centi(327.67f), 32767);
+    CHECK_EQ_INT(numfmt_centi(-327.68f), -32768);
+    CHECK_EQ_INT(numfmt_centi(400.0f), INT16_MAX);
+    CHECK_EQ_INT(numfmt_centi(-400.0f), INT16_MIN);
+    CHECK_EQ_INT(numfmt_centi(1e30f), INT16_MAX);
+    CHECK_EQ_INT(numfmt_centi(INFINITY), INT16_MAX);
+    CHECK_EQ_INT(numfmt_centi(-INFINITY), INT16_MIN);
+    CHECK_EQ_INT(numfmt_centi(NAN), INT16_MIN);
+    CHECK_EQ_INT(numfmt_centi(-NAN), INT16_MIN);
+}
+
+static void test_fixed1_matches_printf(void)
+{
+    char     got[24];
+    char     want[24];
+    uint32_t rng        = 1u;
+    int      mismatches = 0;
+
+    // Every exact quarter in the sensor range, then random floats.
+    for (int i = -400; i <= 2000 && mismatches < 5; i++) {
+        const float v = (float)i * 0.25f;
+        fixed1(got, v);
+        snprintf(want, sizeof(want), "%.1f", (double)v);
+        if (strcmp(got, want) != 0 && strcmp(want, "-0.0") != 0) {
+            CHECK_EQ_STR(got, want);
+            mismatches++;
+        }
+    }
+    for (int i = 0; i < 200000 && mismatches < 5; i++) {
+        rng = rng * 1103515245u + 12345u;
+        const float v = ((float)(rng >> 8) / 16777216.0f) * 140.0f - 40.0f;
+        fixed1(got, v);
+        snprintf(want, sizeof(want), "%.1f", (double)v);
+        if (strcmp(got, want) != 0 && strcmp(want, "-0.0") != 0) {
+            CHECK_EQ_STR(got, want);
+            mismatches++;
+        }
+    }
+    CHECK_EQ_INT(mismatches, 0);
+
+    // printf says "-0.0"; the LCD never did.
+    fixed1(got, -0.04f);
+    CHECK_EQ_STR(got, "0.0");
+}
+
+static void test_json_fixed_matches_printf(void)
+{
+    char     got[32];
+    char     want[32];
+    uint32_t rng        = 2u;
+    int      mismatches = 0;
+
+    for (int i = 0; i < 100000 && mismatches < 5; i++) {
+        rng = rng * 1103515245u + 12345u;
+        const float   v = ((float)(rng >> 8) / 16777216.0f) * 200.0f - 100.0f;
+        const uint8_t d = (uint8_t)(i % 4);
+        json_fixed_str(got, v, d);
+        snprintf(want, sizeof(want), "%.*f", d, (double)v);
+        // printf keeps the sign of a negative value that rounds to zero.
+        if (strcmp(got, want) != 0 && !(want[0] == '-' && atof(want) == 0.0)) {
+            CHECK_EQ_STR(got, want);
+            mismatches++;
+        }
+    }
+    CHECK_EQ_INT(mismatches, 0);
+
+    json_fixed_str(got, 22.125f, 2);
+    CHECK_EQ_STR(got, "22.12");
+    json_fixed_str(got, 22.375f, 2);
+    CHECK_EQ_STR(got, "22.38");
+}
+
+int main(void)
+{
+    RUN_TEST(test_round_scaled_ties_to_even);
+    RUN_TEST(test_centi_saturates);
+    RUN_TEST(test_fixed1_matches_printf);
+    RUN_TEST(test_json_fixed_matches_printf);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,172 @@
+/**
+ * Host simulation for the adaptive sampling scheduler (sample_scheduler.c).
+ *
+ * A first-order room model (heat loss to outside, heater gain) is run
+ * under a bang-bang heat controller with the default setpoint and
+ * hysteresis. The controller only sees the temperature when the sensor
+ * is sampled, once with the fixed PERIOD_SENSORS_MS and once with the
+ * adaptive scheduler. For each run we count samples and measure the
+ * switching delay: time from the true band-edge crossing to the sample
+ * that switches the heater.
+ */
+
+#include "host_test.h"
+
+#include "core/config.h"
+#include "core/sample_scheduler.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define SIM_STEP_MS        10u
+#define SIM_DURATION_MS    (4u * 3600u * 1000u)
+
+// Room: tau ~ 2 h towards outside, heater adds ~1.5 C per 10 min.
+#define ROOM_LOSS_PER_S    (1.0f / 7200.0f)
+#define ROOM_HEAT_C_PER_S  (1.5f / 600.0f)
+
+typedef struct {
+    uint32_t samples;
+    uint32_t switches;
+    uint32_t delay_max_ms;
+    uint64_t delay_sum_ms;
+    float    t_min_c;
+    float    t_max_c;
+} sim_result_t;
+
+static float outside_c(uint32_t t_ms)
+{
+    // Cold morning warming up, with a sunny stretch that parks the room
+    // above the band (heater idle, far from both edges).
+    const float h = (float)t_ms / 3600000.0f;
+    if (h >= 1.5f && h < 3.0f) {
+        return 30.0f;
+    }
+    return 5.0f + 2.0f * h;
+}
+
+static sim_result_t simulate(bool adaptive)
+{
+    const float sp   = THERMOSTAT_SETPOINT_C;
+    const float hyst = THERMOSTAT_HYSTERESIS_C;
+
+    sample_scheduler_t sched;
+    sample_scheduler_init(&sched, PERIOD_SENSORS_MIN_MS, PERIOD_SENSORS_MAX_MS);
+
+    sim_result_t r = { .t_min_c = 1e9f, .t_max_c = -1e9f };
+
+    float    t_room     = sp;
+    bool     heat_on    = false;
+    uint32_t next_ms    = 0;
+    int64_t  crossed_ms = -1;   // true crossing not yet seen by a sample
+
+    for (uint32_t t = 0; t < SIM_DURATION_MS; t += SIM_STEP_MS) {
+        const float dt_s = SIM_STEP_MS / 1000.0f;
+        t_room += dt_s * (ROOM_LOSS_PER_S * (outside_c(t) - t_room) +
+                          (heat_on ? ROOM_HEAT_C_PER_S : 0.0f));
+
+        // The edge the current heater state is waiting for.
+        const bool past_edge = heat_on ? (t_room >= sp + hyst)
+                                       : (t_room <= sp - hyst);
+        if (past_edge && crossed_ms < 0) {
+            crossed_ms = t;
+        }
+
+        if (t >= 600000u) {     // ignore the start-up transient
+            r.t_min_c = fminf(r.t_min_c, t_room);
+            r.t_max_c = fmaxf(r.t_max_c, t_room);
+        }
+
+        if (t < next_ms) {
+            continue;
+        }
+
+        // Sensor sample + control decision.
+        r.samples++;
+        if (past_edge) {
+            heat_on = !heat_on;
+            r.switches++;
+            const uint32_t delay = t - (uint32_t)crossed_ms;
+            r.delay_sum_ms += delay;
+            if (delay > r.delay_max_ms) {
+                r.delay_max_ms = delay;
+            }
+            crossed_ms = -1;
+        }
+
+        uint32_t period = PERIOD_SENSORS_MS;
+        if (adaptive) {
+            const sensor_sample_t s = {
+                .temp_inside_c  = t_room,
+                .temp_outside_c = outside_c(t),
+                .timestamp_us   = (uint64_t)t * 1000u,
+            };
+            period = sample_scheduler_next_period(&sched, &s, sp, hyst);
+        }
+        next_ms = t + period;
+    }
+    return r;
+}
+
+static void print_result(const char *name, const sim_result_t *r)
+{
+    printf("  %-8s samples=%6u switches=%3u delay avg=%4u ms max=%4u ms "
+           "room %.2f..%.2f C\n",
+           name, (unsigned)r->samples, (unsigned)r->switches,
+           (unsigned)(r->switches ? r->delay_sum_ms / r->switches : 0),
+           (unsigned)r->delay_max_ms, r->t_min_c, r->t_max_c);
+}
+
+static void test_adaptive_vs_fixed(void)
+{
+    const sim_result_t fixed    = simulate(false);
+    const sim_result_t adaptive = simulate(true);
+
+    print_result("fixed", &fixed);
+    print_result("adaptive", &adaptive);
+
+    // Same control behaviour...
+    CHECK(adaptive.switches > 0);
+    CHECK(abs((int)adaptive.switches - (int)fixed.switches) <= 1);
+    // ...with far fewer samples...
+    CHECK(adaptive.samples * 2u < fixed.samples);
+    // ...and switching no later than with the fixed rate (near an edge
+    // the adaptive period is at most the fixed one).
+    CHECK(adaptive.delay_max_ms <= PERIOD_SENSORS_MS);
+    CHECK(adaptive.delay_max_ms <= fixed.delay_max_ms);
+}
+
+static void test_bounds(void)
+{
+    sample_scheduler_t s;
+    sample_scheduler_init(&s, PERIOD_SENSORS_MIN_MS, PERIOD_SENSORS_MAX_MS);
+
+    // Far from the band and steady: backs off gradually up to max.
+    uint32_t prev = 0;
+    for (int i = 0; i < 20; i++) {
+        const sensor_sample_t smp = {
+            .temp_inside_c = 30.0f,
+            .timestamp_us  = (uint64_t)i * 5000000u,
+        };
+        const uint32_t p = sample_scheduler_next_period(&s, &smp, 22.0f, 0.5f);
+        CHECK(p >= PERIOD_SENSORS_MIN_MS && p <= PERIOD_SENSORS_MAX_MS);
+        CHECK(prev == 0 || p <= prev * 2u);
+        prev = p;
+    }
+    CHECK_EQ_INT(prev, PERIOD_SENSORS_MAX_MS);
+
+    // On a band edge: straight back to min.
+    const sensor_sample_t edge = {
+        .temp_inside_c = 22.5f,
+        .timestamp_us  = 200000000u,
+    };
+    CHECK_EQ_INT(sample_scheduler_next_period(&s, &edge, 22.0f, 0.5f),
+                 PERIOD_SENSORS_MIN_MS);
+}
+
+int main(void)
+{
+    RUN_TEST(test_bounds);
+    RUN_TEST(test_adaptive_vs_fixed);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,269 @@
+/**
+ * Host test for the flash spool (spool.c) on a file-backed flash stand-in.
+ *
+ * The region is a temporary file that behaves like NOR flash: erase sets
+ * a sector to 0xFF, writes can only clear bits. A power cut is simulated
+ * by letting the next write land only partly; the test then "reboots" by
+ * calling spool_open() again with the acknowledged sequence number the
+ * owner would have persisted.
+ */
+
+#include "host_test.h"
+
+#include "core/spool.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#define FLASH_SECTOR    256u
+#define FLASH_SECTORS   4u
+#define PAYLOAD_LEN     16u         // 28-byte frames, 9 per sector
+#define PER_SECTOR      (FLASH_SECTOR / (12u + PAYLOAD_LEN))
+
+// ---------------------------------------------------------------------------
+// File-backed NOR flash
+// ---------------------------------------------------------------------------
+
+static struct {
+    int    fd;
+    size_t tear_at;     // if non-zero, the next write stops after this many bytes
+    bool   dead;        // power is off: further writes are ignored
+} s_nor;
+
+static int nor_read(void *ctx, size_t off, void *buf, size_t len)
+{
+    return (pread(s_nor.fd, buf, len, (off_t)off) == (ssize_t)len) ? 0 : -1;
+}
+
+static int nor_write(void *ctx, size_t off, const void *buf, size_t len)
+{
+    uint8_t old[FLASH_SECTOR];
+    const uint8_t *src = (const uint8_t *)buf;
+
+    if (s_nor.dead || len > sizeof(old) || nor_read(ctx, off, old, len) != 0) {
+        return -1;
+    }
+    if (s_nor.tear_at != 0) {
+        len          = s_nor.tear_at;
+        s_nor.dead   = true;
+    }
+    for (size_t i = 0; i < len; i++) {
+        old[i] &= src[i];
+    }
+    return (pwrite(s_nor.fd, old, len, (off_t)off) == (ssize_t)len) ? 0 : -1;
+}
+
+static int nor_erase(void *ctx, size_t off)
+{
+    uint8_t ff[FLASH_SECTOR];
+
+    if (s_nor.dead) {
+        return -1;
+    }
+    memset(ff, 0xFF, sizeof(ff));
+    return (pwrite(s_nor.fd, ff, sizeof(ff), (off_t)off) == (ssize_t)sizeof(ff)) ? 0 : -1;
+}
+
+static const spool_flash_t s_flash = {
+    .size         = FLASH_SECTOR * FLASH_SECTORS,
+    .sector_size  = FLASH_SECTOR,
+    .read         = nor_read,
+    .write        = nor_write,
+    .erase_sector = nor_erase,
+};
+
+/** Fresh, fully erased region. */
+static void nor_reset(void)
+{
+    char path[] = "/tmp/spool-test-XXXXXX";
+
+    if (s_nor.fd > 0) {
+        close(s_nor.fd);
+    }
+    memset(&s_nor, 0, sizeof(s_nor));
+    s_nor.fd = mkstemp(path);
+    unlink(path);
+    for (size_t off = 0; off < s_flash.size; off += FLASH_SECTOR) {
+        nor_erase(NULL, off);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static bool append_n(spool_t *sp, uint32_t first, uint32_t n)
+{
+    for (uint32_t i = first; i < first + n; i++) {
+        uint8_t p[PAYLOAD_LEN];
+        memset(p, (int)(i & 0xFF), sizeof(p));
+        memcpy(p, &i, sizeof(i));
+        if (spool_append(sp, p, sizeof(p)) != ERR_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Replay up to @p max records, checking each payload is intact and
+ *        the indices are consecutive.
+ *
+ * @return Number of records read; *first is the index of the first one.
+ */
+static uint32_t replay(spool_t *sp, spool_iter_t *it, uint32_t max, uint32_t *first)
+{
+    uint8_t  buf[SPOOL_MAX_PAYLOAD];
+    size_t   len;
+    uint32_t n = 0, idx = 0;
+
+    spool_iter_begin(sp, it);
+    while (n < max && spool_read_next(sp, it, buf, &len)) {
+        uint32_t i;
+        CHECK_EQ_INT(len, PAYLOAD_LEN);
+        memcpy(&i, buf, sizeof(i));
+        CHECK_EQ_INT(buf[PAYLOAD_LEN - 1], i & 0xFF);
+        if (n == 0) {
+            *first = i;
+        } else {
+            CHECK_EQ_INT(i, idx + 1);
+        }
+        idx = i;
+        n++;
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_reopen_after_ack(void)
+{
+    spool_t      sp;
+    spool_iter_t it;
+    uint32_t     first = 0;
+
+    nor_reset();
+    CHECK_EQ_INT(spool_open(&sp, &s_flash, 0), ERR_OK);
+    CHECK_EQ_INT(spool_pending(&sp), 0);
+    CHECK(append_n(&sp, 0, 5));
+    CHECK_EQ_INT(spool_pending(&sp), 5);
+
+    CHECK_EQ_INT(replay(&sp, &it, 3, &first), 3);
+    CHECK_EQ_INT(first, 0);
+    spool_ack(&sp, &it);
+    const uint32_t ack = spool_ack_seq(&sp);
+    CHECK_EQ_INT(spool_pending(&sp), 2);
+
+    // Reboot with the persisted ack: only the tail is pending, and new
+    // records carry on after it.
+    CHECK_EQ_INT(spool_open(&sp, &s_flash, ack), ERR_OK);
+    CHECK_EQ_INT(spool_pending(&sp), 2);
+    CHECK(append_n(&sp, 5, 2));
+    CHECK_EQ_INT(replay(&sp, &it, 100, &first), 4);
+    CHECK_EQ_INT(first, 3);
+    spool_ack(&sp, &it);
+    CHECK_EQ_INT(spool_pending(&sp), 0);
+
+    CHECK_EQ_INT(spool_open(&sp, &s_flash, spool_ack_seq(&sp)), ERR_OK);
+    CHECK_EQ_INT(spool_pending(&sp), 0);
+    CHECK_EQ_INT(sp.stats.lost, 0);
+}
+
+static void test_torn_append(void)
+{
+    static const size_t tears[] = { 2, 6, 10, 14, 20 };
+
+    for (size_t k = 0; k < sizeof(tears) / sizeof(tears[0]); k++) {
+        spool_t      sp;
+        spool_iter_t it;
+        uint32_t     first = 0;
+
+        nor_reset();
+        spool_open(&sp, &s_flash, 0);
+        CHECK(append_n(&sp, 0, 3));
+
+        // Power fails part-way through the fourth frame.
+        s_nor.tear_at = tears[k];
+        append_n(&sp, 3, 1);
+        s_nor.tear_at = 0;
+        s_nor.dead    = false;
+
+        CHECK_EQ_INT(spool_open(&sp, &s_flash, 0), ERR_OK);
+        CHECK_EQ_INT(sp.stats.crc_errors, 1);
+        CHECK_EQ_INT(spool_pending(&sp), 3);
+        // Never write behind the torn frame.
+        CHECK_EQ_INT(sp.write_off, FLASH_SECTOR);
+
+        CHECK(append_n(&sp, 3, 2));
+        CHECK_EQ_INT(replay(&sp, &it, 100, &first), 5);
+        CHECK_EQ_INT(first, 0);
+        spool_ack(&sp, &it);
+        CHECK_EQ_INT(spool_pending(&sp), 0);
+    }
+}
+
+static void test_wrap_around_loss(void)
+{
+    const uint32_t capacity = PER_SECTOR * FLASH_SECTORS;
+    const uint32_t total    = capacity + 14u;     // spills into two sectors
+    spool_t        sp;
+    spool_iter_t   it;
+    uint32_t       first = 0;
+
+    nor_reset();
+    spool_open(&sp, &s_flash, 0);
+    CHECK(append_n(&sp, 0, total));
+
+    // Each wrap erases the oldest sector, whole.
+    CHECK_EQ_INT(sp.stats.lost, 2 * PER_SECTOR);
+    CHECK_EQ_INT(spool_pending(&sp) + sp.stats.lost, total);
+
+    CHECK_EQ_INT(replay(&sp, &it, 100, &first), total - 2 * PER_SECTOR);
+    CHECK_EQ_INT(first, 2 * PER_SECTOR);
+
+    // The loss is also visible after a reboot with nothing acknowledged.
+    CHECK_EQ_INT(spool_open(&sp, &s_flash, 0), ERR_OK);
+    CHECK_EQ_INT(sp.stats.lost, 2 * PER_SECTOR);
+    CHECK_EQ_INT(spool_pending(&sp), total - 2 * PER_SECTOR);
+    CHECK_EQ_INT(replay(&sp, &it, 100, &first), total - 2 * PER_SECTOR);
+    CHECK_EQ_INT(first, 2 * PER_SECTOR);
+}
+
+static void test_power_loss_before_ack_persisted(void)
+{
+    spool_t      sp;
+    spool_iter_t it;
+    uint32_t     first = 0;
+
+    nor_reset();
+    spool_open(&sp, &s_flash, 0);
+    CHECK(append_n(&sp, 0, 10));
+
+    // Delivered and acknowledged in RAM, but the reset comes before the
+    // new ack reaches NVS: everything is sent again (at-least-once).
+    CHECK_EQ_INT(replay(&sp, &it, 100, &first), 10);
+    spool_ack(&sp, &it);
+    CHECK_EQ_INT(spool_pending(&sp), 0);
+    const uint32_t ack = spool_ack_seq(&sp);
+
+    CHECK_EQ_INT(spool_open(&sp, &s_flash, 0), ERR_OK);
+    CHECK_EQ_INT(spool_pending(&sp), 10);
+    CHECK_EQ_INT(replay(&sp, &it, 100, &first), 10);
+    CHECK_EQ_INT(first, 0);
+    CHECK_EQ_INT(sp.stats.lost, 0);
+
+    // Once the ack is persisted, nothing is repeated.
+    CHECK_EQ_INT(spool_open(&sp, &s_flash, ack), ERR_OK);
+    CHECK_EQ_INT(spool_pending(&sp), 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_reopen_after_ack);
+    RUN_TEST(test_torn_append);
+    RUN_TEST(test_wrap_around_loss);
+    RUN_TEST(test_power_loss_before_ack_persisted);
+    return HOST_TEST_RESULT();
+}
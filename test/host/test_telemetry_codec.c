@@ -0,0 +1,277 @@
+/**
+ * Host test and benchmark for the telemetry batch encoders
+ * (telemetry_codec.c).
+ *
+ * The protobuf output is read back with a small decoder written from
+ * proto/telemetry.proto, so the test checks the wire format a server
+ * sees, not the encoder's own view of it. The benchmark encodes the same
+ * batches as protobuf and as JSON and prints bytes and time per sample.
+ */
+
+#include "host_test.h"
+
+#include "core/config.h"
+#include "core/telemetry_codec.h"
+#include "core/timeutil.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// ---------------------------------------------------------------------------
+// Firmware dependencies
+// ---------------------------------------------------------------------------
+
+// thermostat.c is linked for the mode / output names only.
+app_error_t thermostat_config_init(void) { return ERR_OK; }
+app_error_t thermostat_config_get(thermostat_config_t *out) { return ERR_GENERIC; }
+
+bool timeutil_format_iso8601(time_t t, char *buf, size_t buf_len)
+{
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    return strftime(buf, buf_len, "%Y-%m-%dT%H:%M:%SZ", &tm) != 0;
+}
+
+// ---------------------------------------------------------------------------
+// Reference decoder (proto/telemetry.proto)
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int64_t  epoch_s;
+    int32_t  tin, tout, sp, hyst;   // centi-degrees
+    uint32_t mode_output;
+} dec_sample_t;
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    bool           bad;
+} rd_t;
+
+static uint64_t rd_varint(rd_t *r)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->p >= r->end) {
+            r->bad = true;
+            return 0;
+        }
+        const uint8_t b = *r->p++;
+        v |= (uint64_t)(b & 0x7Fu) << shift;
+        if (!(b & 0x80u)) {
+            return v;
+        }
+    }
+    r->bad = true;
+    return 0;
+}
+
+static int32_t unzigzag(uint64_t v)
+{
+    return (int32_t)((uint32_t)(v >> 1) ^ (0u - (uint32_t)(v & 1u)));
+}
+
+/** @return Number of samples decoded, or -1 on a malformed message. */
+static int decode_batch(const uint8_t *buf, size_t len, dec_sample_t *out, int max)
+{
+    rd_t         r    = { buf, buf + len, false };
+    dec_sample_t prev = { 0 };
+    int          n    = 0;
+
+    while (r.p < r.end && !r.bad) {
+        const uint64_t tag   = rd_varint(&r);
+        const uint32_t field = (uint32_t)(tag >> 3);
+
+        if ((tag & 7u) == 2u) {
+            const uint64_t l = rd_varint(&r);
+            if (r.bad || l > (uint64_t)(r.end - r.p)) {
+                return -1;
+            }
+            if (field == 7) {
+                if (n >= max) {
+                    return -1;
+                }
+                rd_t         s = { r.p, r.p + l, false };
+                dec_sample_t d = prev;
+                d.mode_output  = 0;
+                while (s.p < s.end && !s.bad) {
+                    const uint64_t st = rd_varint(&s);
+                    const uint64_t v  = rd_varint(&s);
+                    switch (st >> 3) {
+                    case 1: d.epoch_s    += unzigzag(v); break;
+                    case 2: d.tin        += unzigzag(v); break;
+                    case 3: d.tout       += unzigzag(v); break;
+                    case 4: d.sp         += unzigzag(v); break;
+                    case 5: d.hyst       += unzigzag(v); break;
+                    case 6: d.mode_output = (uint32_t)v; break;
+                    default: s.bad = true;               break;
+                    }
+                }
+                if (s.bad) {
+                    return -1;
+                }
+                out[n++] = d;
+                prev     = d;
+            }
+            r.p += l;
+            continue;
+        }
+
+        const uint64_t v = rd_varint(&r);
+        switch (field) {
+        case 2: prev.epoch_s = (int64_t)v;  break;
+        case 3: prev.tin     = unzigzag(v); break;
+        case 4: prev.tout    = unzigzag(v); break;
+        case 5: prev.sp      = unzigzag(v); break;
+        case 6: prev.hyst    = unzigzag(v); break;
+        default: return -1;
+        }
+    }
+    return r.bad ? -1 : n;
+}
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+/** A living-room afternoon: slow drifts, heater cycling, 10 s apart. */
+static void make_batch(telemetry_record_t *recs, size_t n, uint32_t t0)
+{
+    static uint32_t rng = 1u;
+
+    for (size_t i = 0; i < n; i++) {
+        rng = rng * 1103515245u + 12345u;
+        recs[i] = (telemetry_record_t){
+            .epoch_s      = t0 + 10u * (uint32_t)i,
+            .mode         = THERMOSTAT_MODE_AUTO,
+            .output       = ((t0 / 10u + i) / 7u) & 1u,
+            .setpoint_c   = 21.5f,
+            .hysteresis_c = 0.5f,
+            .tin_c        = 21.0f + (float)((rng >> 16) % 100u) / 100.0f,
+            .tout_c       = 4.0f + (float)((rng >> 8) % 30u) / 100.0f,
+        };
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_round_trip(void)
+{
+    telemetry_record_t recs[TELEMETRY_BATCH_MAX];
+    dec_sample_t       dec[TELEMETRY_BATCH_MAX];
+    uint8_t            buf[1024];
+
+    make_batch(recs, TELEMETRY_BATCH_MAX, 1760000000u);
+    const size_t len = telemetry_encode_pb(TELEMETRY_DEVICE_ID, recs,
+                                           TELEMETRY_BATCH_MAX, buf, sizeof(buf));
+    CHECK(len > 0);
+    CHECK_EQ_INT(decode_batch(buf, len, dec, TELEMETRY_BATCH_MAX), TELEMETRY_BATCH_MAX);
+
+    for (int i = 0; i < TELEMETRY_BATCH_MAX; i++) {
+        CHECK_EQ_INT(dec[i].epoch_s, recs[i].epoch_s);
+        CHECK_EQ_INT(dec[i].tin, lroundf(recs[i].tin_c * 100.0f));
+        CHECK_EQ_INT(dec[i].tout, lroundf(recs[i].tout_c * 100.0f));
+        CHECK_EQ_INT(dec[i].sp, 2150);
+        CHECK_EQ_INT(dec[i].hyst, 50);
+        CHECK_EQ_INT(dec[i].mode_output, recs[i].mode | (recs[i].output << 4));
+    }
+
+    // Too small a buffer is reported, not truncated.
+    CHECK_EQ_INT(telemetry_encode_pb(TELEMETRY_DEVICE_ID, recs, TELEMETRY_BATCH_MAX,
+                                     buf, len - 1), 0);
+}
+
+static void test_clock_steps_back(void)
+{
+    // SNTP correction mid-batch, and an older replayed record.
+    static const uint32_t epochs[] = { 1000000, 1000010, 999990, 999995, 12, 1000020 };
+    const int             n        = (int)(sizeof(epochs) / sizeof(epochs[0]));
+    telemetry_record_t    recs[8];
+    dec_sample_t          dec[8];
+    uint8_t               buf[512];
+
+    make_batch(recs, (size_t)n, 0);
+    for (int i = 0; i < n; i++) {
+        recs[i].epoch_s = epochs[i];
+    }
+
+    const size_t len = telemetry_encode_pb(TELEMETRY_DEVICE_ID, recs, (size_t)n,
+                                           buf, sizeof(buf));
+    CHECK(len > 0);
+    CHECK_EQ_INT(decode_batch(buf, len, dec, n), n);
+    for (int i = 0; i < n; i++) {
+        CHECK_EQ_INT(dec[i].epoch_s, epochs[i]);
+    }
+}
+
+static void test_non_finite_values(void)
+{
+    telemetry_record_t recs[4];
+    dec_sample_t       dec[4];
+    uint8_t            buf[512];
+
+    make_batch(recs, 4, 1760000000u);
+    recs[0].tin_c  = NAN;               // failed sensor in the base
+    recs[1].tin_c  = INFINITY;
+    recs[1].tout_c = -INFINITY;
+    recs[2].tin_c  = 1e20f;
+    recs[3].tout_c = NAN;
+
+    const size_t len = telemetry_encode_pb(TELEMETRY_DEVICE_ID, recs, 4, buf, sizeof(buf));
+    CHECK(len > 0);
+    CHECK_EQ_INT(decode_batch(buf, len, dec, 4), 4);
+    CHECK_EQ_INT(dec[0].tin, INT16_MIN);
+    CHECK_EQ_INT(dec[1].tin, INT16_MAX);
+    CHECK_EQ_INT(dec[1].tout, INT16_MIN);
+    CHECK_EQ_INT(dec[2].tin, INT16_MAX);
+    CHECK_EQ_INT(dec[3].tout, INT16_MIN);
+    CHECK_EQ_INT(dec[3].tin, lroundf(recs[3].tin_c * 100.0f));
+}
+
+static void test_bench_pb_vs_json(void)
+{
+    enum { BATCHES = 2000 };
+    static telemetry_record_t recs[BATCHES][TELEMETRY_BATCH_MAX];
+    static uint8_t            pb[1024];
+    static char               json[8192];
+    uint64_t                  pb_bytes = 0, json_bytes = 0;
+
+    for (int b = 0; b < BATCHES; b++) {
+        make_batch(recs[b], TELEMETRY_BATCH_MAX, 1760000000u + 200u * (uint32_t)b);
+    }
+
+    uint64_t t0 = host_now_ns();
+    for (int b = 0; b < BATCHES; b++) {
+        pb_bytes += telemetry_encode_pb(TELEMETRY_DEVICE_ID, recs[b],
+                                        TELEMETRY_BATCH_MAX, pb, sizeof(pb));
+    }
+    const uint64_t pb_ns = host_now_ns() - t0;
+
+    t0 = host_now_ns();
+    for (int b = 0; b < BATCHES; b++) {
+        json_bytes += telemetry_encode_json(TELEMETRY_DEVICE_ID, recs[b],
+                                            TELEMETRY_BATCH_MAX, json, sizeof(json));
+    }
+    const uint64_t json_ns = host_now_ns() - t0;
+
+    const double samples = (double)BATCHES * TELEMETRY_BATCH_MAX;
+    printf("  %d-sample batches: protobuf %.1f bytes/sample, %.0f ns/sample; "
+           "JSON %.1f bytes/sample, %.0f ns/sample\n",
+           TELEMETRY_BATCH_MAX,
+           (double)pb_bytes / samples, (double)pb_ns / samples,
+           (double)json_bytes / samples, (double)json_ns / samples);
+
+    CHECK(pb_bytes * 10u < json_bytes);
+    CHECK(pb_ns < json_ns);
+}
+
+int main(void)
+{
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_clock_steps_back);
+    RUN_TEST(test_non_finite_values);
+    RUN_TEST(test_bench_pb_vs_json);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,408 @@
+/**
+ * Host test for the telemetry uploader (task_telemetry.c) against a local
+ * HTTP stand-in server.
+ *
+ * The real task runs on a pthread (stubs/host_rtos.c) and reads states
+ * from the real message bus; esp_http_client is a socket shim pointed at
+ * a server thread in this file. The server counts connections and
+ * requests and can answer 200, reject protobuf with 415, or swallow
+ * requests without answering (black-holed collector). watchdog_feed()
+ * records the longest gap between feeds. The flash spool is absent, as
+ * on a board without a "spool" partition.
+ */
+
+#define _GNU_SOURCE
+
+#include "host_test.h"
+
+#include "core/boot.h"
+#include "core/config.h"
+#include "core/monotime.h"
+#include "core/msgbus.h"
+#include "core/telemetry_codec.h"
+#include "core/timeutil.h"
+#include "core/watchdog.h"
+
+#include "app/task_net.h"
+#include "app/task_telemetry.h"
+
+#include "esp_http_client.h"
+#include "esp_partition.h"
+#include "nvs.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// Firmware dependencies
+// ---------------------------------------------------------------------------
+
+bool task_net_is_connected(void) { return true; }
+bool task_net_wait_connected(TickType_t timeout) { return true; }
+bool boot_wait(uint32_t mask, TickType_t timeout) { return true; }
+
+time_t timeutil_now(void) { return time(NULL); }
+bool   timeutil_is_time_set(void) { return true; }
+bool   timeutil_wait_time_set(uint32_t timeout_ms) { return true; }
+
+// thermostat.c is linked for the mode / output names only.
+app_error_t thermostat_config_init(void) { return ERR_OK; }
+app_error_t thermostat_config_get(thermostat_config_t *out) { return ERR_GENERIC; }
+
+bool timeutil_format_iso8601(time_t t, char *buf, size_t buf_len)
+{
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    return strftime(buf, buf_len, "%Y-%m-%dT%H:%M:%SZ", &tm) != 0;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    return NULL;
+}
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t off, void *dst, size_t len) { return ESP_FAIL; }
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t off, const void *src, size_t len) { return ESP_FAIL; }
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t off, size_t len) { return ESP_FAIL; }
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out) { return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_get_u32(nvs_handle_t h, const char *key, uint32_t *out) { return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_set_u32(nvs_handle_t h, const char *key, uint32_t value) { return ESP_FAIL; }
+esp_err_t nvs_commit(nvs_handle_t h) { return ESP_FAIL; }
+void      nvs_close(nvs_handle_t h) { }
+
+static struct {
+    pthread_mutex_t m;
+    uint32_t        feeds;
+    mono_us_t       last_us;
+    uint64_t        max_gap_us;
+} s_wdt = { .m = PTHREAD_MUTEX_INITIALIZER };
+
+void watchdog_loop_begin(void) { }
+
+esp_err_t watchdog_feed(void)
+{
+    const mono_us_t now = monotime_now_us();
+
+    pthread_mutex_lock(&s_wdt.m);
+    if (s_wdt.last_us != 0 && now - s_wdt.last_us > s_wdt.max_gap_us) {
+        s_wdt.max_gap_us = now - s_wdt.last_us;
+    }
+    s_wdt.last_us = now;
+    s_wdt.feeds++;
+    pthread_mutex_unlock(&s_wdt.m);
+    return ESP_OK;
+}
+
+static uint32_t wdt_feeds(void)
+{
+    pthread_mutex_lock(&s_wdt.m);
+    const uint32_t n = s_wdt.feeds;
+    pthread_mutex_unlock(&s_wdt.m);
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Stand-in collector
+// ---------------------------------------------------------------------------
+
+typedef enum {
+    SRV_OK = 0,         // 200 to everything
+    SRV_REJECT_PB,      // 415 to protobuf, 200 to JSON
+    SRV_BLACKHOLE,      // read requests, never answer
+} srv_mode_t;
+
+#define SRV_MAX_REQ 256
+
+typedef struct {
+    bool     pb;
+    int      status;        // 0: not answered
+    uint32_t head_bytes;
+    uint32_t body_bytes;
+    uint32_t feeds;         // watchdog feeds seen when it arrived
+} srv_req_t;
+
+static struct {
+    pthread_mutex_t m;
+    int             listen_fd;
+    volatile int    mode;
+    uint32_t        connections;
+    uint32_t        nreq;
+    srv_req_t       req[SRV_MAX_REQ];
+} s_srv = { .m = PTHREAD_MUTEX_INITIALIZER };
+
+/** Read one request; false when the client closed the connection. */
+static bool srv_read_request(int fd, srv_req_t *r)
+{
+    static char buf[16384];
+    size_t      len = 0;
+    char       *end = NULL;
+
+    while (end == NULL) {
+        ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        len += (size_t)n;
+        buf[len] = '\0';
+        end = strstr(buf, "\r\n\r\n");
+    }
+
+    const char *cl = strcasestr(buf, "\r\nContent-Length:");
+    const int   body_len = (cl != NULL) ? atoi(cl + 17) : 0;
+    const char *ct = strcasestr(buf, "\r\nContent-Type:");
+
+    r->head_bytes = (uint32_t)(end + 4 - buf);
+    r->body_bytes = (uint32_t)body_len;
+    r->pb         = (ct != NULL) && strncmp(ct + 16, TELEMETRY_CONTENT_TYPE_PB,
+                                            strlen(TELEMETRY_CONTENT_TYPE_PB)) == 0;
+    r->feeds      = wdt_feeds();
+
+    size_t have = len - r->head_bytes;
+    while ((int)have < body_len) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return false;
+        }
+        have += (size_t)n;
+    }
+    return true;
+}
+
+static void *srv_thread(void *arg)
+{
+    while (1) {
+        const int fd = accept(s_srv.listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        pthread_mutex_lock(&s_srv.m);
+        s_srv.connections++;
+        pthread_mutex_unlock(&s_srv.m);
+
+        srv_req_t r;
+        while (srv_read_request(fd, &r)) {
+            const srv_mode_t mode = (srv_mode_t)s_srv.mode;
+            r.status = (mode == SRV_BLACKHOLE)           ? 0
+                     : (mode == SRV_REJECT_PB && r.pb)   ? 415
+                                                         : 200;
+            pthread_mutex_lock(&s_srv.m);
+            if (s_srv.nreq < SRV_MAX_REQ) {
+                s_srv.req[s_srv.nreq++] = r;
+            }
+            pthread_mutex_unlock(&s_srv.m);
+
+            if (r.status != 0) {
+                char resp[96];
+                const int n = snprintf(resp, sizeof(resp),
+                                       "HTTP/1.1 %d %s\r\nContent-Length: 0\r\n\r\n",
+                                       r.status, r.status == 200 ? "OK" : "Unsupported");
+                send(fd, resp, (size_t)n, MSG_NOSIGNAL);
+            }
+        }
+        close(fd);
+    }
+    return NULL;
+}
+
+static int srv_start(void)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    socklen_t          alen = sizeof(addr);
+
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    s_srv.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    bind(s_srv.listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+    listen(s_srv.listen_fd, 4);
+    getsockname(s_srv.listen_fd, (struct sockaddr *)&addr, &alen);
+
+    pthread_t t;
+    pthread_create(&t, NULL, srv_thread, NULL);
+    pthread_detach(t);
+    return ntohs(addr.sin_port);
+}
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+#define STATE_RING_DEPTH 64
+
+static uint8_t s_ring_state[MSGBUS_RING_BYTES(sizeof(thermostat_state_t), STATE_RING_DEPTH)]
+    __attribute__((aligned(8)));
+
+static void publish_states(int n)
+{
+    static float t = 20.0f;
+    for (int i = 0; i < n; i++) {
+        const thermostat_state_t st = {
+            .mode         = THERMOSTAT_MODE_HEAT,
+            .output       = (i & 8) ? THERMOSTAT_OUTPUT_HEAT_ON : THERMOSTAT_OUTPUT_OFF,
+            .setpoint_c   = 21.5f,
+            .hysteresis_c = 0.5f,
+            .tin_c        = t,
+            .tout_c       = 4.2f,
+            .timestamp_us = monotime_now_us(),
+        };
+        t += 0.01f;
+        msgbus_publish(MSGBUS_TOPIC_THERMOSTAT_STATE, &st);
+        vTaskDelay(1);
+    }
+}
+
+static telemetry_stats_t stats(void)
+{
+    telemetry_stats_t st;
+    task_telemetry_get_stats(&st);
+    return st;
+}
+
+/** Poll until samples_sent reaches @p n; false after @p timeout_ms. */
+static bool wait_sent(uint32_t n, uint32_t timeout_ms)
+{
+    for (uint32_t t = 0; t < timeout_ms; t += 10) {
+        if (stats().samples_sent >= n) {
+            return true;
+        }
+        vTaskDelay(10);
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_batches_share_one_connection(void)
+{
+    publish_states(200);
+    CHECK(wait_sent(200, 10000));
+
+    pthread_mutex_lock(&s_srv.m);
+    const uint32_t conns = s_srv.connections;
+    const uint32_t nreq  = s_srv.nreq;
+    uint32_t       bytes = 0, head = 0;
+    for (uint32_t i = 0; i < nreq; i++) {
+        CHECK(s_srv.req[i].pb);
+        CHECK_EQ_INT(s_srv.req[i].status, 200);
+        bytes += s_srv.req[i].head_bytes + s_srv.req[i].body_bytes;
+        head  += s_srv.req[i].head_bytes;
+    }
+    pthread_mutex_unlock(&s_srv.m);
+
+    CHECK_EQ_INT(conns, 1);
+    CHECK_EQ_INT(nreq, 200 / TELEMETRY_BATCH_MAX);
+    CHECK_EQ_INT(stats().samples_sent, 200);
+
+    // Per-sample cost of the old uploader: one connection and one JSON
+    // POST per sample (same headers, single-record body).
+    telemetry_record_t rec;
+    thermostat_state_t st = { .setpoint_c = 21.5f, .hysteresis_c = 0.5f,
+                              .tin_c = 21.03f, .tout_c = 4.2f };
+    char               json[512];
+    telemetry_record_from_state(&st, time(NULL), 0, &rec);
+    const size_t one = telemetry_encode_json(TELEMETRY_DEVICE_ID, &rec, 1, json, sizeof(json));
+    const double per_sample_old = (double)head / nreq + (double)one;
+    const double per_sample_new = (double)bytes / 200.0;
+
+    printf("  200 samples: %u connection, %u POSTs, %.1f HTTP bytes/sample "
+           "(one POST per sample: %.1f bytes + 1 connection each)\n",
+           (unsigned)conns, (unsigned)nreq, per_sample_new, per_sample_old);
+    CHECK(per_sample_new * 10.0 <= per_sample_old);
+}
+
+static void test_415_falls_back_to_json_next_loop(void)
+{
+    const uint32_t first = s_srv.nreq;
+
+    s_srv.mode = SRV_REJECT_PB;
+    publish_states(TELEMETRY_BATCH_MAX);
+    CHECK(wait_sent(200 + TELEMETRY_BATCH_MAX, 5000));
+
+    pthread_mutex_lock(&s_srv.m);
+    CHECK_EQ_INT(s_srv.nreq - first, 2);
+    CHECK(s_srv.req[first].pb);
+    CHECK_EQ_INT(s_srv.req[first].status, 415);
+    CHECK(!s_srv.req[first + 1].pb);
+    CHECK_EQ_INT(s_srv.req[first + 1].status, 200);
+    pthread_mutex_unlock(&s_srv.m);
+    CHECK_EQ_INT(stats().post_failures, 0);
+    s_srv.mode = SRV_OK;
+}
+
+static void test_blackholed_collector_keeps_feeding(void)
+{
+    const uint32_t sent_before = stats().samples_sent;
+
+    s_srv.mode = SRV_BLACKHOLE;
+    pthread_mutex_lock(&s_wdt.m);
+    s_wdt.max_gap_us = 0;
+    pthread_mutex_unlock(&s_wdt.m);
+
+    publish_states(TELEMETRY_BATCH_MAX);
+    for (int t = 0; t < 15000 && stats().post_failures == 0; t += 10) {
+        vTaskDelay(10);
+    }
+    CHECK_EQ_INT(stats().post_failures, 1);
+    s_srv.mode = SRV_OK;
+
+    // Kept in RAM through the back-off, then delivered on a new connection.
+    CHECK(wait_sent(sent_before + TELEMETRY_BATCH_MAX,
+                    TELEMETRY_RETRY_MS + 5000));
+    CHECK_EQ_INT(stats().dropped, 0);
+    CHECK_EQ_INT(s_srv.connections, 2);
+
+    pthread_mutex_lock(&s_wdt.m);
+    const uint64_t gap_ms = s_wdt.max_gap_us / 1000u;
+    pthread_mutex_unlock(&s_wdt.m);
+    printf("  black-holed POST: longest feed gap %u ms (deadline %u ms)\n",
+           (unsigned)gap_ms, (unsigned)TELEMETRY_WDT_DEADLINE_MS);
+    CHECK(gap_ms >= TELEMETRY_HTTP_TIMEOUT_MS);
+    CHECK(gap_ms < TELEMETRY_WDT_DEADLINE_MS);
+}
+
+static void test_one_post_per_loop(void)
+{
+    // Every request arrived after a feed the previous one did not see.
+    pthread_mutex_lock(&s_srv.m);
+    for (uint32_t i = 1; i < s_srv.nreq; i++) {
+        CHECK(s_srv.req[i].feeds > s_srv.req[i - 1].feeds);
+    }
+    pthread_mutex_unlock(&s_srv.m);
+}
+
+static void *telemetry_thread(void *arg)
+{
+    task_telemetry(arg);
+    return NULL;
+}
+
+int main(void)
+{
+    msgbus_topic_init(MSGBUS_TOPIC_THERMOSTAT_STATE, s_ring_state,
+                      sizeof(thermostat_state_t), STATE_RING_DEPTH);
+    host_http_client_redirect(srv_start());
+
+    pthread_t task;
+    pthread_create(&task, NULL, telemetry_thread, NULL);
+
+    msgbus_topic_stats_t ts = { 0 };
+    while (ts.subscribers == 0) {
+        vTaskDelay(1);
+        msgbus_get_topic_stats(MSGBUS_TOPIC_THERMOSTAT_STATE, &ts);
+    }
+
+    RUN_TEST(test_batches_share_one_connection);
+    RUN_TEST(test_415_falls_back_to_json_next_loop);
+    RUN_TEST(test_blackholed_collector_keeps_feeding);
+    RUN_TEST(test_one_post_per_loop);
+
+    // The task never returns; exiting main ends it.
+    return HOST_TEST_RESULT();
+}
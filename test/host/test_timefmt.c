@@ -0,0 +1,195 @@
+/**
+ * Host test and benchmark for the calendar math and cached ISO 8601
+ * formatter (timefmt.c) behind timeutil_format_iso8601().
+ *
+ * Every string is compared with localtime_r() + strftime("%Y-%m-%dT
+ * %H:%M:%S%z") under the same TZ, across several zones: no DST, northern
+ * and southern DST rules, and half- and quarter-hour offsets. The
+ * sequences mix what the firmware does, namely live seconds in a row
+ * (minute cache), back-dated replayed samples (cache misses), and runs
+ * across DST edges.
+ */
+
+#include "host_test.h"
+
+#include "core/timefmt.h"
+
+#include <stdlib.h>
+
+static const char *const s_zones[] = {
+    "UTC0",
+    "PST8PDT,M3.2.0,M11.1.0",           // firmware default
+    "CET-1CEST,M3.5.0,M10.5.0/3",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3",     // DST across the new year
+    "IST-5:30",
+    "<+0545>-5:45",
+};
+
+static void set_zone(const char *tz)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+    timefmt_tz_changed();
+}
+
+/** @return true if timefmt and libc agree on @p t (prints the first few misses). */
+static bool same_as_libc(time_t t)
+{
+    static int reported = 0;
+    char       got[32];
+    char       want[32];
+    struct tm  lt;
+
+    localtime_r(&t, &lt);
+    strftime(want, sizeof(want), "%Y-%m-%dT%H:%M:%S%z", &lt);
+    if (!timefmt_iso8601(t, got, sizeof(got)) || strcmp(got, want) != 0) {
+        if (reported++ < 10) {
+            fprintf(stderr, "  TZ=%s t=%lld: got %s, libc %s\n",
+                    getenv("TZ"), (long long)t, got, want);
+        }
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_civil_round_trip(void)
+{
+    uint32_t bad = 0;
+
+    // Year 0001 to 9999, and past both ends for the round trip.
+    for (int64_t z = -800000; z <= 3000000; z++) {
+        int32_t  y;
+        uint32_t m, d;
+        timefmt_civil_from_days(z, &y, &m, &d);
+        if (timefmt_days_from_civil(y, m, d) != z || m < 1 || m > 12 || d < 1 || d > 31) {
+            bad++;
+            continue;
+        }
+        if (z % 97 == 0 && z >= -719162 && z < 2932897) {      // 0001-01-01 .. 9999-12-31
+            const time_t t = (time_t)(z * 86400);
+            struct tm    tm;
+            gmtime_r(&t, &tm);
+            if (tm.tm_year + 1900 != y || (uint32_t)tm.tm_mon + 1u != m ||
+                (uint32_t)tm.tm_mday != d) {
+                bad++;
+            }
+        }
+    }
+    CHECK_EQ_INT(bad, 0);
+
+    CHECK_EQ_INT(timefmt_days_from_civil(1970, 1, 1), 0);
+    CHECK_EQ_INT(timefmt_days_from_civil(2000, 2, 29), 11016);
+    CHECK_EQ_INT(timefmt_days_from_civil(2100, 3, 1) - timefmt_days_from_civil(2100, 2, 28), 1);
+}
+
+static void test_matches_strftime(void)
+{
+    uint32_t bad = 0, checked = 0;
+    uint32_t rng = 12345u;
+
+    for (size_t z = 0; z < sizeof(s_zones) / sizeof(s_zones[0]); z++) {
+        set_zone(s_zones[z]);
+
+        // Random times 1970..2099, one cache miss after another.
+        for (int i = 0; i < 20000; i++) {
+            rng = rng * 1103515245u + 12345u;
+            const time_t t = (time_t)(((uint64_t)rng << 2) % 4102444800u);
+            bad += !same_as_libc(t);
+            checked++;
+        }
+
+        // Live clock through 2025 in 97 s steps, with a back-dated sample
+        // (up to ten minutes old) formatted between the live ones.
+        for (time_t t = 1735689600; t < 1767225600; t += 97) {
+            bad += !same_as_libc(t);
+            bad += !same_as_libc(t - (time_t)((t / 97) % 600));
+            checked += 2;
+        }
+
+        // Every second of the four hours around each 2025 offset change.
+        for (time_t t = 1735689600; t < 1767225600; t += 3600) {
+            struct tm a, b;
+            const time_t n = t + 3600;
+            localtime_r(&t, &a);
+            localtime_r(&n, &b);
+            if (a.tm_gmtoff == b.tm_gmtoff) {
+                continue;
+            }
+            for (time_t s = t - 7200; s < t + 7200; s++) {
+                bad += !same_as_libc(s);
+                checked++;
+            }
+        }
+
+        // Either side of the epoch, both ways (-30 s is in the same
+        // minute as +30 s by integer division).
+        for (time_t t = -90; t <= 90; t++) {
+            bad += !same_as_libc(t);
+            bad += !same_as_libc(-t);
+            checked += 2;
+        }
+    }
+
+    printf("  %u times in %zu zones checked against strftime\n",
+           (unsigned)checked, sizeof(s_zones) / sizeof(s_zones[0]));
+    CHECK_EQ_INT(bad, 0);
+}
+
+static void test_short_buffer(void)
+{
+    char buf[32];
+    CHECK(!timefmt_iso8601(0, buf, 31));
+    CHECK(timefmt_iso8601(0, buf, 32));
+}
+
+static void test_bench_vs_strftime(void)
+{
+    enum { N = 1000000 };
+    char      buf[32];
+    size_t    sink = 0;
+    struct tm lt;
+
+    set_zone("PST8PDT,M3.2.0,M11.1.0");
+
+    // Live seconds in a row, as the loggers and uploaders ask for them.
+    uint64_t t0 = host_now_ns();
+    for (int i = 0; i < N; i++) {
+        timefmt_iso8601((time_t)(1760000000 + i), buf, sizeof(buf));
+        sink += (size_t)buf[18];
+    }
+    const double live_ns = (double)(host_now_ns() - t0) / N;
+
+    // Scattered back-dated times inside one DST period: full format.
+    t0 = host_now_ns();
+    for (int i = 0; i < N; i++) {
+        timefmt_iso8601((time_t)(1760000000 + (i * 7919) % 2000000), buf, sizeof(buf));
+        sink += (size_t)buf[18];
+    }
+    const double scattered_ns = (double)(host_now_ns() - t0) / N;
+
+    t0 = host_now_ns();
+    for (int i = 0; i < N; i++) {
+        const time_t t = (time_t)(1760000000 + (i * 7919) % 2000000);
+        localtime_r(&t, &lt);
+        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S%z", &lt);
+        sink += (size_t)buf[18];
+    }
+    const double libc_ns = (double)(host_now_ns() - t0) / N;
+
+    printf("  ISO 8601: %.0f ns live, %.0f ns scattered; localtime_r+strftime %.0f ns "
+           "(%zu)\n", live_ns, scattered_ns, libc_ns, sink % 10);
+    CHECK(scattered_ns < libc_ns);
+}
+
+int main(void)
+{
+    RUN_TEST(test_civil_round_trip);
+    RUN_TEST(test_matches_strftime);
+    RUN_TEST(test_short_buffer);
+    RUN_TEST(test_bench_vs_strftime);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,259 @@
+/**
+ * Host test for the Wi-Fi reconnect state machine (wifi_conn.c).
+ *
+ * A simulated driver stands in for esp_wifi: after esp_wifi_connect()
+ * it reports GOT_IP once the association succeeds, or DISCONNECTED
+ * after the auth timeout while the AP is down, and it repeats
+ * DISCONNECTED the way the real driver does. Each simulated device runs
+ * the same loop as the NET task: apply events, sleep wifi_conn_wait_ms(),
+ * poll. The test checks every backoff delay against the documented
+ * bounds, and checks how a fleet spreads its reconnects after an AP
+ * reboot.
+ */
+
+#include "host_test.h"
+
+#include "core/config.h"
+#include "core/wifi_conn.h"
+
+#include <stdlib.h>
+
+#define SIM_STEP_MS     10u
+#define ASSOC_MS        300u        // connect -> GOT_IP with the AP up
+#define AUTH_FAIL_MS    3000u       // connect -> DISCONNECTED with the AP down
+#define DUP_DISC_MS     20u         // driver repeats DISCONNECTED after this
+#define NO_EVENT        UINT32_MAX
+
+// ---------------------------------------------------------------------------
+// Simulated device: state machine + driver
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    wifi_conn_t       conn;
+    wifi_conn_event_t ev;           // pending driver event
+    uint32_t          ev_at;        // NO_EVENT if none
+    uint32_t          dup_at;       // pending repeated DISCONNECTED
+    uint32_t          connects;     // esp_wifi_connect() calls
+    uint32_t          bad_delays;   // backoffs outside [ceiling/2, ceiling]
+    uint32_t          max_delay;
+} sim_dev_t;
+
+static bool s_ap_up;
+
+static uint32_t ceiling_for(const wifi_conn_t *c, uint32_t attempt)
+{
+    const uint32_t shift = (attempt < 16u) ? attempt : 16u;
+    const uint64_t ceil  = (uint64_t)c->base_ms << shift;
+    return (ceil > c->max_ms) ? c->max_ms : (uint32_t)ceil;
+}
+
+static void esp_wifi_connect_sim(sim_dev_t *d, uint32_t now)
+{
+    d->connects++;
+    d->ev    = s_ap_up ? WIFI_CONN_EV_GOT_IP : WIFI_CONN_EV_DISCONNECTED;
+    d->ev_at = now + (s_ap_up ? ASSOC_MS : AUTH_FAIL_MS);
+}
+
+static void dev_apply(sim_dev_t *d, wifi_conn_event_t ev, uint32_t now)
+{
+    const uint32_t attempt = d->conn.attempt;
+    const bool     was_backoff = (d->conn.state == WIFI_CONN_BACKOFF);
+
+    if (wifi_conn_on_event(&d->conn, ev, now)) {
+        esp_wifi_connect_sim(d, now);
+    }
+
+    if (d->conn.state == WIFI_CONN_BACKOFF && !was_backoff) {
+        const uint32_t delay = d->conn.retry_at_ms - now;
+        const uint32_t ceil  = ceiling_for(&d->conn, attempt);
+        if (delay < ceil / 2u || delay > ceil) {
+            d->bad_delays++;
+        }
+        if (delay > d->max_delay) {
+            d->max_delay = delay;
+        }
+        CHECK_EQ_INT(d->conn.attempt, attempt + 1u);
+    }
+    if (ev == WIFI_CONN_EV_DISCONNECTED) {
+        d->dup_at = now + DUP_DISC_MS;
+    }
+}
+
+static void dev_init(sim_dev_t *d, uint32_t seed, uint32_t now)
+{
+    memset(d, 0, sizeof(*d));
+    wifi_conn_init(&d->conn, WIFI_BACKOFF_BASE_MS, WIFI_BACKOFF_MAX_MS, seed);
+    d->ev_at  = NO_EVENT;
+    d->dup_at = NO_EVENT;
+    dev_apply(d, WIFI_CONN_EV_START, now);
+}
+
+/** One NET task iteration at @p now. */
+static void dev_step(sim_dev_t *d, uint32_t now)
+{
+    if (d->ev_at != NO_EVENT && (int32_t)(now - d->ev_at) >= 0) {
+        d->ev_at = NO_EVENT;
+        dev_apply(d, d->ev, now);
+    }
+    if (d->dup_at != NO_EVENT && (int32_t)(now - d->dup_at) >= 0) {
+        d->dup_at = NO_EVENT;
+        const uint32_t a = d->conn.attempt;
+        wifi_conn_on_event(&d->conn, WIFI_CONN_EV_DISCONNECTED, now);
+        CHECK_EQ_INT(d->conn.attempt, a);   // repeats do not count
+    }
+    if (wifi_conn_poll(&d->conn, now)) {
+        esp_wifi_connect_sim(d, now);
+    }
+}
+
+/** The AP drops everyone (reboot / power cut). */
+static void dev_kick(sim_dev_t *d, uint32_t now)
+{
+    if (d->conn.state == WIFI_CONN_CONNECTED) {
+        d->ev    = WIFI_CONN_EV_DISCONNECTED;
+        d->ev_at = now;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static void test_backoff_bounds_and_growth(void)
+{
+    wifi_conn_t c;
+    uint32_t    now = 1000;
+
+    wifi_conn_init(&c, WIFI_BACKOFF_BASE_MS, WIFI_BACKOFF_MAX_MS, 1);
+    CHECK_EQ_INT(c.state, WIFI_CONN_IDLE);
+    CHECK(!wifi_conn_on_event(&c, WIFI_CONN_EV_DISCONNECTED, now));
+    CHECK_EQ_INT(c.state, WIFI_CONN_IDLE);
+    CHECK(wifi_conn_on_event(&c, WIFI_CONN_EV_START, now));
+    CHECK_EQ_INT(c.state, WIFI_CONN_CONNECTING);
+
+    for (uint32_t a = 0; a < 24; a++) {
+        CHECK(!wifi_conn_on_event(&c, WIFI_CONN_EV_DISCONNECTED, now));
+        CHECK_EQ_INT(c.state, WIFI_CONN_BACKOFF);
+        CHECK_EQ_INT(c.attempt, a + 1u);
+
+        const uint32_t delay = c.retry_at_ms - now;
+        const uint32_t ceil  = ceiling_for(&c, a);
+        CHECK(delay >= ceil / 2u && delay <= ceil);
+        CHECK_EQ_INT(wifi_conn_wait_ms(&c, now, UINT32_MAX), delay);
+        CHECK_EQ_INT(wifi_conn_wait_ms(&c, now, 1000), delay < 1000 ? delay : 1000);
+
+        CHECK(!wifi_conn_poll(&c, now + delay - 1u));
+        now += delay;
+        CHECK_EQ_INT(wifi_conn_wait_ms(&c, now, 1000), 0);
+        CHECK(wifi_conn_poll(&c, now));
+        CHECK_EQ_INT(c.state, WIFI_CONN_CONNECTING);
+        CHECK(!wifi_conn_poll(&c, now));
+    }
+    CHECK_EQ_INT(ceiling_for(&c, c.attempt), WIFI_BACKOFF_MAX_MS);
+
+    // Success resets the backoff.
+    CHECK(!wifi_conn_on_event(&c, WIFI_CONN_EV_GOT_IP, now));
+    CHECK_EQ_INT(c.state, WIFI_CONN_CONNECTED);
+    CHECK_EQ_INT(c.attempt, 0);
+    CHECK_EQ_INT(wifi_conn_wait_ms(&c, now, 1000), 1000);
+}
+
+static void test_lost_ip_and_clock_wrap(void)
+{
+    wifi_conn_t    c;
+    const uint32_t now = UINT32_MAX - 100u;     // ~49.7 days of uptime
+
+    wifi_conn_init(&c, WIFI_BACKOFF_BASE_MS, WIFI_BACKOFF_MAX_MS, 7);
+    wifi_conn_on_event(&c, WIFI_CONN_EV_START, now);
+    wifi_conn_on_event(&c, WIFI_CONN_EV_GOT_IP, now);
+
+    // DHCP lease lost: still associated, wait for an address.
+    CHECK(!wifi_conn_on_event(&c, WIFI_CONN_EV_LOST_IP, now));
+    CHECK_EQ_INT(c.state, WIFI_CONN_CONNECTING);
+    CHECK(!wifi_conn_on_event(&c, WIFI_CONN_EV_LOST_IP, now));
+    CHECK_EQ_INT(c.state, WIFI_CONN_CONNECTING);
+
+    // Backoff deadline past the millisecond wrap.
+    wifi_conn_on_event(&c, WIFI_CONN_EV_DISCONNECTED, now);
+    const uint32_t delay = c.retry_at_ms - now;
+    CHECK(delay > 100u);
+    CHECK_EQ_INT(wifi_conn_wait_ms(&c, now, UINT32_MAX), delay);
+    CHECK(!wifi_conn_poll(&c, now + 101u));
+    CHECK_EQ_INT(wifi_conn_wait_ms(&c, now + 101u, UINT32_MAX), delay - 101u);
+    CHECK(wifi_conn_poll(&c, now + delay));
+}
+
+static void test_fleet_after_ap_reboot(void)
+{
+    enum { DEVICES = 200 };
+    const uint32_t down_at  = 10000;
+    const uint32_t up_at    = down_at + 90000;      // AP back after 90 s
+    const uint32_t end_at   = up_at + 2u * WIFI_BACKOFF_MAX_MS;
+    static sim_dev_t dev[DEVICES];
+    static uint16_t  per_sec[(2u * WIFI_BACKOFF_MAX_MS) / 1000u + 1u];
+    uint32_t         all_up_at = 0;
+
+    s_ap_up = true;
+    for (int i = 0; i < DEVICES; i++) {
+        dev_init(&dev[i], 0x1234u + (uint32_t)i * 7919u, 0);
+    }
+
+    for (uint32_t now = 0; now <= end_at; now += SIM_STEP_MS) {
+        if (now == down_at) {
+            s_ap_up = false;
+            for (int i = 0; i < DEVICES; i++) {
+                dev_kick(&dev[i], now);
+            }
+        }
+        if (now == up_at) {
+            s_ap_up = true;
+        }
+
+        uint32_t connected = 0;
+        for (int i = 0; i < DEVICES; i++) {
+            const uint32_t before = dev[i].connects;
+            dev_step(&dev[i], now);
+            if (now >= up_at && dev[i].connects != before) {
+                per_sec[(now - up_at) / 1000u]++;
+            }
+            connected += (dev[i].conn.state == WIFI_CONN_CONNECTED);
+        }
+        if (now >= up_at && all_up_at == 0 && connected == DEVICES) {
+            all_up_at = now;
+        }
+    }
+
+    uint32_t bad = 0, connects = 0, max_delay = 0, peak = 0;
+    for (int i = 0; i < DEVICES; i++) {
+        bad      += dev[i].bad_delays;
+        connects += dev[i].connects;
+        if (dev[i].max_delay > max_delay) {
+            max_delay = dev[i].max_delay;
+        }
+    }
+    for (size_t s = 0; s < sizeof(per_sec) / sizeof(per_sec[0]); s++) {
+        if (per_sec[s] > peak) {
+            peak = per_sec[s];
+        }
+    }
+
+    printf("  %d devices, AP down %u s: %.1f connects/device, longest backoff %u ms, "
+           "all back %u ms after the AP, peak %u connects/s\n",
+           DEVICES, (unsigned)((up_at - down_at) / 1000u), (double)connects / DEVICES,
+           (unsigned)max_delay, (unsigned)(all_up_at - up_at), (unsigned)peak);
+
+    CHECK_EQ_INT(bad, 0);
+    CHECK(max_delay <= WIFI_BACKOFF_MAX_MS);
+    CHECK(all_up_at != 0);
+    CHECK(all_up_at - up_at <= WIFI_BACKOFF_MAX_MS + AUTH_FAIL_MS + ASSOC_MS);
+    // Jitter spreads the fleet: no second sees more than a fifth of it.
+    CHECK(peak * 5u <= DEVICES);
+}
+
+int main(void)
+{
+    RUN_TEST(test_backoff_bounds_and_growth);
+    RUN_TEST(test_lost_ip_and_clock_wrap);
+    RUN_TEST(test_fleet_after_ap_reboot);
+    return HOST_TEST_RESULT();
+}